@@ -0,0 +1,431 @@
+// artifact_cache.cpp
+// 提供了 ArtifactCache 类的具体实现。
+//
+// 目录布局：
+//   objects/<键的前两位十六进制>/<键>/  已发布的条目：压缩后的文件与 .index
+//   tmp/<随机名>/                        写入者的暂存目录
+//   trash/<随机名>/                      正在删除的条目
+//
+// 条目索引 .index 为文本：第一行是压缩级别（0 = fast，1 = high），
+// 其后每个文件一行 "<原始字节数>\t<落盘字节数>\t<文件名>"。
+
+module artifact_cache;
+
+import std;
+import compression;
+
+using namespace importa::artifact_cache;
+namespace compression = importa::compression;
+
+namespace
+{ // 内部辅助函数
+
+constexpr std::string_view kIndexName = ".index";
+
+std::string to_hex(std::uint64_t value)
+{
+    std::array<char, 16> buffer;
+    auto [ptr, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16);
+    std::string hex(buffer.data(), ptr);
+    return std::string(16 - hex.size(), '0') + hex;
+}
+
+std::string unique_name()
+{
+    static std::atomic<std::uint64_t> counter = 0;
+    return std::to_string(std::random_device{}()) + "-" +
+           std::to_string(counter++);
+}
+
+std::uintmax_t directory_bytes(const path& dir)
+{
+    std::uintmax_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        std::error_code size_ec;
+        auto size = entry.file_size(size_ec);
+        if (!size_ec)
+        {
+            total += size;
+        }
+    }
+    return total;
+}
+
+// --- 条目索引 ---
+
+struct IndexedFile
+{
+    std::string name;
+    compression::FileSizes sizes;
+};
+
+struct EntryIndex
+{
+    compression::Level level = compression::Level::fast;
+    std::vector<IndexedFile> files;
+
+    compression::FileSizes total() const
+    {
+        compression::FileSizes sum;
+        for (const auto& file : files)
+        {
+            sum.raw_bytes += file.sizes.raw_bytes;
+            sum.stored_bytes += file.sizes.stored_bytes;
+        }
+        return sum;
+    }
+};
+
+// 先写临时文件再 rename，重新压缩时并发的读取者不会读到半个索引
+bool write_index(const path& dir, const EntryIndex& index)
+{
+    const path temp =
+        dir / (std::string(kIndexName) + ".tmp-" + unique_name());
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << (index.level == compression::Level::high ? 1 : 0) << "\n";
+        for (const auto& file : index.files)
+        {
+            out << file.sizes.raw_bytes << "\t" << file.sizes.stored_bytes
+                << "\t" << file.name << "\n";
+        }
+        if (!out.flush())
+        {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, dir / kIndexName, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<EntryIndex> read_index(const path& dir)
+{
+    std::ifstream in(dir / kIndexName);
+    int level = 0;
+    if (!(in >> level))
+    {
+        return std::nullopt;
+    }
+    EntryIndex index;
+    index.level = level == 1 ? compression::Level::high
+                             : compression::Level::fast;
+    IndexedFile file;
+    while (in >> file.sizes.raw_bytes >> file.sizes.stored_bytes &&
+           in.get() == '\t' && std::getline(in, file.name))
+    {
+        index.files.push_back(file);
+    }
+    return index;
+}
+
+// 条目的字节数；索引缺失（例如正被淘汰）时按目录中的文件估算
+compression::FileSizes entry_sizes(const path& dir)
+{
+    if (auto index = read_index(dir))
+    {
+        return index->total();
+    }
+    const auto bytes = directory_bytes(dir);
+    return { .raw_bytes = bytes, .stored_bytes = bytes };
+}
+
+compression::FileSizes total_sizes(const path& objects_dir)
+{
+    compression::FileSizes total;
+    std::error_code ec;
+    for (const auto& shard :
+         std::filesystem::directory_iterator(objects_dir, ec))
+    {
+        for (const auto& entry :
+             std::filesystem::directory_iterator(shard.path(), ec))
+        {
+            const auto sizes = entry_sizes(entry.path());
+            total.raw_bytes += sizes.raw_bytes;
+            total.stored_bytes += sizes.stored_bytes;
+        }
+    }
+    return total;
+}
+
+// 以 high 级别逐个改写条目中的文件；保留条目的使用时间
+bool recompress_entry(const path& dir, EntryIndex& index,
+                      std::filesystem::file_time_type last_use)
+{
+    std::error_code ec;
+    for (auto& file : index.files)
+    {
+        const path packed = dir / file.name;
+        const path temp = dir / (file.name + ".tmp-" + unique_name());
+        auto sizes = compression::recompress_file(packed, temp,
+                                                  compression::Level::high);
+        if (sizes)
+        {
+            std::filesystem::rename(temp, packed, ec);
+        }
+        if (!sizes || ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        file.sizes = *sizes;
+    }
+    index.level = compression::Level::high;
+    const bool written = write_index(dir, index);
+    // 改写文件会更新目录的修改时间，恢复它以免冷条目被当作刚被使用
+    std::filesystem::last_write_time(dir, last_use, ec);
+    return written;
+}
+
+// 先移出可见位置再删除，其他进程只会看到完整的条目或没有条目
+void retire(const path& dir, const path& trash_dir)
+{
+    std::error_code ec;
+    const path doomed = trash_dir / unique_name();
+    std::filesystem::rename(dir, doomed, ec);
+    if (!ec)
+    {
+        std::filesystem::remove_all(doomed, ec);
+    }
+}
+} // namespace
+
+ArtifactCache::ArtifactCache(path root, ArtifactCacheOptions options)
+    : m_root(std::move(root)), m_options(options)
+{
+    std::filesystem::create_directories(m_root / "objects");
+    std::filesystem::create_directories(m_root / "tmp");
+    std::filesystem::create_directories(m_root / "trash");
+}
+
+ArtifactCache::~ArtifactCache() = default; // m_trimmer 在析构时 join
+
+path ArtifactCache::stage()
+{
+    path dir = m_root / "tmp" / unique_name();
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+bool ArtifactCache::publish(std::uint64_t key, const path& staging_dir)
+{
+    const path target = entry_dir(key);
+    std::error_code ec;
+    if (std::filesystem::is_directory(target, ec))
+    {
+        std::filesystem::remove_all(staging_dir, ec);
+        return true;
+    }
+
+    // 压缩到另一个暂存目录，完成后整体发布
+    const path packed = stage();
+    EntryIndex index{ .level = m_options.level };
+    bool complete = true;
+    for (const auto& file :
+         std::filesystem::directory_iterator(staging_dir, ec))
+    {
+        auto sizes = compression::compress_file(
+            file.path(), packed / file.path().filename(), m_options.level);
+        if (!sizes)
+        {
+            complete = false;
+            break;
+        }
+        index.files.push_back({ file.path().filename().string(), *sizes });
+    }
+    complete = complete && !ec && write_index(packed, index);
+    std::filesystem::remove_all(staging_dir, ec);
+    if (!complete)
+    {
+        std::cerr << "Warning: Cannot store '" << staging_dir.string()
+                  << "' in the artifact cache.\n";
+        std::filesystem::remove_all(packed, ec);
+        return false;
+    }
+
+    std::filesystem::create_directories(target.parent_path(), ec);
+    std::filesystem::rename(packed, target, ec);
+    if (ec)
+    {
+        // 其他进程已发布同一键：内容等价，丢弃本地副本
+        std::filesystem::remove_all(packed, ec);
+        return std::filesystem::is_directory(target, ec);
+    }
+    return true;
+}
+
+bool ArtifactCache::contains(std::uint64_t key) const
+{
+    std::error_code ec;
+    return std::filesystem::is_directory(entry_dir(key), ec);
+}
+
+bool ArtifactCache::fetch(std::uint64_t key, const path& destination_dir)
+{
+    const path source = entry_dir(key);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(source, ec))
+    {
+        return false;
+    }
+    // 刷新使用时间；条目恰好被淘汰时下面的读取会失败
+    std::filesystem::last_write_time(
+        source, std::filesystem::file_time_type::clock::now(), ec);
+    if (std::filesystem::is_directory(destination_dir, ec))
+    {
+        return true;
+    }
+    auto index = read_index(source);
+    if (!index)
+    {
+        return false;
+    }
+
+    std::filesystem::create_directories(destination_dir.parent_path(), ec);
+    const path staging = destination_dir.parent_path() /
+                         (destination_dir.filename().string() + ".tmp-" +
+                          unique_name());
+    std::filesystem::create_directories(staging, ec);
+    bool complete = !ec;
+    for (const auto& file : index->files)
+    {
+        complete = complete && compression::decompress_file(
+                                   source / file.name, staging / file.name);
+    }
+    if (!complete)
+    {
+        std::filesystem::remove_all(staging, ec);
+        return false;
+    }
+
+    std::filesystem::rename(staging, destination_dir, ec);
+    if (ec)
+    {
+        // 并发的读取者已放好同一条目
+        std::filesystem::remove_all(staging, ec);
+        return std::filesystem::is_directory(destination_dir, ec);
+    }
+    return true;
+}
+
+std::uintmax_t ArtifactCache::size_bytes() const
+{
+    return total_sizes(m_root / "objects").stored_bytes;
+}
+
+std::uintmax_t ArtifactCache::raw_bytes() const
+{
+    return total_sizes(m_root / "objects").raw_bytes;
+}
+
+std::uintmax_t ArtifactCache::trim()
+{
+    using clock = std::filesystem::file_time_type::clock;
+    std::error_code ec;
+    const path trash_dir = m_root / "trash";
+
+    // 清理崩溃进程留下的暂存目录与删除到一半的条目
+    const auto stale_before = clock::now() - m_options.stale_staging_age;
+    for (const auto& dir : { m_root / "tmp", trash_dir })
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            std::error_code time_ec;
+            if (entry.last_write_time(time_ec) < stale_before && !time_ec)
+            {
+                std::error_code remove_ec;
+                std::filesystem::remove_all(entry.path(), remove_ec);
+            }
+        }
+    }
+
+    struct Entry
+    {
+        path dir;
+        std::filesystem::file_time_type last_use;
+        std::uintmax_t bytes;
+    };
+    std::vector<Entry> entries;
+    std::uintmax_t total = 0;
+    const auto cold_before = clock::now() - m_options.cold_after;
+    for (const auto& shard :
+         std::filesystem::directory_iterator(m_root / "objects", ec))
+    {
+        for (const auto& entry :
+             std::filesystem::directory_iterator(shard.path(), ec))
+        {
+            std::error_code time_ec;
+            auto last_use = entry.last_write_time(time_ec);
+            auto index = read_index(entry.path());
+            if (time_ec || !index)
+            {
+                continue; // 已被其他进程淘汰
+            }
+            if (last_use < cold_before &&
+                index->level != compression::Level::high)
+            {
+                recompress_entry(entry.path(), *index, last_use);
+            }
+            entries.push_back(
+                { entry.path(), last_use, index->total().stored_bytes });
+            total += entries.back().bytes;
+        }
+    }
+    if (total <= m_options.max_bytes)
+    {
+        return 0;
+    }
+
+    const auto target = static_cast<std::uintmax_t>(
+        static_cast<double>(m_options.max_bytes) * m_options.low_water_ratio);
+    std::ranges::sort(entries, {}, &Entry::last_use);
+    std::uintmax_t freed = 0;
+    for (const auto& entry : entries)
+    {
+        if (total - freed <= target)
+        {
+            break;
+        }
+        retire(entry.dir, trash_dir);
+        freed += entry.bytes;
+    }
+    return freed;
+}
+
+void ArtifactCache::trim_in_background()
+{
+    if (m_trimming.exchange(true))
+    {
+        return;
+    }
+    m_trimmer = std::jthread(
+        [this]
+        {
+            try
+            {
+                trim();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Warning: Artifact cache cleanup failed: "
+                          << e.what() << "\n";
+            }
+            m_trimming = false;
+        });
+}
+
+// --- 私有辅助函数实现 ---
+
+path ArtifactCache::entry_dir(std::uint64_t key) const
+{
+    const std::string hex = to_hex(key);
+    return m_root / "objects" / hex.substr(0, 2) / hex;
+}
@@ -0,0 +1,86 @@
+// artifact_cache.ixx
+//
+// 定义了 ArtifactCache 类：按内容寻址、有容量上限的磁盘产物缓存（BMI、目标文件等）。
+// 条目中的文件以 compression 模块的格式压缩存放，条目索引同时记录原始与落盘字节数，
+// 容量上限按实际占用的磁盘空间计算。
+//
+// 并发约定（多个 importa 进程可同时使用同一缓存，不使用文件锁）：
+// - 写入者在 tmp/ 下的私有目录中准备条目，完成后整体 rename 发布；
+//   同一键已被其他进程发布时丢弃自己的副本（内容寻址，两者等价）。
+// - 读取者把文件解压到目标旁的临时目录，再 rename 就位；
+//   读取中途条目被淘汰只会表现为未命中。
+// - 冷条目被重新压缩时逐个文件写出新副本再 rename 覆盖，读取者只会看到完整的文件。
+// - 淘汰按最近使用时间（命中时刷新条目目录的修改时间）进行：
+//   条目先被 rename 到 trash/ 再删除，读取者不会看到半删除的条目。
+
+export module artifact_cache;
+
+import std;
+import compression;
+
+namespace importa
+{
+
+namespace artifact_cache
+{
+
+using path = std::filesystem::path;
+
+export struct ArtifactCacheOptions
+{
+    std::uintmax_t max_bytes = std::uintmax_t{ 10 } << 30; // 10 GiB
+    // 超过上限时淘汰到 max_bytes * low_water_ratio 以下，避免每次发布都触发清理
+    double low_water_ratio = 0.8;
+    // 超过这个时间仍未发布的暂存目录视为崩溃进程的遗留物
+    std::chrono::seconds stale_staging_age = std::chrono::hours(1);
+    // 新条目的压缩级别；超过 cold_after 未被使用的条目在 trim 时改用 high 级别重新压缩
+    compression::Level level = compression::Level::fast;
+    std::chrono::seconds cold_after = std::chrono::hours(24);
+};
+
+export class ArtifactCache
+{
+  public:
+    explicit ArtifactCache(path root, ArtifactCacheOptions options = {});
+    // 等待后台清理结束
+    ~ArtifactCache();
+
+    ArtifactCache(const ArtifactCache&) = delete;
+    ArtifactCache& operator=(const ArtifactCache&) = delete;
+
+    // 创建一个私有的暂存目录，写入条目的文件（不含子目录）后交给 publish
+    path stage();
+
+    // 压缩暂存目录中的文件并以 key 发布，暂存目录随后被删除。同一键已存在时视为成功
+    bool publish(std::uint64_t key, const path& staging_dir);
+
+    bool contains(std::uint64_t key) const;
+
+    // 把条目中的全部文件解压到 destination_dir（已存在则不动），并刷新其使用时间。
+    // 未命中、条目损坏或在读取中途被淘汰时返回 false
+    bool fetch(std::uint64_t key, const path& destination_dir);
+
+    // 当前所有条目占用的磁盘字节数（压缩后）
+    std::uintmax_t size_bytes() const;
+
+    // 当前所有条目解压后的总字节数
+    std::uintmax_t raw_bytes() const;
+
+    // 重新压缩冷条目；超过容量上限时按 LRU 淘汰条目，并清理遗留的暂存目录。
+    // 返回淘汰条目释放的磁盘字节数
+    std::uintmax_t trim();
+
+    // 在后台线程中执行 trim；已有清理在进行时不重复启动
+    void trim_in_background();
+
+  private:
+    path m_root;
+    ArtifactCacheOptions m_options;
+    std::atomic<bool> m_trimming = false;
+    std::jthread m_trimmer;
+
+    path entry_dir(std::uint64_t key) const;
+};
+
+} // namespace artifact_cache
+} // namespace importa
@@ -0,0 +1,509 @@
+// bmi_fingerprint.cpp
+// 提供了 BMI 接口指纹的具体实现。
+//
+// 位流格式（LLVM Bitstream）：位按小端顺序读取，每个块以 ENTER_SUBBLOCK
+// 开始（块 ID、块内缩写宽度、32 位对齐后的块长度字数），以 END_BLOCK
+// 结束。记录或为未缩写记录（代码与操作数均为 VBR6），或按块内
+// DEFINE_ABBREV（以及 BLOCKINFO 块为该块 ID 预先定义的缩写）编码。
+
+module bmi_fingerprint;
+
+import std;
+import hashing;
+
+using namespace importa::bmi_fingerprint;
+using importa::hashing::hash_bytes;
+using importa::hashing::hash_combine;
+
+namespace
+{ // 内部辅助函数与位流格式定义
+
+constexpr std::string_view kClangPcmMagic = "CPCH";
+
+// LLVM 位流的保留缩写 ID 与块 ID
+constexpr std::uint64_t kEndBlock = 0;
+constexpr std::uint64_t kEnterSubblock = 1;
+constexpr std::uint64_t kDefineAbbrev = 2;
+constexpr std::uint64_t kUnabbrevRecord = 3;
+constexpr std::uint64_t kFirstAbbrevId = 4;
+constexpr std::uint64_t kBlockInfoBlock = 0;
+constexpr std::uint64_t kBlockInfoSetBid = 1;
+
+// Clang AST 文件中与接口无关的块与记录（clang/Serialization/ASTBitCodes.h）
+constexpr std::uint64_t kControlBlock = 15;
+constexpr std::uint64_t kInputFilesBlock = 16;
+constexpr std::uint64_t kUnhashedControlBlock = 19;
+constexpr std::uint64_t kInputFileOffsetsRecord = 6;
+
+// 与 hash_bytes 的内容哈希区分开，避免两种指纹偶然相等
+constexpr std::uint64_t kClangPcmSeed = 0x62'6d'69'2d'70'63'6d'31;
+
+class BitReader
+{
+  public:
+    explicit BitReader(std::string_view data) : m_data(data) {}
+
+    std::size_t remaining_bits() const
+    {
+        return m_data.size() * 8 - m_bit;
+    }
+
+    std::optional<std::uint64_t> fixed(unsigned width)
+    {
+        if (width > 64 || width > remaining_bits())
+        {
+            return std::nullopt;
+        }
+        std::uint64_t value = 0;
+        unsigned shift = 0;
+        while (shift < width)
+        {
+            const auto byte =
+                static_cast<unsigned char>(m_data[m_bit / 8]);
+            const unsigned offset = m_bit % 8;
+            const unsigned take = std::min(8 - offset, width - shift);
+            const std::uint64_t bits = (byte >> offset) & ((1u << take) - 1);
+            value |= bits << shift;
+            shift += take;
+            m_bit += take;
+        }
+        return value;
+    }
+
+    std::optional<std::uint64_t> vbr(unsigned width)
+    {
+        if (width < 2 || width > 32)
+        {
+            return std::nullopt;
+        }
+        const std::uint64_t continue_bit = 1ull << (width - 1);
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += width - 1)
+        {
+            const auto chunk = fixed(width);
+            if (!chunk)
+            {
+                return std::nullopt;
+            }
+            value |= (*chunk & (continue_bit - 1)) << shift;
+            if (!(*chunk & continue_bit))
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool align32()
+    {
+        const std::size_t aligned = (m_bit + 31) / 32 * 32;
+        if (aligned > m_data.size() * 8)
+        {
+            return false;
+        }
+        m_bit = aligned;
+        return true;
+    }
+
+    bool skip_words(std::uint64_t words)
+    {
+        if (words > remaining_bits() / 32)
+        {
+            return false;
+        }
+        m_bit += static_cast<std::size_t>(words) * 32;
+        return true;
+    }
+
+    // 须已按字节对齐
+    std::optional<std::string_view> bytes(std::uint64_t count)
+    {
+        if (m_bit % 8 != 0 || count > remaining_bits() / 8)
+        {
+            return std::nullopt;
+        }
+        const auto result =
+            m_data.substr(m_bit / 8, static_cast<std::size_t>(count));
+        m_bit += static_cast<std::size_t>(count) * 8;
+        return result;
+    }
+
+  private:
+    std::string_view m_data;
+    std::size_t m_bit = 0;
+};
+
+struct AbbrevOp
+{
+    enum class Kind
+    {
+        Literal,
+        Fixed,
+        Vbr,
+        Array,
+        Char6,
+        Blob
+    };
+    Kind kind = Kind::Literal;
+    std::uint64_t value = 0; // Literal 的值或 Fixed/Vbr 的宽度
+};
+
+using Abbrev = std::vector<AbbrevOp>;
+
+struct Record
+{
+    std::uint64_t code = 0;
+    std::vector<std::uint64_t> operands;
+    std::string_view blob;
+};
+
+class PcmHasher
+{
+  public:
+    explicit PcmHasher(std::string_view data) : m_in(data) {}
+
+    std::optional<std::uint64_t> run()
+    {
+        // 顶层只有块，缩写宽度固定为 2
+        while (m_in.remaining_bits() > 0)
+        {
+            const auto id = m_in.fixed(2);
+            if (!id || *id != kEnterSubblock || !enter_block())
+            {
+                return std::nullopt;
+            }
+        }
+        return m_hash;
+    }
+
+  private:
+    BitReader m_in;
+    std::uint64_t m_hash = kClangPcmSeed;
+    // BLOCKINFO 块为各块 ID 预先定义的缩写
+    std::unordered_map<std::uint64_t, std::vector<Abbrev>> m_block_info;
+
+    // 读取 ENTER_SUBBLOCK 的其余部分并处理整个子块
+    bool enter_block()
+    {
+        const auto block_id = m_in.vbr(8);
+        const auto abbrev_width = m_in.vbr(4);
+        if (!block_id || !abbrev_width || *abbrev_width == 0 ||
+            *abbrev_width > 32 || !m_in.align32())
+        {
+            return false;
+        }
+        const auto words = m_in.fixed(32);
+        if (!words)
+        {
+            return false;
+        }
+        if (*block_id == kInputFilesBlock ||
+            *block_id == kUnhashedControlBlock)
+        {
+            return m_in.skip_words(*words);
+        }
+        if (*block_id != kBlockInfoBlock)
+        {
+            m_hash = hash_combine(m_hash, ~*block_id);
+        }
+        return read_block(*block_id,
+                          static_cast<unsigned>(*abbrev_width));
+    }
+
+    bool read_block(std::uint64_t block_id, unsigned abbrev_width)
+    {
+        std::vector<Abbrev> abbrevs;
+        if (auto it = m_block_info.find(block_id); it != m_block_info.end())
+        {
+            abbrevs = it->second;
+        }
+        std::optional<std::uint64_t> info_target; // BLOCKINFO 中的 SETBID
+
+        while (true)
+        {
+            const auto id = m_in.fixed(abbrev_width);
+            if (!id)
+            {
+                return false;
+            }
+            if (*id == kEndBlock)
+            {
+                return m_in.align32();
+            }
+            if (*id == kEnterSubblock)
+            {
+                if (!enter_block())
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (*id == kDefineAbbrev)
+            {
+                auto abbrev = read_abbrev();
+                if (!abbrev)
+                {
+                    return false;
+                }
+                if (block_id != kBlockInfoBlock)
+                {
+                    abbrevs.push_back(std::move(*abbrev));
+                }
+                else if (info_target)
+                {
+                    m_block_info[*info_target].push_back(std::move(*abbrev));
+                }
+                else
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            Record record;
+            if (*id == kUnabbrevRecord)
+            {
+                if (!read_unabbreviated(record))
+                {
+                    return false;
+                }
+            }
+            else if (*id - kFirstAbbrevId < abbrevs.size())
+            {
+                if (!read_abbreviated(abbrevs[*id - kFirstAbbrevId], record))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+
+            if (block_id == kBlockInfoBlock)
+            {
+                // BLOCKINFO 只描述位布局，不参与指纹
+                if (record.code == kBlockInfoSetBid &&
+                    !record.operands.empty())
+                {
+                    info_target = record.operands.front();
+                }
+                continue;
+            }
+            if (block_id == kControlBlock &&
+                record.code == kInputFileOffsetsRecord)
+            {
+                continue; // 指向已跳过的输入文件块
+            }
+            hash_record(record);
+        }
+    }
+
+    std::optional<Abbrev> read_abbrev()
+    {
+        const auto count = m_in.vbr(5);
+        if (!count)
+        {
+            return std::nullopt;
+        }
+        Abbrev abbrev;
+        for (std::uint64_t i = 0; i < *count; ++i)
+        {
+            const auto is_literal = m_in.fixed(1);
+            if (!is_literal)
+            {
+                return std::nullopt;
+            }
+            AbbrevOp op;
+            if (*is_literal)
+            {
+                const auto value = m_in.vbr(8);
+                if (!value)
+                {
+                    return std::nullopt;
+                }
+                op.value = *value;
+                abbrev.push_back(op);
+                continue;
+            }
+            const auto encoding = m_in.fixed(3);
+            if (!encoding)
+            {
+                return std::nullopt;
+            }
+            switch (*encoding)
+            {
+                case 1:
+                case 2:
+                {
+                    const auto width = m_in.vbr(5);
+                    if (!width || *width > 64)
+                    {
+                        return std::nullopt;
+                    }
+                    // 宽度为 0 的字段恒为 0，与 LLVM 一样按字面值处理
+                    if (*width != 0)
+                    {
+                        op.kind = *encoding == 1 ? AbbrevOp::Kind::Fixed
+                                                 : AbbrevOp::Kind::Vbr;
+                        op.value = *width;
+                    }
+                    break;
+                }
+                case 3:
+                    op.kind = AbbrevOp::Kind::Array;
+                    break;
+                case 4:
+                    op.kind = AbbrevOp::Kind::Char6;
+                    break;
+                case 5:
+                    op.kind = AbbrevOp::Kind::Blob;
+                    break;
+                default:
+                    return std::nullopt;
+            }
+            abbrev.push_back(op);
+        }
+        return abbrev;
+    }
+
+    bool read_unabbreviated(Record& record)
+    {
+        const auto code = m_in.vbr(6);
+        const auto count = m_in.vbr(6);
+        if (!code || !count || *count > m_in.remaining_bits())
+        {
+            return false;
+        }
+        record.code = *code;
+        record.operands.reserve(static_cast<std::size_t>(*count));
+        for (std::uint64_t i = 0; i < *count; ++i)
+        {
+            const auto operand = m_in.vbr(6);
+            if (!operand)
+            {
+                return false;
+            }
+            record.operands.push_back(*operand);
+        }
+        return true;
+    }
+
+    std::optional<std::uint64_t> read_scalar(const AbbrevOp& op)
+    {
+        switch (op.kind)
+        {
+            case AbbrevOp::Kind::Literal:
+                return op.value;
+            case AbbrevOp::Kind::Fixed:
+                return m_in.fixed(static_cast<unsigned>(op.value));
+            case AbbrevOp::Kind::Vbr:
+                return m_in.vbr(static_cast<unsigned>(op.value));
+            case AbbrevOp::Kind::Char6:
+                return m_in.fixed(6);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    bool read_abbreviated(const Abbrev& abbrev, Record& record)
+    {
+        if (abbrev.empty())
+        {
+            return false;
+        }
+        const auto code = read_scalar(abbrev.front());
+        if (!code)
+        {
+            return false;
+        }
+        record.code = *code;
+        for (std::size_t i = 1; i < abbrev.size(); ++i)
+        {
+            const auto& op = abbrev[i];
+            if (op.kind == AbbrevOp::Kind::Array)
+            {
+                // 数组的元素编码是紧随其后的最后一个操作
+                const auto length = m_in.vbr(6);
+                if (i + 2 != abbrev.size() || !length ||
+                    *length > m_in.remaining_bits())
+                {
+                    return false;
+                }
+                for (std::uint64_t e = 0; e < *length; ++e)
+                {
+                    const auto element = read_scalar(abbrev[i + 1]);
+                    if (!element)
+                    {
+                        return false;
+                    }
+                    record.operands.push_back(*element);
+                }
+                return true;
+            }
+            if (op.kind == AbbrevOp::Kind::Blob)
+            {
+                const auto length = m_in.vbr(6);
+                if (i + 1 != abbrev.size() || !length || !m_in.align32())
+                {
+                    return false;
+                }
+                const auto blob = m_in.bytes(*length);
+                if (!blob || !m_in.align32())
+                {
+                    return false;
+                }
+                record.blob = *blob;
+                return true;
+            }
+            const auto operand = read_scalar(op);
+            if (!operand)
+            {
+                return false;
+            }
+            record.operands.push_back(*operand);
+        }
+        return true;
+    }
+
+    // 操作数中的源位置也按原值哈希，原因见 bmi_fingerprint.ixx
+    void hash_record(const Record& record)
+    {
+        m_hash = hash_combine(m_hash, record.code);
+        m_hash = hash_combine(m_hash, record.operands.size());
+        for (const auto operand : record.operands)
+        {
+            m_hash = hash_combine(m_hash, operand);
+        }
+        m_hash = hash_combine(
+            m_hash, hash_bytes(record.blob.data(), record.blob.size()));
+    }
+};
+} // namespace
+
+std::optional<std::uint64_t> importa::bmi_fingerprint::clang_pcm_fingerprint(
+    std::string_view data)
+{
+    if (!data.starts_with(kClangPcmMagic))
+    {
+        return std::nullopt;
+    }
+    return PcmHasher(data.substr(kClangPcmMagic.size())).run();
+}
+
+std::optional<std::uint64_t> importa::bmi_fingerprint::interface_fingerprint(
+    const path& bmi)
+{
+    std::ifstream in(bmi, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    const std::string content{ std::istreambuf_iterator<char>(in),
+                               std::istreambuf_iterator<char>() };
+    if (auto fingerprint = clang_pcm_fingerprint(content))
+    {
+        return fingerprint;
+    }
+    return hash_bytes(content.data(), content.size());
+}
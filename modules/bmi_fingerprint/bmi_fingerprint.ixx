@@ -0,0 +1,37 @@
+// bmi_fingerprint.ixx
+//
+// 计算 BMI 的接口指纹，供 Builder 判断重新生成的 BMI 是否真的改变了
+// 导入者看到的内容。
+//
+// Clang 的 .pcm 是 LLVM 位流：控制块中的输入文件块记录了每个源文件的
+// 大小、mtime 与内容哈希，不参与哈希的控制块记录了整个文件的签名。
+// 对源文件的任何编辑都会改变这些部分，即使接口本身不变（例如精简 BMI
+// 中已不包含的非内联函数体）。接口指纹逐条哈希解码后的记录，跳过这些
+// 部分；与位布局（VBR 宽度、缩写定义、对齐）无关，只与记录内容有关。
+//
+// 记录中的源位置按原值参与哈希。导入者的调试信息与 std::source_location
+// 取自这些位置，不能忽略；代价是改变长度的编辑（即使只在函数体内）会移动
+// 其后声明的位置而改变指纹，导入者随之保守地重新编译。
+
+export module bmi_fingerprint;
+
+import std;
+
+namespace importa
+{
+
+namespace bmi_fingerprint
+{
+
+using path = std::filesystem::path;
+
+// 对内存中的 Clang .pcm 计算接口指纹；不是合法的 Clang 位流时返回 nullopt
+export std::optional<std::uint64_t> clang_pcm_fingerprint(
+    std::string_view data);
+
+// 计算文件的接口指纹。Clang 的 .pcm 使用 clang_pcm_fingerprint，
+// 其他格式（或无法解析的 .pcm）退回到内容哈希；文件缺失时返回 nullopt
+export std::optional<std::uint64_t> interface_fingerprint(const path& bmi);
+
+} // namespace bmi_fingerprint
+} // namespace importa
@@ -0,0 +1,216 @@
+// build_log.cpp
+// 提供了 BuildLog 类的具体实现。
+//
+// 文件格式：8 字节文件头（魔数 + 版本号），随后是若干条定长记录。
+// 每条记录末尾的校验和覆盖记录的其余字段，读取时遇到第一条校验失败
+// 或不完整的记录即停止，并将文件截断到最后一条有效记录处。
+
+module build_log;
+
+import std;
+import hashing;
+
+using namespace importa::build_log;
+
+namespace
+{ // 内部辅助函数与磁盘格式定义
+
+constexpr std::array<char, 8> kLogHeader = { 'I', 'M', 'P', 'A',
+                                             'L', 'O', 'G', 1 };
+
+// 过期记录达到有效记录的若干倍时，在打开日志时重写日志
+constexpr std::size_t kCompactRatio = 3;
+constexpr std::size_t kMinRecordsToCompact = 1024;
+
+struct RawRecord
+{
+    std::uint64_t key;
+    std::uint64_t command_hash;
+    std::uint64_t input_stamp;
+    std::uint64_t output_stamp;
+    std::uint32_t duration_ms;
+    std::uint32_t checksum;
+};
+static_assert(sizeof(RawRecord) == 40);
+static_assert(std::is_trivially_copyable_v<RawRecord>);
+
+constexpr std::size_t kChecksummedBytes = offsetof(RawRecord, checksum);
+
+std::uint32_t compute_checksum(const RawRecord& raw)
+{
+    return static_cast<std::uint32_t>(
+        importa::hashing::hash_bytes(&raw, kChecksummedBytes));
+}
+
+std::uint64_t key_for(const path& output)
+{
+    return importa::hashing::hash_string(
+        output.lexically_normal().generic_string());
+}
+
+RawRecord make_raw_record(std::uint64_t key, const BuildRecord& entry)
+{
+    RawRecord raw{};
+    raw.key = key;
+    raw.command_hash = entry.command_hash;
+    raw.input_stamp = entry.input_stamp;
+    raw.output_stamp = entry.output_stamp;
+    raw.duration_ms = entry.duration_ms;
+    raw.checksum = compute_checksum(raw);
+    return raw;
+}
+} // namespace
+
+BuildLog::BuildLog(path log_path) : m_log_path(std::move(log_path))
+{
+    if (m_log_path.has_parent_path())
+    {
+        std::filesystem::create_directories(m_log_path.parent_path());
+    }
+    load();
+
+    if (m_total_records >= kMinRecordsToCompact &&
+        m_total_records > kCompactRatio * m_records.size())
+    {
+        recompact();
+    }
+    else
+    {
+        open_for_append();
+    }
+}
+
+const BuildRecord* BuildLog::find(const path& output) const
+{
+    auto it = m_records.find(key_for(output));
+    return it == m_records.end() ? nullptr : &it->second;
+}
+
+void BuildLog::record(const path& output, const BuildRecord& entry)
+{
+    const std::uint64_t key = key_for(output);
+    RawRecord raw = make_raw_record(key, entry);
+
+    // 每条记录写入后立即刷新，被中断的构建可以从最后一条完整记录处继续
+    m_stream.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+    m_stream.flush();
+    if (!m_stream)
+    {
+        throw std::runtime_error("BuildLog Error: Failed to append to '" +
+                                 m_log_path.string() + "'.");
+    }
+
+    m_records[key] = entry;
+    ++m_total_records;
+}
+
+void BuildLog::recompact()
+{
+    if (m_stream.is_open())
+    {
+        m_stream.close();
+    }
+
+    path temp_path = m_log_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(kLogHeader.data(), kLogHeader.size());
+        for (const auto& [key, entry] : m_records)
+        {
+            RawRecord raw = make_raw_record(key, entry);
+            out.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+        }
+        out.flush();
+        if (!out)
+        {
+            throw std::runtime_error(
+                "BuildLog Error: Failed to write compacted log '" +
+                temp_path.string() + "'.");
+        }
+    }
+
+    // rename 是原子的：读者要么看到旧日志，要么看到完整的新日志
+    std::filesystem::rename(temp_path, m_log_path);
+    m_total_records = m_records.size();
+    open_for_append();
+}
+
+std::size_t BuildLog::size() const
+{
+    return m_records.size();
+}
+
+const path& BuildLog::log_path() const
+{
+    return m_log_path;
+}
+
+// --- 私有辅助函数实现 ---
+
+void BuildLog::load()
+{
+    m_records.clear();
+    m_total_records = 0;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(m_log_path, ec))
+    {
+        return;
+    }
+
+    std::ifstream in(m_log_path, std::ios::binary);
+    std::vector<char> data{ std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>() };
+    in.close();
+
+    if (data.size() < kLogHeader.size() ||
+        !std::equal(kLogHeader.begin(), kLogHeader.end(), data.begin()))
+    {
+        // 未知格式或旧版本：丢弃，下一次构建将全量重建
+        std::filesystem::remove(m_log_path);
+        return;
+    }
+
+    std::size_t offset = kLogHeader.size();
+    while (offset + sizeof(RawRecord) <= data.size())
+    {
+        RawRecord raw;
+        std::memcpy(&raw, data.data() + offset, sizeof(raw));
+        if (raw.checksum != compute_checksum(raw))
+        {
+            break;
+        }
+        m_records[raw.key] = { .command_hash = raw.command_hash,
+                               .input_stamp = raw.input_stamp,
+                               .output_stamp = raw.output_stamp,
+                               .duration_ms = raw.duration_ms };
+        ++m_total_records;
+        offset += sizeof(RawRecord);
+    }
+
+    if (offset != data.size())
+    {
+        // 崩溃留下的不完整或损坏的尾部
+        std::filesystem::resize_file(m_log_path, offset);
+    }
+}
+
+void BuildLog::open_for_append()
+{
+    std::error_code ec;
+    const bool fresh = !std::filesystem::exists(m_log_path, ec) ||
+                       std::filesystem::file_size(m_log_path, ec) == 0;
+
+    m_stream.open(m_log_path, std::ios::binary | std::ios::app);
+    if (!m_stream)
+    {
+        throw std::runtime_error("BuildLog Error: Failed to open '" +
+                                 m_log_path.string() + "'.");
+    }
+    if (fresh)
+    {
+        m_stream.write(kLogHeader.data(), kLogHeader.size());
+        m_stream.flush();
+    }
+}
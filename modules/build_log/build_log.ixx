@@ -0,0 +1,61 @@
+// build_log.ixx
+//
+// 定义了 BuildLog 类：一个持久化、仅追加的二进制构建日志（类似 .ninja_log）。
+// 每个构建动作以其主产物为键，记录命令指纹、输入/输出时间戳指纹与耗时。
+// 每条记录定长并带校验和，进程中途崩溃时只会丢失最后一条不完整的记录。
+
+export module build_log;
+
+import std;
+
+namespace importa
+{
+
+namespace build_log
+{
+
+using path = std::filesystem::path;
+
+// 单个构建动作上一次成功执行时的快照
+export struct BuildRecord
+{
+    std::uint64_t command_hash = 0;
+    std::uint64_t input_stamp = 0;
+    std::uint64_t output_stamp = 0;
+    std::uint32_t duration_ms = 0;
+};
+
+export class BuildLog
+{
+  public:
+    // 打开（或创建）日志文件，读取已有记录并截断损坏的尾部
+    explicit BuildLog(path log_path);
+    ~BuildLog() = default;
+
+    BuildLog(const BuildLog&) = delete;
+    BuildLog& operator=(const BuildLog&) = delete;
+
+    // 查找以 output 为主产物的动作记录，不存在时返回 nullptr
+    const BuildRecord* find(const path& output) const;
+
+    // 追加一条记录并立即刷盘，覆盖同一产物的旧记录
+    void record(const path& output, const BuildRecord& entry);
+
+    // 以仅包含最新记录的新文件原子替换当前日志
+    void recompact();
+
+    std::size_t size() const;
+    const path& log_path() const;
+
+  private:
+    path m_log_path;
+    std::unordered_map<std::uint64_t, BuildRecord> m_records;
+    std::size_t m_total_records = 0; // 文件中的记录条数（含过期记录）
+    std::ofstream m_stream;
+
+    void load();
+    void open_for_append();
+};
+
+} // namespace build_log
+} // namespace importa
@@ -0,0 +1,483 @@
+// build_server.cpp
+// 提供了 BuildServer 类与客户端函数的具体实现。
+
+module;
+
+// --- 平台特定头文件 ---
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+module build_server;
+
+import std;
+import thread_pool;
+import load_governor;
+import watch_mode;
+
+using namespace importa::build_server;
+
+namespace
+{ // 内部辅助函数
+
+// 单个请求或应答行的长度上限
+constexpr std::size_t kMaxLineLength = 64 * 1024;
+
+// 服务器等待客户端发完请求行的时限，连接后不发送的客户端不会一直占住线程
+constexpr std::chrono::seconds kRequestTimeout{ 10 };
+
+BuildReply parse_reply(std::string_view line)
+{
+    BuildReply reply;
+    if (line.starts_with("ok "))
+    {
+        std::istringstream in{ std::string(line.substr(3)) };
+        in >> reply.executed >> reply.skipped >> reply.failed;
+        reply.ok = static_cast<bool>(in);
+        if (!reply.ok)
+        {
+            reply.message = "malformed reply: " + std::string(line);
+        }
+        return reply;
+    }
+    reply.message = line.starts_with("error ") ? line.substr(6) : line;
+    return reply;
+}
+
+#if !defined(_WIN32)
+std::optional<sockaddr_un> make_address(const path& socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string native = socket_path.string();
+    if (native.size() >= sizeof(address.sun_path))
+    {
+        return std::nullopt;
+    }
+    std::ranges::copy(native, address.sun_path);
+    return address;
+}
+
+int connect_to(const path& socket_path)
+{
+    auto address = make_address(socket_path);
+    if (!address)
+    {
+        return -1;
+    }
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&*address),
+                  sizeof(*address)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool write_all(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+// 读取到换行符或连接关闭为止，返回的行不含换行符。
+// 给出 stop_fd 时，它可读（服务器停止）或超过 timeout 仍未读完则放弃，
+// 返回已读到的部分；否则一直等待（客户端等待的构建可能持续数分钟）
+std::string read_line(int fd, int stop_fd = -1,
+                      std::chrono::milliseconds timeout =
+                          std::chrono::milliseconds::max())
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::string line;
+    char buffer[512];
+    while (line.size() < kMaxLineLength)
+    {
+        if (stop_fd >= 0)
+        {
+            const auto elapsed =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+            if (elapsed >= timeout)
+            {
+                break;
+            }
+            pollfd fds[2] = { { fd, POLLIN, 0 }, { stop_fd, POLLIN, 0 } };
+            const int ready = ::poll(
+                fds, 2,
+                static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+                    (timeout - elapsed).count(),
+                    std::numeric_limits<int>::max())));
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ready <= 0 || (fds[1].revents & POLLIN))
+            {
+                break; // 超时、出错或被 stop() 唤醒
+            }
+        }
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        line.append(buffer, static_cast<std::size_t>(n));
+        if (auto newline = line.find('\n'); newline != std::string::npos)
+        {
+            line.resize(newline);
+            break;
+        }
+    }
+    return line;
+}
+
+std::optional<std::string> transact(const path& socket_path,
+                                    std::string_view request)
+{
+    const int fd = connect_to(socket_path);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    std::string reply;
+    if (write_all(fd, std::string(request) + "\n"))
+    {
+        reply = read_line(fd);
+    }
+    ::close(fd);
+    if (reply.empty())
+    {
+        return std::nullopt;
+    }
+    return reply;
+}
+#endif
+} // namespace
+
+// --- BuildReply ---
+BuildReply::operator bool() const
+{
+    return ok && failed == 0;
+}
+
+// --- BuildServer ---
+BuildServer::BuildServer(path socket_path, SessionFactory factory,
+                         std::size_t jobs,
+                         std::optional<load_governor::GovernorOptions> governor)
+    : m_socket_path(std::move(socket_path)), m_factory(std::move(factory)),
+      m_pool(jobs)
+{
+    if (governor)
+    {
+        m_governor.emplace(m_pool, *governor).start();
+    }
+}
+
+BuildServer::~BuildServer()
+{
+    stop();
+}
+
+void BuildServer::wait()
+{
+    std::unique_lock lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_shutdown_requested || !m_running; });
+}
+
+std::size_t BuildServer::sessions() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_loaded_sessions;
+}
+
+#if !defined(_WIN32)
+bool BuildServer::start()
+{
+    if (m_running)
+    {
+        return true;
+    }
+    auto address = make_address(m_socket_path);
+    if (!address)
+    {
+        std::cerr << "Error: Socket path '" << m_socket_path.string()
+                  << "' is too long.\n";
+        return false;
+    }
+
+    // 能连上说明已有服务器在运行；连不上的套接字文件是上次崩溃遗留的
+    if (const int fd = connect_to(m_socket_path); fd >= 0)
+    {
+        ::close(fd);
+        std::cerr << "Error: A build server is already listening on '"
+                  << m_socket_path.string() << "'.\n";
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::remove(m_socket_path, ec);
+
+    auto fail = [this](std::string_view what)
+    {
+        std::cerr << "Error: Failed to " << what << " '"
+                  << m_socket_path.string() << "'. Error code: " << errno
+                  << "\n";
+        if (m_listen_fd >= 0)
+        {
+            ::close(m_listen_fd);
+            m_listen_fd = -1;
+        }
+        return false;
+    };
+
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0)
+    {
+        return fail("create a socket for");
+    }
+    if (::bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&*address),
+               sizeof(*address)) != 0)
+    {
+        return fail("bind");
+    }
+    if (::listen(m_listen_fd, SOMAXCONN) != 0)
+    {
+        return fail("listen on");
+    }
+    if (::pipe2(m_stop_pipe, O_CLOEXEC) != 0)
+    {
+        return fail("create the stop pipe for");
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_running = true;
+        m_shutdown_requested = false;
+    }
+    m_accept_thread = std::jthread([this] { accept_loop(); });
+    return true;
+}
+
+void BuildServer::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+    }
+    m_cv.notify_all();
+
+    const char byte = 0;
+    (void)!::write(m_stop_pipe[1], &byte, 1);
+    if (m_accept_thread.joinable())
+    {
+        m_accept_thread.join();
+    }
+    {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_active_clients == 0; });
+    }
+
+    ::close(m_listen_fd);
+    ::close(m_stop_pipe[0]);
+    ::close(m_stop_pipe[1]);
+    m_listen_fd = -1;
+    m_stop_pipe[0] = m_stop_pipe[1] = -1;
+    std::error_code ec;
+    std::filesystem::remove(m_socket_path, ec);
+}
+
+void BuildServer::accept_loop()
+{
+    while (true)
+    {
+        pollfd fds[2] = { { m_listen_fd, POLLIN, 0 },
+                          { m_stop_pipe[0], POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+        const int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        // 每个连接一个线程：构建可能持续数分钟，不能阻塞其他客户端
+        {
+            std::lock_guard lock(m_mutex);
+            ++m_active_clients;
+        }
+        std::thread(
+            [this, fd]
+            {
+                handle_client(fd);
+                std::lock_guard lock(m_mutex);
+                --m_active_clients;
+                m_cv.notify_all();
+            })
+            .detach();
+    }
+}
+
+void BuildServer::handle_client(int fd)
+{
+    const std::string request = read_line(fd, m_stop_pipe[0], kRequestTimeout);
+    write_all(fd, handle_request(request) + "\n");
+    ::close(fd);
+}
+
+std::optional<BuildReply> importa::build_server::request_build(
+    const path& socket_path, std::string_view project, bool full)
+{
+    auto reply = transact(socket_path, std::string(full ? "build-full "
+                                                        : "build ") +
+                                           std::string(project));
+    if (!reply)
+    {
+        return std::nullopt;
+    }
+    return parse_reply(*reply);
+}
+
+bool importa::build_server::request_shutdown(const path& socket_path)
+{
+    return transact(socket_path, "shutdown").has_value();
+}
+#else
+bool BuildServer::start()
+{
+    std::cerr << "Error: The build server requires Unix domain sockets and "
+                 "is not available on this platform.\n";
+    return false;
+}
+
+void BuildServer::stop()
+{
+}
+
+void BuildServer::accept_loop()
+{
+}
+
+void BuildServer::handle_client(int)
+{
+}
+
+std::optional<BuildReply> importa::build_server::request_build(
+    const path&, std::string_view, bool)
+{
+    return std::nullopt;
+}
+
+bool importa::build_server::request_shutdown(const path&)
+{
+    return false;
+}
+#endif
+
+// --- 私有辅助函数实现 ---
+
+std::string BuildServer::handle_request(std::string_view request)
+{
+    const auto space = request.find(' ');
+    const auto command = request.substr(0, space);
+    const std::string project(
+        space == std::string_view::npos ? "" : request.substr(space + 1));
+
+    if (command == "shutdown")
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_shutdown_requested = true;
+        }
+        m_cv.notify_all();
+        return "ok 0 0 0";
+    }
+    if (command != "build" && command != "build-full")
+    {
+        return "error unknown request '" + std::string(command) + "'";
+    }
+    if (project.empty())
+    {
+        return "error missing project name";
+    }
+
+    Session* entry = find_session(project);
+    std::lock_guard session_lock(entry->mutex);
+    try
+    {
+        if (!entry->session)
+        {
+            entry->session = m_factory(project, m_pool);
+            if (!entry->session)
+            {
+                return "error unknown project '" + project + "'";
+            }
+            std::lock_guard lock(m_mutex);
+            ++m_loaded_sessions;
+        }
+        const auto stats = entry->session->build_pending(command == "build-full");
+        return "ok " + std::to_string(stats.executed) + " " +
+               std::to_string(stats.skipped) + " " +
+               std::to_string(stats.failed);
+    }
+    catch (const std::exception& e)
+    {
+        // 应答必须是单行
+        std::string message = e.what();
+        std::ranges::replace(message, '\n', ' ');
+        return "error " + message;
+    }
+}
+
+BuildServer::Session* BuildServer::find_session(const std::string& project)
+{
+    std::lock_guard lock(m_mutex);
+    auto& entry = m_sessions[project];
+    if (!entry)
+    {
+        entry = std::make_unique<Session>();
+    }
+    return entry.get();
+}
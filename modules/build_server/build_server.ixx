@@ -0,0 +1,110 @@
+// build_server.ixx
+//
+// 定义了 BuildServer 类：常驻的构建守护进程。
+// 每个项目对应一个常驻的 WatchSession（项目图、依赖库与内容哈希缓存都留在
+// 内存中），客户端通过 Unix 域套接字发送构建请求。所有会话共享同一个任务池，
+// 因此多个客户端并发构建时编译进程总数仍受同一上限约束。
+//
+// 协议为单行文本：
+//   请求  "build <project>" | "build-full <project>" | "shutdown"
+//   应答  "ok <executed> <skipped> <failed>" | "error <message>"
+
+export module build_server;
+
+import std;
+import thread_pool;
+import load_governor;
+import watch_mode;
+
+namespace importa
+{
+
+namespace build_server
+{
+
+using path = std::filesystem::path;
+
+export struct BuildReply
+{
+    bool ok = false;
+    std::size_t executed = 0;
+    std::size_t skipped = 0;
+    std::size_t failed = 0;
+    std::string message; // 仅在 ok 为 false 时有意义
+
+    explicit operator bool() const; // 请求被处理且构建成功时为 true
+};
+
+// 为项目创建常驻会话，未知项目返回 nullptr。
+// job_pool 为服务器的共享任务池，应传给 WatchOptions::job_pool。
+export using SessionFactory =
+    std::function<std::unique_ptr<watch_mode::WatchSession>(
+        const std::string& project, thread_pool::ThreadPool& job_pool)>;
+
+export class BuildServer
+{
+  public:
+    // jobs 为共享任务池的线程数，0 表示使用硬件并发数；
+    // 提供 governor 时按系统压力在运行时调整同时执行的任务数
+    BuildServer(path socket_path, SessionFactory factory,
+                std::size_t jobs = 0,
+                std::optional<load_governor::GovernorOptions> governor =
+                    std::nullopt);
+    ~BuildServer();
+
+    BuildServer(const BuildServer&) = delete;
+    BuildServer& operator=(const BuildServer&) = delete;
+
+    // 绑定套接字并开始接受连接。已有服务器在监听该套接字时返回 false。
+    bool start();
+
+    // 停止接受连接，等待进行中的请求完成，并删除套接字文件
+    void stop();
+
+    // 阻塞直到收到 "shutdown" 请求或 stop() 被调用
+    void wait();
+
+    // 当前常驻的项目会话数
+    std::size_t sessions() const;
+
+  private:
+    struct Session
+    {
+        std::mutex mutex; // 同一项目的请求串行执行
+        std::unique_ptr<watch_mode::WatchSession> session;
+    };
+
+    path m_socket_path;
+    SessionFactory m_factory;
+    thread_pool::ThreadPool m_pool;
+    std::optional<load_governor::LoadGovernor> m_governor;
+
+    int m_listen_fd = -1;
+    int m_stop_pipe[2] = { -1, -1 };
+    std::jthread m_accept_thread;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<std::string, std::unique_ptr<Session>> m_sessions;
+    std::size_t m_active_clients = 0;
+    std::size_t m_loaded_sessions = 0;
+    bool m_shutdown_requested = false;
+    bool m_running = false;
+
+    void accept_loop();
+    void handle_client(int fd);
+    std::string handle_request(std::string_view request);
+    Session* find_session(const std::string& project);
+};
+
+// 向 socket_path 上的服务器请求构建 project。
+// 无法连接时返回 nullopt，调用者可退回到进程内构建。
+export std::optional<BuildReply> request_build(const path& socket_path,
+                                               std::string_view project,
+                                               bool full = false);
+
+// 请求服务器退出，服务器未运行时返回 false
+export bool request_shutdown(const path& socket_path);
+
+} // namespace build_server
+} // namespace importa
@@ -0,0 +1,674 @@
+// builder.cpp
+// 提供了 Builder 类的具体实现。
+
+module builder;
+
+import std;
+import executor;
+import bmi_fingerprint;
+import build_log;
+import deps_log;
+import file_hash_cache;
+import hashing;
+import module_processor;
+import toolchains;
+import thread_pool;
+
+using namespace importa::builder;
+using namespace importa::executor;
+using namespace importa::build_log;
+using namespace importa::deps_log;
+using namespace importa::file_hash_cache;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using importa::thread_pool::ThreadPool;
+using importa::bmi_fingerprint::interface_fingerprint;
+using importa::hashing::hash_combine;
+using importa::hashing::hash_string;
+
+namespace
+{ // 内部辅助函数
+
+// 缺失的输入文件也要参与指纹计算，以便其重新出现时触发重建
+constexpr std::uint64_t kMissingFileStamp = 0;
+
+std::string cache_key(const path& file)
+{
+    return file.lexically_normal().generic_string();
+}
+} // namespace
+
+// --- BuildStats ---
+BuildStats::operator bool() const
+{
+    return failed == 0;
+}
+
+std::uint64_t importa::builder::hash_command(const Command& command)
+{
+    std::uint64_t h = hash_string(command.executable.generic_string());
+    for (const auto& arg : command.arguments)
+    {
+        h = hash_string(arg, h);
+    }
+    h = hash_string(command.working_directory.generic_string(), h);
+    for (const auto& [name, value] : command.environment_variables)
+    {
+        h = hash_string(name, h);
+        h = hash_string(value, h);
+    }
+    return h;
+}
+
+std::vector<BuildAction> importa::builder::select_affected(
+    const std::vector<BuildAction>& actions, const std::vector<path>& changed,
+    const DepsLog* deps_log)
+{
+    std::unordered_set<std::string> dirty;
+    for (const auto& file : changed)
+    {
+        dirty.insert(cache_key(file));
+    }
+
+    // actions 已按依赖顺序排列，一次正向遍历即可把脏标记传递给下游
+    std::vector<BuildAction> affected;
+    for (const auto& action : actions)
+    {
+        bool hit = std::ranges::any_of(action.inputs, [&dirty](const path& in)
+                                       { return dirty.contains(cache_key(in)); });
+        if (!hit && deps_log && !action.depfile.empty())
+        {
+            if (auto header_deps = deps_log->get_deps(action.primary_output))
+            {
+                hit = std::ranges::any_of(
+                    *header_deps, [&dirty](const path& dep)
+                    { return dirty.contains(cache_key(dep)); });
+            }
+        }
+        if (!hit)
+        {
+            continue;
+        }
+        for (const auto& output : action.outputs)
+        {
+            dirty.insert(cache_key(output));
+        }
+        affected.push_back(action);
+    }
+    return affected;
+}
+
+// --- Builder ---
+Builder::Builder(IExecutor& executor, BuildLog& log,
+                 FileHashCache* hash_cache, DepsLog* deps_log,
+                 ThreadPool* job_pool)
+    : m_executor(executor), m_log(log), m_hash_cache(hash_cache),
+      m_deps_log(deps_log), m_job_pool(job_pool)
+{
+}
+
+BuildStats Builder::build(const std::vector<BuildAction>& actions)
+{
+    BuildStats stats;
+    m_stamp_cache.clear();
+    m_identity_cache.clear();
+    m_interface_content_stamps.clear();
+    collect_content_stamped(actions);
+    prefetch_hashes(actions);
+
+    std::vector<std::size_t> waiting;
+    const auto dependents = collect_dependents(actions, waiting);
+
+    // 就绪动作按编辑时间从新到旧出队，时间相同时按计划中的顺序
+    const auto priorities = edit_priorities(actions, dependents);
+    auto runs_before = [&priorities](std::size_t a, std::size_t b)
+    {
+        return priorities[a] != priorities[b] ? priorities[a] > priorities[b]
+                                              : a < b;
+    };
+    std::set<std::size_t, decltype(runs_before)> ready(runs_before);
+    for (std::size_t i = 0; i < actions.size(); ++i)
+    {
+        if (waiting[i] == 0)
+        {
+            ready.insert(i);
+        }
+    }
+    auto release = [&](std::size_t index)
+    {
+        for (std::size_t dependent : dependents[index])
+        {
+            if (--waiting[dependent] == 0)
+            {
+                ready.insert(dependent);
+            }
+        }
+    };
+
+    struct Completion
+    {
+        std::size_t index = 0;
+        ExecutionResult result;
+        std::chrono::steady_clock::duration elapsed{};
+        std::exception_ptr error;
+    };
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Completion> completions;
+
+    // 日志、依赖库与时间戳缓存只在调用线程上访问，工作线程只负责执行命令
+    std::vector<StartedAction> started(actions.size());
+    std::size_t running = 0;
+    bool stopping = false;
+    std::exception_ptr first_error;
+    auto fail = [&](std::exception_ptr error)
+    {
+        first_error = first_error ? first_error : error;
+        stopping = true;
+    };
+    auto complete = [&](const Completion& completion)
+    {
+        if (completion.error)
+        {
+            fail(completion.error);
+            return;
+        }
+        try
+        {
+            if (finish_action(actions[completion.index],
+                              started[completion.index], completion.result,
+                              completion.elapsed, stats))
+            {
+                release(completion.index);
+            }
+            else
+            {
+                stopping = true;
+            }
+        }
+        catch (...)
+        {
+            // 其余动作仍在执行，照常收集它们的结果后再抛出
+            fail(std::current_exception());
+        }
+    };
+
+    // 检查一个就绪动作，不干净时开始执行：有任务池时提交后立即返回
+    auto launch = [&](std::size_t index)
+    {
+        const auto& action = actions[index];
+
+        const std::uint64_t command_hash = hash_command(action.command);
+        // 输入指纹在执行前计算：执行期间被修改的输入会在下次构建时被发现
+        const std::uint64_t source_stamp =
+            stamp_inputs(action.inputs, action.interface_fingerprint);
+
+        const auto* previous = m_log.find(action.primary_output);
+        if (previous && previous->command_hash == command_hash &&
+            is_clean(action, source_stamp, *previous))
+        {
+            ++stats.skipped;
+            release(index);
+            return;
+        }
+        started[index] = { .command_hash = command_hash,
+                           .source_stamp = source_stamp,
+                           .previous_output_stamp =
+                               previous ? std::optional(previous->output_stamp)
+                                        : std::nullopt };
+        if (action.clear_outputs)
+        {
+            for (const auto& output : action.outputs)
+            {
+                std::error_code ec;
+                std::filesystem::remove(output, ec);
+            }
+        }
+
+        if (!m_job_pool)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            Completion completion{ .index = index,
+                                   .result =
+                                       m_executor.execute(action.command) };
+            completion.elapsed = std::chrono::steady_clock::now() - start;
+            complete(completion);
+            return;
+        }
+
+        // 自身并行的动作（例如带多个 LTO 后端的链接）占用多个任务槽
+        m_job_pool->submit(
+            [&, index]
+            {
+                Completion completion{ .index = index };
+                const auto start = std::chrono::steady_clock::now();
+                try
+                {
+                    completion.result =
+                        m_executor.execute(actions[index].command);
+                }
+                catch (...)
+                {
+                    completion.error = std::current_exception();
+                }
+                completion.elapsed =
+                    std::chrono::steady_clock::now() - start;
+                // 持锁通知：调用线程被唤醒后可能立即返回并销毁 cv
+                std::lock_guard lock(mutex);
+                completions.push_back(std::move(completion));
+                cv.notify_one();
+            },
+            action.slots);
+        ++running; // 提交失败时不计入，否则会一直等待它完成
+    };
+
+    while (true)
+    {
+        while (!stopping && !ready.empty())
+        {
+            const std::size_t index = *ready.begin();
+            ready.erase(ready.begin());
+            try
+            {
+                launch(index);
+            }
+            catch (...)
+            {
+                // 工作线程引用本栈帧上的状态，须等已提交的动作全部完成
+                fail(std::current_exception());
+            }
+        }
+
+        if (running == 0)
+        {
+            break;
+        }
+        std::vector<Completion> batch;
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&completions] { return !completions.empty(); });
+            batch.swap(completions);
+        }
+        for (const auto& completion : batch)
+        {
+            --running;
+            complete(completion);
+        }
+    }
+
+    if (m_hash_cache)
+    {
+        m_hash_cache->save();
+    }
+    if (first_error)
+    {
+        std::rethrow_exception(first_error);
+    }
+    return stats;
+}
+
+bool Builder::is_up_to_date(const BuildAction& action)
+{
+    const auto* previous = m_log.find(action.primary_output);
+    return previous && previous->command_hash == hash_command(action.command) &&
+           is_clean(action,
+                    stamp_inputs(action.inputs, action.interface_fingerprint),
+                    *previous);
+}
+
+// --- 私有辅助函数实现 ---
+
+std::vector<std::vector<std::size_t>> Builder::collect_dependents(
+    const std::vector<BuildAction>& actions,
+    std::vector<std::size_t>& waiting) const
+{
+    std::unordered_map<std::string, std::size_t> producers;
+    for (std::size_t i = 0; i < actions.size(); ++i)
+    {
+        for (const auto& output : actions[i].outputs)
+        {
+            producers.emplace(cache_key(output), i);
+        }
+    }
+
+    // 只连向更早的动作：计划的顺序本身满足依赖关系，不会因此成环
+    waiting.assign(actions.size(), 0);
+    std::vector<std::vector<std::size_t>> dependents(actions.size());
+    for (std::size_t i = 0; i < actions.size(); ++i)
+    {
+        std::unordered_set<std::size_t> seen;
+        auto add_edges = [&](const std::vector<path>& files)
+        {
+            for (const auto& file : files)
+            {
+                auto it = producers.find(cache_key(file));
+                if (it != producers.end() && it->second < i &&
+                    seen.insert(it->second).second)
+                {
+                    ++waiting[i];
+                    dependents[it->second].push_back(i);
+                }
+            }
+        };
+        add_edges(actions[i].inputs);
+        // 生成的头文件只出现在依赖库中
+        if (auto header_deps = known_header_deps(actions[i]))
+        {
+            add_edges(*header_deps);
+        }
+    }
+    return dependents;
+}
+
+std::vector<std::int64_t> Builder::edit_priorities(
+    const std::vector<BuildAction>& actions,
+    const std::vector<std::vector<std::size_t>>& dependents)
+{
+    constexpr auto kMissing = std::numeric_limits<std::int64_t>::min();
+
+    // 只看源文件：本次计划产出的文件刚被构建过，时间新但不代表被编辑
+    std::unordered_set<std::string> generated;
+    for (const auto& action : actions)
+    {
+        for (const auto& output : action.outputs)
+        {
+            generated.insert(cache_key(output));
+        }
+    }
+    // 修改时间取自 prefetch_hashes 或此后脏检查共用的身份缓存，不另行 stat
+    auto newest = [&](const std::vector<path>& files, std::int64_t& latest)
+    {
+        for (const auto& file : files)
+        {
+            if (generated.contains(cache_key(file)))
+            {
+                continue;
+            }
+            const auto identity = file_identity(file);
+            latest = std::max(latest, identity ? identity->mtime_ns : kMissing);
+        }
+    };
+
+    std::vector<std::int64_t> priorities(actions.size(), kMissing);
+    for (std::size_t i = 0; i < actions.size(); ++i)
+    {
+        newest(actions[i].inputs, priorities[i]);
+        if (auto header_deps = known_header_deps(actions[i]))
+        {
+            newest(*header_deps, priorities[i]);
+        }
+    }
+    // 下游总在上游之后：逆序遍历一次，让被编辑文件所等待的 BMI 也提前构建
+    for (std::size_t i = actions.size(); i-- > 0;)
+    {
+        for (std::size_t dependent : dependents[i])
+        {
+            priorities[i] = std::max(priorities[i], priorities[dependent]);
+        }
+    }
+    return priorities;
+}
+
+bool Builder::finish_action(const BuildAction& action,
+                            const StartedAction& started,
+                            const ExecutionResult& result,
+                            std::chrono::steady_clock::duration elapsed,
+                            BuildStats& stats)
+{
+    if (!result)
+    {
+        std::cerr << "Error: Build action for '"
+                  << action.primary_output.string()
+                  << "' failed with exit code " << result.exit_code << ".\n"
+                  << result.std_err;
+        ++stats.failed;
+        return false;
+    }
+    ++stats.executed;
+
+    // 头文件依赖只有在编译之后才能得知
+    const auto header_deps = ingest_depfile(action);
+
+    for (const auto& output : action.outputs)
+    {
+        m_stamp_cache.erase(cache_key(output));
+        m_identity_cache.erase(cache_key(output));
+        m_interface_content_stamps.erase(cache_key(output));
+    }
+    auto output_stamp = stamp_outputs(action.outputs);
+    if (!output_stamp)
+    {
+        // 命令成功但产物缺失（例如 DryRunExecutor），不能记为已完成
+        return true;
+    }
+    if (action.restat && output_stamp == started.previous_output_stamp)
+    {
+        // 产物逐字节相同：下游以内容为指纹的输入不变，将被跳过
+        ++stats.cut_off;
+    }
+
+    m_log.record(
+        action.primary_output,
+        { .command_hash = started.command_hash,
+          .input_stamp =
+              hash_combine(started.source_stamp, stamp_inputs(header_deps)),
+          .output_stamp = *output_stamp,
+          .duration_ms = static_cast<std::uint32_t>(
+              std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                  .count()) });
+    return true;
+}
+
+bool Builder::is_clean(const BuildAction& action, std::uint64_t source_stamp,
+                       const BuildRecord& previous)
+{
+    // 记录过头文件依赖的动作，其依赖丢失时（例如依赖日志被删除）必须重建
+    const auto header_deps = known_header_deps(action);
+    return header_deps &&
+           previous.input_stamp ==
+               hash_combine(source_stamp, stamp_inputs(*header_deps)) &&
+           stamp_outputs(action.outputs) == previous.output_stamp;
+}
+
+std::optional<std::vector<path>> Builder::known_header_deps(
+    const BuildAction& action) const
+{
+    if (action.depfile.empty() || !m_deps_log)
+    {
+        return std::vector<path>{};
+    }
+    return m_deps_log->get_deps(action.primary_output);
+}
+
+std::vector<path> Builder::ingest_depfile(const BuildAction& action)
+{
+    if (action.depfile.empty() || !m_deps_log)
+    {
+        return {};
+    }
+
+    std::vector<path> deps;
+    std::ifstream in(action.depfile, std::ios::binary);
+    if (in)
+    {
+        std::string content{ std::istreambuf_iterator<char>(in),
+                             std::istreambuf_iterator<char>() };
+        in.close();
+        deps = action.depfile_format ==
+                       DependencyFormat::MsvcSourceDependencies
+                   ? parse_msvc_source_dependencies(content)
+                   : parse_makefile_deps(content);
+        std::error_code ec;
+        std::filesystem::remove(action.depfile, ec);
+    }
+    else
+    {
+        std::cerr << "Warning: Dependency file '" << action.depfile.string()
+                  << "' was not written; header changes will not trigger "
+                     "a rebuild of '"
+                  << action.primary_output.string() << "'.\n";
+    }
+
+    // 源文件与 BMI 已在 inputs 中，依赖库只保存额外的头文件
+    std::unordered_set<std::string> known;
+    for (const auto& input : action.inputs)
+    {
+        known.insert(cache_key(input));
+    }
+    std::erase_if(deps, [&known](const path& dep)
+                  { return known.contains(cache_key(dep)); });
+
+    m_deps_log->record_deps(action.primary_output, deps);
+    return deps;
+}
+
+void Builder::collect_content_stamped(const std::vector<BuildAction>& actions)
+{
+    m_content_stamped.clear();
+    m_interface_stamped.clear();
+    for (const auto& action : actions)
+    {
+        if (!action.restat && !action.interface_fingerprint)
+        {
+            continue;
+        }
+        auto& stamped = action.interface_fingerprint ? m_interface_stamped
+                                                     : m_content_stamped;
+        for (const auto& output : action.outputs)
+        {
+            stamped.insert(cache_key(output));
+        }
+    }
+}
+
+void Builder::prefetch_hashes(const std::vector<BuildAction>& actions)
+{
+    if (!m_hash_cache)
+    {
+        return;
+    }
+
+    // 在线程池上并行哈希所有尚未缓存的输入与输出，之后的逐个查询只需 stat
+    std::unordered_set<std::string> seen;
+    std::vector<path> files;
+    auto add_files = [&](const std::vector<path>& list)
+    {
+        for (const auto& file : list)
+        {
+            if (seen.insert(cache_key(file)).second)
+            {
+                files.push_back(file);
+            }
+        }
+    };
+    for (const auto& action : actions)
+    {
+        add_files(action.inputs);
+        add_files(action.outputs);
+        if (auto header_deps = known_header_deps(action))
+        {
+            add_files(*header_deps);
+        }
+    }
+    m_hash_cache->hash_all(files);
+}
+
+std::optional<std::uint64_t> Builder::stamp_file(const path& file,
+                                                 bool by_content)
+{
+    auto key = cache_key(file);
+    if (by_content && m_interface_stamped.contains(key))
+    {
+        auto it = m_interface_content_stamps.find(key);
+        if (it == m_interface_content_stamps.end())
+        {
+            auto content_hash =
+                m_hash_cache ? m_hash_cache->hash(file) : hash_file(file);
+            std::optional<std::uint64_t> stamp;
+            if (content_hash)
+            {
+                stamp = hash_combine(hash_string(key), *content_hash);
+            }
+            it = m_interface_content_stamps.emplace(std::move(key), stamp)
+                     .first;
+        }
+        return it->second;
+    }
+    if (auto it = m_stamp_cache.find(key); it != m_stamp_cache.end())
+    {
+        return it->second;
+    }
+
+    std::optional<std::uint64_t> stamp;
+    if (m_interface_stamped.contains(key))
+    {
+        if (auto fingerprint = interface_fingerprint(file))
+        {
+            stamp = hash_combine(hash_string(key), *fingerprint);
+        }
+    }
+    else if (m_hash_cache || m_content_stamped.contains(key))
+    {
+        auto content_hash =
+            m_hash_cache ? m_hash_cache->hash(file) : hash_file(file);
+        if (content_hash)
+        {
+            stamp = hash_combine(hash_string(key), *content_hash);
+        }
+    }
+    else if (const auto identity = file_identity(file))
+    {
+        std::uint64_t h = hash_string(key);
+        h = hash_combine(h, static_cast<std::uint64_t>(identity->mtime_ns));
+        stamp = hash_combine(h, identity->size);
+    }
+
+    m_stamp_cache.emplace(std::move(key), stamp);
+    return stamp;
+}
+
+// 启用内容哈希时，预热哈希已 stat 过计划中的所有文件，直接取其结果；
+// 其余情况 stat 一次并缓存到本次构建结束（产出文件在动作完成后失效）
+std::optional<FileIdentity> Builder::file_identity(const path& file)
+{
+    auto key = cache_key(file);
+    if (auto it = m_identity_cache.find(key); it != m_identity_cache.end())
+    {
+        return it->second;
+    }
+    auto identity = m_hash_cache ? m_hash_cache->identity(file) : std::nullopt;
+    if (!identity)
+    {
+        identity = stat_file(file);
+    }
+    m_identity_cache.emplace(std::move(key), identity);
+    return identity;
+}
+
+std::uint64_t Builder::stamp_inputs(const std::vector<path>& files,
+                                    bool by_content)
+{
+    std::uint64_t h = 0;
+    for (const auto& file : files)
+    {
+        h = hash_combine(
+            h, stamp_file(file, by_content).value_or(kMissingFileStamp));
+    }
+    return h;
+}
+
+std::optional<std::uint64_t> Builder::stamp_outputs(
+    const std::vector<path>& files)
+{
+    std::uint64_t h = 0;
+    for (const auto& file : files)
+    {
+        auto stamp = stamp_file(file);
+        if (!stamp)
+        {
+            return std::nullopt;
+        }
+        h = hash_combine(h, *stamp);
+    }
+    return h;
+}
@@ -0,0 +1,141 @@
+// builder.ixx
+//
+// 定义了 Builder 类：按依赖关系执行构建动作，并借助 BuildLog 跳过
+// 自上次成功构建以来命令、输入与输出均未发生变化的动作。
+// 提供 ThreadPool 时，互不依赖的动作在线程池上并行执行；
+// 多个 Builder 共享同一线程池即共享同一组编译任务槽；
+// 动作按 BuildAction::slots 占用其中若干个（例如并行 LTO 后端的链接）。
+// 提供 FileHashCache 时，文件指纹基于内容哈希而非 mtime；
+// 提供 DepsLog 时，编译器报告的头文件也参与脏检测。
+// 精简 BMI 以接口指纹为准，只改实现细节的编辑不会使导入它的目标文件失效。
+// 就绪的动作中，输入最近被编辑过的优先执行，刚改过的代码中的错误最先暴露。
+
+export module builder;
+
+import std;
+import executor;
+import build_log;
+import deps_log;
+import file_hash_cache;
+import module_processor;
+import thread_pool;
+
+namespace importa
+{
+
+namespace builder
+{
+
+using path = std::filesystem::path;
+
+export struct BuildStats
+{
+    std::size_t executed = 0;
+    std::size_t skipped = 0;
+    std::size_t failed = 0;
+    std::size_t cut_off = 0; // 重新执行后输出未变、未使下游失效的动作数
+
+    explicit operator bool() const; // 没有失败的动作时为 true
+};
+
+// 计算命令的指纹，可执行文件、参数、工作目录或环境变量变化都会改变它
+export std::uint64_t hash_command(const executor::Command& command);
+
+// 从 actions 中挑出受 changed 中文件影响的动作（保持原有顺序）：
+// 直接以变化文件为输入或头文件依赖的动作，以及以这些动作的输出为输入的下游动作
+export std::vector<module_processor::BuildAction> select_affected(
+    const std::vector<module_processor::BuildAction>& actions,
+    const std::vector<path>& changed,
+    const deps_log::DepsLog* deps_log = nullptr);
+
+export class Builder
+{
+  public:
+    // hash_cache 为空时使用 (mtime, size) 作为文件指纹；
+    // deps_log 为空时不追踪头文件依赖；
+    // job_pool 为空时在调用线程上逐个执行命令（executor 须线程安全）
+    Builder(executor::IExecutor& executor, build_log::BuildLog& log,
+            file_hash_cache::FileHashCache* hash_cache = nullptr,
+            deps_log::DepsLog* deps_log = nullptr,
+            thread_pool::ThreadPool* job_pool = nullptr);
+
+    // 执行 actions（调用者保证其顺序满足依赖关系）。动作的输入一旦由
+    // 其他动作产出，就要等该动作完成后才开始；遇到第一个失败的动作后
+    // 不再启动新动作，已在运行的动作照常完成并入库。
+    // 就绪动作按源文件（含头文件依赖）的最新修改时间从新到旧启动，
+    // 其上游动作继承下游的优先级；修改时间相同时保持计划中的顺序。
+    BuildStats build(const std::vector<module_processor::BuildAction>& actions);
+
+    // 判断动作是否可以跳过
+    bool is_up_to_date(const module_processor::BuildAction& action);
+
+  private:
+    executor::IExecutor& m_executor;
+    build_log::BuildLog& m_log;
+    file_hash_cache::FileHashCache* m_hash_cache;
+    deps_log::DepsLog* m_deps_log;
+    thread_pool::ThreadPool* m_job_pool;
+
+    // 单次构建内的文件时间戳缓存，多个动作共享的 BMI 只需 stat 一次
+    std::unordered_map<std::string, std::optional<std::uint64_t>>
+        m_stamp_cache;
+
+    // 单次构建内的文件身份：编辑优先级与按 mtime 计算的时间戳共用，
+    // 启用内容哈希时直接取预热哈希时 stat 的结果
+    std::unordered_map<std::string,
+                       std::optional<file_hash_cache::FileIdentity>>
+        m_identity_cache;
+
+    // restat 动作的输出：无论是否启用内容哈希缓存，都按内容计算指纹
+    std::unordered_set<std::string> m_content_stamped;
+    // interface_fingerprint 动作的输出：按接口指纹计算。
+    // 但产出 BMI 的导入者仍按内容看待它们：clang 可能在导入者的 BMI 中
+    // 记录所导入 BMI 的大小与签名，沿用旧 BMI 会让之后同时导入两者的
+    // 编译被拒绝。因此只截断目标文件，不截断 BMI
+    std::unordered_set<std::string> m_interface_stamped;
+    // 上述输出按内容计算的指纹，单次构建内缓存
+    std::unordered_map<std::string, std::optional<std::uint64_t>>
+        m_interface_content_stamps;
+
+    // 动作开始执行前计算、完成后入库所需的状态
+    struct StartedAction
+    {
+        std::uint64_t command_hash = 0;
+        std::uint64_t source_stamp = 0;
+        std::optional<std::uint64_t> previous_output_stamp;
+    };
+
+    std::vector<std::vector<std::size_t>> collect_dependents(
+        const std::vector<module_processor::BuildAction>& actions,
+        std::vector<std::size_t>& waiting) const;
+    std::vector<std::int64_t> edit_priorities(
+        const std::vector<module_processor::BuildAction>& actions,
+        const std::vector<std::vector<std::size_t>>& dependents);
+    bool finish_action(const module_processor::BuildAction& action,
+                       const StartedAction& started,
+                       const executor::ExecutionResult& result,
+                       std::chrono::steady_clock::duration elapsed,
+                       BuildStats& stats);
+    bool is_clean(const module_processor::BuildAction& action,
+                  std::uint64_t source_stamp,
+                  const build_log::BuildRecord& previous);
+    std::optional<std::vector<path>> known_header_deps(
+        const module_processor::BuildAction& action) const;
+    std::vector<path> ingest_depfile(
+        const module_processor::BuildAction& action);
+    void collect_content_stamped(
+        const std::vector<module_processor::BuildAction>& actions);
+    void prefetch_hashes(
+        const std::vector<module_processor::BuildAction>& actions);
+    std::optional<file_hash_cache::FileIdentity> file_identity(
+        const path& file);
+    // by_content 为 true 时，接口指纹输出也按内容计算（见 m_interface_stamped）
+    std::optional<std::uint64_t> stamp_file(const path& file,
+                                            bool by_content = false);
+    std::uint64_t stamp_inputs(const std::vector<path>& files,
+                               bool by_content = false);
+    std::optional<std::uint64_t> stamp_outputs(const std::vector<path>& files);
+};
+
+} // namespace builder
+} // namespace importa
@@ -0,0 +1,463 @@
+// compression.cpp
+// 提供了 compression 模块中声明的各个函数的具体实现。
+//
+// 块编码由若干序列组成：
+//   [标记字节][扩展字面量长度][字面量][u16 偏移][扩展匹配长度]
+// 标记字节高 4 位为字面量长度、低 4 位为匹配长度减 4，取值 15 时后跟扩展字节
+// （逐字节累加，遇到非 255 的字节结束）。最后一个序列只有字面量。
+//
+// 文件格式：8 字节文件头（魔数 + 版本号），随后是若干块：
+//   [u32 原始长度][u32 落盘长度][负载][u32 原始数据校验和]
+// 落盘长度最高位表示负载未压缩（压缩无收益时）。原始长度为 0 的块标志文件结束。
+
+module compression;
+
+import std;
+import hashing;
+
+namespace importa::compression
+{
+
+namespace
+{ // 编码参数与磁盘格式定义
+
+constexpr std::array<char, 8> kFrameHeader = { 'I', 'M', 'P', 'A',
+                                               'L', 'Z', 'B', 1 };
+constexpr std::uint32_t kStoredFlag = 0x80000000u;
+constexpr std::size_t kBlockSize = std::size_t{ 1 } << 18;
+
+constexpr std::size_t kMinMatch = 4;
+// 块末尾的若干字节总是作为字面量输出，解码循环因此无需处理越界的匹配
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMatchSafeDistance = 12;
+constexpr std::size_t kMaxOffset = 0xFFFF;
+constexpr int kHashBits = 16;
+constexpr int kHighSearchDepth = 64;
+
+std::uint32_t read32(const char* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash4(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void write_u32(std::ostream& out, std::uint32_t value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool read_u32(std::istream& in, std::uint32_t& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return in.gcount() == sizeof(value);
+}
+
+std::uint32_t block_checksum(std::string_view raw)
+{
+    return static_cast<std::uint32_t>(
+        importa::hashing::hash_bytes(raw.data(), raw.size()));
+}
+
+// --- 块编码 ---
+
+void write_length(std::string& out, std::size_t length)
+{
+    for (length -= 15; length >= 255; length -= 255)
+    {
+        out.push_back(static_cast<char>(255));
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+void emit_sequence(std::string& out, std::string_view literals,
+                   std::size_t offset, std::size_t match_length)
+{
+    const std::size_t lit_code = std::min<std::size_t>(literals.size(), 15);
+    const std::size_t match_code =
+        match_length ? std::min<std::size_t>(match_length - kMinMatch, 15) : 0;
+    out.push_back(static_cast<char>(lit_code << 4 | match_code));
+    if (lit_code == 15)
+    {
+        write_length(out, literals.size());
+    }
+    out.append(literals);
+    if (match_length == 0)
+    {
+        return;
+    }
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (match_code == 15)
+    {
+        write_length(out, match_length - kMinMatch);
+    }
+}
+
+struct Match
+{
+    std::size_t offset = 0;
+    std::size_t length = 0;
+};
+
+// 在 [0, pos) 中为 pos 处的数据寻找匹配，同时把 pos 加入索引
+class MatchFinder
+{
+  public:
+    MatchFinder(std::string_view data, Level level)
+        : m_data(data), m_level(level),
+          m_head(std::size_t{ 1 } << kHashBits, -1)
+    {
+        if (level == Level::high)
+        {
+            m_chain.assign(kMaxOffset + 1, -1);
+        }
+    }
+
+    Match find(std::size_t pos, std::size_t limit)
+    {
+        const std::uint32_t h = hash4(read32(m_data.data() + pos));
+        std::int32_t candidate = m_head[h];
+        m_head[h] = static_cast<std::int32_t>(pos);
+        if (m_level == Level::fast)
+        {
+            return candidate >= 0 ? extend(static_cast<std::size_t>(candidate),
+                                           pos, limit)
+                                  : Match{};
+        }
+
+        m_chain[pos & kMaxOffset] = candidate;
+        Match best;
+        for (int depth = 0; depth < kHighSearchDepth && candidate >= 0;
+             ++depth)
+        {
+            const auto match =
+                extend(static_cast<std::size_t>(candidate), pos, limit);
+            if (match.offset == 0)
+            {
+                break; // 超出窗口，链上更早的位置只会更远
+            }
+            if (match.length > best.length)
+            {
+                best = match;
+            }
+            candidate =
+                m_chain[static_cast<std::size_t>(candidate) & kMaxOffset];
+        }
+        return best;
+    }
+
+    // 把匹配内部的位置也加入索引，仅 high 级别使用
+    void insert(std::size_t from, std::size_t to)
+    {
+        if (m_level == Level::fast)
+        {
+            return;
+        }
+        for (std::size_t pos = from; pos < to; ++pos)
+        {
+            const std::uint32_t h = hash4(read32(m_data.data() + pos));
+            m_chain[pos & kMaxOffset] = m_head[h];
+            m_head[h] = static_cast<std::int32_t>(pos);
+        }
+    }
+
+  private:
+    std::string_view m_data;
+    Level m_level;
+    std::vector<std::int32_t> m_head;
+    std::vector<std::int32_t> m_chain;
+
+    Match extend(std::size_t candidate, std::size_t pos,
+                 std::size_t limit) const
+    {
+        if (pos - candidate > kMaxOffset)
+        {
+            return {};
+        }
+        std::size_t length = 0;
+        while (pos + length < limit &&
+               m_data[candidate + length] == m_data[pos + length])
+        {
+            ++length;
+        }
+        return { pos - candidate, length };
+    }
+};
+
+// --- 帧读写 ---
+
+class FrameWriter
+{
+  public:
+    FrameWriter(std::ostream& out, Level level) : m_out(out), m_level(level)
+    {
+        m_out.write(kFrameHeader.data(), kFrameHeader.size());
+    }
+
+    void write_block(std::string_view raw)
+    {
+        const std::string packed = compress_block(raw, m_level);
+        const bool stored = packed.size() >= raw.size();
+        const std::string_view payload = stored ? raw : packed;
+        write_u32(m_out, static_cast<std::uint32_t>(raw.size()));
+        write_u32(m_out, static_cast<std::uint32_t>(payload.size()) |
+                             (stored ? kStoredFlag : 0));
+        m_out.write(payload.data(),
+                    static_cast<std::streamsize>(payload.size()));
+        write_u32(m_out, block_checksum(raw));
+        m_sizes.raw_bytes += raw.size();
+    }
+
+    std::optional<FileSizes> finish()
+    {
+        write_u32(m_out, 0);
+        m_out.flush();
+        if (!m_out)
+        {
+            return std::nullopt;
+        }
+        m_sizes.stored_bytes = static_cast<std::uintmax_t>(m_out.tellp());
+        return m_sizes;
+    }
+
+  private:
+    std::ostream& m_out;
+    Level m_level;
+    FileSizes m_sizes;
+};
+
+// 逐块解码并交给 sink；任何格式错误都使整个读取失败
+bool read_frame(std::istream& in,
+                const std::function<void(std::string_view)>& sink)
+{
+    std::array<char, kFrameHeader.size()> header;
+    in.read(header.data(), header.size());
+    if (in.gcount() != static_cast<std::streamsize>(header.size()) ||
+        header != kFrameHeader)
+    {
+        return false;
+    }
+
+    std::string payload;
+    while (true)
+    {
+        std::uint32_t raw_size = 0;
+        std::uint32_t stored_word = 0;
+        if (!read_u32(in, raw_size))
+        {
+            return false;
+        }
+        if (raw_size == 0)
+        {
+            return true;
+        }
+        if (raw_size > kBlockSize || !read_u32(in, stored_word) ||
+            (stored_word & ~kStoredFlag) > kBlockSize)
+        {
+            return false;
+        }
+        payload.resize(stored_word & ~kStoredFlag);
+        in.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+        std::uint32_t checksum = 0;
+        if (in.gcount() != static_cast<std::streamsize>(payload.size()) ||
+            !read_u32(in, checksum))
+        {
+            return false;
+        }
+
+        std::optional<std::string> decoded;
+        if (!(stored_word & kStoredFlag))
+        {
+            decoded = decompress_block(payload, raw_size);
+            if (!decoded)
+            {
+                return false;
+            }
+        }
+        const std::string_view raw = decoded ? std::string_view(*decoded)
+                                             : std::string_view(payload);
+        if (raw.size() != raw_size || block_checksum(raw) != checksum)
+        {
+            return false;
+        }
+        sink(raw);
+    }
+}
+} // namespace
+
+std::string compress_block(std::string_view data, Level level)
+{
+    std::string out;
+    out.reserve(data.size() / 2 + 16);
+    std::size_t anchor = 0;
+    if (data.size() > kMatchSafeDistance)
+    {
+        const std::size_t match_limit = data.size() - kLastLiterals;
+        const std::size_t search_end = data.size() - kMatchSafeDistance;
+        MatchFinder finder(data, level);
+        std::size_t pos = 0;
+        std::size_t misses = 0;
+        while (pos < search_end)
+        {
+            const Match match = finder.find(pos, match_limit);
+            if (match.length < kMinMatch)
+            {
+                // 不可压缩的区域逐渐加大步长
+                pos += level == Level::fast ? 1 + (misses++ >> 6) : 1;
+                continue;
+            }
+            misses = 0;
+            emit_sequence(out, data.substr(anchor, pos - anchor), match.offset,
+                          match.length);
+            finder.insert(pos + 1,
+                          std::min(pos + match.length, search_end));
+            pos += match.length;
+            anchor = pos;
+        }
+    }
+    emit_sequence(out, data.substr(anchor), 0, 0);
+    return out;
+}
+
+std::optional<std::string> decompress_block(std::string_view data,
+                                            std::size_t raw_size)
+{
+    std::string out;
+    out.reserve(raw_size);
+    std::size_t i = 0;
+    auto read_length = [&](std::size_t length) -> std::optional<std::size_t>
+    {
+        if (length != 15)
+        {
+            return length;
+        }
+        while (true)
+        {
+            if (i >= data.size())
+            {
+                return std::nullopt;
+            }
+            const auto byte = static_cast<unsigned char>(data[i++]);
+            length += byte;
+            if (byte != 255)
+            {
+                return length;
+            }
+        }
+    };
+
+    while (i < data.size())
+    {
+        const auto token = static_cast<unsigned char>(data[i++]);
+        auto literals = read_length(token >> 4);
+        if (!literals || *literals > data.size() - i ||
+            *literals > raw_size - out.size())
+        {
+            return std::nullopt;
+        }
+        out.append(data.substr(i, *literals));
+        i += *literals;
+        if (i == data.size())
+        {
+            break; // 最后一个序列
+        }
+
+        if (data.size() - i < 2)
+        {
+            return std::nullopt;
+        }
+        const std::size_t offset = static_cast<unsigned char>(data[i]) |
+                                   static_cast<unsigned char>(data[i + 1]) << 8;
+        i += 2;
+        auto length = read_length(token & 0x0F);
+        if (offset == 0 || offset > out.size() || !length ||
+            *length + kMinMatch > raw_size - out.size())
+        {
+            return std::nullopt;
+        }
+        // 偏移小于长度时源与目标重叠，按已有的部分分段复制
+        const std::size_t from = out.size() - offset;
+        for (std::size_t remaining = *length + kMinMatch; remaining > 0;)
+        {
+            const std::size_t chunk = std::min(remaining, out.size() - from);
+            out.append(out, from, chunk);
+            remaining -= chunk;
+        }
+    }
+    if (out.size() != raw_size)
+    {
+        return std::nullopt;
+    }
+    return out;
+}
+
+std::optional<FileSizes> compress_file(const path& source,
+                                       const path& destination, Level level)
+{
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    if (!in || !out)
+    {
+        return std::nullopt;
+    }
+    FrameWriter writer(out, level);
+    std::string block(kBlockSize, '\0');
+    while (in)
+    {
+        in.read(block.data(), static_cast<std::streamsize>(block.size()));
+        const auto count = static_cast<std::size_t>(in.gcount());
+        if (count > 0)
+        {
+            writer.write_block(std::string_view(block.data(), count));
+        }
+    }
+    if (in.bad())
+    {
+        return std::nullopt;
+    }
+    return writer.finish();
+}
+
+bool decompress_file(const path& source, const path& destination)
+{
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    if (!in || !out)
+    {
+        return false;
+    }
+    const bool ok = read_frame(in,
+                               [&](std::string_view raw)
+                               {
+                                   out.write(raw.data(),
+                                             static_cast<std::streamsize>(
+                                                 raw.size()));
+                               });
+    out.flush();
+    return ok && out.good();
+}
+
+std::optional<FileSizes> recompress_file(const path& source,
+                                         const path& destination, Level level)
+{
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    if (!in || !out)
+    {
+        return std::nullopt;
+    }
+    FrameWriter writer(out, level);
+    if (!read_frame(in,
+                    [&](std::string_view raw) { writer.write_block(raw); }))
+    {
+        return std::nullopt;
+    }
+    return writer.finish();
+}
+
+} // namespace importa::compression
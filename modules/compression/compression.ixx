@@ -0,0 +1,57 @@
+// compression.ixx
+//
+// 提供缓存产物使用的快速无损压缩（LZ4 风格的字节对齐 LZ77 编码，无熵编码）。
+// 目标文件与 BMI 中重复的符号名、类型描述很多，这种编码即可达到数倍的压缩比，
+// 而解压速度接近内存拷贝。
+//
+// 文件以分块帧的形式存放，读写都是流式的，不需要把整个文件读入内存；
+// 每块都带有原始数据的校验和，损坏或截断的文件在解压时会被发现。
+
+export module compression;
+
+import std;
+
+namespace importa
+{
+
+namespace compression
+{
+
+using path = std::filesystem::path;
+
+// 压缩级别：两者输出格式相同，解压速度也相同
+export enum class Level
+{
+    fast, // 单候选哈希表，适合发布新条目
+    high  // 哈希链搜索最长匹配，压缩慢数倍，适合很少被改写的冷数据
+};
+
+// 压缩一块数据；输出只能由 decompress_block 配合原始长度解开
+export std::string compress_block(std::string_view data, Level level);
+
+// 解压一块数据；输入损坏或解出的长度不等于 raw_size 时返回 nullopt
+export std::optional<std::string> decompress_block(std::string_view data,
+                                                   std::size_t raw_size);
+
+// 一个压缩文件的原始字节数与落盘字节数
+export struct FileSizes
+{
+    std::uintmax_t raw_bytes = 0;
+    std::uintmax_t stored_bytes = 0;
+};
+
+// 把 source 压缩写入 destination；读写失败时返回 nullopt
+export std::optional<FileSizes> compress_file(const path& source,
+                                              const path& destination,
+                                              Level level);
+
+// 把压缩文件直接解压到 destination；格式错误、校验失败或读写失败时返回 false
+export bool decompress_file(const path& source, const path& destination);
+
+// 以另一压缩级别重新编码压缩文件，全程不落地原始数据
+export std::optional<FileSizes> recompress_file(const path& source,
+                                                const path& destination,
+                                                Level level);
+
+} // namespace compression
+} // namespace importa
@@ -0,0 +1,483 @@
+// dependency_scanner.cpp
+// 提供了 DependencyScanner 类与 P1689 解析函数的具体实现。
+//
+// 缓存格式：每个源文件一个文件，首行为
+//   "<内容哈希> <扫描命令哈希> <实现的模块名或 -> <头文件数 N>"
+// 其后 N 行为扫描时读取的头文件 "<内容哈希> <路径>"，再往后为扫描器输出的
+// 原始 P1689 JSON。缓存文件通过“写临时文件 + rename”整体替换。
+
+module;
+
+#include "json.hpp"
+
+module dependency_scanner;
+
+import std;
+import executor;
+import hashing;
+import toolchains;
+import thread_pool;
+import file_hash_cache;
+import module_processor;
+import deps_log;
+
+using namespace importa::dependency_scanner;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using json = nlohmann::json;
+
+namespace
+{ // 内部辅助函数
+
+std::string to_hex(std::uint64_t value)
+{
+    std::array<char, 16> buffer;
+    auto [ptr, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16);
+    return std::string(buffer.data(), ptr);
+}
+
+std::optional<std::string> read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+// 识别实现单元的 "module M;" 声明。P1689 不区分 "module M;" 与 "import M;"，
+// 因此需要直接查看源文件；全局模块片段的 "module;" 与分区不会匹配。
+std::string find_implemented_module(const path& source)
+{
+    std::ifstream in(source);
+    static const std::regex rgx(R"(^\s*module\s+([A-Za-z_][\w.]*)\s*;)");
+    std::string line;
+    std::size_t scanned = 0;
+    while (std::getline(in, line) && scanned < 128 * 1024)
+    {
+        scanned += line.size();
+        std::smatch m;
+        if (std::regex_search(line, m, rgx))
+        {
+            return m[1].str();
+        }
+    }
+    return {};
+}
+
+void write_cache_file(const path& cache_file, const std::string& content)
+{
+    path temp_path = cache_file;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out << content;
+        if (!out)
+        {
+            return; // 缓存写入失败不影响本次扫描结果
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, cache_file, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+// 将模块名拆分为 (主模块名, 分区名)
+std::pair<std::string, std::string> split_module_name(const std::string& name)
+{
+    auto colon = name.find(':');
+    if (colon == std::string::npos)
+    {
+        return { name, {} };
+    }
+    return { name.substr(0, colon), name.substr(colon + 1) };
+}
+
+// 按分区之间的导入排序：被导入的分区排在前面，其余保持路径顺序
+bool order_partitions(ModuleUnit& unit)
+{
+    std::ranges::sort(unit.partitions);
+    std::vector<path> ordered;
+    std::set<std::string> emitted;
+    while (ordered.size() < unit.partitions.size())
+    {
+        bool progressed = false;
+        for (const auto& source : unit.partitions)
+        {
+            const auto& partition = unit.partition_info.at(source);
+            if (emitted.contains(partition.name))
+            {
+                continue;
+            }
+            const bool ready = std::ranges::all_of(
+                partition.imports, [&](const std::string& imported)
+                { return emitted.contains(imported); });
+            if (ready)
+            {
+                emitted.insert(partition.name);
+                ordered.push_back(source);
+                progressed = true;
+            }
+        }
+        if (!progressed)
+        {
+            std::cerr << "Error: Partitions of module '" << unit.name
+                      << "' import each other cyclically or import a "
+                         "partition that is not among the scanned "
+                         "sources.\n";
+            return false;
+        }
+    }
+    unit.partitions = std::move(ordered);
+    return true;
+}
+} // namespace
+
+// --- P1689 解析 ---
+
+std::optional<ScanResult> importa::dependency_scanner::parse_p1689(
+    std::string_view text)
+{
+    auto j = json::parse(text, nullptr, false);
+    if (j.is_discarded() || !j.contains("rules") || !j["rules"].is_array() ||
+        j["rules"].empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto& rule = j["rules"][0];
+    ScanResult result;
+    if (rule.contains("provides"))
+    {
+        for (const auto& provided : rule["provides"])
+        {
+            result.provided_module =
+                provided.at("logical-name").get<std::string>();
+            // P1689 规定 is-interface 缺省为 true
+            result.is_interface = provided.value("is-interface", true);
+        }
+    }
+    if (rule.contains("requires"))
+    {
+        for (const auto& required : rule["requires"])
+        {
+            result.required_modules.push_back(
+                required.at("logical-name").get<std::string>());
+        }
+    }
+    return result;
+}
+
+// --- ModuleUnit 组装 ---
+
+std::optional<std::vector<ModuleUnit>> importa::dependency_scanner::
+    build_module_units(const std::vector<ScanResult>& results)
+{
+    std::map<std::string, ModuleUnit> units;
+    std::map<std::string, std::set<std::string>> requires_by_unit;
+
+    for (const auto& result : results)
+    {
+        std::string unit_name;
+        if (!result.provided_module.empty())
+        {
+            auto [module_name, partition] =
+                split_module_name(result.provided_module);
+            unit_name = module_name;
+            auto& unit = units[unit_name];
+            if (!partition.empty())
+            {
+                unit.partitions.push_back(result.source_file);
+                ModulePartition info{ .name = partition,
+                                      .is_interface = result.is_interface };
+                for (const auto& required : result.required_modules)
+                {
+                    auto [required_module, required_partition] =
+                        split_module_name(required);
+                    if (required_module == module_name &&
+                        !required_partition.empty())
+                    {
+                        info.imports.push_back(required_partition);
+                    }
+                }
+                unit.partition_info[result.source_file] = std::move(info);
+            }
+            else if (!unit.primary_interface.empty())
+            {
+                std::cerr << "Error: Module '" << module_name
+                          << "' has more than one primary interface: '"
+                          << unit.primary_interface.string() << "' and '"
+                          << result.source_file.string() << "'.\n";
+                return std::nullopt;
+            }
+            else
+            {
+                unit.primary_interface = result.source_file;
+            }
+        }
+        else
+        {
+            unit_name = result.implemented_module.empty()
+                            ? std::string(kNonModuleUnitName)
+                            : result.implemented_module;
+            units[unit_name].implementations.push_back(result.source_file);
+        }
+        units[unit_name].name = unit_name;
+        requires_by_unit[unit_name].insert(result.required_modules.begin(),
+                                           result.required_modules.end());
+    }
+
+    for (auto& [name, unit] : units)
+    {
+        if (name != kNonModuleUnitName && unit.primary_interface.empty())
+        {
+            std::cerr << "Error: Module '" << name
+                      << "' has partitions or implementation units but no "
+                         "primary interface among the scanned sources.\n";
+            return std::nullopt;
+        }
+        if (!order_partitions(unit))
+        {
+            return std::nullopt;
+        }
+        std::ranges::sort(unit.implementations);
+
+        // 本模块自身及其分区不是外部依赖
+        for (const auto& required : requires_by_unit[name])
+        {
+            if (split_module_name(required).first != name)
+            {
+                unit.dependencies.push_back(required);
+            }
+        }
+    }
+
+    // 拓扑排序：被依赖的模块排在前面；不在扫描集合中的依赖（如 std）视为外部已构建
+    std::vector<ModuleUnit> ordered;
+    std::set<std::string> emitted;
+    while (ordered.size() < units.size())
+    {
+        bool progressed = false;
+        for (auto& [name, unit] : units)
+        {
+            if (emitted.contains(name))
+            {
+                continue;
+            }
+            const bool ready = std::ranges::all_of(
+                unit.dependencies,
+                [&](const std::string& dep)
+                { return !units.contains(dep) || emitted.contains(dep); });
+            if (ready)
+            {
+                emitted.insert(name);
+                ordered.push_back(unit);
+                progressed = true;
+            }
+        }
+        if (!progressed)
+        {
+            std::cerr << "Error: Cyclic module dependency detected among the "
+                         "scanned sources.\n";
+            return std::nullopt;
+        }
+    }
+    return ordered;
+}
+
+// --- DependencyScanner ---
+
+DependencyScanner::DependencyScanner(const IToolchain& toolchain,
+                                     IExecutor& executor,
+                                     thread_pool::ThreadPool& pool,
+                                     file_hash_cache::FileHashCache& hash_cache,
+                                     path cache_dir)
+    : m_toolchain(toolchain), m_executor(executor), m_pool(pool),
+      m_hash_cache(hash_cache), m_cache_dir(std::move(cache_dir))
+{
+    std::filesystem::create_directories(m_cache_dir);
+}
+
+std::optional<std::vector<ScanResult>> DependencyScanner::scan(
+    const std::vector<path>& sources)
+{
+    std::vector<std::optional<ScanResult>> results(sources.size());
+    std::vector<std::size_t> indices(sources.size());
+    std::iota(indices.begin(), indices.end(), std::size_t{ 0 });
+
+    thread_pool::parallel_for_each(m_pool, indices,
+                                   [&](std::size_t i)
+                                   { results[i] = scan_one(sources[i]); });
+
+    std::vector<ScanResult> scanned;
+    scanned.reserve(results.size());
+    for (auto& result : results)
+    {
+        if (!result)
+        {
+            return std::nullopt;
+        }
+        scanned.push_back(std::move(*result));
+    }
+    m_hash_cache.save();
+    return scanned;
+}
+
+std::size_t DependencyScanner::files_scanned() const
+{
+    return m_files_scanned;
+}
+
+// --- 私有辅助函数实现 ---
+
+std::optional<ScanResult> DependencyScanner::scan_one(const path& source)
+{
+    auto content_hash = m_hash_cache.hash(source);
+    if (!content_hash)
+    {
+        std::cerr << "Error: Cannot read source file '" << source.string()
+                  << "' for dependency scanning.\n";
+        return std::nullopt;
+    }
+
+    const std::string stem = to_hex(importa::hashing::hash_string(
+        source.lexically_normal().generic_string()));
+    ScanDepsArgs args;
+    args.source_file = source;
+    args.output_obj_path = m_cache_dir / (stem + ".obj");
+    args.output_scan_path = m_cache_dir / (stem + ".scan.json");
+    args.dependency_file = m_cache_dir / (stem + ".scan.d");
+    const path cache_file = m_cache_dir / (stem + ".p1689");
+
+    auto cmd = m_toolchain.generate_scan_deps_command(args);
+    if (!cmd)
+    {
+        std::cerr << "Error: The toolchain cannot generate a dependency scan "
+                     "command for '"
+                  << source.string() << "'.\n";
+        return std::nullopt;
+    }
+
+    // 扫描结果取决于源文件内容、扫描命令（宏定义、包含目录等），
+    // 以及头文件：导入可能写在头文件中，或由头文件中的宏决定
+    const std::string cache_tag =
+        to_hex(*content_hash) + " " +
+        to_hex(importa::hashing::hash_string(cmd->to_string()));
+
+    std::string p1689;
+    std::string implemented_module;
+    if (auto cached = read_file(cache_file))
+    {
+        std::istringstream in(*cached);
+        std::string line;
+        std::getline(in, line);
+        std::istringstream header(line);
+        std::string content_tag, command_tag;
+        std::size_t header_count = 0;
+        header >> content_tag >> command_tag >> implemented_module >>
+            header_count;
+        bool fresh = header && content_tag + " " + command_tag == cache_tag;
+        for (std::size_t i = 0; fresh && i < header_count; ++i)
+        {
+            std::getline(in, line);
+            const auto space = line.find(' ');
+            if (space == std::string::npos)
+            {
+                fresh = false;
+                break;
+            }
+            const auto header_hash =
+                m_hash_cache.hash(line.substr(space + 1));
+            fresh = header_hash &&
+                    to_hex(*header_hash) == line.substr(0, space);
+        }
+        if (fresh)
+        {
+            p1689.assign(std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>());
+        }
+    }
+
+    if (p1689.empty())
+    {
+        ExecutionResult result = m_executor.execute(*cmd);
+        if (!result)
+        {
+            std::cerr << "Error: Dependency scan failed for '"
+                      << source.string() << "'.\n"
+                      << result.std_err;
+            return std::nullopt;
+        }
+        ++m_files_scanned;
+
+        // MSVC 写到 output_scan_path，clang-scan-deps 写到标准输出
+        if (auto from_file = read_file(args.output_scan_path))
+        {
+            p1689 = std::move(*from_file);
+            std::error_code ec;
+            std::filesystem::remove(args.output_scan_path, ec);
+        }
+        else
+        {
+            p1689 = std::move(result.std_out);
+        }
+
+        std::string headers;
+        std::size_t header_count = 0;
+        if (auto depfile = read_file(args.dependency_file))
+        {
+            const auto deps =
+                m_toolchain.dependency_format() ==
+                        DependencyFormat::MsvcSourceDependencies
+                    ? deps_log::parse_msvc_source_dependencies(*depfile)
+                    : deps_log::parse_makefile_deps(*depfile);
+            for (const auto& dep : deps)
+            {
+                if (dep == source)
+                {
+                    continue;
+                }
+                // 读不到的头文件记为空哈希，下次总会重新扫描
+                const auto header_hash = m_hash_cache.hash(dep);
+                headers += (header_hash ? to_hex(*header_hash) : "-") + " " +
+                           dep.string() + "\n";
+                ++header_count;
+            }
+            std::error_code ec;
+            std::filesystem::remove(args.dependency_file, ec);
+        }
+
+        implemented_module = find_implemented_module(source);
+        write_cache_file(cache_file,
+                         cache_tag + " " +
+                             (implemented_module.empty() ? "-"
+                                                         : implemented_module) +
+                             " " + std::to_string(header_count) + "\n" +
+                             headers + p1689);
+    }
+    if (implemented_module == "-")
+    {
+        implemented_module.clear();
+    }
+
+    auto parsed = parse_p1689(p1689);
+    if (!parsed)
+    {
+        std::cerr << "Error: Could not parse P1689 output for '"
+                  << source.string() << "'.\n";
+        return std::nullopt;
+    }
+    parsed->source_file = source;
+    if (parsed->provided_module.empty())
+    {
+        parsed->implemented_module = std::move(implemented_module);
+    }
+    return parsed;
+}
@@ -0,0 +1,77 @@
+// dependency_scanner.ixx
+//
+// 定义了 DependencyScanner 类：借助编译器的 P1689 扫描能力
+// （clang-scan-deps -format=p1689、MSVC /scanDependencies）并行扫描全部源文件，
+// 并据此自动组装 ModuleUnit，取代手工填写 ModuleUnit::dependencies。
+// 扫描结果按源文件缓存，只有内容或扫描命令变化的文件才会被重新扫描。
+
+export module dependency_scanner;
+
+import std;
+import executor;
+import toolchains;
+import thread_pool;
+import file_hash_cache;
+import module_processor;
+
+namespace importa
+{
+
+namespace dependency_scanner
+{
+
+using path = std::filesystem::path;
+
+// 单个源文件的扫描结果
+export struct ScanResult
+{
+    path source_file;
+    std::string provided_module; // 为空表示不提供模块（实现单元或普通源文件）
+    bool is_interface = false;
+    std::string implemented_module; // "module M;" 实现单元所属的模块
+    std::vector<std::string> required_modules;
+};
+
+// 非模块源文件被归入此名称的伪模块，其依赖为这些源文件导入的全部模块
+export inline constexpr std::string_view kNonModuleUnitName = "__global";
+
+// 解析 P1689 JSON 中第一条规则
+export std::optional<ScanResult> parse_p1689(std::string_view json);
+
+// 将扫描结果组装为 ModuleUnit：
+//  - 提供 "M" 的接口单元成为 M 的主接口；
+//  - 提供 "M:part" 的单元成为 M 的分区，按分区之间的导入排序；
+//  - 以 "module M;" 开头的单元成为 M 的实现文件；
+//  - 其余源文件归入 kNonModuleUnitName。
+export std::optional<std::vector<module_processor::ModuleUnit>>
+build_module_units(const std::vector<ScanResult>& results);
+
+export class DependencyScanner
+{
+  public:
+    DependencyScanner(const toolchains::IToolchain& toolchain,
+                      executor::IExecutor& executor,
+                      thread_pool::ThreadPool& pool,
+                      file_hash_cache::FileHashCache& hash_cache,
+                      path cache_dir);
+
+    // 并行扫描 sources，任一文件扫描失败时返回 nullopt
+    std::optional<std::vector<ScanResult>> scan(
+        const std::vector<path>& sources);
+
+    // 本进程中实际执行过扫描命令的文件数
+    std::size_t files_scanned() const;
+
+  private:
+    const toolchains::IToolchain& m_toolchain;
+    executor::IExecutor& m_executor;
+    thread_pool::ThreadPool& m_pool;
+    file_hash_cache::FileHashCache& m_hash_cache;
+    path m_cache_dir;
+    std::atomic<std::size_t> m_files_scanned{ 0 };
+
+    std::optional<ScanResult> scan_one(const path& source);
+};
+
+} // namespace dependency_scanner
+} // namespace importa
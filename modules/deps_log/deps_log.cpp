@@ -0,0 +1,556 @@
+// deps_log.cpp
+// 提供了 DepsLog 类与依赖文件解析函数的具体实现。
+//
+// 文件格式：8 字节文件头（魔数 + 版本号），随后是若干条变长记录：
+//   [u32 头部][负载][u32 校验和]
+// 头部最高位区分记录类型，其余位为负载字节数。
+//   路径记录：负载为路径字符串，id 按出现顺序隐式分配；
+//   依赖记录：负载为 u32 产物 id 与若干 u32 依赖 id。
+// 读取时遇到第一条校验失败或不完整的记录即停止并截断文件。
+
+module deps_log;
+
+import std;
+import hashing;
+
+using namespace importa::deps_log;
+
+namespace
+{ // 内部辅助函数与磁盘格式定义
+
+constexpr std::array<char, 8> kDepsHeader = { 'I', 'M', 'P', 'A',
+                                              'D', 'E', 'P', 1 };
+constexpr std::uint32_t kDepsRecordFlag = 0x80000000u;
+constexpr std::uint32_t kMaxPayloadSize = 0x7FFFFFFFu;
+
+constexpr std::size_t kCompactRatio = 3;
+constexpr std::size_t kMinRecordsToCompact = 1024;
+
+std::string key_for(const path& file)
+{
+    return file.lexically_normal().generic_string();
+}
+
+std::uint32_t compute_checksum(const char* data, std::size_t size)
+{
+    return static_cast<std::uint32_t>(
+        importa::hashing::hash_bytes(data, size));
+}
+
+void write_record(std::ofstream& out, std::uint32_t header,
+                  std::string_view payload)
+{
+    std::string buffer(sizeof(header), '\0');
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    buffer.append(payload);
+    const std::uint32_t checksum =
+        compute_checksum(buffer.data(), buffer.size());
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+}
+
+// --- Makefile 依赖文件解析 ---
+
+// 将依赖文件切分为词元，处理续行、转义空格与 $$
+std::vector<std::string> tokenize_makefile(std::string_view content)
+{
+    std::vector<std::string> tokens;
+    std::string current;
+    auto flush = [&]
+    {
+        if (!current.empty())
+        {
+            tokens.push_back(std::move(current));
+            current.clear();
+        }
+    };
+
+    for (std::size_t i = 0; i < content.size(); ++i)
+    {
+        const char c = content[i];
+        const char next = i + 1 < content.size() ? content[i + 1] : '\0';
+        if (c == '\\' && (next == '\n' || next == '\r'))
+        {
+            // 续行
+            flush();
+            ++i;
+            if (next == '\r' && i + 1 < content.size() &&
+                content[i + 1] == '\n')
+            {
+                ++i;
+            }
+        }
+        else if (c == '\\' && (next == ' ' || next == '#'))
+        {
+            current.push_back(next);
+            ++i;
+        }
+        else if (c == '$' && next == '$')
+        {
+            current.push_back('$');
+            ++i;
+        }
+        else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            flush();
+        }
+        else
+        {
+            current.push_back(c);
+        }
+    }
+    flush();
+    return tokens;
+}
+
+// --- JSON 字符串解析（仅覆盖 /sourceDependencies 所需的子集） ---
+
+void skip_whitespace(std::string_view text, std::size_t& pos)
+{
+    while (pos < text.size() &&
+           (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' ||
+            text[pos] == '\r'))
+    {
+        ++pos;
+    }
+}
+
+void append_utf8(std::string& out, std::uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+// 从 pos 处（指向开头的引号）解析一个 JSON 字符串
+std::optional<std::string> parse_json_string(std::string_view text,
+                                             std::size_t& pos)
+{
+    if (pos >= text.size() || text[pos] != '"')
+    {
+        return std::nullopt;
+    }
+    ++pos;
+    std::string out;
+    while (pos < text.size())
+    {
+        const char c = text[pos++];
+        if (c == '"')
+        {
+            return out;
+        }
+        if (c != '\\')
+        {
+            out.push_back(c);
+            continue;
+        }
+        if (pos >= text.size())
+        {
+            return std::nullopt;
+        }
+        const char escape = text[pos++];
+        switch (escape)
+        {
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'u':
+            {
+                if (pos + 4 > text.size())
+                {
+                    return std::nullopt;
+                }
+                std::uint32_t code_point = 0;
+                auto [ptr, ec] = std::from_chars(
+                    text.data() + pos, text.data() + pos + 4, code_point, 16);
+                if (ec != std::errc() || ptr != text.data() + pos + 4)
+                {
+                    return std::nullopt;
+                }
+                pos += 4;
+                append_utf8(out, code_point);
+                break;
+            }
+            default: // '"', '\\', '/'
+                out.push_back(escape);
+                break;
+        }
+    }
+    return std::nullopt;
+}
+} // namespace
+
+// --- 解析函数 ---
+
+std::vector<path> importa::deps_log::parse_makefile_deps(
+    std::string_view content)
+{
+    std::vector<path> deps;
+    std::unordered_set<std::string> seen;
+    for (auto& token : tokenize_makefile(content))
+    {
+        // 以 ':' 结尾的词元是规则目标（"C:\foo" 这样的盘符不会出现在词尾）
+        if (token.ends_with(':'))
+        {
+            continue;
+        }
+        if (seen.insert(token).second)
+        {
+            deps.emplace_back(std::move(token));
+        }
+    }
+    return deps;
+}
+
+std::vector<path> importa::deps_log::parse_msvc_source_dependencies(
+    std::string_view content)
+{
+    std::vector<path> deps;
+    std::size_t pos = content.find("\"Includes\"");
+    if (pos == std::string_view::npos)
+    {
+        return deps;
+    }
+    pos = content.find('[', pos);
+    if (pos == std::string_view::npos)
+    {
+        return deps;
+    }
+    ++pos;
+
+    while (true)
+    {
+        skip_whitespace(content, pos);
+        if (pos >= content.size() || content[pos] == ']')
+        {
+            break;
+        }
+        auto include = parse_json_string(content, pos);
+        if (!include)
+        {
+            break;
+        }
+        deps.emplace_back(std::move(*include));
+        skip_whitespace(content, pos);
+        if (pos < content.size() && content[pos] == ',')
+        {
+            ++pos;
+        }
+    }
+    return deps;
+}
+
+// --- DepsLog ---
+
+DepsLog::DepsLog(path log_path) : m_log_path(std::move(log_path))
+{
+    if (m_log_path.has_parent_path())
+    {
+        std::filesystem::create_directories(m_log_path.parent_path());
+    }
+    load();
+
+    if (m_total_deps_records >= kMinRecordsToCompact &&
+        m_total_deps_records > kCompactRatio * m_deps.size())
+    {
+        recompact();
+    }
+    else
+    {
+        open_for_append();
+    }
+}
+
+std::optional<std::vector<path>> DepsLog::get_deps(const path& output) const
+{
+    auto id_it = m_ids.find(key_for(output));
+    if (id_it == m_ids.end())
+    {
+        return std::nullopt;
+    }
+    auto deps_it = m_deps.find(id_it->second);
+    if (deps_it == m_deps.end())
+    {
+        return std::nullopt;
+    }
+
+    std::vector<path> deps;
+    deps.reserve(deps_it->second.size());
+    for (auto id : deps_it->second)
+    {
+        deps.emplace_back(m_paths[id]);
+    }
+    return deps;
+}
+
+void DepsLog::record_deps(const path& output, const std::vector<path>& deps)
+{
+    bool is_new = false;
+    const std::uint32_t output_id = intern(key_for(output), is_new);
+    if (is_new)
+    {
+        write_path_record(m_stream, m_paths[output_id]);
+    }
+
+    std::vector<std::uint32_t> dep_ids;
+    dep_ids.reserve(deps.size());
+    for (const auto& dep : deps)
+    {
+        const std::uint32_t id = intern(key_for(dep), is_new);
+        if (is_new)
+        {
+            write_path_record(m_stream, m_paths[id]);
+        }
+        dep_ids.push_back(id);
+    }
+
+    // 依赖未变化时不追加记录，无操作构建不会让日志增长
+    if (auto it = m_deps.find(output_id);
+        it != m_deps.end() && it->second == dep_ids)
+    {
+        m_stream.flush();
+        return;
+    }
+
+    write_deps_record(m_stream, output_id, dep_ids);
+    m_stream.flush();
+    if (!m_stream)
+    {
+        throw std::runtime_error("DepsLog Error: Failed to append to '" +
+                                 m_log_path.string() + "'.");
+    }
+    m_deps[output_id] = std::move(dep_ids);
+    ++m_total_deps_records;
+}
+
+void DepsLog::recompact()
+{
+    if (m_stream.is_open())
+    {
+        m_stream.close();
+    }
+
+    // 只保留仍被引用的路径，并重新分配连续的 id
+    std::vector<std::string> old_paths = std::move(m_paths);
+    auto old_deps = std::move(m_deps);
+    m_paths.clear();
+    m_ids.clear();
+    m_deps.clear();
+
+    path temp_path = m_log_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(kDepsHeader.data(), kDepsHeader.size());
+
+        bool is_new = false;
+        for (const auto& [old_output_id, old_dep_ids] : old_deps)
+        {
+            const std::uint32_t output_id =
+                intern(old_paths[old_output_id], is_new);
+            if (is_new)
+            {
+                write_path_record(out, m_paths[output_id]);
+            }
+            std::vector<std::uint32_t> dep_ids;
+            dep_ids.reserve(old_dep_ids.size());
+            for (auto old_id : old_dep_ids)
+            {
+                const std::uint32_t id = intern(old_paths[old_id], is_new);
+                if (is_new)
+                {
+                    write_path_record(out, m_paths[id]);
+                }
+                dep_ids.push_back(id);
+            }
+            write_deps_record(out, output_id, dep_ids);
+            m_deps[output_id] = std::move(dep_ids);
+        }
+        out.flush();
+        if (!out)
+        {
+            throw std::runtime_error(
+                "DepsLog Error: Failed to write compacted log '" +
+                temp_path.string() + "'.");
+        }
+    }
+
+    std::filesystem::rename(temp_path, m_log_path);
+    m_total_deps_records = m_deps.size();
+    open_for_append();
+}
+
+std::size_t DepsLog::size() const
+{
+    return m_deps.size();
+}
+
+// --- 私有辅助函数实现 ---
+
+void DepsLog::load()
+{
+    m_paths.clear();
+    m_ids.clear();
+    m_deps.clear();
+    m_total_deps_records = 0;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(m_log_path, ec))
+    {
+        return;
+    }
+
+    std::ifstream in(m_log_path, std::ios::binary);
+    std::vector<char> data{ std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>() };
+    in.close();
+
+    if (data.size() < kDepsHeader.size() ||
+        !std::equal(kDepsHeader.begin(), kDepsHeader.end(), data.begin()))
+    {
+        std::filesystem::remove(m_log_path);
+        return;
+    }
+
+    std::size_t offset = kDepsHeader.size();
+    while (offset + 2 * sizeof(std::uint32_t) <= data.size())
+    {
+        std::uint32_t header;
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        const std::size_t payload_size = header & kMaxPayloadSize;
+        const std::size_t record_size =
+            sizeof(header) + payload_size + sizeof(std::uint32_t);
+        if (offset + record_size > data.size())
+        {
+            break;
+        }
+
+        std::uint32_t checksum;
+        std::memcpy(&checksum,
+                    data.data() + offset + sizeof(header) + payload_size,
+                    sizeof(checksum));
+        if (checksum != compute_checksum(data.data() + offset,
+                                         sizeof(header) + payload_size))
+        {
+            break;
+        }
+
+        const char* payload = data.data() + offset + sizeof(header);
+        if (header & kDepsRecordFlag)
+        {
+            if (payload_size < sizeof(std::uint32_t) ||
+                payload_size % sizeof(std::uint32_t) != 0)
+            {
+                break;
+            }
+            std::vector<std::uint32_t> ids(payload_size /
+                                           sizeof(std::uint32_t));
+            std::memcpy(ids.data(), payload, payload_size);
+            if (std::ranges::any_of(ids, [this](std::uint32_t id)
+                                    { return id >= m_paths.size(); }))
+            {
+                break;
+            }
+            const std::uint32_t output_id = ids.front();
+            ids.erase(ids.begin());
+            m_deps[output_id] = std::move(ids);
+            ++m_total_deps_records;
+        }
+        else
+        {
+            std::string key(payload, payload_size);
+            m_ids.emplace(key, static_cast<std::uint32_t>(m_paths.size()));
+            m_paths.push_back(std::move(key));
+        }
+        offset += record_size;
+    }
+
+    if (offset != data.size())
+    {
+        std::filesystem::resize_file(m_log_path, offset);
+    }
+}
+
+void DepsLog::open_for_append()
+{
+    std::error_code ec;
+    const bool fresh = !std::filesystem::exists(m_log_path, ec) ||
+                       std::filesystem::file_size(m_log_path, ec) == 0;
+
+    m_stream.open(m_log_path, std::ios::binary | std::ios::app);
+    if (!m_stream)
+    {
+        throw std::runtime_error("DepsLog Error: Failed to open '" +
+                                 m_log_path.string() + "'.");
+    }
+    if (fresh)
+    {
+        m_stream.write(kDepsHeader.data(), kDepsHeader.size());
+        m_stream.flush();
+    }
+}
+
+std::uint32_t DepsLog::intern(std::string key, bool& is_new)
+{
+    if (auto it = m_ids.find(key); it != m_ids.end())
+    {
+        is_new = false;
+        return it->second;
+    }
+    is_new = true;
+    const auto id = static_cast<std::uint32_t>(m_paths.size());
+    m_ids.emplace(key, id);
+    m_paths.push_back(std::move(key));
+    return id;
+}
+
+void DepsLog::write_path_record(std::ofstream& out, const std::string& key)
+{
+    write_record(out, static_cast<std::uint32_t>(key.size()), key);
+}
+
+void DepsLog::write_deps_record(std::ofstream& out, std::uint32_t output_id,
+                                const std::vector<std::uint32_t>& dep_ids)
+{
+    std::string payload((dep_ids.size() + 1) * sizeof(std::uint32_t), '\0');
+    std::memcpy(payload.data(), &output_id, sizeof(output_id));
+    if (!dep_ids.empty())
+    {
+        std::memcpy(payload.data() + sizeof(output_id), dep_ids.data(),
+                    dep_ids.size() * sizeof(std::uint32_t));
+    }
+    write_record(out,
+                 kDepsRecordFlag | static_cast<std::uint32_t>(payload.size()),
+                 payload);
+}
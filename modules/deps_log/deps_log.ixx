@@ -0,0 +1,65 @@
+// deps_log.ixx
+//
+// 定义了 DepsLog 类：一个持久化、仅追加的头文件依赖数据库（类似 .ninja_deps）。
+// 路径只在首次出现时以字符串记录一次，此后以 32 位 id 引用，
+// 使数千个动作共享的系统头文件只占用很少的空间。
+// 同时提供了编译器依赖输出（Makefile 依赖文件与 MSVC JSON）的解析函数。
+
+export module deps_log;
+
+import std;
+
+namespace importa
+{
+
+namespace deps_log
+{
+
+using path = std::filesystem::path;
+
+// 解析 clang/gcc -MD 生成的 Makefile 格式依赖文件，返回全部前置条件
+export std::vector<path> parse_makefile_deps(std::string_view content);
+
+// 解析 MSVC /sourceDependencies 生成的 JSON，返回 Data.Includes
+export std::vector<path> parse_msvc_source_dependencies(
+    std::string_view content);
+
+export class DepsLog
+{
+  public:
+    // 打开（或创建）依赖日志，读取已有记录并截断损坏的尾部
+    explicit DepsLog(path log_path);
+    ~DepsLog() = default;
+
+    DepsLog(const DepsLog&) = delete;
+    DepsLog& operator=(const DepsLog&) = delete;
+
+    // 返回上一次构建 output 时记录的头文件依赖；没有记录时返回 nullopt
+    std::optional<std::vector<path>> get_deps(const path& output) const;
+
+    // 记录 output 的头文件依赖并立即刷盘；与已有记录相同时不写入
+    void record_deps(const path& output, const std::vector<path>& deps);
+
+    // 以仅包含最新依赖记录的新文件原子替换当前日志
+    void recompact();
+
+    std::size_t size() const;
+
+  private:
+    path m_log_path;
+    std::vector<std::string> m_paths;                     // id -> 路径
+    std::unordered_map<std::string, std::uint32_t> m_ids; // 路径 -> id
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_deps;
+    std::size_t m_total_deps_records = 0;
+    std::ofstream m_stream;
+
+    void load();
+    void open_for_append();
+    std::uint32_t intern(std::string key, bool& is_new);
+    void write_path_record(std::ofstream& out, const std::string& key);
+    void write_deps_record(std::ofstream& out, std::uint32_t output_id,
+                           const std::vector<std::uint32_t>& dep_ids);
+};
+
+} // namespace deps_log
+} // namespace importa
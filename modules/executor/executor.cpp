@@ -14,8 +14,18 @@ module;
 // #include <vector>
 
 // --- 平台特定头文件 ---
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
 
 module executor;
 
@@ -64,6 +74,7 @@ ExecutionResult DryRunExecutor::execute(const Command& command)
 
 // --- LocalExecutor ---
 
+#if defined(_WIN32)
 namespace
 { // 内部辅助函数
 
@@ -167,3 +178,207 @@ ExecutionResult LocalExecutor::execute(const Command& command)
     result.std_err = std_err;
     return result;
 }
+#else
+namespace
+{ // 内部辅助函数
+
+// 在父进程中按 PATH 解析可执行文件，子进程在 fork 之后只调用异步信号安全的函数
+std::string resolve_executable(const std::filesystem::path& executable)
+{
+    const std::string name = executable.string();
+    if (name.find('/') != std::string::npos)
+    {
+        return name;
+    }
+    const char* path_env = std::getenv("PATH");
+    std::string_view search = path_env ? path_env : "/usr/bin:/bin";
+    while (!search.empty())
+    {
+        auto sep = search.find(':');
+        std::filesystem::path dir(search.substr(0, sep));
+        search = sep == std::string_view::npos ? std::string_view{}
+                                               : search.substr(sep + 1);
+        auto candidate = (dir.empty() ? std::filesystem::path(".") : dir) / name;
+        if (::access(candidate.c_str(), X_OK) == 0)
+        {
+            return candidate.string();
+        }
+    }
+    return name;
+}
+
+void close_pipe(int fds[2])
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (fds[i] >= 0)
+        {
+            ::close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+// 原子地设置 FD_CLOEXEC：其他线程同时 fork 的子进程不会继承写端，
+// 否则读端要等到那个无关的子进程退出才能读到 EOF
+int make_pipe(int fds[2])
+{
+    return ::pipe2(fds, O_CLOEXEC);
+}
+} // namespace
+
+ExecutionResult LocalExecutor::execute(const Command& command)
+{
+    // 所有内存分配都在 fork 之前完成
+    const std::string executable = resolve_executable(command.executable);
+    std::vector<std::string> argv_storage;
+    argv_storage.push_back(command.executable.string());
+    argv_storage.insert(argv_storage.end(), command.arguments.begin(),
+                        command.arguments.end());
+    std::vector<char*> argv;
+    for (auto& arg : argv_storage)
+    {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    std::vector<std::string> env_storage;
+    for (char** env = environ; *env; ++env)
+    {
+        std::string_view entry(*env);
+        auto name = entry.substr(0, entry.find('='));
+        if (!command.environment_variables.contains(std::string(name)))
+        {
+            env_storage.emplace_back(entry);
+        }
+    }
+    for (const auto& [name, value] : command.environment_variables)
+    {
+        env_storage.push_back(name + "=" + value);
+    }
+    std::vector<char*> envp;
+    for (auto& entry : env_storage)
+    {
+        envp.push_back(entry.data());
+    }
+    envp.push_back(nullptr);
+
+    const std::string working_directory = command.working_directory.string();
+
+    int stdout_pipe[2] = { -1, -1 };
+    int stderr_pipe[2] = { -1, -1 };
+    int error_pipe[2] = { -1, -1 }; // 子进程 exec 失败时回传 errno
+    if (make_pipe(stdout_pipe) != 0 || make_pipe(stderr_pipe) != 0 ||
+        make_pipe(error_pipe) != 0)
+    {
+        close_pipe(stdout_pipe);
+        close_pipe(stderr_pipe);
+        close_pipe(error_pipe);
+        throw std::runtime_error(
+            "LocalExecutor Error: Failed to create pipes.");
+    }
+
+    const pid_t pid = ::fork();
+    if (pid < 0)
+    {
+        close_pipe(stdout_pipe);
+        close_pipe(stderr_pipe);
+        close_pipe(error_pipe);
+        throw std::runtime_error("LocalExecutor Error: fork failed. Error "
+                                 "code: " +
+                                 std::to_string(errno));
+    }
+
+    if (pid == 0)
+    {
+        ::dup2(stdout_pipe[1], STDOUT_FILENO);
+        ::dup2(stderr_pipe[1], STDERR_FILENO);
+        if (!working_directory.empty() &&
+            ::chdir(working_directory.c_str()) != 0)
+        {
+            const int err = errno;
+            (void)!::write(error_pipe[1], &err, sizeof(err));
+            ::_exit(127);
+        }
+        ::execve(executable.c_str(), argv.data(), envp.data());
+        const int err = errno;
+        (void)!::write(error_pipe[1], &err, sizeof(err));
+        ::_exit(127);
+    }
+
+    // 关键：父进程必须关闭管道的写入端，否则 read 会一直阻塞
+    ::close(stdout_pipe[1]);
+    ::close(stderr_pipe[1]);
+    ::close(error_pipe[1]);
+
+    int exec_error = 0;
+    const bool exec_failed =
+        ::read(error_pipe[0], &exec_error, sizeof(exec_error)) ==
+        static_cast<ssize_t>(sizeof(exec_error));
+    ::close(error_pipe[0]);
+
+    // 同时读取 stdout 与 stderr，避免任一管道写满导致子进程阻塞
+    std::string std_out;
+    std::string std_err;
+    pollfd fds[2] = { { stdout_pipe[0], POLLIN, 0 },
+                      { stderr_pipe[0], POLLIN, 0 } };
+    std::string* sinks[2] = { &std_out, &std_err };
+    int open_fds = 2;
+    std::array<char, 4096> buffer;
+    while (open_fds > 0)
+    {
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP)))
+            {
+                continue;
+            }
+            const ssize_t n = ::read(fds[i].fd, buffer.data(), buffer.size());
+            if (n > 0)
+            {
+                sinks[i]->append(buffer.data(), static_cast<std::size_t>(n));
+            }
+            else if (n == 0 || errno != EINTR)
+            {
+                ::close(fds[i].fd);
+                fds[i].fd = -1;
+                --open_fds;
+            }
+        }
+    }
+    for (auto& fd : fds)
+    {
+        if (fd.fd >= 0)
+        {
+            ::close(fd.fd);
+        }
+    }
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+
+    if (exec_failed)
+    {
+        throw std::runtime_error(
+            "LocalExecutor Error: Failed to start process. Error code: " +
+            std::to_string(exec_error));
+    }
+
+    ExecutionResult result;
+    result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result.success = (result.exit_code == 0);
+    result.std_out = std::move(std_out);
+    result.std_err = std::move(std_err);
+    return result;
+}
+#endif
@@ -0,0 +1,301 @@
+// file_hash_cache.cpp
+// 提供了 FileHashCache 类的具体实现。
+//
+// 文件格式：8 字节文件头（魔数 + 版本号），随后是若干条定长记录。
+// 缓存文件总是通过“写临时文件 + rename”整体替换，不会出现半写状态。
+
+module;
+
+// --- 平台特定头文件 ---
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+module file_hash_cache;
+
+import std;
+import hashing;
+import thread_pool;
+
+using namespace importa::file_hash_cache;
+
+namespace
+{ // 内部辅助函数与磁盘格式定义
+
+constexpr std::array<char, 8> kCacheHeader = { 'I', 'M', 'P', 'A',
+                                               'H', 'S', 'H', 1 };
+
+// 与当前时间相差不足该值的 mtime 被视为“可能仍在写入”
+constexpr std::int64_t kRacyWindowNs = 2'000'000'000;
+
+struct RawEntry
+{
+    std::uint64_t key;
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t size;
+    std::int64_t mtime_ns;
+    std::uint64_t content_hash;
+};
+static_assert(sizeof(RawEntry) == 48);
+static_assert(std::is_trivially_copyable_v<RawEntry>);
+
+std::uint64_t key_for(const path& file)
+{
+    return importa::hashing::hash_string(
+        file.lexically_normal().generic_string());
+}
+
+std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::optional<std::uint64_t> read_and_hash(const path& file,
+                                           std::uint64_t expected_size)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    std::vector<char> buffer(static_cast<std::size_t>(expected_size));
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.resize(static_cast<std::size_t>(in.gcount()));
+    return importa::hashing::hash_bytes(buffer.data(), buffer.size());
+}
+} // namespace
+
+// --- stat_file ---
+
+#if defined(_WIN32)
+std::optional<FileIdentity> importa::file_hash_cache::stat_file(
+    const path& file)
+{
+    HANDLE handle = CreateFileW(
+        file.c_str(), FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return std::nullopt;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    const BOOL ok = GetFileInformationByHandle(handle, &info);
+    CloseHandle(handle);
+    if (!ok || (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        return std::nullopt;
+    }
+
+    // FILETIME 以 1601-01-01 起的 100 纳秒为单位
+    constexpr std::int64_t kFileTimeToUnixEpoch = 116444736000000000LL;
+    const std::int64_t filetime =
+        (static_cast<std::int64_t>(info.ftLastWriteTime.dwHighDateTime)
+         << 32) |
+        info.ftLastWriteTime.dwLowDateTime;
+
+    FileIdentity identity;
+    identity.device = info.dwVolumeSerialNumber;
+    identity.inode = (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) |
+                     info.nFileIndexLow;
+    identity.size = (static_cast<std::uint64_t>(info.nFileSizeHigh) << 32) |
+                    info.nFileSizeLow;
+    identity.mtime_ns = (filetime - kFileTimeToUnixEpoch) * 100;
+    return identity;
+}
+#else
+std::optional<FileIdentity> importa::file_hash_cache::stat_file(
+    const path& file)
+{
+    struct stat st;
+    if (::stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        return std::nullopt;
+    }
+
+    FileIdentity identity;
+    identity.device = static_cast<std::uint64_t>(st.st_dev);
+    identity.inode = static_cast<std::uint64_t>(st.st_ino);
+    identity.size = static_cast<std::uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    identity.mtime_ns =
+        static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1'000'000'000 +
+        st.st_mtimespec.tv_nsec;
+#else
+    identity.mtime_ns =
+        static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+        st.st_mtim.tv_nsec;
+#endif
+    return identity;
+}
+#endif
+
+std::optional<std::uint64_t> importa::file_hash_cache::hash_file(
+    const path& file)
+{
+    auto identity = stat_file(file);
+    if (!identity)
+    {
+        return std::nullopt;
+    }
+    return read_and_hash(file, identity->size);
+}
+
+// --- FileHashCache ---
+
+FileHashCache::FileHashCache(path db_path, thread_pool::ThreadPool& pool)
+    : m_db_path(std::move(db_path)), m_pool(pool)
+{
+    load();
+}
+
+std::optional<std::uint64_t> FileHashCache::hash(const path& file)
+{
+    auto identity = stat_file(file);
+    if (!identity)
+    {
+        return std::nullopt;
+    }
+
+    const std::uint64_t key = key_for(file);
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_entries.find(key);
+            it != m_entries.end() && it->second.identity == *identity)
+        {
+            return it->second.content_hash;
+        }
+    }
+
+    // 在锁外读取文件内容，多个线程可以同时哈希不同的文件
+    auto content_hash = read_and_hash(file, identity->size);
+    if (!content_hash)
+    {
+        return std::nullopt;
+    }
+    ++m_files_read;
+
+    std::lock_guard lock(m_mutex);
+    m_entries[key] = { .identity = *identity,
+                       .content_hash = *content_hash,
+                       .persistable =
+                           identity->mtime_ns < now_ns() - kRacyWindowNs };
+    m_dirty = true;
+    return content_hash;
+}
+
+void FileHashCache::hash_all(const std::vector<path>& files)
+{
+    thread_pool::parallel_for_each(m_pool, files,
+                                   [this](const path& file) { hash(file); });
+}
+
+std::optional<FileIdentity> FileHashCache::identity(const path& file) const
+{
+    const std::uint64_t key = key_for(file);
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second.identity;
+}
+
+void FileHashCache::save()
+{
+    std::lock_guard lock(m_mutex);
+    if (!m_dirty)
+    {
+        return;
+    }
+
+    if (m_db_path.has_parent_path())
+    {
+        std::filesystem::create_directories(m_db_path.parent_path());
+    }
+
+    // 临时文件名带随机后缀，两个进程同时保存时互不覆盖对方的临时文件
+    path temp_path = m_db_path;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(kCacheHeader.data(), kCacheHeader.size());
+        for (const auto& [key, entry] : m_entries)
+        {
+            if (!entry.persistable)
+            {
+                continue;
+            }
+            RawEntry raw{ .key = key,
+                          .device = entry.identity.device,
+                          .inode = entry.identity.inode,
+                          .size = entry.identity.size,
+                          .mtime_ns = entry.identity.mtime_ns,
+                          .content_hash = entry.content_hash };
+            out.write(reinterpret_cast<const char*>(&raw), sizeof(raw));
+        }
+        out.flush();
+        if (!out)
+        {
+            std::filesystem::remove(temp_path);
+            throw std::runtime_error(
+                "FileHashCache Error: Failed to write '" +
+                temp_path.string() + "'.");
+        }
+    }
+    std::filesystem::rename(temp_path, m_db_path);
+    m_dirty = false;
+}
+
+std::size_t FileHashCache::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+std::size_t FileHashCache::files_read() const
+{
+    return m_files_read;
+}
+
+// --- 私有辅助函数实现 ---
+
+void FileHashCache::load()
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(m_db_path, ec))
+    {
+        return;
+    }
+
+    std::ifstream in(m_db_path, std::ios::binary);
+    std::vector<char> data{ std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>() };
+
+    if (data.size() < kCacheHeader.size() ||
+        !std::equal(kCacheHeader.begin(), kCacheHeader.end(), data.begin()) ||
+        (data.size() - kCacheHeader.size()) % sizeof(RawEntry) != 0)
+    {
+        // 未知格式：忽略，所有文件将被重新哈希
+        return;
+    }
+
+    for (std::size_t offset = kCacheHeader.size(); offset < data.size();
+         offset += sizeof(RawEntry))
+    {
+        RawEntry raw;
+        std::memcpy(&raw, data.data() + offset, sizeof(raw));
+        m_entries[raw.key] = { .identity = { .device = raw.device,
+                                             .inode = raw.inode,
+                                             .size = raw.size,
+                                             .mtime_ns = raw.mtime_ns },
+                               .content_hash = raw.content_hash };
+    }
+}
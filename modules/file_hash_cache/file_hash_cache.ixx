@@ -0,0 +1,87 @@
+// file_hash_cache.ixx
+//
+// 定义了 FileHashCache 类：基于文件内容哈希的脏检测。
+// 每个文件的内容哈希与其 (device, inode, size, mtime) 一同持久化，
+// 只要这组 stat 信息不变，文件就不会被再次读取。
+// 这使得 git checkout 或网络文件系统造成的 mtime 抖动不再触发重建。
+
+export module file_hash_cache;
+
+import std;
+import thread_pool;
+
+namespace importa
+{
+
+namespace file_hash_cache
+{
+
+using path = std::filesystem::path;
+
+// 一次 stat 得到的文件身份信息，mtime 统一为 Unix 纪元起的纳秒数
+export struct FileIdentity
+{
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+// 获取普通文件的身份信息，文件不存在或不是普通文件时返回 nullopt
+export std::optional<FileIdentity> stat_file(const path& file);
+
+// 不经缓存直接读取并哈希文件内容，文件缺失时返回 nullopt
+export std::optional<std::uint64_t> hash_file(const path& file);
+
+export class FileHashCache
+{
+  public:
+    // 从 db_path 加载已有的缓存；哈希任务在 pool 上并行执行
+    FileHashCache(path db_path, thread_pool::ThreadPool& pool);
+    ~FileHashCache() = default;
+
+    FileHashCache(const FileHashCache&) = delete;
+    FileHashCache& operator=(const FileHashCache&) = delete;
+
+    // 返回文件内容的哈希，文件缺失时返回 nullopt。线程安全。
+    std::optional<std::uint64_t> hash(const path& file);
+
+    // 在线程池上并行预热一组文件的哈希
+    void hash_all(const std::vector<path>& files);
+
+    // 最近一次成功哈希该文件时 stat 得到的身份，不访问文件系统；
+    // 从未哈希过时返回 nullopt。线程安全。
+    std::optional<FileIdentity> identity(const path& file) const;
+
+    // 将缓存原子地写回磁盘（仅在有变化时）
+    void save();
+
+    std::size_t size() const;
+
+    // 本进程中实际读取过内容的文件数
+    std::size_t files_read() const;
+
+  private:
+    struct Entry
+    {
+        FileIdentity identity;
+        std::uint64_t content_hash = 0;
+        // mtime 距哈希时刻过近的条目不落盘，以免同一时间粒度内的
+        // 后续修改被误判为未变化
+        bool persistable = true;
+    };
+
+    path m_db_path;
+    thread_pool::ThreadPool& m_pool;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::uint64_t, Entry> m_entries; // 键为规范化路径的哈希
+    std::atomic<std::size_t> m_files_read{ 0 };
+    bool m_dirty = false;
+
+    void load();
+};
+
+} // namespace file_hash_cache
+} // namespace importa
@@ -0,0 +1,343 @@
+// file_watcher.cpp
+// 提供了 FileWatcher 类的具体实现。
+
+module;
+
+// --- 平台特定头文件 ---
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+module file_watcher;
+
+import std;
+import file_hash_cache;
+
+using namespace importa::file_watcher;
+using importa::file_hash_cache::stat_file;
+
+namespace
+{ // 内部辅助函数
+
+// 轮询模式下两次扫描之间的间隔
+constexpr std::chrono::milliseconds kPollInterval{ 100 };
+
+path normalize(const path& file)
+{
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(file, ec);
+    return (ec ? file : absolute).lexically_normal();
+}
+
+void sort_unique(std::vector<path>& files)
+{
+    std::ranges::sort(files);
+    auto [first, last] = std::ranges::unique(files);
+    files.erase(first, last);
+}
+} // namespace
+
+FileWatcher::FileWatcher()
+{
+#if defined(__linux__)
+    m_notify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notify_fd >= 0 && ::pipe2(m_stop_pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        ::close(m_notify_fd);
+        m_notify_fd = -1;
+    }
+    if (m_notify_fd < 0)
+    {
+        std::cerr << "Warning: inotify is unavailable; falling back to "
+                     "polling for file changes.\n";
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if defined(__linux__)
+    if (m_notify_fd >= 0)
+    {
+        ::close(m_notify_fd);
+        ::close(m_stop_pipe[0]);
+        ::close(m_stop_pipe[1]);
+    }
+#endif
+}
+
+void FileWatcher::watch(const path& file)
+{
+    auto normalized = normalize(file);
+    auto key = normalized.generic_string();
+
+    std::lock_guard lock(m_mutex);
+    if (!m_files.emplace(key, normalized).second)
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    if (m_notify_fd >= 0)
+    {
+        // 监视父目录而非文件本身：原子保存会替换 inode，文件级 watch 随之失效
+        const auto dir = normalized.parent_path();
+        const int wd = ::inotify_add_watch(
+            m_notify_fd, dir.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE |
+                IN_DELETE | IN_ATTRIB);
+        if (wd < 0)
+        {
+            std::cerr << "Warning: Cannot watch directory '" << dir.string()
+                      << "'; changes to '" << file.string()
+                      << "' will not be noticed.\n";
+            return;
+        }
+        m_watched_dirs[wd] = dir; // 同一目录重复添加时内核返回相同的 wd
+        return;
+    }
+#endif
+    m_snapshots[key] = stat_file(normalized);
+}
+
+void FileWatcher::clear()
+{
+    std::lock_guard lock(m_mutex);
+#if defined(__linux__)
+    for (const auto& [wd, dir] : m_watched_dirs)
+    {
+        ::inotify_rm_watch(m_notify_fd, wd);
+    }
+#endif
+    m_watched_dirs.clear();
+    m_snapshots.clear();
+    m_files.clear();
+}
+
+std::vector<path> FileWatcher::wait_for_changes(
+    std::chrono::milliseconds quiet_period,
+    std::chrono::milliseconds max_coalesce)
+{
+    auto changed = uses_notifications()
+                       ? wait_notify(quiet_period, max_coalesce)
+                       : wait_poll(quiet_period, max_coalesce);
+    if (m_stop)
+    {
+        return {};
+    }
+    sort_unique(changed);
+    return changed;
+}
+
+std::vector<path> FileWatcher::take_changes()
+{
+    std::vector<path> changed;
+    if (uses_notifications())
+    {
+        drain_events(changed);
+    }
+    else
+    {
+        changed = poll_once();
+    }
+    sort_unique(changed);
+    return changed;
+}
+
+void FileWatcher::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_stop_cv.notify_all();
+#if defined(__linux__)
+    if (m_notify_fd >= 0)
+    {
+        const char byte = 0;
+        (void)!::write(m_stop_pipe[1], &byte, 1);
+    }
+#endif
+}
+
+bool FileWatcher::stopped() const
+{
+    return m_stop;
+}
+
+bool FileWatcher::uses_notifications() const
+{
+    return m_notify_fd >= 0;
+}
+
+std::size_t FileWatcher::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_files.size();
+}
+
+// --- 私有辅助函数实现 ---
+
+std::vector<path> FileWatcher::wait_notify(
+    std::chrono::milliseconds quiet_period,
+    std::chrono::milliseconds max_coalesce)
+{
+    std::vector<path> changed;
+#if defined(__linux__)
+    std::chrono::steady_clock::time_point first_change;
+    while (!m_stop)
+    {
+        // 尚无变化时无限期阻塞；之后每次只等待一个静默期
+        int timeout = -1;
+        if (!changed.empty())
+        {
+            const auto elapsed = std::chrono::duration_cast<
+                std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                           first_change);
+            if (elapsed >= max_coalesce)
+            {
+                break;
+            }
+            timeout = static_cast<int>(
+                std::min(quiet_period, max_coalesce - elapsed).count());
+        }
+
+        pollfd fds[2] = { { m_notify_fd, POLLIN, 0 },
+                          { m_stop_pipe[0], POLLIN, 0 } };
+        const int ready = ::poll(fds, 2, timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (ready == 0 || (fds[1].revents & POLLIN))
+        {
+            break; // 静默期结束或被 stop() 唤醒
+        }
+
+        const bool was_empty = changed.empty();
+        if (drain_events(changed) && was_empty)
+        {
+            first_change = std::chrono::steady_clock::now();
+        }
+    }
+#endif
+    return changed;
+}
+
+bool FileWatcher::drain_events(std::vector<path>& changed)
+{
+    const auto before = changed.size();
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[16 * 1024];
+    std::lock_guard lock(m_mutex);
+    while (true)
+    {
+        const ssize_t length = ::read(m_notify_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            break; // EAGAIN：事件已读完
+        }
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const auto* event =
+                reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // 事件队列溢出：无法得知哪些文件变了，只能全部视为已修改
+                for (const auto& [key, file] : m_files)
+                {
+                    changed.push_back(file);
+                }
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                m_watched_dirs.erase(event->wd);
+                continue;
+            }
+            auto dir = m_watched_dirs.find(event->wd);
+            if (dir == m_watched_dirs.end() || event->len == 0)
+            {
+                continue;
+            }
+            auto file = dir->second / event->name;
+            auto it = m_files.find(file.generic_string());
+            if (it != m_files.end())
+            {
+                changed.push_back(it->second);
+            }
+        }
+    }
+#endif
+    return changed.size() > before;
+}
+
+std::vector<path> FileWatcher::wait_poll(std::chrono::milliseconds quiet_period,
+                                         std::chrono::milliseconds max_coalesce)
+{
+    std::vector<path> changed;
+    std::chrono::steady_clock::time_point first_change;
+    while (!m_stop)
+    {
+        auto interval = kPollInterval;
+        if (!changed.empty())
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - first_change;
+            if (elapsed >= max_coalesce)
+            {
+                break;
+            }
+            interval = quiet_period;
+        }
+        {
+            std::unique_lock lock(m_mutex);
+            if (m_stop_cv.wait_for(lock, interval, [this] { return m_stop.load(); }))
+            {
+                break;
+            }
+        }
+
+        auto found = poll_once();
+        if (found.empty())
+        {
+            if (!changed.empty())
+            {
+                break; // 一个静默期内没有新的变化
+            }
+            continue;
+        }
+        if (changed.empty())
+        {
+            first_change = std::chrono::steady_clock::now();
+        }
+        changed.insert(changed.end(), found.begin(), found.end());
+    }
+    return changed;
+}
+
+std::vector<path> FileWatcher::poll_once()
+{
+    std::vector<path> changed;
+    std::lock_guard lock(m_mutex);
+    for (auto& [key, snapshot] : m_snapshots)
+    {
+        const auto& file = m_files.at(key);
+        auto current = stat_file(file);
+        if (current != snapshot)
+        {
+            snapshot = current;
+            changed.push_back(file);
+        }
+    }
+    return changed;
+}
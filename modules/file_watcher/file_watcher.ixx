@@ -0,0 +1,82 @@
+// file_watcher.ixx
+//
+// 定义了 FileWatcher 类：监视一组文件的修改、创建、删除与重命名。
+// Linux 上基于 inotify（按父目录订阅，以便捕获编辑器“写临时文件再 rename”
+// 的保存方式），其他平台退化为定期 stat 轮询。
+// 一次 git checkout 之类的突发修改会被合并为一批变化返回。
+
+export module file_watcher;
+
+import std;
+import file_hash_cache;
+
+namespace importa
+{
+
+namespace file_watcher
+{
+
+using path = std::filesystem::path;
+using namespace std::chrono_literals;
+
+export class FileWatcher
+{
+  public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // 开始监视 file（可以尚不存在）；重复调用是幂等的
+    void watch(const path& file);
+
+    // 取消对所有文件的监视
+    void clear();
+
+    // 阻塞直到有被监视的文件发生变化。第一个变化到达后，继续收集直到
+    // 连续 quiet_period 内没有新事件，或累计等待超过 max_coalesce。
+    // 调用 stop() 后返回空列表。
+    std::vector<path> wait_for_changes(
+        std::chrono::milliseconds quiet_period = 15ms,
+        std::chrono::milliseconds max_coalesce = 500ms);
+
+    // 不阻塞地取出自上次调用以来积累的变化
+    std::vector<path> take_changes();
+
+    // 唤醒并终止 wait_for_changes，可在任意线程调用
+    void stop();
+
+    bool stopped() const;
+
+    // 是否使用了内核通知（否则为轮询）
+    bool uses_notifications() const;
+
+    std::size_t size() const;
+
+  private:
+    int m_notify_fd = -1;
+    int m_stop_pipe[2] = { -1, -1 };
+    std::atomic<bool> m_stop{ false };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stop_cv; // 轮询模式下用于打断睡眠
+
+    // 规范化路径 -> 原始路径
+    std::unordered_map<std::string, path> m_files;
+    // inotify watch descriptor -> 目录
+    std::unordered_map<int, path> m_watched_dirs;
+    // 轮询模式下每个文件上次观察到的状态
+    std::unordered_map<std::string, std::optional<file_hash_cache::FileIdentity>>
+        m_snapshots;
+
+    std::vector<path> wait_notify(std::chrono::milliseconds quiet_period,
+                                  std::chrono::milliseconds max_coalesce);
+    std::vector<path> wait_poll(std::chrono::milliseconds quiet_period,
+                                std::chrono::milliseconds max_coalesce);
+    bool drain_events(std::vector<path>& changed);
+    std::vector<path> poll_once();
+};
+
+} // namespace file_watcher
+} // namespace importa
@@ -0,0 +1,583 @@
+// gcc_module_mapper.cpp
+// 提供了 ModuleMapper 与 ModuleMapperServer 类的具体实现。
+
+module;
+
+// --- 平台特定头文件 ---
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+module gcc_module_mapper;
+
+import std;
+import module_processor;
+
+using namespace importa::gcc_module_mapper;
+using importa::module_processor::BuildAction;
+
+namespace
+{ // 内部辅助函数
+
+// 单批请求的长度上限，超过即断开连接
+constexpr std::size_t kMaxBlockLength = 1024 * 1024;
+
+bool is_safe_char(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) ||
+           std::string_view("-+_/%.:=,@").find(c) != std::string_view::npos;
+}
+
+int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 一行以 " ;" 结尾表示同一批还有后续请求
+bool continues_batch(std::string_view line)
+{
+    if (line.ends_with('\r'))
+    {
+        line.remove_suffix(1);
+    }
+    return line.ends_with(" ;");
+}
+
+// 缓冲区中第一批完整请求结束处的换行符位置
+std::size_t find_block_end(std::string_view data)
+{
+    std::size_t start = 0;
+    for (auto newline = data.find('\n'); newline != std::string_view::npos;
+         newline = data.find('\n', start))
+    {
+        if (!continues_batch(data.substr(start, newline - start)))
+        {
+            return newline;
+        }
+        start = newline + 1;
+    }
+    return std::string_view::npos;
+}
+
+// 映射器的 CMI 按模块名建立索引
+bool is_cmi(const path& file)
+{
+    return file.extension() == ".gcm";
+}
+
+// 分区 M:P 的 CMI 名为 M-P.gcm（模块名不含 '-'）
+std::string module_name_of(const path& cmi)
+{
+    std::string name = cmi.stem().string();
+    if (auto dash = name.find('-'); dash != std::string::npos)
+    {
+        name[dash] = ':';
+    }
+    return name;
+}
+
+// 构建图中未声明的分区 CMI 写在该编译的主输出旁边
+path undeclared_partition_cmi(const std::string& ident,
+                              const std::string& name)
+{
+    std::string file_name = name;
+    std::ranges::replace(file_name, ':', '-');
+    return path(ident).parent_path() / (file_name + ".gcm");
+}
+
+#if !defined(_WIN32)
+std::optional<sockaddr_un> make_address(const path& socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string native = socket_path.string();
+    if (native.size() >= sizeof(address.sun_path))
+    {
+        return std::nullopt;
+    }
+    std::ranges::copy(native, address.sun_path);
+    return address;
+}
+
+bool write_all(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+#endif
+} // namespace
+
+// --- 单词编码 ---
+
+std::vector<std::string> importa::gcc_module_mapper::split_words(
+    std::string_view line)
+{
+    std::vector<std::string> words;
+    std::size_t i = 0;
+    while (true)
+    {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' ||
+                                   line[i] == '\r'))
+        {
+            ++i;
+        }
+        if (i >= line.size())
+        {
+            return words;
+        }
+
+        std::string word;
+        bool quoted = false;
+        for (; i < line.size(); ++i)
+        {
+            const char c = line[i];
+            if (!quoted && (c == ' ' || c == '\t' || c == '\r'))
+            {
+                break;
+            }
+            if (c == '\'')
+            {
+                quoted = !quoted;
+                continue;
+            }
+            if (!quoted || c != '\\' || i + 1 >= line.size())
+            {
+                word.push_back(c);
+                continue;
+            }
+            const char next = line[++i];
+            if (next == 'n')
+            {
+                word.push_back('\n');
+            }
+            else if (next == 't')
+            {
+                word.push_back('\t');
+            }
+            else if (i + 1 < line.size() && hex_value(next) >= 0 &&
+                     hex_value(line[i + 1]) >= 0)
+            {
+                word.push_back(static_cast<char>(hex_value(next) * 16 +
+                                                 hex_value(line[i + 1])));
+                ++i;
+            }
+            else
+            {
+                word.push_back(next); // 引号与反斜杠
+            }
+        }
+        words.push_back(std::move(word));
+    }
+}
+
+std::string importa::gcc_module_mapper::quote_word(std::string_view word)
+{
+    if (!word.empty() && std::ranges::all_of(word, is_safe_char))
+    {
+        return std::string(word);
+    }
+    constexpr std::string_view kHex = "0123456789abcdef";
+    std::string quoted = "'";
+    for (const char c : word)
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        if (c == '\'' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (c == '\n')
+        {
+            quoted += "\\n";
+        }
+        else if (c == '\t')
+        {
+            quoted += "\\t";
+        }
+        else if (byte < 0x20 || byte == 0x7f)
+        {
+            quoted += '\\';
+            quoted += kHex[byte >> 4];
+            quoted += kHex[byte & 0xf];
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    quoted += '\'';
+    return quoted;
+}
+
+// --- ModuleMapper ---
+
+void ModuleMapper::set_actions(const std::vector<BuildAction>& actions)
+{
+    std::unordered_map<std::string, Compilation> compilations;
+    std::map<std::string, path, std::less<>> modules;
+    for (const auto& action : actions)
+    {
+        Compilation compilation;
+        for (const auto& output : action.outputs)
+        {
+            if (is_cmi(output))
+            {
+                compilation.exports[module_name_of(output)] = output;
+                modules[module_name_of(output)] = output;
+            }
+        }
+        for (const auto& input : action.inputs)
+        {
+            if (is_cmi(input))
+            {
+                compilation.imports[module_name_of(input)] = input;
+            }
+        }
+        if (!compilation.exports.empty() || !compilation.imports.empty())
+        {
+            compilations[action.primary_output.generic_string()] =
+                std::move(compilation);
+        }
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_compilations = std::move(compilations);
+    m_modules = std::move(modules);
+}
+
+std::string ModuleMapper::respond(std::string& ident,
+                                  std::string_view block) const
+{
+    std::shared_lock lock(m_mutex);
+    std::string reply;
+    for (auto line : block | std::views::split('\n'))
+    {
+        std::string_view text(line.begin(), line.end());
+        auto words = split_words(text);
+        if (!words.empty() && words.back() == ";")
+        {
+            words.pop_back();
+        }
+        if (words.empty())
+        {
+            continue;
+        }
+        if (words[0] == "HELLO")
+        {
+            ident = words.size() > 3 ? words[3] : "";
+        }
+        if (!reply.empty())
+        {
+            reply += " ;\n";
+        }
+        reply += answer(ident, words);
+    }
+    reply += '\n';
+    return reply;
+}
+
+std::string ModuleMapper::answer(const std::string& ident,
+                                 const std::vector<std::string>& request) const
+{
+    const std::string& verb = request[0];
+    const std::string name = request.size() > 1 ? request[1] : "";
+    auto error = [](const std::string& message)
+    { return "ERROR " + quote_word(message); };
+    auto pathname = [](const path& file)
+    { return "PATHNAME " + quote_word(file.string()); };
+
+    const auto compilation = m_compilations.find(ident);
+    const Compilation* current =
+        compilation == m_compilations.end() ? nullptr : &compilation->second;
+
+    if (verb == "HELLO")
+    {
+        return "HELLO 1 importa";
+    }
+    if (verb == "MODULE-REPO")
+    {
+        // CMI 路径都直接给出，不需要仓库目录前缀
+        return "PATHNAME ''";
+    }
+    if (verb == "MODULE-EXPORT")
+    {
+        if (current)
+        {
+            if (auto it = current->exports.find(name);
+                it != current->exports.end())
+            {
+                return pathname(it->second);
+            }
+        }
+        if (ident.empty())
+        {
+            return error("no compilation identified for export of '" + name +
+                         "'");
+        }
+        return pathname(undeclared_partition_cmi(ident, name));
+    }
+    if (verb == "MODULE-IMPORT")
+    {
+        if (current)
+        {
+            if (auto it = current->imports.find(name);
+                it != current->imports.end())
+            {
+                return pathname(it->second);
+            }
+        }
+        if (auto it = m_modules.find(name); it != m_modules.end())
+        {
+            return pathname(it->second);
+        }
+        // 与 MODULE-EXPORT 相同的规则：同一模块的各单元位于同一目录
+        if (name.find(':') != std::string::npos && !ident.empty())
+        {
+            return pathname(undeclared_partition_cmi(ident, name));
+        }
+        return error("unknown module '" + name + "'");
+    }
+    if (verb == "MODULE-COMPILED")
+    {
+        return "OK";
+    }
+    if (verb == "INCLUDE-TRANSLATE")
+    {
+        // 不使用头文件单元，#include 保持原样
+        return "BOOL FALSE";
+    }
+    return error("unsupported request '" + verb + "'");
+}
+
+// --- ModuleMapperServer ---
+
+ModuleMapperServer::ModuleMapperServer(path socket_path,
+                                       const ModuleMapper& mapper)
+    : m_socket_path(std::move(socket_path)), m_mapper(mapper)
+{
+}
+
+ModuleMapperServer::~ModuleMapperServer()
+{
+    stop();
+}
+
+std::string ModuleMapperServer::endpoint() const
+{
+    return "=" + m_socket_path.string();
+}
+
+#if !defined(_WIN32)
+bool ModuleMapperServer::start()
+{
+    if (m_running)
+    {
+        return true;
+    }
+    auto address = make_address(m_socket_path);
+    if (!address)
+    {
+        std::cerr << "Error: Socket path '" << m_socket_path.string()
+                  << "' is too long.\n";
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::remove(m_socket_path, ec);
+
+    auto fail = [this](std::string_view what)
+    {
+        std::cerr << "Error: Failed to " << what << " '"
+                  << m_socket_path.string() << "'. Error code: " << errno
+                  << "\n";
+        if (m_listen_fd >= 0)
+        {
+            ::close(m_listen_fd);
+            m_listen_fd = -1;
+        }
+        return false;
+    };
+
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0)
+    {
+        return fail("create a socket for");
+    }
+    if (::bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&*address),
+               sizeof(*address)) != 0)
+    {
+        return fail("bind");
+    }
+    if (::listen(m_listen_fd, SOMAXCONN) != 0)
+    {
+        return fail("listen on");
+    }
+    if (::pipe2(m_stop_pipe, O_CLOEXEC) != 0)
+    {
+        return fail("create the stop pipe for");
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_running = true;
+    }
+    m_accept_thread = std::jthread([this] { accept_loop(); });
+    return true;
+}
+
+void ModuleMapperServer::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+    }
+
+    const char byte = 0;
+    (void)!::write(m_stop_pipe[1], &byte, 1);
+    if (m_accept_thread.joinable())
+    {
+        m_accept_thread.join();
+    }
+    {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_active_clients == 0; });
+    }
+
+    ::close(m_listen_fd);
+    ::close(m_stop_pipe[0]);
+    ::close(m_stop_pipe[1]);
+    m_listen_fd = -1;
+    m_stop_pipe[0] = m_stop_pipe[1] = -1;
+    std::error_code ec;
+    std::filesystem::remove(m_socket_path, ec);
+}
+
+void ModuleMapperServer::accept_loop()
+{
+    while (true)
+    {
+        pollfd fds[2] = { { m_listen_fd, POLLIN, 0 },
+                          { m_stop_pipe[0], POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+        const int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        // 每个编译器进程在整个编译期间保持连接
+        {
+            std::lock_guard lock(m_mutex);
+            ++m_active_clients;
+        }
+        std::thread(
+            [this, fd]
+            {
+                handle_client(fd);
+                std::lock_guard lock(m_mutex);
+                --m_active_clients;
+                m_cv.notify_all();
+            })
+            .detach();
+    }
+}
+
+void ModuleMapperServer::handle_client(int fd)
+{
+    std::string ident;
+    std::string pending;
+    char buffer[4096];
+    while (pending.size() < kMaxBlockLength)
+    {
+        std::size_t end;
+        while ((end = find_block_end(pending)) != std::string::npos)
+        {
+            const std::string reply = m_mapper.respond(
+                ident, std::string_view(pending).substr(0, end));
+            pending.erase(0, end + 1);
+            if (!write_all(fd, reply))
+            {
+                ::close(fd);
+                return;
+            }
+        }
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        pending.append(buffer, static_cast<std::size_t>(n));
+    }
+    ::close(fd);
+}
+#else
+bool ModuleMapperServer::start()
+{
+    std::cerr << "Error: The GCC module mapper server requires Unix domain "
+                 "sockets and is not available on this platform.\n";
+    return false;
+}
+
+void ModuleMapperServer::stop()
+{
+}
+
+void ModuleMapperServer::accept_loop()
+{
+}
+
+void ModuleMapperServer::handle_client(int)
+{
+}
+#endif
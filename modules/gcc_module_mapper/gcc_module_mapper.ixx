@@ -0,0 +1,102 @@
+// gcc_module_mapper.ixx
+//
+// 定义了 GCC 模块映射器协议（libcody）的服务端：GCC 在编译过程中询问
+// 每个 import/export 的 CMI 位置，由 importa 根据内存中的构建图当场回答，
+// 无需为每次编译生成映射文件或在命令行中列出全部依赖。
+//
+// 协议为逐行文本，单词以空格分隔，含特殊字符的单词以单引号括起：
+//   请求  "HELLO 1 GCC <ident>" | "MODULE-REPO" | "MODULE-EXPORT <name>"
+//         | "MODULE-IMPORT <name>" | "MODULE-COMPILED <name>"
+//         | "INCLUDE-TRANSLATE <header>"
+//   应答  "HELLO 1 importa" | "PATHNAME <path>" | "OK" | "BOOL FALSE"
+//         | "ERROR <message>"
+// 客户端可以把多个请求合为一批，除最后一行外每行以 " ;" 结尾，
+// 应答按相同的方式成批返回。
+
+export module gcc_module_mapper;
+
+import std;
+import module_processor;
+
+namespace importa
+{
+
+namespace gcc_module_mapper
+{
+
+using path = std::filesystem::path;
+
+// 按协议切分一行：处理单引号与 \n、\t、\'、\\ 及两位十六进制转义
+export std::vector<std::string> split_words(std::string_view line);
+
+// 按需给单词加引号并转义，使 split_words 能原样还原
+export std::string quote_word(std::string_view word);
+
+// 协议层：以构建图为索引回答请求，不涉及套接字。
+// 一次编译以动作的 primary_output 为 ident（见 GccToolchain）：
+// 其输出中的 .gcm 文件是它导出的模块，输入中的 .gcm 文件是它可以导入的模块，
+// 模块名即文件名去掉扩展名（分区 M:P 的文件名为 M-P.gcm）。
+export class ModuleMapper
+{
+  public:
+    // 替换索引；可以在其他线程正在回答请求时调用
+    void set_actions(const std::vector<module_processor::BuildAction>& actions);
+
+    // 回答一批请求（不含结尾换行），返回的应答以换行结尾。
+    // ident 为连接的状态，由 HELLO 请求设置
+    std::string respond(std::string& ident, std::string_view block) const;
+
+  private:
+    struct Compilation
+    {
+        std::map<std::string, path, std::less<>> exports;
+        std::map<std::string, path, std::less<>> imports;
+    };
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, Compilation> m_compilations;
+    // 整个构建图中产出的 CMI，用于回答未在输入中声明的导入
+    std::map<std::string, path, std::less<>> m_modules;
+
+    std::string answer(const std::string& ident,
+                       const std::vector<std::string>& request) const;
+};
+
+// 在 Unix 域套接字上提供映射器服务，每个编译器连接一个线程
+export class ModuleMapperServer
+{
+  public:
+    ModuleMapperServer(path socket_path, const ModuleMapper& mapper);
+    ~ModuleMapperServer();
+
+    ModuleMapperServer(const ModuleMapperServer&) = delete;
+    ModuleMapperServer& operator=(const ModuleMapperServer&) = delete;
+
+    // 绑定套接字并开始接受连接，失败时返回 false
+    bool start();
+
+    // 停止接受连接，等待进行中的编译器断开，并删除套接字文件
+    void stop();
+
+    // 传给 GccToolchain 的 -fmodule-mapper 端点（"=<socket_path>"）
+    std::string endpoint() const;
+
+  private:
+    path m_socket_path;
+    const ModuleMapper& m_mapper;
+
+    int m_listen_fd = -1;
+    int m_stop_pipe[2] = { -1, -1 };
+    std::jthread m_accept_thread;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_running = false;
+    std::size_t m_active_clients = 0;
+
+    void accept_loop();
+    void handle_client(int fd);
+};
+
+} // namespace gcc_module_mapper
+} // namespace importa
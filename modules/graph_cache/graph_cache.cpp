@@ -0,0 +1,643 @@
+// graph_cache.cpp
+// 提供了构建图缓存的具体实现。
+//
+// 文件格式（本机字节序，各段按 4 字节对齐）：
+//   文件头    魔数与版本号、指纹、其后全部字节的 XXH64 校验和、各段的元素数
+//   动作表    每个动作 14 个 u32（见 ActionField）
+//   编号表    u32 字符串编号；动作中的列表是其中连续的一段
+//   字符串目录 每个字符串一对 u32：在字符串数据中的偏移与长度
+//   字符串数据 所有字符串首尾相接，不含结束符
+
+module;
+
+// --- 平台特定头文件 ---
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+module graph_cache;
+
+import std;
+import hashing;
+import executor;
+import toolchains;
+import module_processor;
+import builder;
+
+using namespace importa::graph_cache;
+using importa::module_processor::BuildAction;
+using importa::toolchains::DependencyFormat;
+
+namespace
+{ // 内部辅助函数与磁盘格式定义
+
+// 末字节为格式版本，记录布局变化时递增，旧文件因此整体失效
+constexpr std::array<char, 8> kGraphMagic = { 'I', 'M', 'P', 'A',
+                                              'G', 'R', 'F', 2 };
+
+struct Header
+{
+    std::array<char, 8> magic;
+    std::uint64_t fingerprint;
+    std::uint64_t checksum;
+    std::uint32_t action_count;
+    std::uint32_t id_count;
+    std::uint32_t string_count;
+    std::uint32_t blob_size;
+};
+static_assert(sizeof(Header) == 40);
+static_assert(std::is_trivially_copyable_v<Header>);
+
+enum ActionField : std::size_t
+{
+    kExecutable,
+    kWorkingDirectory,
+    kArgumentsBegin,
+    kArgumentsCount,
+    kEnvironmentBegin,
+    kEnvironmentCount, // 名称与值的总数
+    kPrimaryOutput,
+    kInputsBegin,
+    kInputsCount,
+    kOutputsBegin,
+    kOutputsCount,
+    kDepfile,
+    kPool,
+    kFlags, // 位 0 restat，位 1 clear_outputs，位 2 interface_fingerprint，
+            // 位 8-15 depfile_format，位 16-31 slots
+    kActionFieldCount
+};
+constexpr std::size_t kActionBytes = kActionFieldCount * 4;
+
+constexpr std::uint32_t kRestatFlag = 1u << 0;
+constexpr std::uint32_t kClearOutputsFlag = 1u << 1;
+constexpr std::uint32_t kInterfaceFingerprintFlag = 1u << 2;
+constexpr unsigned kDepfileFormatShift = 8;
+constexpr unsigned kSlotsShift = 16;
+
+std::uint32_t depfile_format_bits(std::uint32_t flags)
+{
+    return (flags >> kDepfileFormatShift) & 0xff;
+}
+
+// 映射内存只保证页对齐，逐个字段 memcpy 读取，编译后即普通的加载指令
+std::uint32_t load_u32(const std::byte* data, std::size_t index = 0)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data + index * 4, 4);
+    return value;
+}
+
+void append_u32(std::string& out, std::uint32_t value)
+{
+    out.append(reinterpret_cast<const char*>(&value), 4);
+}
+
+// 驻留字符串并记录 BuildAction 中的各个列表
+class GraphWriter
+{
+  public:
+    std::uint32_t intern(std::string_view text)
+    {
+        auto [it, inserted] = m_index.try_emplace(
+            std::string(text), static_cast<std::uint32_t>(m_strings.size()));
+        if (inserted)
+        {
+            m_strings.push_back(&it->first);
+        }
+        return it->second;
+    }
+
+    // 返回 {起始位置, 元素数}
+    template <typename Range, typename Project>
+    std::pair<std::uint32_t, std::uint32_t> list(const Range& items,
+                                                 Project project)
+    {
+        const auto begin = static_cast<std::uint32_t>(m_ids.size());
+        for (const auto& item : items)
+        {
+            m_ids.push_back(intern(project(item)));
+        }
+        return { begin, static_cast<std::uint32_t>(m_ids.size() - begin) };
+    }
+
+    void add(const BuildAction& action)
+    {
+        auto as_string = [](const auto& file)
+        { return file.generic_string(); };
+        auto as_view = [](const std::string& text)
+        { return std::string_view(text); };
+
+        std::array<std::uint32_t, kActionFieldCount> record{};
+        record[kExecutable] = intern(action.command.executable.string());
+        record[kWorkingDirectory] =
+            intern(action.command.working_directory.string());
+        std::tie(record[kArgumentsBegin], record[kArgumentsCount]) =
+            list(action.command.arguments, as_view);
+        record[kEnvironmentBegin] = static_cast<std::uint32_t>(m_ids.size());
+        for (const auto& [name, value] : action.command.environment_variables)
+        {
+            m_ids.push_back(intern(name));
+            m_ids.push_back(intern(value));
+        }
+        record[kEnvironmentCount] = static_cast<std::uint32_t>(
+            m_ids.size() - record[kEnvironmentBegin]);
+        record[kPrimaryOutput] = intern(as_string(action.primary_output));
+        std::tie(record[kInputsBegin], record[kInputsCount]) =
+            list(action.inputs, as_string);
+        std::tie(record[kOutputsBegin], record[kOutputsCount]) =
+            list(action.outputs, as_string);
+        record[kDepfile] = intern(as_string(action.depfile));
+        record[kPool] = intern(action.pool);
+        record[kFlags] =
+            (action.restat ? kRestatFlag : 0) |
+            (action.clear_outputs ? kClearOutputsFlag : 0) |
+            (action.interface_fingerprint ? kInterfaceFingerprintFlag : 0) |
+            (static_cast<std::uint32_t>(action.depfile_format)
+             << kDepfileFormatShift) |
+            (std::clamp<std::uint32_t>(action.slots, 1, 0xffff)
+             << kSlotsShift);
+        m_records.push_back(record);
+    }
+
+    std::string serialize(std::uint64_t fingerprint) const
+    {
+        std::string body;
+        for (const auto& record : m_records)
+        {
+            for (auto field : record)
+            {
+                append_u32(body, field);
+            }
+        }
+        for (auto id : m_ids)
+        {
+            append_u32(body, id);
+        }
+        std::uint32_t offset = 0;
+        for (const auto* text : m_strings)
+        {
+            append_u32(body, offset);
+            append_u32(body, static_cast<std::uint32_t>(text->size()));
+            offset += static_cast<std::uint32_t>(text->size());
+        }
+        for (const auto* text : m_strings)
+        {
+            body += *text;
+        }
+
+        Header header{ .magic = kGraphMagic,
+                       .fingerprint = fingerprint,
+                       .checksum = importa::hashing::hash_bytes(body.data(),
+                                                                body.size()),
+                       .action_count =
+                           static_cast<std::uint32_t>(m_records.size()),
+                       .id_count = static_cast<std::uint32_t>(m_ids.size()),
+                       .string_count =
+                           static_cast<std::uint32_t>(m_strings.size()),
+                       .blob_size = offset };
+        std::string out(reinterpret_cast<const char*>(&header),
+                        sizeof(header));
+        return out + body;
+    }
+
+  private:
+    std::unordered_map<std::string, std::uint32_t> m_index;
+    std::vector<const std::string*> m_strings; // 按编号排列，指向 m_index 的键
+    std::vector<std::uint32_t> m_ids;
+    std::vector<std::array<std::uint32_t, kActionFieldCount>> m_records;
+};
+
+// 只读映射整个文件；空文件或失败时返回空指针
+std::pair<std::shared_ptr<const std::byte>, std::size_t> map_file(
+    const path& file)
+{
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return {};
+    }
+    LARGE_INTEGER size{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+    {
+        mapping =
+            CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(handle);
+    if (!mapping)
+    {
+        return {};
+    }
+    // 视图独立于映射对象句柄存在
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+    {
+        return {};
+    }
+    return { std::shared_ptr<const std::byte>(
+                 static_cast<const std::byte*>(view),
+                 [](const std::byte* data) { UnmapViewOfFile(data); }),
+             static_cast<std::size_t>(size.QuadPart) };
+#else
+    const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return {};
+    }
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                      PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd); // 映射独立于文件描述符存在
+    if (view == MAP_FAILED)
+    {
+        return {};
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    return { std::shared_ptr<const std::byte>(
+                 static_cast<const std::byte*>(view),
+                 [size](const std::byte* data)
+                 { ::munmap(const_cast<std::byte*>(data), size); }),
+             size };
+#endif
+}
+
+void hash_optional_command(std::uint64_t& h,
+                           const std::optional<importa::executor::Command>& cmd)
+{
+    h = importa::hashing::hash_combine(
+        h, cmd ? importa::builder::hash_command(*cmd) : 0);
+}
+} // namespace
+
+// --- 指纹 ---
+
+std::uint64_t importa::graph_cache::manifest_fingerprint(
+    const std::vector<path>& manifests)
+{
+    std::uint64_t h = 0;
+    for (const auto& manifest : manifests)
+    {
+        h = hashing::hash_string(manifest.generic_string(), h);
+        std::ifstream in(manifest, std::ios::binary);
+        if (!in)
+        {
+            h = hashing::hash_combine(h, 0);
+            continue;
+        }
+        const std::string content{ std::istreambuf_iterator<char>(in),
+                                   std::istreambuf_iterator<char>() };
+        h = hashing::hash_combine(
+            h, hashing::hash_bytes(content.data(), content.size()) | 1);
+    }
+    return h;
+}
+
+std::uint64_t importa::graph_cache::toolchain_fingerprint(
+    const toolchains::IToolchain& toolchain)
+{
+    using namespace importa::toolchains;
+    const std::vector<ModuleReference> deps = { { "probe.dep",
+                                                  "probe_dep.ifc" } };
+    std::uint64_t h = 0;
+
+    EmitIFCArgs emit;
+    emit.interface_unit_path = "probe.ixx";
+    emit.output_ifc_path = "probe.ifc";
+    emit.output_obj_path = "probe.ixx.obj";
+    emit.module_dependencies = deps;
+    emit.dependency_file = "probe.ifc.d";
+    hash_optional_command(h, toolchain.generate_emit_ifc_command(emit));
+
+    CompileObjectArgs compile;
+    compile.source_file = "probe.cpp";
+    compile.output_obj_path = "probe.obj";
+    compile.module_dependencies = deps;
+    compile.dependency_file = "probe.obj.d";
+    const auto compile_cmd = toolchain.generate_compile_obj_command(compile);
+    hash_optional_command(h, compile_cmd);
+
+    LinkArgs link;
+    link.object_files = { "probe.obj", "probe.lib" };
+    link.output_target_path = "probe.exe";
+    link.link_libraries = { "probe_system.lib" };
+    hash_optional_command(h, toolchain.generate_link_command(link));
+
+    ArchiveArgs archive;
+    archive.object_files = { "probe.obj" };
+    archive.output_archive_path = "probe.lib";
+    hash_optional_command(h, toolchain.generate_archive_command(archive));
+
+    ScanDepsArgs scan;
+    scan.source_file = "probe.cpp";
+    scan.output_obj_path = "probe.obj";
+    scan.output_scan_path = "probe.ddi";
+    hash_optional_command(h, toolchain.generate_scan_deps_command(scan));
+
+    EmitPchArgs pch;
+    pch.pch.header = "probe.h";
+    pch.pch.pch_path = "probe.pch";
+    pch.stub_source = "probe_pch.cpp";
+    pch.output_obj_path = "probe_pch.obj";
+    hash_optional_command(h, toolchain.generate_emit_pch_command(pch));
+    hash_optional_command(h, toolchain.generate_version_command());
+
+    h = hashing::hash_string(toolchain.get_bmi_path("probe.ifc").string(), h);
+    h = hashing::hash_string(toolchain.archive_file_name("probe").string(), h);
+    h = hashing::hash_combine(
+        h, static_cast<std::uint64_t>(toolchain.dependency_format()));
+    h = hashing::hash_combine(h, (toolchain.emit_ifc_writes_object() ? 1 : 0) |
+                                     (toolchain.pch_emits_object() ? 2 : 0));
+
+    // 同一路径上升级的编译器
+    if (compile_cmd)
+    {
+        std::error_code ec;
+        const auto size =
+            std::filesystem::file_size(compile_cmd->executable, ec);
+        const auto time =
+            std::filesystem::last_write_time(compile_cmd->executable, ec);
+        if (!ec)
+        {
+            h = hashing::hash_combine(h, size);
+            h = hashing::hash_combine(
+                h, static_cast<std::uint64_t>(
+                       time.time_since_epoch().count()));
+        }
+    }
+    return h;
+}
+
+// --- 写入 ---
+
+bool importa::graph_cache::write_graph(const path& file,
+                                       std::uint64_t fingerprint,
+                                       const std::vector<BuildAction>& actions)
+{
+    GraphWriter writer;
+    for (const auto& action : actions)
+    {
+        writer.add(action);
+    }
+    const std::string bytes = writer.serialize(fingerprint);
+
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    // 临时文件名带随机后缀：共用构建目录的两个会话同时保存时，
+    // 不会写入同一个临时文件而把交错的内容改名为 graph.bin
+    path temp = file;
+    temp += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out.flush())
+        {
+            out.close();
+            std::filesystem::remove(temp, ec);
+            std::cerr << "Warning: Cannot write the build graph cache '"
+                      << temp.string() << "'.\n";
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, file, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// --- StringList ---
+
+std::size_t StringList::size() const
+{
+    return m_count;
+}
+
+std::string_view StringList::operator[](std::size_t index) const
+{
+    const std::uint32_t id = load_u32(m_ids, index);
+    return { m_blob + load_u32(m_strings, id * 2),
+             load_u32(m_strings, id * 2 + 1) };
+}
+
+std::vector<std::string> StringList::to_vector() const
+{
+    std::vector<std::string> result;
+    result.reserve(m_count);
+    for (std::size_t i = 0; i < m_count; ++i)
+    {
+        result.emplace_back((*this)[i]);
+    }
+    return result;
+}
+
+// --- MappedGraph ---
+
+std::optional<MappedGraph> MappedGraph::open(const path& file,
+                                             std::uint64_t fingerprint)
+{
+    auto [mapping, size] = map_file(file);
+    if (!mapping || size < sizeof(Header))
+    {
+        return std::nullopt;
+    }
+    Header header;
+    std::memcpy(&header, mapping.get(), sizeof(header));
+    if (header.magic != kGraphMagic || header.fingerprint != fingerprint)
+    {
+        return std::nullopt;
+    }
+
+    MappedGraph graph;
+    graph.m_mapping = std::move(mapping);
+    graph.m_size = size;
+    graph.m_action_count = header.action_count;
+    graph.m_id_count = header.id_count;
+    graph.m_string_count = header.string_count;
+    graph.m_blob_size = header.blob_size;
+    const std::uint64_t expected_size =
+        sizeof(Header) +
+        std::uint64_t{ header.action_count } * kActionBytes +
+        std::uint64_t{ header.id_count } * 4 +
+        std::uint64_t{ header.string_count } * 8 + header.blob_size;
+    if (expected_size != size ||
+        hashing::hash_bytes(graph.m_mapping.get() + sizeof(Header),
+                            size - sizeof(Header)) != header.checksum ||
+        !graph.validate())
+    {
+        std::cerr << "Warning: Ignoring the damaged build graph cache '"
+                  << file.string() << "'.\n";
+        return std::nullopt;
+    }
+    return graph;
+}
+
+std::size_t MappedGraph::size() const
+{
+    return m_action_count;
+}
+
+ActionView MappedGraph::action(std::size_t index) const
+{
+    const std::byte* record = section(0) + index * kActionBytes;
+    auto field = [record](ActionField which)
+    { return load_u32(record, which); };
+    const std::uint32_t flags = field(kFlags);
+    return { .executable = string(field(kExecutable)),
+             .arguments =
+                 list(field(kArgumentsBegin), field(kArgumentsCount)),
+             .working_directory = string(field(kWorkingDirectory)),
+             .environment =
+                 list(field(kEnvironmentBegin), field(kEnvironmentCount)),
+             .primary_output = string(field(kPrimaryOutput)),
+             .inputs = list(field(kInputsBegin), field(kInputsCount)),
+             .outputs = list(field(kOutputsBegin), field(kOutputsCount)),
+             .depfile = string(field(kDepfile)),
+             .depfile_format =
+                 static_cast<DependencyFormat>(depfile_format_bits(flags)),
+             .restat = (flags & kRestatFlag) != 0,
+             .interface_fingerprint =
+                 (flags & kInterfaceFingerprintFlag) != 0,
+             .pool = string(field(kPool)),
+             .slots = flags >> kSlotsShift,
+             .clear_outputs = (flags & kClearOutputsFlag) != 0 };
+}
+
+std::vector<BuildAction> MappedGraph::to_actions() const
+{
+    auto to_paths = [](const StringList& list)
+    {
+        std::vector<path> paths;
+        paths.reserve(list.size());
+        for (std::size_t i = 0; i < list.size(); ++i)
+        {
+            paths.emplace_back(list[i]);
+        }
+        return paths;
+    };
+
+    std::vector<BuildAction> actions;
+    actions.reserve(m_action_count);
+    for (std::size_t i = 0; i < m_action_count; ++i)
+    {
+        const ActionView view = action(i);
+        BuildAction& action = actions.emplace_back();
+        action.command.executable = view.executable;
+        action.command.arguments = view.arguments.to_vector();
+        action.command.working_directory = view.working_directory;
+        for (std::size_t e = 0; e + 1 < view.environment.size(); e += 2)
+        {
+            action.command.environment_variables.emplace(
+                view.environment[e], view.environment[e + 1]);
+        }
+        action.primary_output = view.primary_output;
+        action.inputs = to_paths(view.inputs);
+        action.outputs = to_paths(view.outputs);
+        action.depfile = view.depfile;
+        action.depfile_format = view.depfile_format;
+        action.restat = view.restat;
+        action.interface_fingerprint = view.interface_fingerprint;
+        action.pool = view.pool;
+        action.slots = view.slots;
+        action.clear_outputs = view.clear_outputs;
+    }
+    return actions;
+}
+
+// --- 私有辅助函数实现 ---
+
+// 各段的起始位置由元素数推出，offset 为相对动作表的字节数
+const std::byte* MappedGraph::section(std::size_t offset) const
+{
+    return m_mapping.get() + sizeof(Header) + offset;
+}
+
+bool MappedGraph::validate() const
+{
+    const std::byte* ids = section(m_action_count * kActionBytes);
+    const std::byte* strings = ids + m_id_count * 4;
+    auto valid_list = [this](std::uint64_t begin, std::uint64_t count)
+    { return begin + count <= m_id_count; };
+
+    for (std::size_t i = 0; i < m_action_count; ++i)
+    {
+        const std::byte* record = section(i * kActionBytes);
+        for (auto which : { kExecutable, kWorkingDirectory, kPrimaryOutput,
+                            kDepfile, kPool })
+        {
+            if (load_u32(record, which) >= m_string_count)
+            {
+                return false;
+            }
+        }
+        if (!valid_list(load_u32(record, kArgumentsBegin),
+                        load_u32(record, kArgumentsCount)) ||
+            !valid_list(load_u32(record, kEnvironmentBegin),
+                        load_u32(record, kEnvironmentCount)) ||
+            !valid_list(load_u32(record, kInputsBegin),
+                        load_u32(record, kInputsCount)) ||
+            !valid_list(load_u32(record, kOutputsBegin),
+                        load_u32(record, kOutputsCount)) ||
+            depfile_format_bits(load_u32(record, kFlags)) >
+                static_cast<std::uint32_t>(
+                    DependencyFormat::MsvcSourceDependencies))
+        {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < m_id_count; ++i)
+    {
+        if (load_u32(ids, i) >= m_string_count)
+        {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < m_string_count; ++i)
+    {
+        if (std::uint64_t{ load_u32(strings, i * 2) } +
+                load_u32(strings, i * 2 + 1) >
+            m_blob_size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view MappedGraph::string(std::uint32_t id) const
+{
+    const std::byte* strings =
+        section(m_action_count * kActionBytes + m_id_count * 4);
+    const char* blob =
+        reinterpret_cast<const char*>(strings + m_string_count * 8);
+    return { blob + load_u32(strings, id * 2),
+             load_u32(strings, id * 2 + 1) };
+}
+
+StringList MappedGraph::list(std::uint32_t begin, std::uint32_t count) const
+{
+    StringList result;
+    result.m_ids = section(m_action_count * kActionBytes) + begin * 4;
+    result.m_strings =
+        section(m_action_count * kActionBytes + m_id_count * 4);
+    result.m_blob =
+        reinterpret_cast<const char*>(result.m_strings + m_string_count * 8);
+    result.m_count = count;
+    return result;
+}
@@ -0,0 +1,104 @@
+// graph_cache.ixx
+//
+// 把规划完成的构建图（BuildAction 序列）写成紧凑的二进制文件，下次启动时
+// 以内存映射的方式直接使用，跳过项目加载与 generate_build_plan。
+// 文件中的字符串全部驻留（相同的路径与参数只存一份），记录之间以下标
+// 互相引用，不含指针，因此映射到任意地址都可以直接读取。
+// 缓存以调用者给出的指纹（清单内容、工具链与构建配置）为键，不匹配即失效。
+
+export module graph_cache;
+
+import std;
+import toolchains;
+import module_processor;
+
+namespace importa
+{
+
+namespace graph_cache
+{
+
+using path = std::filesystem::path;
+
+// 清单文件内容的指纹；缺失的文件也参与计算
+export std::uint64_t manifest_fingerprint(const std::vector<path>& manifests);
+
+// 工具链与其构建配置的指纹：用一组固定参数生成各类命令并计算其指纹，
+// 编译器路径、编译与链接选项的任何变化都会改变它；
+// 编译器可执行文件的大小与修改时间（能找到时）也参与计算
+export std::uint64_t toolchain_fingerprint(
+    const toolchains::IToolchain& toolchain);
+
+// 把 actions 写入 file（先写临时文件再 rename），失败时返回 false
+export bool write_graph(const path& file, std::uint64_t fingerprint,
+                        const std::vector<module_processor::BuildAction>&
+                            actions);
+
+// 映射文件中的一组字符串，按下标解码为 string_view（不复制）
+export class StringList
+{
+  public:
+    std::size_t size() const;
+    std::string_view operator[](std::size_t index) const;
+    std::vector<std::string> to_vector() const;
+
+  private:
+    friend class MappedGraph;
+    // 都指向映射内存：字符串编号（u32）、字符串目录与字符串数据
+    const std::byte* m_ids = nullptr;
+    const std::byte* m_strings = nullptr;
+    const char* m_blob = nullptr;
+    std::size_t m_count = 0;
+};
+
+// 一个动作在映射文件中的视图，只在映射（任一 MappedGraph 副本）存在时有效
+export struct ActionView
+{
+    std::string_view executable;
+    StringList arguments;
+    std::string_view working_directory;
+    StringList environment; // 名称与值交替排列
+    std::string_view primary_output;
+    StringList inputs;
+    StringList outputs;
+    std::string_view depfile;
+    toolchains::DependencyFormat depfile_format =
+        toolchains::DependencyFormat::Makefile;
+    bool restat = false;
+    bool interface_fingerprint = false;
+    std::string_view pool;
+    unsigned slots = 1;
+    bool clear_outputs = false;
+};
+
+export class MappedGraph
+{
+  public:
+    // 映射 file；文件缺失、损坏或指纹不符时返回 nullopt。
+    // 打开时一次性校验全部下标，之后的访问不再检查边界
+    static std::optional<MappedGraph> open(const path& file,
+                                           std::uint64_t fingerprint);
+
+    std::size_t size() const; // 动作数
+    ActionView action(std::size_t index) const;
+
+    // 还原为 BuildAction 序列，供 Builder 使用
+    std::vector<module_processor::BuildAction> to_actions() const;
+
+  private:
+    std::shared_ptr<const std::byte> m_mapping; // 释放最后一个副本时解除映射
+    std::size_t m_size = 0;
+    std::size_t m_action_count = 0;
+    std::size_t m_id_count = 0;
+    std::size_t m_string_count = 0;
+    std::size_t m_blob_size = 0;
+
+    MappedGraph() = default;
+    bool validate() const;
+    const std::byte* section(std::size_t offset) const;
+    std::string_view string(std::uint32_t id) const;
+    StringList list(std::uint32_t begin, std::uint32_t count) const;
+};
+
+} // namespace graph_cache
+} // namespace importa
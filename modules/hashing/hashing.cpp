@@ -0,0 +1,123 @@
+// hashing.cpp
+// 提供了 hashing 模块中声明的各个函数的具体实现。
+
+module hashing;
+
+import std;
+
+namespace importa::hashing
+{
+
+namespace
+{ // XXH64 的常量与轮函数
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+std::uint64_t read64(const unsigned char* p)
+{
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t read32(const unsigned char* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint64_t round(std::uint64_t acc, std::uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+std::uint64_t merge_round(std::uint64_t acc, std::uint64_t value)
+{
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+} // namespace
+
+std::uint64_t hash_bytes(const void* data, std::size_t size,
+                         std::uint64_t seed)
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    const unsigned char* const end = p + size;
+    std::uint64_t h;
+
+    if (size >= 32)
+    {
+        std::uint64_t v1 = seed + kPrime1 + kPrime2;
+        std::uint64_t v2 = seed + kPrime2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - kPrime1;
+
+        const unsigned char* const limit = end - 32;
+        do
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+            std::rotl(v4, 18);
+        h = merge_round(h, v1);
+        h = merge_round(h, v2);
+        h = merge_round(h, v3);
+        h = merge_round(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<std::uint64_t>(size);
+
+    while (p + 8 <= end)
+    {
+        h ^= round(0, read64(p));
+        h = std::rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= static_cast<std::uint64_t>(read32(p)) * kPrime1;
+        h = std::rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end)
+    {
+        h ^= static_cast<std::uint64_t>(*p) * kPrime5;
+        h = std::rotl(h, 11) * kPrime1;
+        ++p;
+    }
+
+    // 雪崩混合
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t hash_string(std::string_view text, std::uint64_t seed)
+{
+    return hash_bytes(text.data(), text.size(), seed);
+}
+
+std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value)
+{
+    return hash_bytes(&value, sizeof(value), seed);
+}
+} // namespace importa::hashing
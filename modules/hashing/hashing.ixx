@@ -0,0 +1,27 @@
+// hashing.ixx
+//
+// 提供构建系统内部使用的快速非加密哈希（XXH64 算法）。
+// 用于命令指纹、文件时间戳/内容指纹以及构建日志的键。
+
+export module hashing;
+
+import std;
+
+namespace importa
+{
+
+namespace hashing
+{
+
+// 计算一段内存的 64 位哈希
+export std::uint64_t hash_bytes(const void* data, std::size_t size,
+                                std::uint64_t seed = 0);
+
+// 计算字符串的 64 位哈希
+export std::uint64_t hash_string(std::string_view text, std::uint64_t seed = 0);
+
+// 将一个 64 位值混入已有的哈希种子中，顺序敏感
+export std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value);
+
+} // namespace hashing
+} // namespace importa
@@ -0,0 +1,198 @@
+// load_governor.cpp
+// 提供了 LoadGovernor 类与 PSI 解析函数的具体实现。
+//
+// /proc/pressure/<资源> 的格式（cpu 在较旧的内核上没有 full 行）：
+//   some avg10=1.23 avg60=0.50 avg300=0.10 total=123456
+//   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+
+module load_governor;
+
+import std;
+import thread_pool;
+
+using namespace importa::load_governor;
+
+namespace
+{ // 内部辅助函数
+
+std::optional<std::string> read_text(const path& file)
+{
+    std::ifstream in(file);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+std::optional<double> parse_number(std::string_view text)
+{
+    double value = 0;
+    auto [ptr, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr == text.data())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// 在以 prefix 开头的行中取 avg10 的值
+std::optional<double> find_avg10(std::string_view text,
+                                 std::string_view prefix)
+{
+    for (auto line : text | std::views::split('\n'))
+    {
+        std::string_view row(line.begin(), line.end());
+        if (!row.starts_with(prefix))
+        {
+            continue;
+        }
+        const auto pos = row.find("avg10=");
+        if (pos == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        return parse_number(row.substr(pos + 6));
+    }
+    return std::nullopt;
+}
+} // namespace
+
+namespace importa::load_governor
+{
+
+std::optional<PressureStall> parse_pressure(std::string_view text)
+{
+    auto some = find_avg10(text, "some ");
+    if (!some)
+    {
+        return std::nullopt;
+    }
+    return PressureStall{ .some = *some,
+                          .full = find_avg10(text, "full ").value_or(0) };
+}
+
+std::optional<double> parse_load_average(std::string_view text)
+{
+    return parse_number(text);
+}
+
+std::optional<SystemLoad> read_system_load(const path& proc_root)
+{
+    SystemLoad load;
+    load.cpu_count = std::max(1u, std::thread::hardware_concurrency());
+    auto read_pressure = [&](std::string_view resource)
+    {
+        auto text = read_text(proc_root / "pressure" / resource);
+        return text ? parse_pressure(*text) : std::nullopt;
+    };
+    load.cpu = read_pressure("cpu");
+    load.memory = read_pressure("memory");
+    load.io = read_pressure("io");
+
+    std::optional<double> load_average;
+    if (auto text = read_text(proc_root / "loadavg"))
+    {
+        load_average = parse_load_average(*text);
+    }
+    if (!load.cpu && !load.memory && !load.io && !load_average)
+    {
+        return std::nullopt;
+    }
+    load.load_average = load_average.value_or(0);
+    return load;
+}
+
+} // namespace importa::load_governor
+
+LoadGovernor::LoadGovernor(thread_pool::ThreadPool& pool,
+                           GovernorOptions options)
+    : m_pool(pool), m_options(options),
+      m_max_jobs(options.max_jobs == 0
+                     ? pool.size()
+                     : std::clamp<std::size_t>(options.max_jobs, 1,
+                                               pool.size())),
+      m_limit(m_max_jobs)
+{
+    m_options.min_jobs =
+        std::clamp<std::size_t>(m_options.min_jobs, 1, m_max_jobs);
+    m_pool.set_concurrency_limit(m_max_jobs);
+}
+
+LoadGovernor::~LoadGovernor()
+{
+    // 先停止采样，之后不会再有人修改上限
+    m_sampler = std::jthread();
+    m_pool.set_concurrency_limit(m_pool.size());
+}
+
+std::size_t LoadGovernor::update(const SystemLoad& load)
+{
+    bool overloaded = false;
+    bool relaxed = true;
+    auto check = [&](double value, double limit)
+    {
+        overloaded = overloaded || value > limit;
+        relaxed = relaxed && value < limit / 2;
+    };
+    if (load.cpu)
+    {
+        check(load.cpu->some, m_options.cpu_some_limit);
+    }
+    if (load.memory)
+    {
+        check(load.memory->some, m_options.memory_some_limit);
+    }
+    if (load.io)
+    {
+        check(load.io->some, m_options.io_some_limit);
+    }
+    check(load.load_average / std::max(1u, load.cpu_count),
+          m_options.load_per_cpu_limit);
+
+    // 加性增、乘性减：过载时迅速让出资源，恢复时逐步试探
+    std::size_t limit = m_limit;
+    if (overloaded)
+    {
+        limit -= std::max<std::size_t>(1, limit / 4);
+    }
+    else if (relaxed)
+    {
+        ++limit;
+    }
+    limit = std::clamp(limit, m_options.min_jobs, m_max_jobs);
+    m_limit = limit;
+    m_pool.set_concurrency_limit(limit);
+    return limit;
+}
+
+void LoadGovernor::start(path proc_root)
+{
+    m_sampler = std::jthread(
+        [this, proc_root = std::move(proc_root)](std::stop_token stop)
+        {
+            std::mutex mutex;
+            std::condition_variable_any cv;
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                cv.wait_for(lock, stop, m_options.interval,
+                            [] { return false; });
+                if (stop.stop_requested())
+                {
+                    return;
+                }
+                if (auto load = read_system_load(proc_root))
+                {
+                    update(*load);
+                }
+            }
+        });
+}
+
+std::size_t LoadGovernor::limit() const
+{
+    return m_limit;
+}
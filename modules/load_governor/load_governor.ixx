@@ -0,0 +1,93 @@
+// load_governor.ixx
+//
+// 定义了 LoadGovernor 类：根据 Linux 的压力停顿信息（PSI，
+// /proc/pressure/{cpu,memory,io}）与平均负载，在运行时调整任务池的并发上限。
+// 共享构建机上其他任务占满 CPU、内存或磁盘时减少同时执行的动作，
+// 压力消退后再逐步恢复，避免固定的任务数在高峰期互相拖慢。
+
+export module load_governor;
+
+import std;
+import thread_pool;
+
+namespace importa
+{
+
+namespace load_governor
+{
+
+using path = std::filesystem::path;
+using namespace std::chrono_literals;
+
+// 一种资源的 PSI 统计，取内核给出的 10 秒平均值（百分比）
+export struct PressureStall
+{
+    double some = 0; // 至少一个任务因该资源停顿的时间占比
+    double full = 0; // 全部非空闲任务同时停顿的时间占比
+};
+
+export struct SystemLoad
+{
+    // 内核未启用 PSI 时为空
+    std::optional<PressureStall> cpu;
+    std::optional<PressureStall> memory;
+    std::optional<PressureStall> io;
+    double load_average = 0; // 1 分钟平均负载
+    unsigned cpu_count = 1;
+};
+
+// 解析 /proc/pressure/<资源> 的内容，缺少 "some" 行时返回 nullopt
+export std::optional<PressureStall> parse_pressure(std::string_view text);
+
+// 解析 /proc/loadavg 的内容，返回 1 分钟平均负载
+export std::optional<double> parse_load_average(std::string_view text);
+
+// 读取 proc_root 下的 PSI 与平均负载；两者都读不到（例如非 Linux 系统）时
+// 返回 nullopt
+export std::optional<SystemLoad> read_system_load(
+    const path& proc_root = "/proc");
+
+export struct GovernorOptions
+{
+    std::size_t min_jobs = 1;
+    std::size_t max_jobs = 0; // 0 表示任务池的线程数
+    std::chrono::milliseconds interval = 1s; // 后台采样间隔
+
+    // 任一指标超过其上限即视为过载，并发上限按四分之一递减；
+    // 全部指标低于上限的一半时每次采样加一，介于两者之间时保持不变
+    double cpu_some_limit = 40;
+    double memory_some_limit = 10;
+    double io_some_limit = 20;
+    double load_per_cpu_limit = 1.5;
+};
+
+export class LoadGovernor
+{
+  public:
+    // 构造时把并发上限设为 max_jobs，析构时恢复为任务池的线程数
+    explicit LoadGovernor(thread_pool::ThreadPool& pool,
+                          GovernorOptions options = {});
+    ~LoadGovernor();
+
+    LoadGovernor(const LoadGovernor&) = delete;
+    LoadGovernor& operator=(const LoadGovernor&) = delete;
+
+    // 按一次采样调整任务池的并发上限并返回新值
+    std::size_t update(const SystemLoad& load);
+
+    // 启动后台线程，每个 interval 读取一次 proc_root 下的统计并调用 update；
+    // 读不到统计时保持当前上限
+    void start(path proc_root = "/proc");
+
+    std::size_t limit() const;
+
+  private:
+    thread_pool::ThreadPool& m_pool;
+    GovernorOptions m_options;
+    std::size_t m_max_jobs;
+    std::atomic<std::size_t> m_limit;
+    std::jthread m_sampler;
+};
+
+} // namespace load_governor
+} // namespace importa
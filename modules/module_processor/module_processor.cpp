@@ -8,18 +8,243 @@ module module_processor;
 import std;
 import executor;
 import toolchains;
+import unity_build;
+import precompiled_headers;
 
 using namespace importa::module_processor;
 using namespace importa::executor;
 using namespace importa::toolchains;
 
+namespace
+{ // 项目级规划的内部辅助函数
+
+std::optional<std::vector<const ModuleUnit*>> sort_modules(
+    const Project& project)
+{
+    std::map<std::string, const ModuleUnit*> by_name;
+    for (const auto& unit : project.modules)
+    {
+        by_name[unit.name] = &unit;
+    }
+
+    // Kahn 算法，保持项目中的声明顺序以获得稳定的计划
+    std::vector<const ModuleUnit*> ordered;
+    std::set<std::string> emitted;
+    while (ordered.size() < project.modules.size())
+    {
+        bool progressed = false;
+        for (const auto& unit : project.modules)
+        {
+            if (emitted.contains(unit.name))
+            {
+                continue;
+            }
+            const bool ready = std::ranges::all_of(
+                unit.dependencies,
+                [&](const std::string& dep)
+                { return !by_name.contains(dep) || emitted.contains(dep); });
+            if (ready)
+            {
+                emitted.insert(unit.name);
+                ordered.push_back(&unit);
+                progressed = true;
+            }
+        }
+        if (!progressed)
+        {
+            std::cerr << "Error: Cyclic module dependency in project '"
+                      << project.name << "'.\n";
+            return std::nullopt;
+        }
+    }
+    return ordered;
+}
+
+// 按导入关系对模块的分区排序，被导入的分区排在前面；
+// 返回的 imports 展开为每个分区直接与间接导入的全部分区
+std::optional<std::vector<std::pair<path, ModulePartition>>> sort_partitions(
+    const ModuleUnit& unit)
+{
+    std::vector<std::pair<path, ModulePartition>> pending;
+    std::set<std::string> names;
+    for (const auto& source : unit.partitions)
+    {
+        ModulePartition partition;
+        if (auto it = unit.partition_info.find(source);
+            it != unit.partition_info.end())
+        {
+            partition = it->second;
+        }
+        else
+        {
+            partition.name = source.stem().string();
+            for (const auto& [earlier_source, earlier] : pending)
+            {
+                partition.imports.push_back(earlier.name);
+            }
+        }
+        if (!names.insert(partition.name).second)
+        {
+            std::cerr << "Error: Module '" << unit.name
+                      << "' has more than one partition named '"
+                      << partition.name << "'.\n";
+            return std::nullopt;
+        }
+        pending.emplace_back(source, std::move(partition));
+    }
+
+    std::vector<std::pair<path, ModulePartition>> ordered;
+    std::map<std::string, std::set<std::string>> closures;
+    while (ordered.size() < pending.size())
+    {
+        bool progressed = false;
+        for (const auto& [source, partition] : pending)
+        {
+            if (closures.contains(partition.name))
+            {
+                continue;
+            }
+            for (const auto& imported : partition.imports)
+            {
+                if (!names.contains(imported))
+                {
+                    std::cerr << "Error: Partition '" << unit.name << ":"
+                              << partition.name
+                              << "' imports unknown partition '" << imported
+                              << "'.\n";
+                    return std::nullopt;
+                }
+            }
+            const bool ready = std::ranges::all_of(
+                partition.imports, [&](const std::string& imported)
+                { return closures.contains(imported); });
+            if (!ready)
+            {
+                continue;
+            }
+            std::set<std::string> closure;
+            for (const auto& imported : partition.imports)
+            {
+                closure.insert(imported);
+                closure.insert(closures[imported].begin(),
+                               closures[imported].end());
+            }
+            ModulePartition sorted = partition;
+            sorted.imports.assign(closure.begin(), closure.end());
+            closures[partition.name] = std::move(closure);
+            ordered.emplace_back(source, std::move(sorted));
+            progressed = true;
+        }
+        if (!progressed)
+        {
+            std::cerr << "Error: Cyclic partition imports in module '"
+                      << unit.name << "'.\n";
+            return std::nullopt;
+        }
+    }
+    return ordered;
+}
+
+// 按已排好的顺序为每个模块生成计划
+std::optional<ProjectBuildPlan> plan_sorted_modules(
+    const Project& project, const std::vector<const ModuleUnit*>& ordered,
+    const IToolchain& toolchain, const path& build_dir,
+    std::map<std::string, path> dependency_ifcs, PlanExtensions extensions,
+    const std::vector<path>& external_objects)
+{
+    ProjectBuildPlan plan;
+    for (const ModuleUnit* unit : ordered)
+    {
+        ModuleProcessor processor(*unit, toolchain, build_dir, dependency_ifcs,
+                                  extensions);
+        auto module_plan = processor.generate_build_plan();
+        if (!module_plan)
+        {
+            std::cerr << "Error: Failed to plan module '" << unit->name
+                      << "' of project '" << project.name << "'.\n";
+            return std::nullopt;
+        }
+
+        if (!module_plan->final_ifc_path.empty())
+        {
+            dependency_ifcs[unit->name] = module_plan->final_ifc_path;
+            plan.module_ifcs[unit->name] = module_plan->final_ifc_path;
+        }
+        plan.actions.insert(plan.actions.end(), module_plan->actions.begin(),
+                            module_plan->actions.end());
+        plan.module_order.push_back(unit->name);
+        plan.module_plans.push_back(std::move(*module_plan));
+    }
+    if (extensions.unity)
+    {
+        extensions.unity->save();
+    }
+    if (project.output_executable.empty())
+    {
+        return plan;
+    }
+
+    // 链接：打包为静态库的模块以库代替其目标文件
+    LinkArgs args;
+    args.output_target_path = build_dir / project.output_executable;
+    args.link_libraries = project.link_libraries;
+    // ThinLTO 缓存按配置分开，不同优化选项的代码生成结果互不干扰
+    args.lto_cache_dir = build_dir / "lto_cache";
+    // LTO 在链接时为所有模块生成代码，取各模块覆盖中最高的优化级别
+    for (const ModuleUnit* unit : ordered)
+    {
+        const auto& level = unit->configuration.optimization;
+        if (level && (!args.optimization || *args.optimization < *level))
+        {
+            args.optimization = level;
+        }
+    }
+    for (const auto& module_plan : plan.module_plans)
+    {
+        if (module_plan.static_library.empty())
+        {
+            args.object_files.insert(args.object_files.end(),
+                                     module_plan.generated_obj_paths.begin(),
+                                     module_plan.generated_obj_paths.end());
+        }
+    }
+    args.object_files.insert(args.object_files.end(),
+                             external_objects.begin(), external_objects.end());
+    // GNU ld 与 gold 只从静态库中取出扫描到它时已经未定义的符号：
+    // 库排在全部目标文件之后，且依赖者在前、被依赖的库在后
+    for (const auto& module_plan : plan.module_plans | std::views::reverse)
+    {
+        if (!module_plan.static_library.empty())
+        {
+            args.object_files.push_back(module_plan.static_library);
+        }
+    }
+    auto cmd = toolchain.generate_link_command(args);
+    if (!cmd)
+    {
+        std::cerr << "Error: Failed to generate the link command for '"
+                  << args.output_target_path.string() << "'.\n";
+        return std::nullopt;
+    }
+    plan.actions.push_back({ .command = *cmd,
+                             .primary_output = args.output_target_path,
+                             .inputs = args.object_files,
+                             .outputs = { args.output_target_path },
+                             .pool = "link",
+                             .slots = toolchain.link_jobs() });
+    return plan;
+}
+} // namespace
+
 // --- ModuleProcessor 实现 ---
 
 ModuleProcessor::ModuleProcessor(
     const ModuleUnit& module_to_process, const IToolchain& toolchain,
-    const path& build_dir, const std::map<std::string, path>& dependency_ifcs)
+    const path& build_dir, const std::map<std::string, path>& dependency_ifcs,
+    PlanExtensions extensions)
     : m_module(module_to_process), m_toolchain(toolchain),
-      m_build_dir(build_dir), m_dependency_ifcs(dependency_ifcs)
+      m_build_dir(build_dir), m_dependency_ifcs(dependency_ifcs),
+      m_extensions(extensions)
 {
     m_module_artifact_dir = m_build_dir / m_module.name;
     std::filesystem::create_directories(m_module_artifact_dir);
@@ -38,67 +263,107 @@ std::optional<ModuleBuildPlan> ModuleProcessor::generate_build_plan()
         return std::nullopt;
     }
 
-    // 步骤 2: [A-阶段] 规划分区编译
-    for (const auto& partition_path : m_module.partitions)
+    // 启用合并编译时，多个实现单元可能合并为一个生成的翻译单元
+    const auto units = plan_implementation_units();
+
+    // 为全局模块片段相同的实现单元规划预编译头，其创建动作排在所有使用者之前
+    plan_precompiled_headers(plan, units);
+
+    // 步骤 2: [A-阶段] 规划分区编译。分区与主接口一样产出 BMI，
+    // 被导入的分区排在导入者之前，其 BMI 列入导入者的输入
+    auto partitions = sort_partitions(m_module);
+    if (!partitions)
     {
-        CompileObjectArgs args;
-        args.source_file = partition_path;
+        return std::nullopt;
+    }
+    std::map<std::string, ModuleReference> partition_refs;
+    for (const auto& [partition_path, partition] : *partitions)
+    {
+        EmitIFCArgs args;
+        args.interface_unit_path = partition_path;
+        args.output_ifc_path = m_module_artifact_dir /
+                               (m_module.name + "-" + partition.name + ".ifc");
         args.output_obj_path = get_obj_path_for_source(partition_path);
         args.module_dependencies = *resolved_deps;
-
-        if (auto cmd = m_toolchain.generate_compile_obj_command(args))
+        for (const auto& imported : partition.imports)
         {
-            plan.actions.push_back({ *cmd, args.output_obj_path });
-            // 修正点：在规划的同时，安全地记录产物
-            plan.generated_obj_paths.push_back(args.output_obj_path);
+            args.module_dependencies.push_back(partition_refs.at(imported));
         }
-        else
+        args.internal_partition = !partition.is_interface;
+        args.dependency_file = get_depfile_path(args.output_ifc_path);
+        args.configuration = m_module.configuration;
+
+        if (!plan_interface_unit(plan, args))
         {
-            std::cerr
-                << "Error: Failed to generate compile command for partition '"
-                << partition_path.string() << "'.\n";
             return std::nullopt;
         }
+        partition_refs[partition.name] = {
+            m_module.name + ":" + partition.name, args.output_ifc_path
+        };
     }
 
-    // 步骤 3: [B-阶段] 规划主接口编译
+    // 步骤 3: [B-阶段] 规划主接口编译，它可以导入（并导出）任一分区
     if (!m_module.primary_interface.empty())
     {
         EmitIFCArgs args;
         args.interface_unit_path = m_module.primary_interface;
         args.output_ifc_path = m_module_artifact_dir / (m_module.name + ".ifc");
+        args.output_obj_path = m_module_artifact_dir / (m_module.name + ".obj");
         args.module_dependencies = *resolved_deps;
-
-        plan.final_ifc_path = args.output_ifc_path;
-
-        if (auto cmd = m_toolchain.generate_emit_ifc_command(args))
+        for (const auto& [name, ref] : partition_refs)
         {
-            plan.actions.push_back({ *cmd, args.output_ifc_path });
-
-            // 修正点：安全地记录主接口附带的 .obj 产物
-            path obj_path = get_obj_path_for_source(m_module.primary_interface);
-            plan.generated_obj_paths.push_back(obj_path);
+            args.module_dependencies.push_back(ref);
         }
-        else
+        args.dependency_file = get_depfile_path(args.output_ifc_path);
+        args.configuration = m_module.configuration;
+
+        plan.final_ifc_path = args.output_ifc_path;
+        if (!plan_interface_unit(plan, args))
         {
-            std::cerr << "Error: Failed to generate compile command for "
-                         "primary interface '"
-                      << m_module.primary_interface.string() << "'.\n";
             return std::nullopt;
         }
     }
 
-    // 步骤 4: [C-阶段] 规划实现文件编译
-    for (const auto& impl_path : m_module.implementations)
+    // 步骤 4: [C-阶段] 规划实现文件编译。实现单元隐式导入本模块的主接口，
+    // 也可以导入任一分区；clang 需要为它们逐一给出 BMI
+    std::vector<ModuleReference> impl_dependencies = *resolved_deps;
+    for (const auto& [name, ref] : partition_refs)
+    {
+        impl_dependencies.push_back(ref);
+    }
+    if (!plan.final_ifc_path.empty())
+    {
+        impl_dependencies.push_back({ m_module.name, plan.final_ifc_path });
+    }
+    for (const auto& [impl_path, members] : units)
     {
         CompileObjectArgs args;
         args.source_file = impl_path;
         args.output_obj_path = get_obj_path_for_source(impl_path);
-        args.module_dependencies = *resolved_deps;
+        args.module_dependencies = impl_dependencies;
+        args.dependency_file = get_depfile_path(args.output_obj_path);
+        args.precompiled_header = find_precompiled_header(impl_path);
+        args.configuration = m_module.configuration;
 
         if (auto cmd = m_toolchain.generate_compile_obj_command(args))
         {
-            plan.actions.push_back({ *cmd, args.output_obj_path });
+            auto inputs = collect_inputs(impl_path, args.module_dependencies);
+            // 合并单元的内容取决于每个成员文件
+            for (const auto& member : members)
+            {
+                if (member != impl_path)
+                {
+                    inputs.push_back(member);
+                }
+            }
+            plan.actions.push_back(
+                { .command = *cmd,
+                  .primary_output = args.output_obj_path,
+                  .inputs = std::move(inputs),
+                  .outputs = { args.output_obj_path },
+                  .depfile = args.dependency_file,
+                  .depfile_format = m_toolchain.dependency_format(),
+                  .restat = true });
             // 修正点：在规划的同时，安全地记录产物
             plan.generated_obj_paths.push_back(args.output_obj_path);
         }
@@ -111,11 +376,91 @@ std::optional<ModuleBuildPlan> ModuleProcessor::generate_build_plan()
         }
     }
 
+    // 步骤 5: 按需把模块打包为静态库；各模块的打包动作互不依赖，可以并行
+    if (m_module.static_library && !plan.generated_obj_paths.empty())
+    {
+        ArchiveArgs args;
+        args.object_files = plan.generated_obj_paths;
+        args.output_archive_path = m_module_artifact_dir /
+                                   m_toolchain.archive_file_name(m_module.name);
+        auto cmd = m_toolchain.generate_archive_command(args);
+        if (!cmd)
+        {
+            std::cerr << "Error: The toolchain cannot archive module '"
+                      << m_module.name << "' as a static library.\n";
+            return std::nullopt;
+        }
+        plan.actions.push_back({ .command = *cmd,
+                                 .primary_output = args.output_archive_path,
+                                 .inputs = args.object_files,
+                                 .outputs = { args.output_archive_path },
+                                 .clear_outputs = true });
+        plan.static_library = args.output_archive_path;
+    }
+
     return plan;
 }
 
 // --- 私有辅助函数实现 ---
 
+bool ModuleProcessor::plan_interface_unit(ModuleBuildPlan& plan,
+                                          const EmitIFCArgs& args)
+{
+    const path bmi_path = m_toolchain.get_bmi_path(args.output_ifc_path);
+    const bool writes_object = m_toolchain.emit_ifc_writes_object();
+    auto cmd = m_toolchain.generate_emit_ifc_command(args);
+    if (!cmd)
+    {
+        std::cerr << "Error: Failed to generate compile command for "
+                     "interface unit '"
+                  << args.interface_unit_path.string() << "'.\n";
+        return false;
+    }
+    // 导入者只读取 BMI，目标文件的变化不影响 restat 的截断效果
+    std::vector<path> outputs = { bmi_path };
+    if (writes_object)
+    {
+        outputs.push_back(args.output_obj_path);
+    }
+    plan.actions.push_back(
+        { .command = *cmd,
+          .primary_output = args.output_ifc_path,
+          .inputs = collect_inputs(args.interface_unit_path,
+                                   args.module_dependencies),
+          .outputs = std::move(outputs),
+          .depfile = args.dependency_file,
+          .depfile_format = m_toolchain.dependency_format(),
+          .restat = true,
+          .interface_fingerprint = m_toolchain.writes_reduced_bmi() });
+    plan.generated_obj_paths.push_back(args.output_obj_path);
+    if (writes_object)
+    {
+        return true;
+    }
+
+    // 接口单元中的定义需要由 BMI 另行编译出的目标文件提供
+    CompileObjectArgs obj_args;
+    obj_args.source_file = bmi_path;
+    obj_args.output_obj_path = args.output_obj_path;
+    obj_args.module_dependencies = args.module_dependencies;
+    obj_args.configuration = args.configuration;
+    auto obj_cmd = m_toolchain.generate_compile_obj_command(obj_args);
+    if (!obj_cmd)
+    {
+        std::cerr << "Error: Failed to generate the object command for "
+                     "interface unit '"
+                  << args.interface_unit_path.string() << "'.\n";
+        return false;
+    }
+    plan.actions.push_back(
+        { .command = *obj_cmd,
+          .primary_output = obj_args.output_obj_path,
+          .inputs = collect_inputs(bmi_path, obj_args.module_dependencies),
+          .outputs = { obj_args.output_obj_path },
+          .restat = true });
+    return true;
+}
+
 std::optional<std::vector<ModuleReference>> ModuleProcessor::
     resolve_dependencies() const
 {
@@ -138,9 +483,225 @@ std::optional<std::vector<ModuleReference>> ModuleProcessor::
     return resolved;
 }
 
+std::vector<path> ModuleProcessor::collect_inputs(
+    const path& source_path,
+    const std::vector<ModuleReference>& module_dependencies) const
+{
+    std::vector<path> inputs;
+    inputs.reserve(module_dependencies.size() + 2);
+    inputs.push_back(source_path);
+    for (const auto& dep : module_dependencies)
+    {
+        inputs.push_back(m_toolchain.get_bmi_path(dep.ifc_path));
+    }
+    if (auto pch = find_precompiled_header(source_path))
+    {
+        inputs.push_back(pch->pch_path);
+    }
+    return inputs;
+}
+
+std::vector<std::pair<path, std::vector<path>>> ModuleProcessor::
+    plan_implementation_units() const
+{
+    std::vector<std::pair<path, std::vector<path>>> units;
+    if (m_extensions.unity)
+    {
+        for (auto& batch : m_extensions.unity->plan(m_module.name,
+                                                    m_module.implementations))
+        {
+            units.emplace_back(std::move(batch.source),
+                               std::move(batch.members));
+        }
+        return units;
+    }
+    for (const auto& impl_path : m_module.implementations)
+    {
+        units.push_back({ impl_path, { impl_path } });
+    }
+    return units;
+}
+
+void ModuleProcessor::plan_precompiled_headers(
+    ModuleBuildPlan& plan,
+    const std::vector<std::pair<path, std::vector<path>>>& units)
+{
+    m_precompiled_headers.clear();
+    if (!m_extensions.pch)
+    {
+        return;
+    }
+
+    // 只有实现单元使用预编译头：PCH 按普通 C++ 创建，与接口单元的编译
+    // 选项不一致，而且注入的内容会出现在接口单元的全局模块片段之前
+    std::vector<path> sources;
+    for (const auto& [source, members] : units)
+    {
+        sources.push_back(source);
+    }
+
+    for (const auto& group : m_extensions.pch->plan(m_module.name, sources))
+    {
+        EmitPchArgs args;
+        args.pch.header = group.header;
+        args.pch.pch_path = m_module_artifact_dir /
+                            group.header.filename().replace_extension(".pch");
+        args.stub_source = group.stub_source;
+        args.output_obj_path = get_obj_path_for_source(group.stub_source);
+        args.dependency_file = get_depfile_path(args.pch.pch_path);
+        args.configuration = m_module.configuration;
+
+        auto cmd = m_toolchain.generate_emit_pch_command(args);
+        if (!cmd)
+        {
+            // 工具链不支持预编译头时照常编译，只是没有加速
+            return;
+        }
+        BuildAction action{ .command = *cmd,
+                            .primary_output = args.pch.pch_path,
+                            .inputs = { group.header, group.stub_source },
+                            .outputs = { args.pch.pch_path },
+                            .depfile = args.dependency_file,
+                            .depfile_format =
+                                m_toolchain.dependency_format() };
+        if (m_toolchain.pch_emits_object())
+        {
+            action.outputs.push_back(args.output_obj_path);
+            plan.generated_obj_paths.push_back(args.output_obj_path);
+        }
+        plan.actions.push_back(std::move(action));
+
+        for (const auto& member : group.members)
+        {
+            m_precompiled_headers[member] = args.pch;
+        }
+    }
+}
+
+std::optional<PrecompiledHeader> ModuleProcessor::find_precompiled_header(
+    const path& source_path) const
+{
+    auto it = m_precompiled_headers.find(source_path);
+    if (it == m_precompiled_headers.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+path ModuleProcessor::get_depfile_path(const path& output_path) const
+{
+    // 依赖文件与产物同目录，扩展名表明其格式
+    path depfile = output_path;
+    depfile += m_toolchain.dependency_format() ==
+                       DependencyFormat::MsvcSourceDependencies
+                   ? ".json"
+                   : ".d";
+    return depfile;
+}
+
 path ModuleProcessor::get_obj_path_for_source(const path& source_path) const
 {
     // 将源文件的文件名（带后缀）替换扩展名为 .obj，并放入此模块的专属产物目录
     return m_module_artifact_dir /
            source_path.filename().replace_extension(".obj");
 }
+
+// --- ProjectProcessor 实现 ---
+
+ProjectProcessor::ProjectProcessor(const Project& project,
+                                   const IToolchain& toolchain, path build_dir,
+                                   std::map<std::string, path> external_ifcs,
+                                   PlanExtensions extensions,
+                                   std::vector<path> external_objects)
+    : m_project(project), m_toolchain(toolchain),
+      m_build_dir(std::move(build_dir)),
+      m_external_ifcs(std::move(external_ifcs)), m_extensions(extensions),
+      m_external_objects(std::move(external_objects))
+{
+}
+
+std::optional<ProjectBuildPlan> ProjectProcessor::generate_build_plan()
+{
+    auto ordered = sort_modules(m_project);
+    if (!ordered)
+    {
+        return std::nullopt;
+    }
+    return plan_sorted_modules(m_project, *ordered, m_toolchain, m_build_dir,
+                               m_external_ifcs, m_extensions,
+                               m_external_objects);
+}
+
+// --- MultiConfigProcessor 实现 ---
+
+MultiConfigProcessor::MultiConfigProcessor(const Project& project,
+                                           path build_dir)
+    : m_project(project), m_build_dir(std::move(build_dir))
+{
+}
+
+std::optional<MultiConfigBuildPlan> MultiConfigProcessor::generate_build_plan(
+    const std::vector<ConfigurationTarget>& configurations)
+{
+    auto ordered = sort_modules(m_project);
+    if (!ordered)
+    {
+        return std::nullopt;
+    }
+
+    std::set<std::string> names;
+    for (const auto& config : configurations)
+    {
+        if (config.name.empty() || !config.toolchain ||
+            !names.insert(config.name).second)
+        {
+            std::cerr << "Error: Configuration '" << config.name
+                      << "' of project '" << m_project.name
+                      << "' needs a unique name and a toolchain.\n";
+            return std::nullopt;
+        }
+    }
+
+    MultiConfigBuildPlan plan;
+    std::vector<const ProjectBuildPlan*> config_plans;
+    for (const auto& config : configurations)
+    {
+        auto config_plan = plan_sorted_modules(
+            m_project, *ordered, *config.toolchain, m_build_dir / config.name,
+            config.external_ifcs, config.extensions, config.external_objects);
+        if (!config_plan)
+        {
+            std::cerr << "Error: Failed to plan configuration '"
+                      << config.name << "'.\n";
+            return std::nullopt;
+        }
+        auto [it, inserted] =
+            plan.plans.emplace(config.name, std::move(*config_plan));
+        config_plans.push_back(&it->second);
+    }
+
+    // 配置之间没有依赖，按模块交错合并：各配置齐头并进，
+    // 而不是先跑完一个配置再在其尾部留下空闲的任务槽
+    std::vector<std::size_t> module_actions(config_plans.size(), 0);
+    for (std::size_t i = 0; i < ordered->size(); ++i)
+    {
+        for (std::size_t c = 0; c < config_plans.size(); ++c)
+        {
+            const auto& actions = config_plans[c]->module_plans[i].actions;
+            plan.actions.insert(plan.actions.end(), actions.begin(),
+                                actions.end());
+            module_actions[c] += actions.size();
+        }
+    }
+    // 模块之后的链接动作
+    for (std::size_t c = 0; c < config_plans.size(); ++c)
+    {
+        const auto& actions = config_plans[c]->actions;
+        plan.actions.insert(plan.actions.end(),
+                            actions.begin() +
+                                static_cast<std::ptrdiff_t>(module_actions[c]),
+                            actions.end());
+    }
+    return plan;
+}
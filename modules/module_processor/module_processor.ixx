@@ -9,6 +9,8 @@ export module module_processor;
 import std;
 import executor;
 import toolchains;
+import unity_build;
+import precompiled_headers;
 
 using path = std::filesystem::path;
 using namespace importa::executor;
@@ -21,13 +23,31 @@ namespace module_processor
 {
 
 // --- 项目模型定义 ---
+
+// 分区单元的描述，通常由依赖扫描填写
+export struct ModulePartition
+{
+    std::string name; // 不含模块名的分区名，例如 "M:P" 中的 "P"
+    bool is_interface = true; // false 表示 "module M:P;" 实现分区
+    std::vector<std::string> imports; // 导入的本模块分区名
+};
+
 export struct ModuleUnit
 {
     std::string name;
     path primary_interface;
     std::vector<path> partitions;
+    // 分区源文件 -> 分区描述。缺少描述的分区以文件名主干为分区名，
+    // 并保守地视为导入 partitions 中排在它之前的全部分区
+    std::map<path, ModulePartition> partition_info;
     std::vector<path> implementations;
     std::vector<std::string> dependencies;
+
+    // 为 true 时把本模块的目标文件打包为静态库，链接时以库代替这些目标文件
+    bool static_library = false;
+
+    // 本模块全部编译动作（含预编译头）使用的配置覆盖，默认沿用工具链配置
+    toolchains::ConfigurationOverride configuration;
 };
 
 export struct Project
@@ -36,7 +56,7 @@ export struct Project
     path root_directory;
     std::vector<ModuleUnit> modules;
 
-    path output_executable;
+    path output_executable; // 为空时不规划链接；相对路径相对于构建目录
     std::string main_module_name;
     std::vector<std::string> link_libraries;
 };
@@ -46,6 +66,34 @@ export struct BuildAction
 {
     executor::Command command;
     path primary_output;
+
+    // 增量构建所需的输入/输出清单：输入包含源文件与所引用的 BMI，
+    // 输出包含 primary_output 在内的全部产物
+    std::vector<path> inputs;
+    std::vector<path> outputs;
+
+    // 编译器写出的头文件依赖（为空表示不追踪），执行后由 Builder 解析入库
+    path depfile;
+    DependencyFormat depfile_format = DependencyFormat::Makefile;
+
+    // 类似 ninja 的 restat：重新执行后若输出内容未变，下游动作保持干净。
+    // 用于产出 BMI 的动作，只改函数体的接口编辑不会级联到所有导入者；
+    // 也用于产出目标文件的动作，重新编译出相同的目标文件时不会重新链接。
+    bool restat = false;
+
+    // 输出按接口指纹（见 bmi_fingerprint）而非内容判断是否变化，用于写出
+    // 精简 BMI 的动作：只改实现细节的编辑不会使导入者失效。
+    // 非 BMI 的输出（例如同时写出的目标文件）仍按内容判断
+    bool interface_fingerprint = false;
+
+    // 具名任务池（例如 "link"），用于限制内存密集型动作的并发数；为空表示默认池
+    std::string pool;
+
+    // 动作同时占用的任务槽数，例如并行运行多个 LTO 后端的链接
+    unsigned slots = 1;
+
+    // 执行前删除已有的输出，用于只会在旧输出上增量更新的工具（例如 ar r）
+    bool clear_outputs = false;
 };
 
 /**
@@ -59,6 +107,28 @@ export struct ModuleBuildPlan
 
     // --- 修改点：将此成员加回来 ---
     std::vector<path> generated_obj_paths; // 最终生成的所有 .obj 文件路径
+    path static_library; // 非空时本模块以此静态库参与链接
+};
+
+/**
+ * @struct ProjectBuildPlan
+ * @brief 整个项目的构建计划：按依赖顺序排列的各模块计划及其展开后的动作序列。
+ */
+export struct ProjectBuildPlan
+{
+    std::vector<ModuleBuildPlan> module_plans; // 与 module_order 一一对应
+    std::vector<std::string> module_order;     // 拓扑序的模块名
+    std::vector<BuildAction> actions;          // 全部动作，顺序满足依赖关系
+    std::map<std::string, path> module_ifcs;   // 模块名 -> IFC 路径
+};
+
+// 可选的规划扩展，所指对象由调用方持有
+export struct PlanExtensions
+{
+    // 非空时，实现单元按其划分的批次合并编译
+    unity_build::UnityPlanner* unity = nullptr;
+    // 非空时，全局模块片段相同的单元共享一个预编译头
+    precompiled_headers::PchPlanner* pch = nullptr;
 };
 
 // --- 模块处理器 ---
@@ -67,7 +137,8 @@ export class ModuleProcessor
   public:
     ModuleProcessor(const ModuleUnit& module_to_process,
                     const IToolchain& toolchain, const path& build_dir,
-                    const std::map<std::string, path>& dependency_ifcs);
+                    const std::map<std::string, path>& dependency_ifcs,
+                    PlanExtensions extensions = {});
 
     std::optional<ModuleBuildPlan> generate_build_plan();
 
@@ -76,10 +147,86 @@ export class ModuleProcessor
     const IToolchain& m_toolchain;
     const path& m_build_dir;
     const std::map<std::string, path>& m_dependency_ifcs;
+    PlanExtensions m_extensions;
     path m_module_artifact_dir;
+    std::map<path, PrecompiledHeader> m_precompiled_headers; // 源文件 -> PCH
 
     std::optional<std::vector<ModuleReference>> resolve_dependencies() const;
     path get_obj_path_for_source(const path& source_path) const;
+    path get_depfile_path(const path& output_path) const;
+    std::vector<path> collect_inputs(
+        const path& source_path,
+        const std::vector<ModuleReference>& module_dependencies) const;
+
+    // 规划产出 BMI 的接口单元（主接口或分区）及其目标文件
+    bool plan_interface_unit(ModuleBuildPlan& plan, const EmitIFCArgs& args);
+
+    // 实际编译的实现单元及其包含的原始源文件
+    std::vector<std::pair<path, std::vector<path>>> plan_implementation_units()
+        const;
+    void plan_precompiled_headers(
+        ModuleBuildPlan& plan,
+        const std::vector<std::pair<path, std::vector<path>>>& units);
+    std::optional<PrecompiledHeader> find_precompiled_header(
+        const path& source_path) const;
+};
+
+// --- 项目处理器 ---
+// 按依赖关系对项目中的模块排序，并依次调用 ModuleProcessor 生成完整计划
+export class ProjectProcessor
+{
+  public:
+    // external_ifcs 提供项目之外已构建好的模块（例如 std），
+    // external_objects 为它们需要参与链接的目标文件
+    ProjectProcessor(const Project& project, const IToolchain& toolchain,
+                     path build_dir,
+                     std::map<std::string, path> external_ifcs = {},
+                     PlanExtensions extensions = {},
+                     std::vector<path> external_objects = {});
+
+    std::optional<ProjectBuildPlan> generate_build_plan();
+
+  private:
+    const Project& m_project;
+    const IToolchain& m_toolchain;
+    path m_build_dir;
+    std::map<std::string, path> m_external_ifcs;
+    PlanExtensions m_extensions;
+    std::vector<path> m_external_objects;
+};
+
+// --- 多配置构建 ---
+
+// 同一次调用中构建的一个配置，其 BuildConfiguration 由 toolchain 携带
+export struct ConfigurationTarget
+{
+    std::string name; // 例如 "Debug"，同时是构建目录下的子目录名
+    const IToolchain* toolchain = nullptr;
+    std::map<std::string, path> external_ifcs; // 按该配置构建的外部模块
+    std::vector<path> external_objects;
+    PlanExtensions extensions;
+};
+
+export struct MultiConfigBuildPlan
+{
+    std::map<std::string, ProjectBuildPlan> plans; // 配置名 -> 计划
+    // 全部配置的动作，顺序满足依赖关系；交给一次 Builder::build，
+    // 所有配置共用同一组任务槽
+    std::vector<BuildAction> actions;
+};
+
+// 一次调用构建多个配置：模块图只排序一次，每个配置在 build_dir/<name> 下规划
+export class MultiConfigProcessor
+{
+  public:
+    MultiConfigProcessor(const Project& project, path build_dir);
+
+    std::optional<MultiConfigBuildPlan> generate_build_plan(
+        const std::vector<ConfigurationTarget>& configurations);
+
+  private:
+    const Project& m_project;
+    path m_build_dir;
 };
 
 } // namespace ModuleProcessor
@@ -0,0 +1,552 @@
+// ninja_generator.cpp
+// 提供了 NinjaGenerator 类与 dyndep 汇总函数的具体实现。
+//
+// 映射文件为制表符分隔的文本，由生成阶段写出、汇总边读取：
+//   module <模块名> <BMI 路径>
+//   scan   <边的显式输出> <扫描结果文件>
+
+module ninja_generator;
+
+import std;
+import executor;
+import toolchains;
+import hashing;
+import module_processor;
+import dependency_scanner;
+
+using namespace importa::ninja_generator;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using importa::dependency_scanner::ScanResult;
+
+namespace
+{ // 内部辅助函数
+
+constexpr std::string_view kActionRule = "importa_action";
+constexpr std::string_view kScanRule = "importa_scan";
+constexpr std::string_view kCollateRule = "importa_collate";
+
+std::string to_hex(std::uint64_t value)
+{
+    std::array<char, 16> buffer;
+    auto [ptr, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16);
+    return std::string(buffer.data(), ptr);
+}
+
+// 转义变量值：只有 '$' 有特殊含义，换行会截断变量
+std::string escape_value(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        if (c == '$')
+        {
+            escaped += "$$";
+        }
+        else if (c == '\n')
+        {
+            escaped += ' ';
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string posix_quote(std::string_view arg)
+{
+    const bool plain =
+        !arg.empty() &&
+        std::ranges::all_of(arg,
+                            [](char c)
+                            {
+                                return std::isalnum(
+                                           static_cast<unsigned char>(c)) ||
+                                       std::string_view("_./=:,+-@%").find(c) !=
+                                           std::string_view::npos;
+                            });
+    if (plain)
+    {
+        return std::string(arg);
+    }
+    std::string quoted = "'";
+    for (char c : arg)
+    {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+// 按 CommandLineToArgvW 的规则引用：含空白或引号的参数整体加引号，
+// 内部引号写作 \"，紧邻引号（包括结尾的引号）的反斜杠加倍
+std::string windows_quote(std::string_view arg)
+{
+    if (!arg.empty() && arg.find_first_of(" \t\"") == std::string_view::npos)
+    {
+        return std::string(arg);
+    }
+    std::string quoted = "\"";
+    std::size_t backslashes = 0;
+    for (char c : arg)
+    {
+        if (c == '\\')
+        {
+            ++backslashes;
+            continue;
+        }
+        quoted.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+        backslashes = 0;
+        quoted += c;
+    }
+    quoted.append(backslashes * 2, '\\');
+    return quoted + "\"";
+}
+
+std::string shell_quote(std::string_view arg, NinjaShell shell)
+{
+    return shell == NinjaShell::Posix ? posix_quote(arg) : windows_quote(arg);
+}
+
+// 边的显式输出：dyndep 文件以它来指代这条边
+path edge_output(const BuildAction& action)
+{
+    return action.outputs.empty() ? action.primary_output
+                                  : action.outputs.front();
+}
+
+std::string join_paths(const std::vector<path>& paths)
+{
+    std::string joined;
+    for (const auto& file : paths)
+    {
+        joined += ' ';
+        joined += escape_ninja_path(file.string());
+    }
+    return joined;
+}
+
+std::optional<std::string> read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+// 内容不变时不改写文件，ninja 据此判断清单或 dyndep 是否需要重新加载
+void write_if_changed(const path& file, const std::string& content)
+{
+    if (read_file(file) == content)
+    {
+        return;
+    }
+    std::filesystem::create_directories(file.parent_path());
+    path temp_path = file;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out << content;
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write '" + temp_path.string() +
+                                     "'.");
+        }
+    }
+    std::filesystem::rename(temp_path, file);
+}
+
+std::vector<std::string> split_tabs(std::string_view line)
+{
+    std::vector<std::string> fields;
+    while (true)
+    {
+        auto tab = line.find('\t');
+        fields.emplace_back(line.substr(0, tab));
+        if (tab == std::string_view::npos)
+        {
+            return fields;
+        }
+        line.remove_prefix(tab + 1);
+    }
+}
+} // namespace
+
+// --- 自由函数 ---
+
+std::string importa::ninja_generator::escape_ninja_path(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        if (c == '$' || c == ' ' || c == ':')
+        {
+            escaped += '$';
+        }
+        escaped += c == '\n' ? ' ' : c;
+    }
+    return escaped;
+}
+
+std::string importa::ninja_generator::to_shell_command(const Command& command,
+                                                       NinjaShell shell)
+{
+    if (shell == NinjaShell::Windows)
+    {
+        std::string line = "\"" + command.executable.string() + "\"";
+        for (const auto& arg : command.arguments)
+        {
+            line += " " + windows_quote(arg);
+        }
+        if (command.working_directory.empty() &&
+            command.environment_variables.empty())
+        {
+            return line;
+        }
+        // 只有 cmd 能切换目录与设置环境变量
+        std::string prefix;
+        if (!command.working_directory.empty())
+        {
+            prefix += "cd /d \"" + command.working_directory.string() + "\" && ";
+        }
+        for (const auto& [name, value] : command.environment_variables)
+        {
+            prefix += "set \"" + name + "=" + value + "\" && ";
+        }
+        return "cmd /c \"" + prefix + line + "\"";
+    }
+
+    std::string line;
+    if (!command.working_directory.empty())
+    {
+        line += "cd " + posix_quote(command.working_directory.string()) + " && ";
+    }
+    if (!command.environment_variables.empty())
+    {
+        line += "env";
+        for (const auto& [name, value] : command.environment_variables)
+        {
+            line += " " + posix_quote(name + "=" + value);
+        }
+        line += ' ';
+    }
+    line += posix_quote(command.executable.string());
+    for (const auto& arg : command.arguments)
+    {
+        line += ' ';
+        line += posix_quote(arg);
+    }
+    return line;
+}
+
+std::string importa::ninja_generator::format_dyndep(
+    const std::vector<std::pair<path, ScanResult>>& edges,
+    const std::map<std::string, path>& module_bmis)
+{
+    std::string out = "ninja_dyndep_version = 1\n";
+    for (const auto& [output, result] : edges)
+    {
+        out += "build " + escape_ninja_path(output.string()) + ": dyndep";
+        std::vector<path> imported;
+        for (const auto& name : result.required_modules)
+        {
+            if (auto it = module_bmis.find(name); it != module_bmis.end())
+            {
+                imported.push_back(it->second);
+            }
+        }
+        if (!imported.empty())
+        {
+            out += " |" + join_paths(imported);
+        }
+        out += '\n';
+        if (!result.provided_module.empty())
+        {
+            out += "  restat = 1\n";
+        }
+    }
+    return out;
+}
+
+bool importa::ninja_generator::collate_dyndep(const path& map_file,
+                                              const path& dyndep_file)
+{
+    auto map = read_file(map_file);
+    if (!map)
+    {
+        std::cerr << "Error: Cannot read module map '" << map_file.string()
+                  << "'.\n";
+        return false;
+    }
+
+    std::map<std::string, path> module_bmis;
+    std::vector<std::pair<path, ScanResult>> edges;
+    std::istringstream lines(*map);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        auto fields = split_tabs(line);
+        if (fields.size() != 3)
+        {
+            continue;
+        }
+        if (fields[0] == "module")
+        {
+            module_bmis[fields[1]] = fields[2];
+            continue;
+        }
+        if (fields[0] != "scan")
+        {
+            continue;
+        }
+        auto p1689 = read_file(fields[2]);
+        auto result =
+            p1689 ? dependency_scanner::parse_p1689(*p1689) : std::nullopt;
+        if (!result)
+        {
+            std::cerr << "Error: Could not parse P1689 output '" << fields[2]
+                      << "'.\n";
+            return false;
+        }
+        edges.emplace_back(fields[1], std::move(*result));
+    }
+
+    write_if_changed(dyndep_file, format_dyndep(edges, module_bmis));
+    return true;
+}
+
+// --- NinjaGenerator ---
+
+NinjaGenerator::NinjaGenerator(const IToolchain& toolchain, path build_dir,
+                               NinjaOptions options)
+    : m_toolchain(toolchain), m_build_dir(std::move(build_dir)),
+      m_options(std::move(options))
+{
+}
+
+void NinjaGenerator::write(const ProjectBuildPlan& plan,
+                           std::ostream& out) const
+{
+    const NinjaShell shell = m_options.shell;
+    out << "# Generated by importa. Do not edit.\n"
+        << "ninja_required_version = 1.10\n"
+        << "builddir = " << escape_value(m_build_dir.string()) << "\n\n";
+
+    // 任务池：console 为 ninja 内置
+    std::set<std::string> pools;
+    for (const auto& action : plan.actions)
+    {
+        if (!action.pool.empty() && action.pool != "console")
+        {
+            pools.insert(action.pool);
+        }
+    }
+    for (const auto& pool : pools)
+    {
+        auto it = m_options.pool_depths.find(pool);
+        out << "pool " << pool << "\n  depth = "
+            << (it == m_options.pool_depths.end() ? 1 : it->second) << "\n\n";
+    }
+
+    out << "rule " << kActionRule << "\n  command = $cmd\n"
+        << "  description = $desc\n\n";
+
+    // dyndep 模式：每个源文件一条扫描边，再由一条汇总边写出 dyndep 文件
+    std::set<const BuildAction*> dyndep_edges;
+    if (!m_options.collator_command.empty())
+    {
+        std::vector<std::string> scan_edges;
+        std::vector<path> scan_files;
+        for (const auto* action : scannable_actions(plan))
+        {
+            const path scan_file = scan_file_for(*action);
+            auto cmd = scan_command(*action, scan_file);
+            if (!cmd)
+            {
+                std::cerr << "Warning: The toolchain cannot scan '"
+                          << action->inputs.front().string()
+                          << "'; falling back to static module ordering.\n";
+                scan_edges.clear();
+                dyndep_edges.clear();
+                break;
+            }
+            scan_edges.push_back(
+                "build " + escape_ninja_path(scan_file.string()) + ": " +
+                std::string(kScanRule) + " " +
+                escape_ninja_path(action->inputs.front().string()) +
+                "\n  cmd = " + escape_value(*cmd) + "\n\n");
+            scan_files.push_back(scan_file);
+            dyndep_edges.insert(action);
+        }
+
+        if (!dyndep_edges.empty())
+        {
+            std::string collator;
+            for (const auto& arg : m_options.collator_command)
+            {
+                collator += shell_quote(arg, shell) + " ";
+            }
+            out << "rule " << kScanRule
+                << "\n  command = $cmd\n  description = SCAN $in\n\n"
+                << "rule " << kCollateRule << "\n  command = "
+                << escape_value(collator) << "$map $out\n"
+                << "  description = COLLATE $out\n  restat = 1\n\n";
+            for (const auto& edge : scan_edges)
+            {
+                out << edge;
+            }
+            out << "build " << escape_ninja_path(dyndep_file().string())
+                << ": " << kCollateRule << join_paths(scan_files) << " | "
+                << escape_ninja_path(map_file().string()) << "\n  map = "
+                << escape_value(shell_quote(map_file().string(), shell))
+                << "\n\n";
+        }
+    }
+
+    for (const auto& action : plan.actions)
+    {
+        const std::vector<path> outputs =
+            action.outputs.empty() ? std::vector{ action.primary_output }
+                                   : action.outputs;
+        const bool dyndep = dyndep_edges.contains(&action);
+
+        out << "build" << join_paths(outputs) << ": " << kActionRule
+            << join_paths(action.inputs);
+        if (dyndep)
+        {
+            out << " || " << escape_ninja_path(dyndep_file().string());
+        }
+        out << "\n  cmd = " << escape_value(to_shell_command(action.command, shell))
+            << "\n  desc = BUILD " << escape_value(edge_output(action).string())
+            << "\n";
+        if (action.restat)
+        {
+            out << "  restat = 1\n";
+        }
+        // ninja 只理解 Makefile 格式的依赖文件；MSVC 的 JSON 依赖由 importa 自己的
+        // Builder 处理，在 ninja 下不追踪头文件
+        if (!action.depfile.empty() &&
+            action.depfile_format == DependencyFormat::Makefile)
+        {
+            out << "  depfile = " << escape_value(action.depfile.string())
+                << "\n  deps = gcc\n";
+        }
+        if (dyndep)
+        {
+            out << "  dyndep = " << escape_value(dyndep_file().string())
+                << "\n";
+        }
+        if (!action.pool.empty())
+        {
+            out << "  pool = " << action.pool << "\n";
+        }
+        out << "\n";
+    }
+}
+
+path NinjaGenerator::write_files(const ProjectBuildPlan& plan) const
+{
+    std::ostringstream manifest;
+    write(plan, manifest);
+    if (!m_options.collator_command.empty())
+    {
+        write_if_changed(map_file(), map_file_content(plan));
+    }
+    const path manifest_path = m_build_dir / "build.ninja";
+    write_if_changed(manifest_path, manifest.str());
+    return manifest_path;
+}
+
+// --- 私有辅助函数实现 ---
+
+path NinjaGenerator::dyndep_file() const
+{
+    return m_build_dir / "modules.dd";
+}
+
+path NinjaGenerator::map_file() const
+{
+    return m_build_dir / "modules.map";
+}
+
+std::string NinjaGenerator::map_file_content(const ProjectBuildPlan& plan) const
+{
+    std::string content;
+    for (const auto& [name, ifc] : plan.module_ifcs)
+    {
+        content += "module\t" + name + "\t" +
+                   m_toolchain.get_bmi_path(ifc).string() + "\n";
+    }
+    for (const auto* action : scannable_actions(plan))
+    {
+        content += "scan\t" + edge_output(*action).string() + "\t" +
+                   scan_file_for(*action).string() + "\n";
+    }
+    return content;
+}
+
+std::optional<std::string> NinjaGenerator::scan_command(
+    const BuildAction& action, const path& scan_file) const
+{
+    ScanDepsArgs args;
+    args.source_file = action.inputs.front();
+    args.output_obj_path = edge_output(action);
+    args.output_scan_path = scan_file;
+    auto cmd = m_toolchain.generate_scan_deps_command(args);
+    if (!cmd)
+    {
+        return std::nullopt;
+    }
+
+    auto line = to_shell_command(*cmd, m_options.shell);
+    // clang-scan-deps 把结果写到标准输出，MSVC 则写到 /scanDependencies 指定的文件
+    if (std::ranges::find(cmd->arguments, scan_file.string()) ==
+        cmd->arguments.end())
+    {
+        line += " > " + shell_quote(scan_file.string(), m_options.shell);
+    }
+    return line;
+}
+
+path NinjaGenerator::scan_file_for(const BuildAction& action) const
+{
+    const path& source = action.inputs.front();
+    return m_build_dir / "dyndep" /
+           (source.filename().string() + "." +
+            to_hex(importa::hashing::hash_string(
+                source.lexically_normal().generic_string())) +
+            ".ddi");
+}
+
+std::vector<const BuildAction*> NinjaGenerator::scannable_actions(
+    const ProjectBuildPlan& plan) const
+{
+    // 第一个输入由其他动作产出的（例如链接）不是编译动作
+    std::set<std::string> produced;
+    for (const auto& action : plan.actions)
+    {
+        for (const auto& output : action.outputs)
+        {
+            produced.insert(output.lexically_normal().generic_string());
+        }
+    }
+    std::vector<const BuildAction*> actions;
+    for (const auto& action : plan.actions)
+    {
+        if (action.pool.empty() && !action.inputs.empty() &&
+            !produced.contains(
+                action.inputs.front().lexically_normal().generic_string()))
+        {
+            actions.push_back(&action);
+        }
+    }
+    return actions;
+}
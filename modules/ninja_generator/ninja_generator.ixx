@@ -0,0 +1,98 @@
+// ninja_generator.ixx
+//
+// 定义了 NinjaGenerator 类：把项目构建计划序列化为 build.ninja，
+// 交由 ninja 调度执行（并行、restat、任务池与 CI 中的缓存包装器）。
+// 每个 BuildAction 对应一条边；可选的 dyndep 模式为每个源文件生成 P1689
+// 扫描边，并由汇总边写出 dyndep 文件，使 import 的增删无需重新生成 build.ninja。
+
+export module ninja_generator;
+
+import std;
+import executor;
+import toolchains;
+import module_processor;
+import dependency_scanner;
+
+namespace importa
+{
+
+namespace ninja_generator
+{
+
+using path = std::filesystem::path;
+
+// ninja 用来执行命令的外壳：POSIX 上为 /bin/sh，Windows 上直接 CreateProcess
+export enum class NinjaShell
+{
+    Posix,
+    Windows
+};
+
+export struct NinjaOptions
+{
+#if defined(_WIN32)
+    NinjaShell shell = NinjaShell::Windows;
+#else
+    NinjaShell shell = NinjaShell::Posix;
+#endif
+
+    // 具名任务池的并发上限，例如 {"link", 2}；动作通过 BuildAction::pool 引用。
+    // 计划中出现但未在此列出的任务池深度为 1。
+    std::map<std::string, int> pool_depths;
+
+    // 非空时启用 dyndep 模式。汇总边执行 "<collator_command...> <映射文件> <dyndep
+    // 文件>"，该程序应调用 collate_dyndep；为空时只依赖计划中静态的 BMI 输入。
+    std::vector<std::string> collator_command;
+};
+
+// 转义 build 行中的路径（'$'、' '、':'）
+export std::string escape_ninja_path(std::string_view text);
+
+// 将命令转为指定外壳下的一行命令（尚未做 ninja 的 '$' 转义）
+export std::string to_shell_command(const executor::Command& command,
+                                    NinjaShell shell);
+
+// 由 (边的显式输出, 扫描结果) 生成 dyndep 文件内容。
+// module_bmis 为模块名到 BMI 路径的映射，其中没有的模块（例如预构建的 std）被忽略。
+export std::string format_dyndep(
+    const std::vector<std::pair<path, dependency_scanner::ScanResult>>& edges,
+    const std::map<std::string, path>& module_bmis);
+
+// 汇总边的实现：读取生成阶段写出的映射文件与其中列出的扫描结果，
+// 写出 dyndep 文件（内容不变时不改写，以配合 restat）
+export bool collate_dyndep(const path& map_file, const path& dyndep_file);
+
+export class NinjaGenerator
+{
+  public:
+    NinjaGenerator(const toolchains::IToolchain& toolchain, path build_dir,
+                   NinjaOptions options = {});
+
+    // 将 plan 写为 ninja 清单。路径按计划中的原样写出，
+    // 因此 ninja 须在生成计划时的工作目录下以 -f 指定清单运行。
+    void write(const module_processor::ProjectBuildPlan& plan,
+               std::ostream& out) const;
+
+    // 写出 build_dir/build.ninja（dyndep 模式下还有映射文件），
+    // 内容未变时保留原文件。返回清单路径。
+    path write_files(const module_processor::ProjectBuildPlan& plan) const;
+
+  private:
+    const toolchains::IToolchain& m_toolchain;
+    path m_build_dir;
+    NinjaOptions m_options;
+
+    path dyndep_file() const;
+    path map_file() const;
+    std::string map_file_content(
+        const module_processor::ProjectBuildPlan& plan) const;
+    std::optional<std::string> scan_command(
+        const module_processor::BuildAction& action,
+        const path& scan_file) const;
+    path scan_file_for(const module_processor::BuildAction& action) const;
+    std::vector<const module_processor::BuildAction*> scannable_actions(
+        const module_processor::ProjectBuildPlan& plan) const;
+};
+
+} // namespace ninja_generator
+} // namespace importa
@@ -0,0 +1,214 @@
+// precompiled_headers.cpp
+// 提供了全局模块片段预编译头规划的具体实现。
+
+module precompiled_headers;
+
+import std;
+import hashing;
+
+using namespace importa::precompiled_headers;
+
+namespace
+{ // 内部辅助函数
+
+const std::regex kModuleKeyword(R"(^\s*(export\s+)?module(\s|;|$))");
+const std::regex kQuotedInclude(R"re(^(\s*#\s*include\s*)"([^"]+)"(.*)$)re");
+
+std::string to_hex(std::uint64_t value)
+{
+    std::array<char, 16> buffer;
+    auto [ptr, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16);
+    return std::string(buffer.data(), ptr);
+}
+
+std::string_view trim(std::string_view line)
+{
+    const auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto last = line.find_last_not_of(" \t\r");
+    return line.substr(first, last - first + 1);
+}
+
+std::optional<std::string> read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+// 生成的头文件位于构建目录，"..." 包含改写为相对源文件所在目录的绝对路径
+std::string rewrite_includes(const std::string& fragment, const path& source)
+{
+    std::error_code ec;
+    const path dir = std::filesystem::absolute(source, ec).parent_path();
+    std::istringstream in(fragment);
+    std::string rewritten;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::smatch m;
+        if (std::regex_match(line, m, kQuotedInclude) &&
+            std::filesystem::exists(dir / m[2].str(), ec))
+        {
+            const path header = (dir / m[2].str()).lexically_normal();
+            line = m[1].str() + "\"" + header.generic_string() + "\"" +
+                   m[3].str();
+        }
+        rewritten += line;
+        rewritten += '\n';
+    }
+    return rewritten;
+}
+
+// 内容不变时不改写，预编译头保持干净
+void write_if_changed(const path& file, const std::string& content)
+{
+    if (read_file(file) == content)
+    {
+        return;
+    }
+    std::filesystem::create_directories(file.parent_path());
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out << content;
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write precompiled header source '" +
+                                 file.string() + "'.");
+    }
+}
+} // namespace
+
+// --- extract_global_fragment ---
+
+std::optional<std::string> importa::precompiled_headers::
+    extract_global_fragment(std::string_view text)
+{
+    std::istringstream in{ std::string(text) };
+    std::string line;
+    bool in_fragment = false;
+    bool continuation = false; // 上一行以反斜杠结尾
+    bool has_include = false;
+    std::string fragment;
+    while (std::getline(in, line))
+    {
+        const auto trimmed = trim(line);
+        if (!in_fragment)
+        {
+            if (trimmed.empty() || trimmed.starts_with("//"))
+            {
+                continue;
+            }
+            if (trimmed != "module;")
+            {
+                return std::nullopt;
+            }
+            in_fragment = true;
+            continue;
+        }
+
+        if (!continuation)
+        {
+            if (trimmed.empty() || trimmed.starts_with("//") ||
+                trimmed.starts_with("#line"))
+            {
+                continue;
+            }
+            if (std::regex_search(line, kModuleKeyword))
+            {
+                if (!has_include)
+                {
+                    return std::nullopt;
+                }
+                return fragment;
+            }
+            if (!trimmed.starts_with("#"))
+            {
+                return std::nullopt; // 片段中只允许预处理指令
+            }
+            has_include = has_include ||
+                          trim(trimmed.substr(1)).starts_with("include");
+        }
+        fragment += trimmed;
+        fragment += '\n';
+        continuation = trimmed.ends_with('\\');
+    }
+    return std::nullopt; // 没有模块声明
+}
+
+// --- PchPlanner ---
+
+PchPlanner::PchPlanner(path build_dir, PchOptions options)
+    : m_build_dir(std::move(build_dir)), m_options(options)
+{
+}
+
+std::vector<PchGroup> PchPlanner::plan(const std::string& module_name,
+                                       const std::vector<path>& sources) const
+{
+    // 片段文本（包含路径已规范化）-> 使用它的源文件
+    std::map<std::string, std::vector<path>> by_fragment;
+    for (const auto& source : sources)
+    {
+        auto text = read_file(source);
+        if (!text)
+        {
+            continue;
+        }
+        if (auto fragment = extract_global_fragment(*text))
+        {
+            by_fragment[rewrite_includes(*fragment, source)].push_back(source);
+        }
+    }
+
+    // 使用绝对路径：工具链要求 PCH 创建与使用时头文件名的写法一致
+    std::error_code ec;
+    const path pch_dir =
+        std::filesystem::absolute(m_build_dir / module_name / "pch", ec)
+            .lexically_normal();
+    std::vector<PchGroup> groups;
+    std::set<path> written;
+    for (auto& [fragment, members] : by_fragment)
+    {
+        if (members.size() < std::max<std::size_t>(m_options.min_units, 1))
+        {
+            continue;
+        }
+        const std::string stem =
+            "gmf_" + to_hex(importa::hashing::hash_string(fragment));
+        PchGroup group{ .header = pch_dir / (stem + ".h"),
+                        .stub_source = pch_dir / (stem + ".cpp"),
+                        .members = std::move(members) };
+
+        write_if_changed(group.header,
+                         "// Generated by importa (precompiled global module "
+                         "fragment). Do not edit.\n" +
+                             fragment);
+        write_if_changed(group.stub_source,
+                         "#include \"" + group.header.string() + "\"\n");
+        written.insert(group.header);
+        written.insert(group.stub_source);
+        groups.push_back(std::move(group));
+    }
+
+    // 删除不再使用的片段头文件；对应的 PCH 产物随之失去引用
+    for (const auto& entry : std::filesystem::directory_iterator(pch_dir, ec))
+    {
+        const auto name = entry.path().filename().string();
+        const auto extension = entry.path().extension();
+        if (name.starts_with("gmf_") &&
+            (extension == ".h" || extension == ".cpp") &&
+            !written.contains(entry.path()))
+        {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+    return groups;
+}
@@ -0,0 +1,54 @@
+// precompiled_headers.ixx
+//
+// 定义了 PchPlanner 类：为全局模块片段生成预编译头。
+// 同一模块中全局模块片段完全相同的多个实现单元（例如都以 <windows.h> 开头）
+// 共享一个预编译头：片段内容被写入生成的头文件，预编译一次后注入各单元的编译命令，
+// 源文件中原有的 #include 因头文件的包含保护而不再重复解析。
+
+export module precompiled_headers;
+
+import std;
+
+namespace importa
+{
+
+namespace precompiled_headers
+{
+
+using path = std::filesystem::path;
+
+export struct PchOptions
+{
+    // 至少有这么多个单元共享同一片段时才生成预编译头
+    std::size_t min_units = 2;
+};
+
+// 提取全局模块片段。片段只能由预处理指令组成（#line 被忽略），
+// 且至少包含一个 #include；否则返回 nullopt。
+export std::optional<std::string> extract_global_fragment(std::string_view text);
+
+// 共享同一全局模块片段的一组编译单元
+export struct PchGroup
+{
+    path header;         // 生成的头文件（绝对路径），内容为片段本身
+    path stub_source;    // 只包含 header 的源文件，供需要源文件创建 PCH 的工具链使用
+    std::vector<path> members;
+};
+
+export class PchPlanner
+{
+  public:
+    // 生成的文件写在 build_dir/<模块名>/pch/ 下
+    explicit PchPlanner(path build_dir, PchOptions options = {});
+
+    // 按全局模块片段对模块的编译单元分组，写出（内容变化的）头文件
+    std::vector<PchGroup> plan(const std::string& module_name,
+                               const std::vector<path>& sources) const;
+
+  private:
+    path m_build_dir;
+    PchOptions m_options;
+};
+
+} // namespace precompiled_headers
+} // namespace importa
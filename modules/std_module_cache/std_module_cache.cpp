@@ -0,0 +1,275 @@
+// std_module_cache.cpp
+// 提供了 StdModuleCache 类的具体实现。
+//
+// 每个缓存条目存放一个模块的 BMI 与目标文件，发布与并发读取的约定见 artifact_cache。
+
+module std_module_cache;
+
+import std;
+import executor;
+import hashing;
+import toolchains;
+import artifact_cache;
+
+using namespace importa::std_module_cache;
+using namespace importa::executor;
+using namespace importa::toolchains;
+
+namespace
+{ // 内部辅助函数
+
+std::string to_hex(std::uint64_t value)
+{
+    std::array<char, 16> buffer;
+    auto [ptr, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16);
+    return std::string(buffer.data(), ptr);
+}
+
+std::optional<std::string> read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+path env_path(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value && *value ? path(value) : path();
+}
+
+// 指纹中使用的占位路径，使指纹与缓存和构建目录的位置无关
+const path kPlaceholderDir = "importa-std-cache";
+} // namespace
+
+path importa::std_module_cache::default_cache_root()
+{
+    if (auto root = env_path("IMPORTA_CACHE_DIR"); !root.empty())
+    {
+        return root / "std";
+    }
+#if defined(_WIN32)
+    path base = env_path("LOCALAPPDATA");
+#else
+    path base = env_path("XDG_CACHE_HOME");
+    if (base.empty() && !env_path("HOME").empty())
+    {
+        base = env_path("HOME") / ".cache";
+    }
+#endif
+    if (base.empty())
+    {
+        base = std::filesystem::temp_directory_path();
+    }
+    return base / "importa" / "std";
+}
+
+// --- StdModuleCache ---
+
+StdModuleCache::StdModuleCache(path cache_root, const IToolchain& toolchain,
+                               IExecutor& executor,
+                               importa::artifact_cache::ArtifactCacheOptions
+                                   options)
+    : m_store(std::move(cache_root), options), m_toolchain(toolchain),
+      m_executor(executor)
+{
+}
+
+std::optional<StdModuleArtifacts> StdModuleCache::ensure(
+    const std::vector<StdModuleSource>& modules, const path& install_dir)
+{
+    const std::size_t built_before = m_modules_built;
+    StdModuleArtifacts artifacts;
+    std::map<std::string, std::uint64_t> fingerprints;
+    for (const auto& module : modules)
+    {
+        auto fp = fingerprint(module, fingerprints);
+        if (!fp)
+        {
+            return std::nullopt;
+        }
+        fingerprints[module.name] = *fp;
+
+        const path entry_dir = install_dir / (module.name + "-" + to_hex(*fp));
+        const path ifc_path = entry_dir / (module.name + ".ifc");
+        std::error_code ec;
+        if (!m_store.fetch(*fp, entry_dir))
+        {
+            if (!build_entry(module, *fp, artifacts.ifcs) ||
+                !m_store.fetch(*fp, entry_dir))
+            {
+                std::cerr << "Error: Cannot install standard module '"
+                          << module.name << "' into '" << entry_dir.string()
+                          << "'.\n";
+                return std::nullopt;
+            }
+        }
+
+        artifacts.ifcs[module.name] = ifc_path;
+        const path obj_path = entry_dir / (module.name + ".obj");
+        if (std::filesystem::exists(obj_path, ec))
+        {
+            artifacts.objects.push_back(obj_path);
+        }
+    }
+
+    if (m_modules_built != built_before)
+    {
+        m_store.trim_in_background();
+    }
+    return artifacts;
+}
+
+std::size_t StdModuleCache::modules_built() const
+{
+    return m_modules_built;
+}
+
+// --- 私有辅助函数实现 ---
+
+std::uint64_t StdModuleCache::toolchain_identity(const path& compiler)
+{
+    if (m_toolchain_identity)
+    {
+        return *m_toolchain_identity;
+    }
+
+    // 同一路径上的编译器被升级后，大小、修改时间或版本输出至少有一个会变化
+    std::uint64_t h = importa::hashing::hash_string(compiler.generic_string());
+    std::error_code ec;
+    if (auto size = std::filesystem::file_size(compiler, ec); !ec)
+    {
+        h = importa::hashing::hash_combine(h, size);
+        auto mtime = std::filesystem::last_write_time(compiler, ec);
+        h = importa::hashing::hash_combine(
+            h, static_cast<std::uint64_t>(mtime.time_since_epoch().count()));
+    }
+    if (auto cmd = m_toolchain.generate_version_command())
+    {
+        auto result = m_executor.execute(*cmd);
+        h = importa::hashing::hash_string(result.std_out, h);
+        h = importa::hashing::hash_string(result.std_err, h);
+    }
+    m_toolchain_identity = h;
+    return h;
+}
+
+std::optional<std::uint64_t> StdModuleCache::fingerprint(
+    const StdModuleSource& module,
+    const std::map<std::string, std::uint64_t>& known)
+{
+    auto content = read_file(module.interface_unit);
+    if (!content)
+    {
+        std::cerr << "Error: Cannot read the interface of standard module '"
+                  << module.name << "' at '" << module.interface_unit.string()
+                  << "'.\n";
+        return std::nullopt;
+    }
+
+    EmitIFCArgs args;
+    args.interface_unit_path =
+        kPlaceholderDir / module.interface_unit.filename();
+    args.output_ifc_path = kPlaceholderDir / (module.name + ".ifc");
+    args.output_obj_path = kPlaceholderDir / (module.name + ".obj");
+    std::uint64_t h = importa::hashing::hash_string(*content);
+    for (const auto& dep : module.dependencies)
+    {
+        auto it = known.find(dep);
+        if (it == known.end())
+        {
+            std::cerr << "Error: Standard module '" << module.name
+                      << "' depends on '" << dep
+                      << "', which must be listed before it.\n";
+            return std::nullopt;
+        }
+        args.module_dependencies.push_back(
+            { dep, kPlaceholderDir / (dep + ".ifc") });
+        h = importa::hashing::hash_combine(h, it->second);
+    }
+
+    auto cmd = m_toolchain.generate_emit_ifc_command(args);
+    if (!cmd)
+    {
+        std::cerr << "Error: The toolchain cannot compile standard module '"
+                  << module.name << "'.\n";
+        return std::nullopt;
+    }
+    h = importa::hashing::hash_string(cmd->to_string(), h);
+    if (auto obj_cmd = object_command(args))
+    {
+        h = importa::hashing::hash_string(obj_cmd->to_string(), h);
+    }
+    h = importa::hashing::hash_string(module.name, h);
+    return importa::hashing::hash_combine(h,
+                                          toolchain_identity(cmd->executable));
+}
+
+std::optional<Command> StdModuleCache::object_command(
+    const EmitIFCArgs& emit) const
+{
+    if (m_toolchain.emit_ifc_writes_object())
+    {
+        return std::nullopt;
+    }
+    // 与 module_processor 相同：接口中的定义由 BMI 另行编译出目标文件
+    CompileObjectArgs args;
+    args.source_file = m_toolchain.get_bmi_path(emit.output_ifc_path);
+    args.output_obj_path = emit.output_obj_path;
+    args.module_dependencies = emit.module_dependencies;
+    return m_toolchain.generate_compile_obj_command(args);
+}
+
+bool StdModuleCache::build_entry(
+    const StdModuleSource& module, std::uint64_t key,
+    const std::map<std::string, path>& dependency_ifcs)
+{
+    const path temp_dir = m_store.stage();
+
+    EmitIFCArgs args;
+    args.interface_unit_path = module.interface_unit;
+    args.output_ifc_path = temp_dir / (module.name + ".ifc");
+    args.output_obj_path = temp_dir / (module.name + ".obj");
+    for (const auto& dep : module.dependencies)
+    {
+        args.module_dependencies.push_back({ dep, dependency_ifcs.at(dep) });
+    }
+
+    std::vector<Command> commands = { *m_toolchain.generate_emit_ifc_command(
+        args) };
+    if (!m_toolchain.emit_ifc_writes_object())
+    {
+        auto obj_cmd = object_command(args);
+        if (!obj_cmd)
+        {
+            std::cerr << "Error: The toolchain cannot compile the object file "
+                         "of standard module '"
+                      << module.name << "'.\n";
+            std::error_code ec;
+            std::filesystem::remove_all(temp_dir, ec);
+            return false;
+        }
+        commands.push_back(std::move(*obj_cmd));
+    }
+
+    for (const auto& cmd : commands)
+    {
+        auto result = m_executor.execute(cmd);
+        if (!result)
+        {
+            std::cerr << "Error: Failed to build standard module '"
+                      << module.name << "' for the shared cache.\n"
+                      << result.std_out << result.std_err;
+            std::error_code ec;
+            std::filesystem::remove_all(temp_dir, ec);
+            return false;
+        }
+    }
+    ++m_modules_built;
+    return m_store.publish(key, temp_dir);
+}
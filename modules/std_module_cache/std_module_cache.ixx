@@ -0,0 +1,76 @@
+// std_module_cache.ixx
+//
+// 定义了 StdModuleCache 类：用户级的标准库模块（std / std.compat）BMI 缓存。
+// 标准库模块的接口编译最慢，却在每个项目、每个构建目录中都相同。
+// 缓存条目以指纹为键存放在 ArtifactCache 中，指纹涵盖编译器可执行文件、其版本输出、
+// 接口源文件内容，以及工具链为该接口生成的完整编译命令（即所有影响 BMI 的构建配置）。
+// 构建目录使用解压到本地的副本，缓存淘汰条目不会影响已有的构建目录。
+
+export module std_module_cache;
+
+import std;
+import executor;
+import toolchains;
+import artifact_cache;
+
+namespace importa
+{
+
+namespace std_module_cache
+{
+
+using path = std::filesystem::path;
+
+// 一个需要缓存的标准库模块
+export struct StdModuleSource
+{
+    std::string name; // 例如 "std"、"std.compat"
+    path interface_unit;
+    std::vector<std::string> dependencies; // 须排在本模块之前
+};
+
+// 安装到构建目录中的产物，可直接交给 ProjectProcessor 的 external_ifcs 与链接步骤
+export struct StdModuleArtifacts
+{
+    std::map<std::string, path> ifcs;
+    std::vector<path> objects;
+};
+
+// 用户级缓存目录：IMPORTA_CACHE_DIR，否则为平台惯用的缓存位置下的 importa/std
+export path default_cache_root();
+
+export class StdModuleCache
+{
+  public:
+    StdModuleCache(path cache_root, const toolchains::IToolchain& toolchain,
+                   executor::IExecutor& executor,
+                   artifact_cache::ArtifactCacheOptions options = {});
+
+    // 把各模块的产物安装到 install_dir/<模块名>-<指纹>/ 下；缓存中缺失的先构建并发布，
+    // 之后在后台按容量上限清理缓存。任何模块构建失败时返回 nullopt。
+    std::optional<StdModuleArtifacts> ensure(
+        const std::vector<StdModuleSource>& modules, const path& install_dir);
+
+    // 本实例实际编译过的模块数（其余均命中缓存）
+    std::size_t modules_built() const;
+
+  private:
+    artifact_cache::ArtifactCache m_store;
+    const toolchains::IToolchain& m_toolchain;
+    executor::IExecutor& m_executor;
+    std::optional<std::uint64_t> m_toolchain_identity;
+    std::size_t m_modules_built = 0;
+
+    std::uint64_t toolchain_identity(const path& compiler);
+    std::optional<std::uint64_t> fingerprint(
+        const StdModuleSource& module,
+        const std::map<std::string, std::uint64_t>& known);
+    // 接口编译不写出目标文件时，从 BMI 编译目标文件的命令
+    std::optional<executor::Command> object_command(
+        const toolchains::EmitIFCArgs& emit) const;
+    bool build_entry(const StdModuleSource& module, std::uint64_t key,
+                     const std::map<std::string, path>& dependency_ifcs);
+};
+
+} // namespace std_module_cache
+} // namespace importa
@@ -0,0 +1,101 @@
+// thread_pool.cpp
+// 提供了 ThreadPool 类的具体实现。
+
+module thread_pool;
+
+import std;
+
+using namespace importa::thread_pool;
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_limit = thread_count;
+    m_workers.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+        m_workers.emplace_back([this](std::stop_token stop)
+                               { worker_loop(stop); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    // jthread 析构时请求停止并等待；先统一请求停止以便并行退出
+    for (auto& worker : m_workers)
+    {
+        worker.request_stop();
+    }
+    m_cv.notify_all();
+    // 必须在互斥量与队列析构之前汇合所有工作线程
+    m_workers.clear();
+}
+
+std::size_t ThreadPool::size() const
+{
+    return m_workers.size();
+}
+
+void ThreadPool::set_concurrency_limit(std::size_t limit)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_limit = std::clamp<std::size_t>(limit, 1, m_workers.size());
+    }
+    m_cv.notify_all();
+}
+
+std::size_t ThreadPool::concurrency_limit() const
+{
+    return m_limit;
+}
+
+void ThreadPool::enqueue(std::move_only_function<void()> task,
+                         std::size_t slots)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back({ std::move(task), std::max<std::size_t>(slots, 1) });
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::worker_loop(std::stop_token stop)
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock lock(m_mutex);
+            // 占用多个任务槽的任务按并发上限截断，否则永远等不到足够的名额
+            auto front_slots = [this]
+            { return std::min<std::size_t>(m_tasks.front().slots, m_limit); };
+            // 停止请求到达后仍会先清空队列（不受并发上限约束），
+            // 已提交的 future 不会悬空
+            m_cv.wait(lock, stop,
+                      [&]
+                      {
+                          return !m_tasks.empty() &&
+                                 m_active + front_slots() <= m_limit;
+                      });
+            if (m_tasks.empty())
+            {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            task.slots = front_slots();
+            m_tasks.pop_front();
+            m_active += task.slots;
+        }
+        task.run();
+        {
+            std::lock_guard lock(m_mutex);
+            m_active -= task.slots;
+        }
+        // 让出的名额可能正被多个暂停的线程等待
+        m_cv.notify_all();
+    }
+}
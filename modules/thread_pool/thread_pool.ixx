@@ -0,0 +1,101 @@
+// thread_pool.ixx
+//
+// 定义了 ThreadPool 类：固定数量的工作线程与一个 FIFO 任务队列。
+// 用于并行执行文件哈希、依赖扫描等彼此独立的短任务。
+// 同时执行任务的线程数可以在运行时下调（见 LoadGovernor）。
+// 自身也会并行的任务（例如带多个 LTO 后端的链接）可以占用多个任务槽。
+
+export module thread_pool;
+
+import std;
+
+namespace importa
+{
+
+namespace thread_pool
+{
+
+export class ThreadPool
+{
+  public:
+    // thread_count 为 0 时使用硬件并发数
+    explicit ThreadPool(std::size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交一个任务，返回可获取其结果（或异常）的 future。
+    // 任务执行期间占用 slots 个任务槽（超过并发上限时按上限计）；
+    // 队首任务等到空出足够的任务槽才开始，其后的任务不会越过它
+    template <typename F>
+    auto submit(F&& task, std::size_t slots = 1)
+        -> std::future<std::invoke_result_t<F&>>
+    {
+        using Result = std::invoke_result_t<F&>;
+        std::packaged_task<Result()> packaged(std::forward<F>(task));
+        auto future = packaged.get_future();
+        enqueue([packaged = std::move(packaged)]() mutable { packaged(); },
+                slots);
+        return future;
+    }
+
+    std::size_t size() const;
+
+    // 同时占用的任务槽数上限，限制在 [1, size()] 内，默认为 size()。
+    // 下调后正在执行的任务照常完成，之后多出的线程暂停取任务
+    void set_concurrency_limit(std::size_t limit);
+    std::size_t concurrency_limit() const;
+
+  private:
+    struct Task
+    {
+        std::move_only_function<void()> run;
+        std::size_t slots = 1;
+    };
+
+    std::vector<std::jthread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    std::deque<Task> m_tasks;
+    std::atomic<std::size_t> m_limit = 0;
+    std::size_t m_active = 0; // 正在执行的任务占用的任务槽数，由 m_mutex 保护
+
+    void enqueue(std::move_only_function<void()> task, std::size_t slots);
+    void worker_loop(std::stop_token stop);
+};
+
+// 在线程池上对 items 中的每个元素调用 fn，并等待全部完成。
+// 任一调用抛出的第一个异常会在所有任务结束后重新抛出。
+export template <typename T, typename Fn>
+void parallel_for_each(ThreadPool& pool, const std::vector<T>& items, Fn fn)
+{
+    std::vector<std::future<void>> futures;
+    futures.reserve(items.size());
+    for (const auto& item : items)
+    {
+        futures.push_back(pool.submit([&fn, &item] { fn(item); }));
+    }
+    std::exception_ptr first_error;
+    for (auto& future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch (...)
+        {
+            if (!first_error)
+            {
+                first_error = std::current_exception();
+            }
+        }
+    }
+    if (first_error)
+    {
+        std::rethrow_exception(first_error);
+    }
+}
+
+} // namespace thread_pool
+} // namespace importa
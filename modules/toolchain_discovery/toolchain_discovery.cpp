@@ -0,0 +1,485 @@
+// toolchain_discovery.cpp
+// 提供了编译器查找、能力探测与 ProbeCache 的具体实现。
+//
+// 缓存文件为文本：首行为格式版本，之后每行一个编译器，字段以制表符分隔，
+// 可执行文件路径在行尾。探测规则变化时提高 kCacheVersion，旧结果整体作废。
+
+module toolchain_discovery;
+
+import std;
+import executor;
+import toolchains;
+import file_hash_cache;
+
+using namespace importa::toolchain_discovery;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using importa::file_hash_cache::FileIdentity;
+using importa::file_hash_cache::stat_file;
+
+namespace
+{ // 内部辅助函数
+
+constexpr std::string_view kCacheHeader = "importa-toolchains";
+constexpr int kCacheVersion = 1;
+
+#if defined(_WIN32)
+constexpr char kPathSeparator = ';';
+constexpr std::string_view kNullDevice = "NUL";
+#else
+constexpr char kPathSeparator = ':';
+constexpr std::string_view kNullDevice = "/dev/null";
+#endif
+
+// CompilerInfo 中能力位在缓存文件中的编码
+constexpr unsigned kModulesBit = 1u << 0;
+constexpr unsigned kModuleOutputBit = 1u << 1;
+constexpr unsigned kReducedBmiBit = 1u << 2;
+constexpr unsigned kP1689ScanBit = 1u << 3;
+
+std::string cache_key(const path& executable)
+{
+    return executable.lexically_normal().generic_string();
+}
+
+path env_path(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value && *value ? path(value) : path();
+}
+
+// "clang++"、"g++" 或其后接 "-<版本号>"（例如 clang++-18、g++-14）
+std::optional<CompilerFamily> family_from_name(std::string name)
+{
+#if defined(_WIN32)
+    if (name.ends_with(".exe"))
+    {
+        name.resize(name.size() - 4);
+    }
+#endif
+    std::string_view rest = name;
+    std::optional<CompilerFamily> family;
+    if (rest.starts_with("clang++"))
+    {
+        family = CompilerFamily::Clang;
+        rest.remove_prefix(7);
+    }
+    else if (rest.starts_with("g++"))
+    {
+        family = CompilerFamily::Gcc;
+        rest.remove_prefix(3);
+    }
+    if (!family || rest.empty())
+    {
+        return family;
+    }
+    if (rest.size() < 2 || rest.front() != '-' ||
+        !std::isdigit(static_cast<unsigned char>(rest[1])))
+    {
+        return std::nullopt;
+    }
+    for (const char c : rest.substr(1))
+    {
+        if (!std::isdigit(static_cast<unsigned char>(c)) && c != '.')
+        {
+            return std::nullopt;
+        }
+    }
+    return family;
+}
+
+bool is_executable_file(const std::filesystem::directory_entry& entry)
+{
+    std::error_code ec;
+    if (!entry.is_regular_file(ec))
+    {
+        return false;
+    }
+#if defined(_WIN32)
+    return true;
+#else
+    using std::filesystem::perms;
+    const auto permissions = entry.status(ec).permissions();
+    return !ec && (permissions & (perms::owner_exec | perms::group_exec |
+                                  perms::others_exec)) != perms::none;
+#endif
+}
+
+// 从 --version 输出的第一行识别编译器与版本号：
+//   "Ubuntu clang version 18.1.3 (1ubuntu1)" -> Clang, "18.1.3"
+//   "g++ (Ubuntu 13.2.0-23ubuntu4) 13.2.0"    -> Gcc, "13.2.0"
+//   "g++ (GCC) 14.2.1 20240910"               -> Gcc, "14.2.1"
+// GCC 的版本号是括号中的发行版标记之后第一个只含数字与点的词，
+// 其后可能还有日期或另一个发行版标记
+std::optional<std::pair<CompilerFamily, std::string>> parse_version_output(
+    std::string_view output)
+{
+    const std::string_view first_line = output.substr(0, output.find('\n'));
+    std::vector<std::string_view> words;
+    for (auto word : first_line | std::views::split(' '))
+    {
+        if (!std::ranges::empty(word))
+        {
+            words.emplace_back(word.begin(), word.end());
+        }
+    }
+
+    auto is_version = [](std::string_view word)
+    {
+        return !word.empty() &&
+               std::isdigit(static_cast<unsigned char>(word[0]));
+    };
+
+    for (std::size_t i = 0; i + 2 < words.size(); ++i)
+    {
+        if (words[i] == "clang" && words[i + 1] == "version" &&
+            is_version(words[i + 2]))
+        {
+            return std::pair{ CompilerFamily::Clang,
+                              std::string(words[i + 2]) };
+        }
+    }
+    if (output.find("Free Software Foundation") == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+    auto word = std::ranges::find_if(
+        words, [](std::string_view w) { return w.ends_with(')'); });
+    if (word == words.end())
+    {
+        return std::nullopt;
+    }
+    auto version = std::find_if(
+        word + 1, words.end(),
+        [&](std::string_view w)
+        {
+            return is_version(w) &&
+                   w.find_first_not_of("0123456789.") == std::string_view::npos;
+        });
+    if (version == words.end())
+    {
+        return std::nullopt;
+    }
+    return std::pair{ CompilerFamily::Gcc, std::string(*version) };
+}
+
+unsigned major_of(std::string_view version)
+{
+    unsigned major = 0;
+    std::from_chars(version.data(), version.data() + version.size(), major);
+    return major;
+}
+
+// 编译器是否接受 flags：对空输入做语法检查，未知选项会使其以非零状态退出
+bool accepts_flags(const path& executable, std::vector<std::string> flags,
+                   IExecutor& executor)
+{
+    Command cmd;
+    cmd.executable = executable;
+    cmd.arguments = std::move(flags);
+    cmd.arguments.push_back("-fsyntax-only");
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back(std::string(kNullDevice));
+    return static_cast<bool>(executor.execute(cmd));
+}
+
+// 与 clang++ 同目录、同后缀的 clang-scan-deps 是否存在
+bool has_clang_scan_deps(const path& clangxx)
+{
+    std::string name = clangxx.filename().string();
+    const auto pos = name.rfind("clang++");
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+    name.replace(pos, 7, "clang-scan-deps");
+    std::error_code ec;
+    return std::filesystem::is_regular_file(clangxx.parent_path() / name, ec);
+}
+} // namespace
+
+// --- ProbeCache ---
+
+ProbeCache::ProbeCache(path cache_file) : m_cache_file(std::move(cache_file))
+{
+    load();
+}
+
+std::optional<CompilerInfo> ProbeCache::find(const path& executable) const
+{
+    const auto it = m_entries.find(cache_key(executable));
+    if (it == m_entries.end() || stat_file(executable) != it->second.identity)
+    {
+        return std::nullopt;
+    }
+    return it->second.info;
+}
+
+void ProbeCache::store(const CompilerInfo& info)
+{
+    auto identity = stat_file(info.executable);
+    if (!identity)
+    {
+        return;
+    }
+    m_entries[cache_key(info.executable)] = { *identity, info };
+    m_dirty = true;
+}
+
+bool ProbeCache::save()
+{
+    if (!m_dirty)
+    {
+        return true;
+    }
+
+    std::error_code ec;
+    if (m_cache_file.has_parent_path())
+    {
+        std::filesystem::create_directories(m_cache_file.parent_path(), ec);
+    }
+    // 临时文件名带随机后缀，两个进程同时保存时互不覆盖对方的临时文件
+    path temp_path = m_cache_file;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << kCacheHeader << ' ' << kCacheVersion << '\n';
+        for (const auto& [key, entry] : m_entries)
+        {
+            const auto& info = entry.info;
+            const unsigned caps =
+                (info.modules ? kModulesBit : 0) |
+                (info.module_output ? kModuleOutputBit : 0) |
+                (info.reduced_bmi ? kReducedBmiBit : 0) |
+                (info.p1689_scan ? kP1689ScanBit : 0);
+            out << entry.identity.device << '\t' << entry.identity.inode
+                << '\t' << entry.identity.size << '\t'
+                << entry.identity.mtime_ns << '\t'
+                << static_cast<int>(info.family) << '\t'
+                << info.major_version << '\t' << caps << '\t'
+                << info.bmi_extension << '\t' << info.version << '\t'
+                << info.executable.string() << '\n';
+        }
+        if (!out.flush())
+        {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, m_cache_file, ec);
+    if (ec)
+    {
+        std::cerr << "Warning: Cannot save the toolchain cache '"
+                  << m_cache_file.string() << "': " << ec.message() << "\n";
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
+
+void ProbeCache::load()
+{
+    std::ifstream in(m_cache_file);
+    std::string header;
+    int version = 0;
+    if (!(in >> header >> version) || header != kCacheHeader ||
+        version != kCacheVersion)
+    {
+        return;
+    }
+
+    Entry entry;
+    int family = 0;
+    unsigned caps = 0;
+    std::string executable;
+    while (in >> entry.identity.device >> entry.identity.inode >>
+           entry.identity.size >> entry.identity.mtime_ns >> family >>
+           entry.info.major_version >> caps >> entry.info.bmi_extension >>
+           entry.info.version &&
+           in.get() == '\t' && std::getline(in, executable))
+    {
+        entry.info.executable = executable;
+        entry.info.family = static_cast<CompilerFamily>(family);
+        entry.info.modules = caps & kModulesBit;
+        entry.info.module_output = caps & kModuleOutputBit;
+        entry.info.reduced_bmi = caps & kReducedBmiBit;
+        entry.info.p1689_scan = caps & kP1689ScanBit;
+        m_entries[cache_key(entry.info.executable)] = entry;
+    }
+}
+
+// --- 查找与探测 ---
+
+path importa::toolchain_discovery::default_probe_cache_path()
+{
+    if (auto root = env_path("IMPORTA_CACHE_DIR"); !root.empty())
+    {
+        return root / "toolchains.cache";
+    }
+#if defined(_WIN32)
+    path base = env_path("LOCALAPPDATA");
+#else
+    path base = env_path("XDG_CACHE_HOME");
+    if (base.empty() && !env_path("HOME").empty())
+    {
+        base = env_path("HOME") / ".cache";
+    }
+#endif
+    if (base.empty())
+    {
+        base = std::filesystem::temp_directory_path();
+    }
+    return base / "importa" / "toolchains.cache";
+}
+
+std::vector<path> importa::toolchain_discovery::path_directories()
+{
+    std::vector<path> dirs;
+    const char* value = std::getenv("PATH");
+    if (!value)
+    {
+        return dirs;
+    }
+    for (auto dir : std::string_view(value) | std::views::split(kPathSeparator))
+    {
+        if (!std::ranges::empty(dir))
+        {
+            dirs.emplace_back(std::string_view(dir.begin(), dir.end()));
+        }
+    }
+    return dirs;
+}
+
+std::optional<CompilerInfo> importa::toolchain_discovery::probe_compiler(
+    const path& executable, IExecutor& executor)
+{
+    Command version_cmd;
+    version_cmd.executable = executable;
+    version_cmd.arguments = { "--version" };
+    const auto result = executor.execute(version_cmd);
+    const auto parsed =
+        result ? parse_version_output(result.std_out) : std::nullopt;
+    if (!parsed)
+    {
+        std::cerr << "Warning: Cannot identify the compiler '"
+                  << executable.string() << "' from its --version output.\n";
+        return std::nullopt;
+    }
+
+    CompilerInfo info;
+    info.executable = executable;
+    info.family = parsed->first;
+    info.version = parsed->second;
+    info.major_version = major_of(info.version);
+    switch (info.family)
+    {
+        case CompilerFamily::Clang:
+            info.bmi_extension = ".pcm";
+            // clang 16 起支持 -fmodule-file=<name>=<path> 与 P1689 扫描
+            info.modules = info.major_version >= 16;
+            info.module_output =
+                info.modules &&
+                accepts_flags(executable,
+                              { "-std=c++20", "-fmodule-output=" +
+                                                  std::string(kNullDevice) },
+                              executor);
+            info.reduced_bmi =
+                info.module_output &&
+                accepts_flags(executable,
+                              { "-std=c++20", "-fmodules-reduced-bmi" },
+                              executor);
+            info.p1689_scan = info.modules && has_clang_scan_deps(executable);
+            break;
+        case CompilerFamily::Gcc:
+            info.bmi_extension = ".gcm";
+            info.modules = accepts_flags(
+                executable, { "-std=c++20", "-fmodules-ts" }, executor);
+            // -fdeps-format=p1689r5 自 GCC 14 起提供
+            info.p1689_scan = info.modules && info.major_version >= 14;
+            break;
+    }
+    return info;
+}
+
+std::vector<CompilerInfo> importa::toolchain_discovery::discover_compilers(
+    ProbeCache& cache, IExecutor& executor,
+    const std::vector<path>& search_dirs)
+{
+    std::vector<CompilerInfo> found;
+    std::unordered_set<std::string> seen; // 解析符号链接后的真实路径
+    for (const auto& dir : search_dirs)
+    {
+        std::error_code ec;
+        std::vector<std::filesystem::directory_entry> entries;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (family_from_name(entry.path().filename().string()))
+            {
+                entries.push_back(entry);
+            }
+        }
+        // 目录遍历顺序不确定，按文件名排序使结果可复现
+        std::ranges::sort(entries, {}, [](const auto& entry)
+                          { return entry.path().filename(); });
+
+        for (const auto& entry : entries)
+        {
+            const auto target = std::filesystem::canonical(entry.path(), ec);
+            if (ec || !is_executable_file(entry) ||
+                !seen.insert(target.generic_string()).second)
+            {
+                continue;
+            }
+            auto info = cache.find(entry.path());
+            if (!info)
+            {
+                info = probe_compiler(entry.path(), executor);
+                if (!info)
+                {
+                    continue;
+                }
+                cache.store(*info);
+            }
+            found.push_back(std::move(*info));
+        }
+    }
+    std::ranges::stable_sort(found, std::greater<>{},
+                             &CompilerInfo::major_version);
+    return found;
+}
+
+std::unique_ptr<IToolchain> importa::toolchain_discovery::make_toolchain(
+    const CompilerInfo& info, BuildConfiguration config,
+    std::string gcc_module_mapper)
+{
+    if (!info.modules)
+    {
+        std::cerr << "Error: The compiler '" << info.executable.string()
+                  << "' (version " << info.version
+                  << ") does not support C++20 modules.\n";
+        return nullptr;
+    }
+    switch (info.family)
+    {
+        case CompilerFamily::Clang:
+            config.reduced_bmi = config.reduced_bmi && info.reduced_bmi;
+            return std::make_unique<ClangxxToolchain>(
+                info.executable, std::move(config),
+                info.module_output ? InterfaceCompilation::OnePhase
+                                   : InterfaceCompilation::TwoPhase);
+        case CompilerFamily::Gcc:
+            if (gcc_module_mapper.empty())
+            {
+                std::cerr << "Error: GCC toolchain '"
+                          << info.executable.string()
+                          << "' needs a module mapper endpoint.\n";
+                return nullptr;
+            }
+            return std::make_unique<GccToolchain>(info.executable,
+                                                  std::move(config),
+                                                  std::move(gcc_module_mapper));
+    }
+    return nullptr;
+}
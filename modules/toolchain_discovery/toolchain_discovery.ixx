@@ -0,0 +1,104 @@
+// toolchain_discovery.ixx
+//
+// 在 PATH 中查找已安装的编译器（clang++、clang++-N、g++、g++-N），
+// 探测其版本、支持的模块选项与 BMI 格式，并据此创建工具链。
+//
+// 探测需要多次运行编译器，结果保存在 ProbeCache 中：每条记录以可执行文件
+// 路径为键，并带有该文件的 (device, inode, size, mtime)。只要编译器未被
+// 替换或升级，之后的启动就不再运行它。
+
+export module toolchain_discovery;
+
+import std;
+import executor;
+import toolchains;
+import file_hash_cache;
+
+namespace importa
+{
+
+namespace toolchain_discovery
+{
+
+using path = std::filesystem::path;
+
+export enum class CompilerFamily
+{
+    Clang, // Unix 风格的 clang++ 驱动程序
+    Gcc
+};
+
+// 一个编译器的探测结果
+export struct CompilerInfo
+{
+    path executable;
+    CompilerFamily family = CompilerFamily::Clang;
+    std::string version; // 例如 "18.1.3"
+    unsigned major_version = 0;
+    std::string bmi_extension; // ".pcm" 或 ".gcm"
+
+    bool modules = false;       // 可以编译 C++20 命名模块
+    bool module_output = false; // clang：-fmodule-output（一次编译写出 BMI）
+    bool reduced_bmi = false;   // clang：-fmodules-reduced-bmi
+    bool p1689_scan = false;    // clang-scan-deps 或 gcc -fdeps-format=p1689r5
+
+    bool operator==(const CompilerInfo&) const = default;
+};
+
+// 探测结果的持久化缓存
+export class ProbeCache
+{
+  public:
+    // 从 cache_file 加载已有结果；文件缺失、损坏或版本不符时从空缓存开始
+    explicit ProbeCache(path cache_file);
+
+    // executable 的缓存结果；从未探测过，或可执行文件已被替换时返回 nullopt
+    std::optional<CompilerInfo> find(const path& executable) const;
+
+    // 以可执行文件当前的身份信息记录探测结果
+    void store(const CompilerInfo& info);
+
+    // 有变化时写回磁盘（临时文件 + rename），失败时返回 false
+    bool save();
+
+  private:
+    struct Entry
+    {
+        file_hash_cache::FileIdentity identity;
+        CompilerInfo info;
+    };
+
+    path m_cache_file;
+    std::map<std::string, Entry> m_entries;
+    bool m_dirty = false;
+
+    void load();
+};
+
+// 用户级缓存文件：IMPORTA_CACHE_DIR，否则为平台惯用的缓存位置下的
+// importa/toolchains.cache
+export path default_probe_cache_path();
+
+// PATH 中的目录，按出现顺序
+export std::vector<path> path_directories();
+
+// 运行编译器探测其能力；无法运行或无法识别版本输出时返回 nullopt
+export std::optional<CompilerInfo> probe_compiler(
+    const path& executable, executor::IExecutor& executor);
+
+// 在 search_dirs 中查找编译器，同一个可执行文件（例如 g++ 与它指向的
+// g++-14）只保留先找到的名字。缓存命中的不再运行，其余探测后写入 cache
+// （不自动保存）。结果按主版本号从新到旧排列，相同时保持查找顺序
+export std::vector<CompilerInfo> discover_compilers(
+    ProbeCache& cache, executor::IExecutor& executor,
+    const std::vector<path>& search_dirs = path_directories());
+
+// 按探测结果创建工具链：clang 支持 -fmodule-output 时使用一次编译，
+// 不支持精简 BMI 时关闭 config.reduced_bmi；GCC 需要 gcc_module_mapper
+// 端点（见 gcc_module_mapper 模块）。不支持模块时返回 nullptr
+export std::unique_ptr<toolchains::IToolchain> make_toolchain(
+    const CompilerInfo& info, toolchains::BuildConfiguration config,
+    std::string gcc_module_mapper = {});
+
+} // namespace toolchain_discovery
+} // namespace importa
@@ -18,6 +18,23 @@ namespace importa::toolchains
 namespace
 { // 放在匿名命名空间中，作为此文件的内部实现细节
 
+// clang 的 LTO 模式：目标文件为 LLVM 位码，链接时也要给出同一选项
+void add_clang_lto_options(std::vector<std::string>& args,
+                           const BuildConfiguration& config)
+{
+    switch (config.lto)
+    {
+        case LtoMode::Off:
+            break;
+        case LtoMode::Full:
+            args.push_back("-flto");
+            break;
+        case LtoMode::Thin:
+            args.push_back("-flto=thin");
+            break;
+    }
+}
+
 // 将通用的 MSVC 编译选项从 BuildConfiguration 翻译并添加到命令参数列表中
 void add_common_msvc_compile_options(std::vector<std::string>& args,
                                      const BuildConfiguration& config)
@@ -93,6 +110,11 @@ void add_common_msvc_compile_options(std::vector<std::string>& args,
     args.push_back("/c");           // 只编译，不链接
     args.push_back("/TP");          // 将所有文件视为 C++ 文件
     args.push_back("/permissive-"); // 更严格的标准一致性
+    args.push_back("/Brepro");      // 不写入时间戳，相同的输入产生相同的目标文件
+    if (config.lto != LtoMode::Off)
+    {
+        args.push_back("/GL"); // 代码生成推迟到链接时（/LTCG）
+    }
 
     // 添加宏定义
     for (const auto& def : config.defines)
@@ -176,6 +198,7 @@ void add_common_clang_compile_options(std::vector<std::string>& args,
     // 其他标志
     args.push_back("-fms-compatibility"); // 开启与 MSVC 的兼容模式
     args.push_back("-Wno-msvc-include");  // 禁用一些关于 MSVC include 的警告
+    add_clang_lto_options(args, config);
 
     // 宏定义和包含目录
     for (const auto& def : config.defines)
@@ -187,6 +210,347 @@ void add_common_clang_compile_options(std::vector<std::string>& args,
         args.push_back("-I" + dir.string());
     }
 }
+
+// 要求 MSVC 以 JSON 形式写出本次编译读取的头文件
+void add_msvc_dependency_options(std::vector<std::string>& args,
+                                 const path& dependency_file)
+{
+    if (!dependency_file.empty())
+    {
+        args.push_back("/sourceDependencies");
+        args.push_back(dependency_file.string());
+    }
+}
+
+// 使用预编译头：强制包含 header，并从 pch_path 读取其预编译结果。
+// clang-cl 也接受这组选项
+void add_msvc_pch_options(std::vector<std::string>& args,
+                          const std::optional<PrecompiledHeader>& pch)
+{
+    if (pch)
+    {
+        args.push_back("/Yu" + pch->header.string());
+        args.push_back("/FI" + pch->header.string());
+        args.push_back("/Fp" + pch->pch_path.string());
+    }
+}
+
+void add_clang_pch_options(std::vector<std::string>& args,
+                           const std::optional<PrecompiledHeader>& pch)
+{
+    if (pch)
+    {
+        args.push_back("-include-pch");
+        args.push_back(pch->pch_path.string());
+    }
+}
+
+// GCC 与原生 clang++ 共用的编译选项（不含 MSVC 兼容选项）
+void add_gnu_compile_options(std::vector<std::string>& args,
+                             const BuildConfiguration& config)
+{
+    switch (config.cpp_standard)
+    {
+        case CppStandard::Cpp20:
+            args.push_back("-std=c++20");
+            break;
+        case CppStandard::Cpp23:
+            args.push_back("-std=c++23");
+            break;
+        case CppStandard::CppLatest:
+            args.push_back("-std=c++2c");
+            break;
+    }
+
+    const auto level = config.mode == BuildMode::Debug
+                           ? OptimizationLevel::O0
+                           : config.optimization;
+    switch (level)
+    {
+        case OptimizationLevel::O0:
+            args.push_back("-O0");
+            break;
+        case OptimizationLevel::O1:
+            args.push_back("-O1");
+            break;
+        case OptimizationLevel::O2:
+            args.push_back("-O2");
+            break;
+        case OptimizationLevel::O3:
+            args.push_back("-O3");
+            break;
+    }
+    if (config.debug_info != DebugInfo::None)
+    {
+        args.push_back("-g");
+    }
+
+    for (const auto& def : config.defines)
+    {
+        args.push_back("-D" + def);
+    }
+    for (const auto& dir : config.include_dirs)
+    {
+        args.push_back("-I" + dir.string());
+    }
+}
+
+void add_clangxx_compile_options(std::vector<std::string>& args,
+                                 const BuildConfiguration& config)
+{
+    add_gnu_compile_options(args, config);
+    add_clang_lto_options(args, config);
+}
+
+// GCC 没有 ThinLTO，两种模式都写出 GIMPLE 中间代码
+void add_gcc_compile_options(std::vector<std::string>& args,
+                             const BuildConfiguration& config)
+{
+    add_gnu_compile_options(args, config);
+    if (config.lto != LtoMode::Off)
+    {
+        args.push_back("-flto");
+    }
+}
+
+// LTO 的代码生成推迟到链接时，链接命令不给出优化级别时 lld 与 LLVMgold
+// 按 O2 生成代码。Debug 模式为 O0，否则取配置与各模块覆盖中较高的级别
+OptimizationLevel lto_optimization(const BuildConfiguration& config,
+                                   const LinkArgs& args)
+{
+    if (config.mode == BuildMode::Debug)
+    {
+        return OptimizationLevel::O0;
+    }
+    return std::max(config.optimization,
+                    args.optimization.value_or(config.optimization));
+}
+
+std::string optimization_digit(OptimizationLevel level)
+{
+    switch (level)
+    {
+        case OptimizationLevel::O0:
+            return "0";
+        case OptimizationLevel::O1:
+            return "1";
+        case OptimizationLevel::O2:
+            return "2";
+        case OptimizationLevel::O3:
+            return "3";
+    }
+    return "2";
+}
+
+// 链接器自行决定 LTO 并行数时，按全部硬件线程计入任务槽
+unsigned lto_backend_jobs(const BuildConfiguration& config)
+{
+    return config.lto_jobs > 0
+               ? config.lto_jobs
+               : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// link.exe 的 /CGTHREADS 默认值与上限
+constexpr unsigned kMsvcDefaultCodegenThreads = 4;
+constexpr unsigned kMsvcMaxCodegenThreads = 8;
+
+// 一周未用的条目删除，总量超过 4 GiB 时从最久未用的开始删除
+constexpr std::string_view kThinLtoCachePolicy =
+    "prune_after=168h:cache_size_bytes=4g";
+
+// clang 驱动程序的 LTO 链接选项：ThinLTO 的后端并行数与缓存目录。
+// 缓存按模块的位码与优化选项寻址，增量链接只重新生成变化的模块
+void add_clang_lto_link_options(std::vector<std::string>& args,
+                                const BuildConfiguration& config,
+                                const LinkArgs& link)
+{
+    add_clang_lto_options(args, config);
+    if (config.lto == LtoMode::Off)
+    {
+        return;
+    }
+    // 驱动程序将其转为 --lto-O<n> 或 -plugin-opt=O<n>
+    args.push_back("-O" + optimization_digit(lto_optimization(config, link)));
+    if (config.lto != LtoMode::Thin)
+    {
+        return;
+    }
+    const path& cache_dir = link.lto_cache_dir;
+    if (config.lto_jobs > 0)
+    {
+        args.push_back("-flto-jobs=" + std::to_string(config.lto_jobs));
+    }
+    if (!cache_dir.empty())
+    {
+        // lld 内置 ThinLTO，其他链接器经由 LLVMgold 插件。链接器在每次
+        // 链接后按 kThinLtoCachePolicy 清理缓存，目录不会无限增长
+        const std::string prefix = config.linker == Linker::Lld
+                                       ? "-Wl,--thinlto-cache-"
+                                       : "-Wl,-plugin-opt,cache-";
+        args.push_back(prefix + "dir=" + cache_dir.string());
+        args.push_back(prefix + "policy=" + std::string(kThinLtoCachePolicy));
+    }
+}
+
+// 以 name=path 的形式引用依赖模块的 .pcm
+void add_clang_module_references(
+    std::vector<std::string>& args,
+    const std::vector<ModuleReference>& module_dependencies)
+{
+    for (const auto& dep : module_dependencies)
+    {
+        path dep_pcm_path = dep.ifc_path;
+        dep_pcm_path.replace_extension(".pcm");
+        args.push_back("-fmodule-file=" + dep.name + "=" +
+                       dep_pcm_path.string());
+    }
+}
+
+// 一次编译同时写出目标文件与 .pcm；精简 BMI 只能以这种方式生成
+void add_one_phase_interface_options(std::vector<std::string>& args,
+                                     const EmitIFCArgs& emit,
+                                     const path& pcm_path,
+                                     bool reduced_bmi)
+{
+    args.push_back("-x");
+    args.push_back("c++-module");
+    args.push_back("-c");
+    args.push_back(emit.interface_unit_path.string());
+    args.push_back("-o");
+    args.push_back(emit.output_obj_path.string());
+    args.push_back("-fmodule-output=" + pcm_path.string());
+    if (reduced_bmi)
+    {
+        args.push_back("-fmodules-reduced-bmi");
+    }
+}
+
+// clang++ 与 g++ 驱动程序的链接器选择与线程数
+void add_gnu_linker_options(std::vector<std::string>& args,
+                            const BuildConfiguration& config)
+{
+    const std::string threads = std::to_string(config.link_threads);
+    switch (config.linker)
+    {
+        case Linker::Default:
+            break;
+        case Linker::Lld:
+            args.push_back("-fuse-ld=lld");
+            if (config.link_threads > 0)
+            {
+                args.push_back("-Wl,--threads=" + threads);
+            }
+            break;
+        case Linker::Mold:
+            args.push_back("-fuse-ld=mold");
+            if (config.link_threads > 0)
+            {
+                args.push_back("-Wl,--thread-count=" + threads);
+            }
+            break;
+    }
+    for (const auto& dir : config.library_dirs)
+    {
+        args.push_back("-L" + dir.string());
+    }
+}
+
+// 裸库名（例如 "pthread"）按 -l 传递，路径与文件名原样传递
+void add_gnu_link_libraries(std::vector<std::string>& args,
+                            const std::vector<std::string>& libraries)
+{
+    for (const auto& lib : libraries)
+    {
+        const path lib_path(lib);
+        args.push_back(lib_path.has_extension() || lib_path.has_parent_path() ||
+                               lib.starts_with("-")
+                           ? lib
+                           : "-l" + lib);
+    }
+}
+
+// link.exe 读不了 clang 写出的 LLVM 位码，LTO 时 clang-cl 总是使用 lld-link
+bool uses_lld_link(const BuildConfiguration& config)
+{
+    return config.linker == Linker::Lld || config.lto != LtoMode::Off;
+}
+
+// clang-cl 驱动 lld-link 或 link.exe，-Wl, 与 ELF 链接器的选项（包括 Mold）
+// 都不适用：链接器选项须放在命令末尾的 /link 之后，此处返回这部分选项
+std::vector<std::string> clang_cl_linker_options(
+    const BuildConfiguration& config, const LinkArgs& link)
+{
+    std::vector<std::string> options;
+    if (config.lto != LtoMode::Off)
+    {
+        options.push_back("/opt:lldlto=" +
+                          optimization_digit(lto_optimization(config, link)));
+    }
+    if (uses_lld_link(config) && config.link_threads > 0)
+    {
+        options.push_back("/threads:" + std::to_string(config.link_threads));
+    }
+    for (const auto& dir : config.library_dirs)
+    {
+        options.push_back("/LIBPATH:" + dir.string());
+    }
+    if (config.lto == LtoMode::Thin)
+    {
+        // 与 clang 驱动程序的 -flto-jobs 及 ThinLTO 缓存相同，见上文
+        if (config.lto_jobs > 0)
+        {
+            options.push_back("/opt:lldltojobs=" +
+                              std::to_string(config.lto_jobs));
+        }
+        if (!link.lto_cache_dir.empty())
+        {
+            options.push_back("/lldltocache:" + link.lto_cache_dir.string());
+            options.push_back("/lldltocachepolicy:" +
+                              std::string(kThinLtoCachePolicy));
+        }
+    }
+    return options;
+}
+
+// 与驱动程序同目录、同前后缀的工具，例如 g++-14 -> gcc-ar-14，
+// clang++-18 -> llvm-ar-18；驱动程序名中没有 driver 时只替换文件名
+path sibling_tool(const path& driver_path, std::string_view driver,
+                  std::string_view tool)
+{
+    std::string name = driver_path.filename().string();
+    const auto pos = name.rfind(driver);
+    if (pos == std::string::npos)
+    {
+        return driver_path.parent_path() /
+               (std::string(tool) + driver_path.extension().string());
+    }
+    name.replace(pos, driver.size(), tool);
+    return driver_path.parent_path() / name;
+}
+
+// 要求 clang++ 与 g++ 驱动程序写出 Makefile 格式的依赖文件
+void add_clang_dependency_options(std::vector<std::string>& args,
+                                  const path& dependency_file)
+{
+    if (!dependency_file.empty())
+    {
+        args.push_back("-MD");
+        args.push_back("-MF");
+        args.push_back(dependency_file.string());
+    }
+}
+
+// clang-cl 把 -MD 当作 /MD（会覆盖调试运行时 /MDd），也不认识 -MF，
+// 须经 /clang: 原样转交给 clang
+void add_clang_cl_dependency_options(std::vector<std::string>& args,
+                                     const path& dependency_file)
+{
+    if (!dependency_file.empty())
+    {
+        args.push_back("/clang:-MD");
+        args.push_back("/clang:-MF" + dependency_file.string());
+    }
+}
 } // namespace
 
 // --- BuildConfigurationFactory 实现 ---
@@ -199,6 +563,9 @@ BuildConfiguration BuildConfigurationFactory::create_debug_default()
     config.debug_info = DebugInfo::Full;
     config.msvc_runtime = MsvcRuntime::MultiThreadedDebugDLL;
     config.defines.push_back("_DEBUG");
+    // 调试迭代时链接时间占大头
+    config.incremental_link = true;
+    config.fastlink_pdb = true;
     return config;
 }
 
@@ -220,33 +587,92 @@ BuildConfiguration BuildConfigurationFactory::create_release_with_debug_info()
     return config;
 }
 
+// --- CompileFlagCache 实现 ---
+
+CompileFlagCache::CompileFlagCache(Generator generate)
+    : m_generate(generate), m_state(std::make_shared<State>())
+{
+}
+
+CompileFlags CompileFlagCache::get(
+    const BuildConfiguration& base,
+    const ConfigurationOverride& configuration) const
+{
+    // 以有效配置为键，与基础配置相同的覆盖项不产生新的列表；
+    // Debug 模式忽略优化级别
+    ConfigurationOverride key;
+    key.optimization = base.mode == BuildMode::Debug
+                           ? base.optimization
+                           : configuration.optimization.value_or(
+                                 base.optimization);
+    key.debug_info = configuration.debug_info.value_or(base.debug_info);
+    key.defines = configuration.defines;
+
+    std::lock_guard lock(m_state->mutex);
+    auto& flags = m_state->flags[key];
+    if (!flags)
+    {
+        BuildConfiguration effective = base;
+        effective.optimization = *key.optimization;
+        effective.debug_info = *key.debug_info;
+        effective.defines.insert(effective.defines.end(), key.defines.begin(),
+                                 key.defines.end());
+        auto generated = std::make_shared<std::vector<std::string>>();
+        m_generate(*generated, effective);
+        flags = std::move(generated);
+    }
+    return flags;
+}
+
 // --- MsvcToolchain 实现 ---
 
 MsvcToolchain::MsvcToolchain(path cl_path, path link_path,
                              BuildConfiguration config)
     : m_cl_path(std::move(cl_path)), m_link_path(std::move(link_path)),
-      m_config(std::move(config))
+      m_config(std::move(config)),
+      m_compile_flags(add_common_msvc_compile_options)
 {
 }
 
+CompileFlags MsvcToolchain::compile_flags(
+    const ConfigurationOverride& configuration) const
+{
+    return m_compile_flags.get(m_config, configuration);
+}
+
+unsigned MsvcToolchain::link_jobs() const
+{
+    if (m_config.lto == LtoMode::Off)
+    {
+        return 1;
+    }
+    return m_config.lto_jobs > 0
+               ? std::min(m_config.lto_jobs, kMsvcMaxCodegenThreads)
+               : kMsvcDefaultCodegenThreads;
+}
+
 std::optional<Command> MsvcToolchain::generate_emit_ifc_command(
     const EmitIFCArgs& args) const
 {
     Command cmd;
     cmd.executable = m_cl_path;
-    add_common_msvc_compile_options(cmd.arguments, m_config);
-    cmd.arguments.push_back("/interface");
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back(args.internal_partition ? "/internalPartition"
+                                                    : "/interface");
     cmd.arguments.push_back(args.interface_unit_path.string());
     cmd.arguments.push_back("/ifcOutput");
     cmd.arguments.push_back(args.output_ifc_path.string());
-    auto obj_path = args.output_ifc_path.parent_path() /
-                    (args.output_ifc_path.stem().string() + ".obj");
+    auto obj_path = args.output_obj_path.empty()
+                        ? args.output_ifc_path.parent_path() /
+                              (args.output_ifc_path.stem().string() + ".obj")
+                        : args.output_obj_path;
     cmd.arguments.push_back("/Fo:" + obj_path.string());
     for (const auto& dep : args.module_dependencies)
     {
         cmd.arguments.push_back("/reference");
         cmd.arguments.push_back(dep.name + "=" + dep.ifc_path.string());
     }
+    add_msvc_dependency_options(cmd.arguments, args.dependency_file);
     return cmd;
 }
 
@@ -255,7 +681,7 @@ std::optional<Command> MsvcToolchain::generate_compile_obj_command(
 {
     Command cmd;
     cmd.executable = m_cl_path;
-    add_common_msvc_compile_options(cmd.arguments, m_config);
+    cmd.arguments = *compile_flags(args.configuration);
     cmd.arguments.push_back(args.source_file.string());
     cmd.arguments.push_back("/Fo:" + args.output_obj_path.string());
     for (const auto& dep : args.module_dependencies)
@@ -263,26 +689,131 @@ std::optional<Command> MsvcToolchain::generate_compile_obj_command(
         cmd.arguments.push_back("/reference");
         cmd.arguments.push_back(dep.name + "=" + dep.ifc_path.string());
     }
+    add_msvc_pch_options(cmd.arguments, args.precompiled_header);
+    add_msvc_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+DependencyFormat MsvcToolchain::dependency_format() const
+{
+    return DependencyFormat::MsvcSourceDependencies;
+}
+
+std::optional<Command> MsvcToolchain::generate_scan_deps_command(
+    const ScanDepsArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_cl_path;
+    cmd.arguments = *compile_flags({});
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("/scanDependencies");
+    cmd.arguments.push_back(args.output_scan_path.string());
+    cmd.arguments.push_back("/Fo:" + args.output_obj_path.string());
+    return cmd;
+}
+
+std::optional<Command> MsvcToolchain::generate_emit_pch_command(
+    const EmitPchArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_cl_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back(args.stub_source.string());
+    cmd.arguments.push_back("/Yc" + args.pch.header.string());
+    cmd.arguments.push_back("/Fp" + args.pch.pch_path.string());
+    cmd.arguments.push_back("/Fo:" + args.output_obj_path.string());
+    add_msvc_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+bool MsvcToolchain::pch_emits_object() const
+{
+    return true;
+}
+
+std::optional<Command> MsvcToolchain::generate_version_command() const
+{
+    Command cmd;
+    cmd.executable = m_cl_path;
+    return cmd;
+}
+
+std::optional<Command> MsvcToolchain::generate_archive_command(
+    const ArchiveArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_link_path.parent_path() /
+                     ("lib" + m_link_path.extension().string());
+    cmd.arguments.push_back("/nologo");
+    if (m_config.lto != LtoMode::Off)
+    {
+        cmd.arguments.push_back("/LTCG");
+    }
+    cmd.arguments.push_back("/OUT:" + args.output_archive_path.string());
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
     return cmd;
 }
 
 std::optional<Command> MsvcToolchain::generate_link_command(
     const LinkArgs& args) const
 {
+    const bool lto = m_config.lto != LtoMode::Off;
+    // lld-link 无法读取 /GL 写出的目标文件，LTO 时总是使用 link.exe
+    const bool lld = m_config.linker == Linker::Lld && !lto;
     Command cmd;
-    cmd.executable = m_link_path;
+    cmd.executable =
+        lld ? m_link_path.parent_path() /
+                  ("lld-link" + m_link_path.extension().string())
+            : m_link_path;
     cmd.arguments.push_back("/nologo");
     cmd.arguments.push_back("/OUT:" + args.output_target_path.string());
     if (m_config.debug_info == DebugInfo::Full)
     {
-        cmd.arguments.push_back("/DEBUG:FULL");
+        // lld-link 把 FASTLINK 当作 FULL 处理，且本身已足够快
+        cmd.arguments.push_back(m_config.fastlink_pdb && !lld
+                                    ? "/DEBUG:FASTLINK"
+                                    : "/DEBUG:FULL");
     }
-    if (m_config.mode == BuildMode::Release &&
-        m_config.debug_info == DebugInfo::Full)
+    const bool optimize_references = m_config.mode == BuildMode::Release &&
+                                     m_config.debug_info == DebugInfo::Full;
+    if (optimize_references)
     {
         cmd.arguments.push_back("/OPT:REF");
         cmd.arguments.push_back("/OPT:ICF");
     }
+    if (lto)
+    {
+        // 增量 LTCG 在输出旁保留 .iobj/.ipdb，只重新生成变化的函数
+        cmd.arguments.push_back(m_config.lto == LtoMode::Thin
+                                    ? "/LTCG:INCREMENTAL"
+                                    : "/LTCG");
+        if (m_config.lto_jobs > 0)
+        {
+            cmd.arguments.push_back("/CGTHREADS:" +
+                                    std::to_string(link_jobs()));
+        }
+    }
+    if (lld)
+    {
+        // lld-link 不支持增量链接
+        if (m_config.link_threads > 0)
+        {
+            cmd.arguments.push_back("/threads:" +
+                                    std::to_string(m_config.link_threads));
+        }
+    }
+    else if (m_config.incremental_link && !optimize_references && !lto)
+    {
+        cmd.arguments.push_back("/INCREMENTAL");
+    }
+    else if (m_config.debug_info == DebugInfo::Full)
+    {
+        // /DEBUG 默认启用增量链接
+        cmd.arguments.push_back("/INCREMENTAL:NO");
+    }
     for (const auto& dir : m_config.library_dirs)
     {
         cmd.arguments.push_back("/LIBPATH:\"" + dir.string() + "\"");
@@ -301,31 +832,45 @@ std::optional<Command> MsvcToolchain::generate_link_command(
 // --- ClangToolchain 完整实现 ---
 
 ClangToolchain::ClangToolchain(path clang_cl_path, BuildConfiguration config)
-    : m_clang_cl_path(std::move(clang_cl_path)), m_config(std::move(config))
+    : m_clang_cl_path(std::move(clang_cl_path)), m_config(std::move(config)),
+      m_compile_flags(add_common_clang_compile_options)
 {
 }
 
+CompileFlags ClangToolchain::compile_flags(
+    const ConfigurationOverride& configuration) const
+{
+    return m_compile_flags.get(m_config, configuration);
+}
+
+unsigned ClangToolchain::link_jobs() const
+{
+    return m_config.lto == LtoMode::Thin ? lto_backend_jobs(m_config) : 1;
+}
+
 std::optional<Command> ClangToolchain::generate_emit_ifc_command(
     const EmitIFCArgs& args) const
 {
     Command cmd;
     cmd.executable = m_clang_cl_path;
-    add_common_clang_compile_options(cmd.arguments, m_config);
-    cmd.arguments.push_back("--precompile");
-    cmd.arguments.push_back("-x");
-    cmd.arguments.push_back("c++-module");
-    cmd.arguments.push_back(args.interface_unit_path.string());
-    path pcm_path = args.output_ifc_path;
-    pcm_path.replace_extension(".pcm");
-    cmd.arguments.push_back("-o");
-    cmd.arguments.push_back(pcm_path.string());
-    for (const auto& dep : args.module_dependencies)
+    cmd.arguments = *compile_flags(args.configuration);
+    const path pcm_path = get_bmi_path(args.output_ifc_path);
+    if (writes_reduced_bmi())
     {
-        path dep_pcm_path = dep.ifc_path;
-        dep_pcm_path.replace_extension(".pcm");
-        cmd.arguments.push_back("-fmodule-file=" + dep.name + "=" +
-                                dep_pcm_path.string());
+        add_one_phase_interface_options(cmd.arguments, args, pcm_path,
+                                        writes_reduced_bmi());
+    }
+    else
+    {
+        cmd.arguments.push_back("--precompile");
+        cmd.arguments.push_back("-x");
+        cmd.arguments.push_back("c++-module");
+        cmd.arguments.push_back(args.interface_unit_path.string());
+        cmd.arguments.push_back("-o");
+        cmd.arguments.push_back(pcm_path.string());
     }
+    add_clang_module_references(cmd.arguments, args.module_dependencies);
+    add_clang_cl_dependency_options(cmd.arguments, args.dependency_file);
     return cmd;
 }
 
@@ -334,18 +879,14 @@ std::optional<Command> ClangToolchain::generate_compile_obj_command(
 {
     Command cmd;
     cmd.executable = m_clang_cl_path;
-    add_common_clang_compile_options(cmd.arguments, m_config);
+    cmd.arguments = *compile_flags(args.configuration);
     cmd.arguments.push_back("-c");
     cmd.arguments.push_back(args.source_file.string());
     cmd.arguments.push_back("-o");
     cmd.arguments.push_back(args.output_obj_path.string());
-    for (const auto& dep : args.module_dependencies)
-    {
-        path dep_pcm_path = dep.ifc_path;
-        dep_pcm_path.replace_extension(".pcm");
-        cmd.arguments.push_back("-fmodule-file=" + dep.name + "=" +
-                                dep_pcm_path.string());
-    }
+    add_clang_module_references(cmd.arguments, args.module_dependencies);
+    add_msvc_pch_options(cmd.arguments, args.precompiled_header);
+    add_clang_cl_dependency_options(cmd.arguments, args.dependency_file);
     return cmd;
 }
 
@@ -360,10 +901,11 @@ std::optional<Command> ClangToolchain::generate_link_command(
     {
         cmd.arguments.push_back("-g");
     }
-    for (const auto& dir : m_config.library_dirs)
+    if (uses_lld_link(m_config))
     {
-        cmd.arguments.push_back("-L" + dir.string());
+        cmd.arguments.push_back("-fuse-ld=lld"); // 即 lld-link
     }
+    add_clang_lto_options(cmd.arguments, m_config);
     for (const auto& obj : args.object_files)
     {
         cmd.arguments.push_back(obj.string());
@@ -373,6 +915,103 @@ std::optional<Command> ClangToolchain::generate_link_command(
     {
         cmd.arguments.push_back(lib);
     }
+    const auto linker_options =
+        clang_cl_linker_options(m_config, args);
+    if (!linker_options.empty())
+    {
+        cmd.arguments.push_back("/link");
+        cmd.arguments.insert(cmd.arguments.end(), linker_options.begin(),
+                             linker_options.end());
+    }
+    return cmd;
+}
+
+bool ClangToolchain::emit_ifc_writes_object() const
+{
+    return m_config.reduced_bmi;
+}
+
+bool ClangToolchain::writes_reduced_bmi() const
+{
+    return m_config.reduced_bmi;
+}
+
+std::optional<Command> ClangToolchain::generate_archive_command(
+    const ArchiveArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clang_cl_path.parent_path() /
+                     ("llvm-ar" + m_clang_cl_path.extension().string());
+    // r 只替换同名成员，调用方须先删除旧库以免残留已移除的成员
+    cmd.arguments.push_back(args.thin ? "rcsT" : "rcs");
+    cmd.arguments.push_back(args.output_archive_path.string());
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
+    return cmd;
+}
+
+path ClangToolchain::archive_file_name(const std::string& name) const
+{
+    return "lib" + name + ".a";
+}
+
+path ClangToolchain::get_bmi_path(const path& ifc_path) const
+{
+    path pcm_path = ifc_path;
+    pcm_path.replace_extension(".pcm");
+    return pcm_path;
+}
+
+std::optional<Command> ClangToolchain::generate_scan_deps_command(
+    const ScanDepsArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clang_cl_path.parent_path() /
+                     ("clang-scan-deps" +
+                      m_clang_cl_path.extension().string());
+    cmd.arguments.push_back("-format=p1689");
+    cmd.arguments.push_back("--");
+    cmd.arguments.push_back(m_clang_cl_path.string());
+    const auto flags = compile_flags({});
+    cmd.arguments.insert(cmd.arguments.end(), flags->begin(), flags->end());
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    add_clang_cl_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> ClangToolchain::generate_emit_pch_command(
+    const EmitPchArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clang_cl_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back(args.stub_source.string());
+    cmd.arguments.push_back("/Yc" + args.pch.header.string());
+    cmd.arguments.push_back("/Fp" + args.pch.pch_path.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    add_clang_cl_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+bool ClangToolchain::pch_emits_object() const
+{
+    return true;
+}
+
+std::optional<Command> ClangToolchain::generate_version_command() const
+{
+    Command cmd;
+    cmd.executable = m_clang_cl_path;
+    cmd.arguments.push_back("--version");
     return cmd;
 }
 
@@ -382,4 +1021,335 @@ std::optional<Command> ClangToolchain::generate_pcm_command(
     // 此函数的职责已与 generate_emit_ifc_command 合并，直接调用它即可
     return this->generate_emit_ifc_command(args);
 }
-}
\ No newline at end of file
+
+// --- ClangxxToolchain 实现 ---
+
+ClangxxToolchain::ClangxxToolchain(path clangxx_path,
+                                   BuildConfiguration config,
+                                   InterfaceCompilation interface_compilation)
+    : m_clangxx_path(std::move(clangxx_path)), m_config(std::move(config)),
+      m_compile_flags(add_clangxx_compile_options),
+      m_interface_compilation(interface_compilation)
+{
+}
+
+CompileFlags ClangxxToolchain::compile_flags(
+    const ConfigurationOverride& configuration) const
+{
+    return m_compile_flags.get(m_config, configuration);
+}
+
+unsigned ClangxxToolchain::link_jobs() const
+{
+    return m_config.lto == LtoMode::Thin ? lto_backend_jobs(m_config) : 1;
+}
+
+std::optional<Command> ClangxxToolchain::generate_emit_ifc_command(
+    const EmitIFCArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clangxx_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    const path pcm_path = get_bmi_path(args.output_ifc_path);
+    if (m_interface_compilation == InterfaceCompilation::OnePhase)
+    {
+        add_one_phase_interface_options(cmd.arguments, args, pcm_path,
+                                        writes_reduced_bmi());
+    }
+    else
+    {
+        cmd.arguments.push_back("--precompile");
+        cmd.arguments.push_back("-x");
+        cmd.arguments.push_back("c++-module");
+        cmd.arguments.push_back(args.interface_unit_path.string());
+        cmd.arguments.push_back("-o");
+        cmd.arguments.push_back(pcm_path.string());
+    }
+    add_clang_module_references(cmd.arguments, args.module_dependencies);
+    add_clang_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> ClangxxToolchain::generate_compile_obj_command(
+    const CompileObjectArgs& args) const
+{
+    // source_file 为 .pcm 时（TwoPhase 的第二步）clang 按扩展名识别
+    Command cmd;
+    cmd.executable = m_clangxx_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    add_clang_module_references(cmd.arguments, args.module_dependencies);
+    add_clang_pch_options(cmd.arguments, args.precompiled_header);
+    add_clang_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> ClangxxToolchain::generate_link_command(
+    const LinkArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clangxx_path;
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_target_path.string());
+    if (m_config.debug_info == DebugInfo::Full)
+    {
+        cmd.arguments.push_back("-g");
+    }
+    add_gnu_linker_options(cmd.arguments, m_config);
+    add_clang_lto_link_options(cmd.arguments, m_config, args);
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
+    add_gnu_link_libraries(cmd.arguments, args.link_libraries);
+    return cmd;
+}
+
+path ClangxxToolchain::get_bmi_path(const path& ifc_path) const
+{
+    path pcm_path = ifc_path;
+    pcm_path.replace_extension(".pcm");
+    return pcm_path;
+}
+
+std::optional<Command> ClangxxToolchain::generate_scan_deps_command(
+    const ScanDepsArgs& args) const
+{
+    Command cmd;
+    cmd.executable = sibling_tool(m_clangxx_path, "clang++", "clang-scan-deps");
+    cmd.arguments.push_back("-format=p1689");
+    cmd.arguments.push_back("--");
+    cmd.arguments.push_back(m_clangxx_path.string());
+    const auto flags = compile_flags({});
+    cmd.arguments.insert(cmd.arguments.end(), flags->begin(), flags->end());
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    add_clang_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> ClangxxToolchain::generate_emit_pch_command(
+    const EmitPchArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_clangxx_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++-header");
+    cmd.arguments.push_back(args.pch.header.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.pch.pch_path.string());
+    add_clang_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> ClangxxToolchain::generate_version_command() const
+{
+    Command cmd;
+    cmd.executable = m_clangxx_path;
+    cmd.arguments.push_back("--version");
+    return cmd;
+}
+
+bool ClangxxToolchain::emit_ifc_writes_object() const
+{
+    return m_interface_compilation == InterfaceCompilation::OnePhase;
+}
+
+bool ClangxxToolchain::writes_reduced_bmi() const
+{
+    return m_config.reduced_bmi &&
+           m_interface_compilation == InterfaceCompilation::OnePhase;
+}
+
+std::optional<Command> ClangxxToolchain::generate_archive_command(
+    const ArchiveArgs& args) const
+{
+    Command cmd;
+    cmd.executable = sibling_tool(m_clangxx_path, "clang++", "llvm-ar");
+    cmd.arguments.push_back(args.thin ? "rcsT" : "rcs");
+    cmd.arguments.push_back(args.output_archive_path.string());
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
+    return cmd;
+}
+
+path ClangxxToolchain::archive_file_name(const std::string& name) const
+{
+    return "lib" + name + ".a";
+}
+
+// --- GccToolchain 实现 ---
+
+namespace
+{
+// GCC 的依赖文件默认还包含 CMI 与 .c++-module 伪目标的规则，只保留头文件
+void add_gcc_dependency_options(std::vector<std::string>& args,
+                                const path& dependency_file)
+{
+    add_clang_dependency_options(args, dependency_file);
+    if (!dependency_file.empty())
+    {
+        args.push_back("-Mno-modules");
+    }
+}
+
+// ident 与该动作的 primary_output 一致，映射器据此找到对应的编译
+std::string gcc_module_mapper_option(const std::string& mapper,
+                                     const path& primary_output)
+{
+    return "-fmodule-mapper=" + mapper + "?" +
+           primary_output.generic_string();
+}
+
+} // namespace
+
+GccToolchain::GccToolchain(path gxx_path, BuildConfiguration config,
+                           std::string module_mapper)
+    : m_gxx_path(std::move(gxx_path)), m_config(std::move(config)),
+      m_compile_flags(add_gcc_compile_options),
+      m_module_mapper(std::move(module_mapper))
+{
+}
+
+CompileFlags GccToolchain::compile_flags(
+    const ConfigurationOverride& configuration) const
+{
+    return m_compile_flags.get(m_config, configuration);
+}
+
+unsigned GccToolchain::link_jobs() const
+{
+    return m_config.lto == LtoMode::Off ? 1 : lto_backend_jobs(m_config);
+}
+
+std::optional<Command> GccToolchain::generate_emit_ifc_command(
+    const EmitIFCArgs& args) const
+{
+    // 一次编译同时写出 CMI 与目标文件，CMI 的位置由映射器给出
+    Command cmd;
+    cmd.executable = m_gxx_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back("-fmodules-ts");
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back(args.interface_unit_path.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    cmd.arguments.push_back(
+        gcc_module_mapper_option(m_module_mapper, args.output_ifc_path));
+    add_gcc_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> GccToolchain::generate_compile_obj_command(
+    const CompileObjectArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_gxx_path;
+    cmd.arguments = *compile_flags(args.configuration);
+    cmd.arguments.push_back("-fmodules-ts");
+    cmd.arguments.push_back("-c");
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_obj_path.string());
+    cmd.arguments.push_back(
+        gcc_module_mapper_option(m_module_mapper, args.output_obj_path));
+    add_gcc_dependency_options(cmd.arguments, args.dependency_file);
+    return cmd;
+}
+
+std::optional<Command> GccToolchain::generate_link_command(
+    const LinkArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_gxx_path;
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(args.output_target_path.string());
+    add_gnu_linker_options(cmd.arguments, m_config);
+    if (m_config.lto != LtoMode::Off)
+    {
+        // 并行编译 LTRANS 分区；auto 时使用 make 的 jobserver 或全部 CPU
+        cmd.arguments.push_back(
+            m_config.lto_jobs > 0
+                ? "-flto=" + std::to_string(m_config.lto_jobs)
+                : "-flto=auto");
+    }
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
+    add_gnu_link_libraries(cmd.arguments, args.link_libraries);
+    return cmd;
+}
+
+path GccToolchain::get_bmi_path(const path& ifc_path) const
+{
+    path gcm_path = ifc_path;
+    gcm_path.replace_extension(".gcm");
+    return gcm_path;
+}
+
+std::optional<Command> GccToolchain::generate_scan_deps_command(
+    const ScanDepsArgs& args) const
+{
+    Command cmd;
+    cmd.executable = m_gxx_path;
+    cmd.arguments = *compile_flags({});
+    cmd.arguments.push_back("-fmodules-ts");
+    cmd.arguments.push_back("-E");
+    cmd.arguments.push_back("-x");
+    cmd.arguments.push_back("c++");
+    cmd.arguments.push_back(args.source_file.string());
+    cmd.arguments.push_back("-fdeps-format=p1689r5");
+    cmd.arguments.push_back("-fdeps-file=" + args.output_scan_path.string());
+    cmd.arguments.push_back("-fdeps-target=" +
+                            args.output_obj_path.string());
+    add_gcc_dependency_options(cmd.arguments, args.dependency_file);
+    // 预处理结果本身不需要，但 -E 必须有输出位置
+    path preprocessed = args.output_scan_path;
+    preprocessed += ".ii";
+    cmd.arguments.push_back("-o");
+    cmd.arguments.push_back(preprocessed.string());
+    return cmd;
+}
+
+std::optional<Command> GccToolchain::generate_version_command() const
+{
+    Command cmd;
+    cmd.executable = m_gxx_path;
+    cmd.arguments.push_back("--version");
+    return cmd;
+}
+
+std::optional<Command> GccToolchain::generate_archive_command(
+    const ArchiveArgs& args) const
+{
+    Command cmd;
+    cmd.executable = sibling_tool(m_gxx_path, "g++", "gcc-ar");
+    cmd.arguments.push_back(args.thin ? "rcsT" : "rcs");
+    cmd.arguments.push_back(args.output_archive_path.string());
+    for (const auto& obj : args.object_files)
+    {
+        cmd.arguments.push_back(obj.string());
+    }
+    return cmd;
+}
+
+path GccToolchain::archive_file_name(const std::string& name) const
+{
+    return "lib" + name + ".a";
+}
+}
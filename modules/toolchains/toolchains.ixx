@@ -55,6 +55,23 @@ export enum class CppStandard
     CppLatest
 };
 
+export enum class Linker
+{
+    Default, // 驱动程序或 link.exe 的默认链接器
+    Lld,     // clang: -fuse-ld=lld；MSVC: 与 link.exe 同目录的 lld-link
+    Mold     // 仅用于 ELF 目标，MSVC 与 clang-cl 工具链忽略此项
+};
+
+// 链接时优化
+export enum class LtoMode
+{
+    Off,
+    Full, // clang/gcc: -flto；MSVC: /GL + /LTCG
+    // clang: -flto=thin，后端按模块并行，且可缓存未变模块的代码生成结果；
+    // MSVC: /GL + /LTCG:INCREMENTAL；GCC 没有 ThinLTO，按 Full 处理
+    Thin
+};
+
 export struct BuildConfiguration
 {
     BuildMode mode;
@@ -66,8 +83,43 @@ export struct BuildConfiguration
     std::vector<path> include_dirs;
     std::vector<path> library_dirs;
     std::vector<std::string> defines;
+
+    // 链接设置
+    Linker linker = Linker::Default;
+    unsigned link_threads = 0; // 链接器线程数，0 表示由链接器决定
+    // MSVC /INCREMENTAL：只修补变化的目标文件；与 /OPT:REF 互斥，Release 中无效
+    bool incremental_link = false;
+    // MSVC /DEBUG:FASTLINK：PDB 只引用目标文件中的调试信息而不合并，
+    // 链接更快，但调试时目标文件必须仍在原处
+    bool fastlink_pdb = false;
+
+    // 链接时优化：编译选项与链接选项同时生效，所有目标文件须使用同一模式
+    LtoMode lto = LtoMode::Off;
+    // 并行的 LTO 后端数（ThinLTO 后端、GCC LTRANS、MSVC /CGTHREADS），
+    // 0 表示由链接器决定。链接动作按此数占用 Builder 的任务槽
+    unsigned lto_jobs = 0;
+
+    // Clang 写出精简 BMI（-fmodules-reduced-bmi）：不含非内联函数体等
+    // 实现细节，只改实现的编辑不改变其接口指纹，导入者加载也更快。
+    // 需要一次编译同时写出目标文件与 BMI，其他工具链忽略此项
+    bool reduced_bmi = false;
 };
 
+// 单个模块对 BuildConfiguration 的覆盖（见 ModuleUnit::configuration），
+// 未设置的项沿用工具链的配置。例如热点数值模块使用 O3，测试辅助模块使用
+// O1 与最少的调试信息，以构建时间换取运行速度。Debug 模式始终不优化
+export struct ConfigurationOverride
+{
+    std::optional<OptimizationLevel> optimization;
+    std::optional<DebugInfo> debug_info;
+    std::vector<std::string> defines; // 追加在全局宏定义之后
+
+    auto operator<=>(const ConfigurationOverride&) const = default;
+};
+
+// 只读的公共编译选项，同一有效配置的所有动作共享同一份
+export using CompileFlags = std::shared_ptr<const std::vector<std::string>>;
+
 export struct BuildConfigurationFactory
 {
     static BuildConfiguration create_debug_default();
@@ -75,6 +127,13 @@ export struct BuildConfigurationFactory
     static BuildConfiguration create_release_with_debug_info();
 };
 
+// 编译器输出的头文件依赖信息格式
+export enum class DependencyFormat
+{
+    Makefile,               // clang/gcc 的 -MD -MF 依赖文件
+    MsvcSourceDependencies  // MSVC 的 /sourceDependencies JSON
+};
+
 // --- 数据传输结构体 (无改动) ---
 
 export struct ModuleReference
@@ -83,11 +142,32 @@ export struct ModuleReference
     path ifc_path;
 };
 
+// 预编译头：header 为被预编译的头文件，pch_path 为预编译产物
+export struct PrecompiledHeader
+{
+    path header;
+    path pch_path;
+};
+
+export struct EmitPchArgs
+{
+    PrecompiledHeader pch;
+    // 只包含 header 的源文件（MSVC 与 clang-cl 以 /Yc 编译它）
+    path stub_source;
+    path output_obj_path; // /Yc 创建 PCH 时同时写出的目标文件
+    path dependency_file; // 非空时要求编译器写出头文件依赖
+    ConfigurationOverride configuration; // 使用者所在模块的配置覆盖
+};
+
 export struct EmitIFCArgs
 {
     path interface_unit_path;
     path output_ifc_path;
+    path output_obj_path; // 同时写出的目标文件，见 emit_ifc_writes_object
     std::vector<ModuleReference> module_dependencies;
+    bool internal_partition = false; // "module M:P;" 实现分区（MSVC 需区分）
+    path dependency_file; // 非空时要求编译器写出头文件依赖
+    ConfigurationOverride configuration; // 所在模块的配置覆盖
 };
 
 export struct CompileObjectArgs
@@ -95,13 +175,44 @@ export struct CompileObjectArgs
     path source_file;
     path output_obj_path;
     std::vector<ModuleReference> module_dependencies;
+    path dependency_file; // 非空时要求编译器写出头文件依赖
+    // 只用于以普通 C++ 方式编译的实现单元：PCH 与其创建时的编译选项一致，
+    // 且接口单元的全局模块片段之前不能注入任何内容
+    std::optional<PrecompiledHeader> precompiled_header;
+    ConfigurationOverride configuration; // 所在模块的配置覆盖
+};
+
+// P1689 依赖扫描的参数
+export struct ScanDepsArgs
+{
+    path source_file;
+    path output_obj_path;  // 扫描规则中的 primary-output
+    path output_scan_path; // 写出 P1689 JSON 的位置（部分扫描器写到标准输出）
+    // 非空时要求同时写出扫描读取的头文件（格式见 dependency_format），
+    // 不能在扫描时写出的工具链（MSVC）忽略此项
+    path dependency_file;
 };
 
 export struct LinkArgs
 {
-    std::vector<path> object_files;
+    std::vector<path> object_files; // 目标文件与静态库
     path output_target_path; // .exe 或 .lib
     std::vector<std::string> link_libraries;
+    // ThinLTO 缓存目录：增量链接时未改变的模块复用上次的代码生成结果。
+    // 由 ProjectProcessor 放在构建目录下，其他 LTO 模式忽略此项
+    path lto_cache_dir;
+    // 各模块覆盖中最高的优化级别。LTO 在链接时生成代码，链接命令取它与
+    // 工具链配置中较高的一个，模块的 O3 覆盖不会被降为链接器默认的 O2
+    std::optional<OptimizationLevel> optimization;
+};
+
+// 把一个模块的目标文件打包为静态库
+export struct ArchiveArgs
+{
+    std::vector<path> object_files;
+    path output_archive_path;
+    // 瘦归档只记录成员路径而不复制内容，链接时成员文件必须仍在原处
+    bool thin = true;
 };
 
 // --- 抽象接口 (修改点) ---
@@ -122,10 +233,114 @@ export class IToolchain
     // 修改点：移除了 config 参数
     virtual std::optional<executor::Command> generate_link_command(
         const LinkArgs& args) const = 0;
+
+    // 返回工具链针对给定 IFC 路径实际写出的 BMI 文件路径
+    virtual path get_bmi_path(const path& ifc_path) const
+    {
+        return ifc_path;
+    }
+
+    // 返回 dependency_file 的格式
+    virtual DependencyFormat dependency_format() const
+    {
+        return DependencyFormat::Makefile;
+    }
+
+    // 生成 P1689 模块依赖扫描命令；不支持扫描的工具链返回 nullopt
+    virtual std::optional<executor::Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const
+    {
+        return std::nullopt;
+    }
+
+    // 生成预编译头的创建命令；不支持预编译头的工具链返回 nullopt
+    virtual std::optional<executor::Command> generate_emit_pch_command(
+        const EmitPchArgs& args) const
+    {
+        return std::nullopt;
+    }
+
+    // 创建 PCH 时是否写出需要参与链接的 output_obj_path
+    virtual bool pch_emits_object() const
+    {
+        return false;
+    }
+
+    // 生成打印编译器版本的命令，其输出用于区分编译器版本（例如缓存的键）
+    virtual std::optional<executor::Command> generate_version_command() const
+    {
+        return std::nullopt;
+    }
+
+    // 编译主接口的命令是否同时写出 EmitIFCArgs::output_obj_path；
+    // 为 false 时另行把 BMI 编译为目标文件
+    virtual bool emit_ifc_writes_object() const
+    {
+        return true;
+    }
+
+    // 写出的 BMI 是否只含接口；为 true 时以接口指纹（见 bmi_fingerprint）
+    // 而非文件内容判断重新生成的 BMI 是否使导入者失效
+    virtual bool writes_reduced_bmi() const
+    {
+        return false;
+    }
+
+    // 应用 configuration 后的公共编译选项。每种有效配置只生成一次，
+    // 结果相同的覆盖返回同一份列表；不按配置生成选项的工具链返回 nullptr
+    virtual CompileFlags compile_flags(
+        const ConfigurationOverride& configuration) const
+    {
+        return nullptr;
+    }
+
+    // 链接命令同时占用的 CPU 数（例如并行的 LTO 后端），Builder 把链接
+    // 动作按此数计入任务槽，避免与编译动作一起超额占用 CPU
+    virtual unsigned link_jobs() const
+    {
+        return 1;
+    }
+
+    // 生成静态库的打包命令；不支持的工具链返回 nullopt
+    virtual std::optional<executor::Command> generate_archive_command(
+        const ArchiveArgs& args) const
+    {
+        return std::nullopt;
+    }
+
+    // 模块 name 的静态库文件名
+    virtual path archive_file_name(const std::string& name) const
+    {
+        return name + ".lib";
+    }
 };
 
 // --- 具体工具链声明 (修改点) ---
 
+// 各工具链内部的编译选项缓存：以覆盖后的有效配置为键。工具链被复制时
+// 副本共享同一缓存（基础配置相同）
+class CompileFlagCache
+{
+  public:
+    using Generator = void (*)(std::vector<std::string>&,
+                               const BuildConfiguration&);
+
+    explicit CompileFlagCache(Generator generate);
+
+    CompileFlags get(const BuildConfiguration& base,
+                     const ConfigurationOverride& configuration) const;
+
+  private:
+    struct State
+    {
+        std::mutex mutex;
+        std::map<ConfigurationOverride, CompileFlags> flags;
+    };
+
+    Generator m_generate;
+    std::shared_ptr<State> m_state;
+};
+
 export class MsvcToolchain final : public IToolchain
 {
   public:
@@ -142,10 +357,36 @@ export class MsvcToolchain final : public IToolchain
     std::optional<executor::Command> generate_link_command(
         const LinkArgs& args) const override;
 
+    CompileFlags compile_flags(
+        const ConfigurationOverride& configuration) const override;
+
+    // 启用 LTO 时为代码生成线程数（/CGTHREADS，link.exe 默认 4，至多 8）
+    unsigned link_jobs() const override;
+
+    DependencyFormat dependency_format() const override;
+
+    std::optional<executor::Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override;
+
+    std::optional<executor::Command> generate_emit_pch_command(
+        const EmitPchArgs& args) const override;
+
+    // /Yc 写出的目标文件带有 PCH 的调试类型信息，必须参与链接
+    bool pch_emits_object() const override;
+
+    // 不带参数运行 cl，版本横幅写到标准错误
+    std::optional<executor::Command> generate_version_command() const override;
+
+    // 使用与 link.exe 同目录的 lib.exe；lib.exe 不支持瘦归档，thin 被忽略。
+    // 启用 LTO 时加 /LTCG，以免 lib.exe 警告 /GL 目标文件
+    std::optional<executor::Command> generate_archive_command(
+        const ArchiveArgs& args) const override;
+
   private:
     path m_cl_path;
     path m_link_path;
     BuildConfiguration m_config; // 修改点：新增成员变量
+    CompileFlagCache m_compile_flags;
 };
 
 export class ClangToolchain final : public IToolchain
@@ -164,6 +405,39 @@ export class ClangToolchain final : public IToolchain
     std::optional<executor::Command> generate_link_command(
         const LinkArgs& args) const override;
 
+    CompileFlags compile_flags(
+        const ConfigurationOverride& configuration) const override;
+
+    // ThinLTO 时为并行后端数；完整 LTO 的代码生成是单线程的
+    unsigned link_jobs() const override;
+
+    // Clang 的 BMI 为 .pcm 文件
+    path get_bmi_path(const path& ifc_path) const override;
+
+    // 使用与 clang 同目录的 clang-scan-deps，结果写到标准输出
+    std::optional<executor::Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override;
+
+    // 与 MSVC 相同，以 /Yc 创建、以 /Yu 使用预编译头
+    std::optional<executor::Command> generate_emit_pch_command(
+        const EmitPchArgs& args) const override;
+
+    bool pch_emits_object() const override;
+
+    std::optional<executor::Command> generate_version_command() const override;
+
+    // --precompile 只写出 .pcm，目标文件由 .pcm 另行编译；
+    // 启用 reduced_bmi 时改为一次编译同时写出两者
+    bool emit_ifc_writes_object() const override;
+
+    bool writes_reduced_bmi() const override;
+
+    // 使用与 clang 同目录的 llvm-ar
+    std::optional<executor::Command> generate_archive_command(
+        const ArchiveArgs& args) const override;
+
+    path archive_file_name(const std::string& name) const override;
+
     // Clangd 支持的专属功能
     std::optional<executor::Command> generate_pcm_command(
         const EmitIFCArgs& args) const;
@@ -171,6 +445,123 @@ export class ClangToolchain final : public IToolchain
   private:
     path m_clang_cl_path;
     BuildConfiguration m_config; // 修改点：新增成员变量
+    CompileFlagCache m_compile_flags;
+};
+
+// 原生 clang++ 编译模块接口单元的方式
+export enum class InterfaceCompilation
+{
+    // 一次编译同时写出目标文件与 .pcm（-fmodule-output），接口只解析一次
+    OnePhase,
+    // 先 --precompile 出 .pcm，再由 .pcm 编译目标文件；依赖方只需等待
+    // 第一步，可以更早开始，但接口的前端工作做了两遍
+    TwoPhase
+};
+
+// 原生 clang++（Unix 风格驱动程序，不带 MSVC 兼容选项）
+export class ClangxxToolchain final : public IToolchain
+{
+  public:
+    ClangxxToolchain(path clangxx_path, BuildConfiguration config,
+                     InterfaceCompilation interface_compilation =
+                         InterfaceCompilation::OnePhase);
+    ~ClangxxToolchain() override = default;
+
+    std::optional<executor::Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override;
+
+    std::optional<executor::Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override;
+
+    std::optional<executor::Command> generate_link_command(
+        const LinkArgs& args) const override;
+
+    CompileFlags compile_flags(
+        const ConfigurationOverride& configuration) const override;
+
+    // ThinLTO 时为并行后端数；完整 LTO 的代码生成是单线程的
+    unsigned link_jobs() const override;
+
+    // BMI 为 .pcm 文件
+    path get_bmi_path(const path& ifc_path) const override;
+
+    // 使用与 clang++ 同目录、同后缀的 clang-scan-deps，结果写到标准输出
+    std::optional<executor::Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override;
+
+    std::optional<executor::Command> generate_emit_pch_command(
+        const EmitPchArgs& args) const override;
+
+    std::optional<executor::Command> generate_version_command() const override;
+
+    // 仅 OnePhase 时为 true
+    bool emit_ifc_writes_object() const override;
+
+    // 精简 BMI 只能在 OnePhase 中生成：TwoPhase 的 .pcm 还要编译出目标文件
+    bool writes_reduced_bmi() const override;
+
+    // 使用与 clang++ 同目录、同后缀的 llvm-ar（例如 clang++-18 对应
+    // llvm-ar-18）
+    std::optional<executor::Command> generate_archive_command(
+        const ArchiveArgs& args) const override;
+
+    path archive_file_name(const std::string& name) const override;
+
+  private:
+    path m_clangxx_path;
+    BuildConfiguration m_config;
+    CompileFlagCache m_compile_flags;
+    InterfaceCompilation m_interface_compilation;
+};
+
+// GCC（-fmodules-ts）。GCC 不接受逐个模块的 BMI 路径参数，而是在编译过程中
+// 通过模块映射器协议询问每个 import/export 的 CMI 位置。命令只携带
+// -fmodule-mapper=<module_mapper>?<ident>，ident 为该动作的 primary_output，
+// 映射器（见 gcc_module_mapper 模块）据此从构建图中查找答案。
+export class GccToolchain final : public IToolchain
+{
+  public:
+    // module_mapper 为 -fmodule-mapper 的端点，例如 "=/tmp/mapper.sock"
+    // （Unix 域套接字）或 "localhost:5000"
+    GccToolchain(path gxx_path, BuildConfiguration config,
+                 std::string module_mapper);
+    ~GccToolchain() override = default;
+
+    std::optional<executor::Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override;
+
+    std::optional<executor::Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override;
+
+    std::optional<executor::Command> generate_link_command(
+        const LinkArgs& args) const override;
+
+    CompileFlags compile_flags(
+        const ConfigurationOverride& configuration) const override;
+
+    // 启用 LTO 时为并行的 LTRANS 进程数
+    unsigned link_jobs() const override;
+
+    // GCC 的 BMI 为 .gcm 文件
+    path get_bmi_path(const path& ifc_path) const override;
+
+    // GCC 14 起支持 -fdeps-format=p1689r5，结果写到 output_scan_path
+    std::optional<executor::Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override;
+
+    std::optional<executor::Command> generate_version_command() const override;
+
+    // 使用与 g++ 同目录、同前后缀的 gcc-ar（例如 g++-14 对应 gcc-ar-14）
+    std::optional<executor::Command> generate_archive_command(
+        const ArchiveArgs& args) const override;
+
+    path archive_file_name(const std::string& name) const override;
+
+  private:
+    path m_gxx_path;
+    BuildConfiguration m_config;
+    CompileFlagCache m_compile_flags;
+    std::string m_module_mapper;
 };
 } // namespace toolchains
 } // namespace importa
\ No newline at end of file
@@ -0,0 +1,470 @@
+// unity_build.cpp
+// 提供了合并编译规划的具体实现。
+//
+// 修改历史文件为文本格式，每行 "<历史位图> <内容哈希> <路径>"（十六进制），
+// 通过“写临时文件 + rename”整体替换。
+
+module unity_build;
+
+import std;
+import hashing;
+
+using namespace importa::unity_build;
+
+namespace
+{ // 内部辅助函数
+
+const std::regex kModuleDeclaration(
+    R"(^\s*module\s+([A-Za-z_][\w.]*)\s*;\s*$)");
+const std::regex kImport(R"(^\s*import\s+[^;]+;\s*(//.*)?$)");
+const std::regex kModuleKeyword(R"(^\s*(export\s+)?module(\s|;|$))");
+const std::regex kQuotedInclude(R"re(^(\s*#\s*include\s*)"([^"]+)"(.*)$)re");
+
+std::string key_for(const path& file)
+{
+    return file.lexically_normal().generic_string();
+}
+
+std::string_view trim(std::string_view line)
+{
+    const auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto last = line.find_last_not_of(" \t\r");
+    return line.substr(first, last - first + 1);
+}
+
+std::vector<std::string> split_lines(std::string_view text)
+{
+    std::vector<std::string> lines;
+    while (!text.empty())
+    {
+        auto newline = text.find('\n');
+        lines.emplace_back(text.substr(0, newline));
+        if (newline == std::string_view::npos)
+        {
+            break;
+        }
+        text.remove_prefix(newline + 1);
+    }
+    return lines;
+}
+
+// 跳过空行、行注释与独占若干行的块注释
+std::size_t skip_trivia(const std::vector<std::string>& lines, std::size_t i)
+{
+    while (i < lines.size())
+    {
+        auto line = trim(lines[i]);
+        if (line.empty() || line.starts_with("//"))
+        {
+            ++i;
+            continue;
+        }
+        if (!line.starts_with("/*"))
+        {
+            break;
+        }
+        while (i < lines.size() && lines[i].find("*/") == std::string::npos)
+        {
+            ++i;
+        }
+        ++i;
+    }
+    return i;
+}
+
+std::string join_lines(const std::vector<std::string>& lines,
+                       std::size_t first, std::size_t last)
+{
+    std::string text;
+    for (std::size_t i = first; i < last; ++i)
+    {
+        text += lines[i];
+        text += '\n';
+    }
+    return text;
+}
+
+std::string line_directive(std::size_t line, const path& file)
+{
+    std::string name = file.generic_string();
+    std::string escaped;
+    for (char c : name)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return "#line " + std::to_string(line) + " \"" + escaped + "\"\n";
+}
+
+// 合并单元位于构建目录，"..." 包含不再相对原文件解析，改写为绝对路径
+std::string rewrite_includes(const std::string& text, const path& source)
+{
+    std::error_code ec;
+    const path dir = std::filesystem::absolute(source, ec).parent_path();
+    std::string rewritten;
+    for (const auto& line : split_lines(text))
+    {
+        std::smatch m;
+        if (std::regex_match(line, m, kQuotedInclude) &&
+            std::filesystem::exists(dir / m[2].str(), ec))
+        {
+            const path header = (dir / m[2].str()).lexically_normal();
+            rewritten += m[1].str() + "\"" + header.generic_string() + "\"" +
+                         m[3].str();
+        }
+        else
+        {
+            rewritten += line;
+        }
+        rewritten += '\n';
+    }
+    return rewritten;
+}
+
+std::optional<std::string> read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+// 内容不变时不改写，未改动的批次保持干净
+void write_if_changed(const path& file, const std::string& content)
+{
+    if (read_file(file) == content)
+    {
+        return;
+    }
+    std::filesystem::create_directories(file.parent_path());
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out << content;
+    if (!out)
+    {
+        throw std::runtime_error("Failed to write unity source '" +
+                                 file.string() + "'.");
+    }
+}
+} // namespace
+
+// --- split_unit / compose_unity_source ---
+
+std::optional<UnitParts> importa::unity_build::split_unit(std::string_view text)
+{
+    const auto lines = split_lines(text);
+    UnitParts parts;
+
+    std::size_t i = skip_trivia(lines, 0);
+    std::size_t declaration = lines.size();
+    if (i < lines.size() && trim(lines[i]) == "module;")
+    {
+        // 全局模块片段延续到模块声明为止
+        parts.global_fragment_line = i + 2;
+        for (std::size_t j = i + 1; j < lines.size(); ++j)
+        {
+            if (std::regex_search(lines[j], kModuleKeyword))
+            {
+                declaration = j;
+                break;
+            }
+        }
+        if (declaration == lines.size())
+        {
+            return std::nullopt;
+        }
+        parts.global_fragment = join_lines(lines, i + 1, declaration);
+    }
+    else if (i < lines.size() && std::regex_search(lines[i], kModuleKeyword))
+    {
+        declaration = i;
+    }
+
+    std::size_t body = 0;
+    if (declaration < lines.size())
+    {
+        // 只接受 "module M;"：接口单元与分区不能合并
+        std::smatch m;
+        if (!std::regex_match(lines[declaration], m, kModuleDeclaration))
+        {
+            return std::nullopt;
+        }
+        parts.module_name = m[1].str();
+
+        body = declaration + 1;
+        while (true)
+        {
+            std::size_t next = skip_trivia(lines, body);
+            if (next >= lines.size() || !std::regex_match(lines[next], kImport))
+            {
+                break;
+            }
+            parts.imports.emplace_back(trim(lines[next]));
+            body = next + 1;
+        }
+    }
+
+    // 主体中若还有 import（例如被 #if 包裹），合并后会出现在其他文件的声明之后；
+    // 非模块源文件中的 import 可以出现在任何位置
+    for (std::size_t j = body; j < lines.size(); ++j)
+    {
+        if (std::regex_search(lines[j], kModuleKeyword) ||
+            (!parts.module_name.empty() && std::regex_match(lines[j], kImport)))
+        {
+            return std::nullopt;
+        }
+    }
+
+    parts.body = join_lines(lines, body, lines.size());
+    parts.body_line = body + 1;
+    return parts;
+}
+
+std::string importa::unity_build::compose_unity_source(
+    const std::vector<std::pair<path, UnitParts>>& members)
+{
+    std::string out = "// Generated by importa (unity build). Do not edit.\n";
+    if (members.empty())
+    {
+        return out;
+    }
+
+    const std::string& module_name = members.front().second.module_name;
+    if (!module_name.empty())
+    {
+        out += "module;\n";
+        for (const auto& [file, parts] : members)
+        {
+            if (parts.global_fragment_line != 0)
+            {
+                out += line_directive(parts.global_fragment_line, file);
+                out += rewrite_includes(parts.global_fragment, file);
+            }
+        }
+        out += "module " + module_name + ";\n";
+
+        std::set<std::string> seen;
+        for (const auto& [file, parts] : members)
+        {
+            for (const auto& import : parts.imports)
+            {
+                if (seen.insert(import).second)
+                {
+                    out += import + "\n";
+                }
+            }
+        }
+    }
+
+    for (const auto& [file, parts] : members)
+    {
+        out += line_directive(parts.body_line, file);
+        out += rewrite_includes(parts.body, file);
+    }
+    return out;
+}
+
+// --- ChurnTracker ---
+
+ChurnTracker::ChurnTracker(path db_path) : m_db_path(std::move(db_path))
+{
+    load();
+}
+
+void ChurnTracker::observe(const path& file, std::uint64_t content_hash)
+{
+    auto [it, inserted] = m_entries.try_emplace(key_for(file));
+    Entry& entry = it->second;
+    const bool changed = !inserted && entry.content_hash != content_hash;
+    const std::uint32_t history = (entry.history << 1) | (changed ? 1u : 0u);
+    if (inserted || history != entry.history ||
+        entry.content_hash != content_hash)
+    {
+        m_dirty = true;
+    }
+    entry.history = history;
+    entry.content_hash = content_hash;
+}
+
+std::size_t ChurnTracker::recent_changes(const path& file,
+                                         std::size_t window) const
+{
+    auto it = m_entries.find(key_for(file));
+    if (it == m_entries.end())
+    {
+        return 0;
+    }
+    const std::uint32_t mask =
+        window >= 32 ? ~0u : (1u << static_cast<unsigned>(window)) - 1;
+    return static_cast<std::size_t>(std::popcount(it->second.history & mask));
+}
+
+void ChurnTracker::save()
+{
+    if (!m_dirty)
+    {
+        return;
+    }
+    std::filesystem::create_directories(m_db_path.parent_path());
+    path temp_path = m_db_path;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << std::hex;
+        for (const auto& [key, entry] : m_entries)
+        {
+            out << entry.history << ' ' << entry.content_hash << ' ' << key
+                << '\n';
+        }
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write churn history '" +
+                                     temp_path.string() + "'.");
+        }
+    }
+    std::filesystem::rename(temp_path, m_db_path);
+    m_dirty = false;
+}
+
+void ChurnTracker::load()
+{
+    std::ifstream in(m_db_path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        Entry entry;
+        fields >> std::hex >> entry.history >> entry.content_hash;
+        fields.get(); // 分隔空格；路径本身可能含空格
+        std::string key;
+        std::getline(fields, key);
+        if (fields.fail() || key.empty())
+        {
+            continue; // 损坏的行只是丢失历史，不影响正确性
+        }
+        m_entries[key] = entry;
+    }
+}
+
+// --- UnityPlanner ---
+
+UnityPlanner::UnityPlanner(path build_dir, UnityOptions options)
+    : m_build_dir(std::move(build_dir)), m_options(options),
+      m_churn(m_build_dir / "unity_churn")
+{
+}
+
+std::vector<UnityBatch> UnityPlanner::plan(const std::string& module_name,
+                                           const std::vector<path>& sources)
+{
+    // 按路径排序，使批次划分不依赖清单中的书写顺序
+    std::vector<path> sorted = sources;
+    std::ranges::sort(sorted, {}, [](const path& p) { return key_for(p); });
+
+    std::vector<UnityBatch> batches;
+    // 同一批次中的文件必须同属一个模块（或同为非模块源文件）
+    std::map<std::string, std::vector<std::pair<path, UnitParts>>> groups;
+    std::map<std::string, std::vector<std::uintmax_t>> sizes;
+    for (const auto& file : sorted)
+    {
+        auto text = read_file(file);
+        if (!text)
+        {
+            batches.push_back({ .source = file, .members = { file } });
+            continue;
+        }
+        m_churn.observe(file, importa::hashing::hash_string(*text));
+
+        auto parts = split_unit(*text);
+        if (!parts || is_hot(file) || text->size() >= m_options.max_batch_bytes)
+        {
+            batches.push_back({ .source = file, .members = { file } });
+            continue;
+        }
+        sizes[parts->module_name].push_back(text->size());
+        groups[parts->module_name].emplace_back(file, std::move(*parts));
+    }
+
+    const path unity_dir = m_build_dir / module_name;
+    std::set<path> written;
+    auto flush = [&](std::vector<std::pair<path, UnitParts>>& batch)
+    {
+        if (batch.size() == 1)
+        {
+            const path& file = batch.front().first;
+            batches.push_back({ .source = file, .members = { file } });
+        }
+        else if (!batch.empty())
+        {
+            const path unity_file =
+                unity_dir / (module_name + ".unity" +
+                             std::to_string(written.size()) + ".cpp");
+            write_if_changed(unity_file, compose_unity_source(batch));
+            written.insert(unity_file);
+
+            UnityBatch unity{ .source = unity_file };
+            for (const auto& [file, parts] : batch)
+            {
+                unity.members.push_back(file);
+            }
+            batches.push_back(std::move(unity));
+        }
+        batch.clear();
+    };
+
+    for (auto& [name, group] : groups)
+    {
+        std::vector<std::pair<path, UnitParts>> batch;
+        std::uintmax_t batch_bytes = 0;
+        for (std::size_t i = 0; i < group.size(); ++i)
+        {
+            const auto size = sizes[name][i];
+            if (!batch.empty() &&
+                (batch_bytes + size > m_options.max_batch_bytes ||
+                 batch.size() >= m_options.max_batch_files))
+            {
+                flush(batch);
+                batch_bytes = 0;
+            }
+            batch.push_back(std::move(group[i]));
+            batch_bytes += size;
+        }
+        flush(batch);
+    }
+
+    // 删除上一次规划留下、本次不再使用的合并单元
+    std::error_code ec;
+    const std::string prefix = module_name + ".unity";
+    for (const auto& entry : std::filesystem::directory_iterator(unity_dir, ec))
+    {
+        const auto name = entry.path().filename().string();
+        if (name.starts_with(prefix) && name.ends_with(".cpp") &&
+            !written.contains(entry.path()))
+        {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+    return batches;
+}
+
+void UnityPlanner::save()
+{
+    m_churn.save();
+}
+
+// --- 私有辅助函数实现 ---
+
+bool UnityPlanner::is_hot(const path& file) const
+{
+    return m_churn.recent_changes(file, m_options.history_window) >=
+           m_options.hot_threshold;
+}
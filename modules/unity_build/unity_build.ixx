@@ -0,0 +1,110 @@
+// unity_build.ixx
+//
+// 定义了 UnityPlanner 类：可选的合并编译（unity / jumbo build）。
+// 把同一模块的多个小实现单元按大小预算合并为一个生成的翻译单元，
+// 省去重复的编译器启动与 BMI 导入开销。
+//
+// 模块实现单元不能简单地互相 #include（每个文件都有自己的 "module M;"），
+// 因此生成的翻译单元按“全局模块片段 + 一个模块声明 + 合并后的 import + 各文件主体”
+// 重新拼接，并用 #line 保持诊断信息指向原文件。
+// 近期被频繁修改的文件会被移出合并批次单独编译，避免每次修改都重编整批。
+
+export module unity_build;
+
+import std;
+
+namespace importa
+{
+
+namespace unity_build
+{
+
+using path = std::filesystem::path;
+
+export struct UnityOptions
+{
+    std::uintmax_t max_batch_bytes = 512 * 1024; // 每批源文件的总字节数上限
+    std::size_t max_batch_files = 32;
+
+    // 最近 history_window 次规划中被修改至少 hot_threshold 次的文件单独编译
+    std::size_t hot_threshold = 3;
+    std::size_t history_window = 8; // 不超过 32
+};
+
+// 一个实现单元拆分后的各部分
+export struct UnitParts
+{
+    std::string module_name; // 为空表示非模块源文件
+    std::string global_fragment; // "module;" 与模块声明之间的内容
+    std::size_t global_fragment_line = 0; // 全局模块片段首行的行号（从 1 开始）
+    std::vector<std::string> imports;
+    std::string body;
+    std::size_t body_line = 1;
+};
+
+// 拆分实现单元。接口单元、分区，以及 import 不全在文件开头的单元无法合并，返回 nullopt。
+export std::optional<UnitParts> split_unit(std::string_view text);
+
+// 将同一模块（或同为非模块）的若干单元拼接为一个翻译单元。
+// 各文件中以引号包含、且相对其所在目录存在的头文件被改写为绝对路径。
+export std::string compose_unity_source(
+    const std::vector<std::pair<path, UnitParts>>& members);
+
+// 一个编译批次
+export struct UnityBatch
+{
+    path source;               // 实际编译的文件：生成的合并单元，或单独编译时的原文件
+    std::vector<path> members; // 该批次包含的原始源文件
+};
+
+// 记录每个文件在最近若干次规划中是否被修改过
+export class ChurnTracker
+{
+  public:
+    explicit ChurnTracker(path db_path);
+
+    // 记录一次规划时文件内容的哈希
+    void observe(const path& file, std::uint64_t content_hash);
+
+    // 最近 window 次观察中被修改的次数
+    std::size_t recent_changes(const path& file, std::size_t window) const;
+
+    void save();
+
+  private:
+    struct Entry
+    {
+        std::uint64_t content_hash = 0;
+        std::uint32_t history = 0; // 最低位为最近一次观察，置位表示被修改
+    };
+
+    path m_db_path;
+    std::map<std::string, Entry> m_entries; // 键为规范化路径
+    bool m_dirty = false;
+
+    void load();
+};
+
+export class UnityPlanner
+{
+  public:
+    // 生成的合并单元写在 build_dir/<模块名>/ 下，修改历史保存在 build_dir 中
+    explicit UnityPlanner(path build_dir, UnityOptions options = {});
+
+    // 将模块的实现单元划分为编译批次，并写出（内容变化的）合并单元
+    std::vector<UnityBatch> plan(const std::string& module_name,
+                                 const std::vector<path>& sources);
+
+    // 持久化修改历史
+    void save();
+
+  private:
+    path m_build_dir;
+    UnityOptions m_options;
+    ChurnTracker m_churn;
+
+    bool is_hot(const path& file) const;
+};
+
+} // namespace unity_build
+} // namespace importa
@@ -0,0 +1,399 @@
+// watch_mode.cpp
+// 提供了 WatchSession 类的具体实现。
+
+module watch_mode;
+
+import std;
+import executor;
+import toolchains;
+import thread_pool;
+import load_governor;
+import build_log;
+import deps_log;
+import file_hash_cache;
+import file_watcher;
+import module_processor;
+import builder;
+import std_module_cache;
+import artifact_cache;
+import graph_cache;
+import gcc_module_mapper;
+import hashing;
+
+using namespace importa::watch_mode;
+using namespace importa::module_processor;
+using importa::builder::BuildStats;
+using importa::executor::IExecutor;
+using importa::toolchains::IToolchain;
+using importa::builder::hash_command;
+using importa::builder::select_affected;
+namespace graph_cache = importa::graph_cache;
+
+namespace
+{ // 内部辅助函数
+
+// 计划的指纹：命令、输入或输出的任何变化（例如新增了 import，
+// 或合并编译单元的成员变了而命令不变）都会改变它
+std::uint64_t plan_fingerprint(const std::vector<BuildAction>& actions)
+{
+    namespace hashing = importa::hashing;
+    std::uint64_t h = 0;
+    for (const auto& action : actions)
+    {
+        h = hashing::hash_combine(h, hash_command(action.command));
+        for (const auto* files : { &action.inputs, &action.outputs })
+        {
+            // 先记录数量，输入与输出之间的边界移动也会改变指纹
+            h = hashing::hash_combine(h, files->size());
+            for (const auto& file : *files)
+            {
+                h = hashing::hash_string(file.generic_string(), h);
+            }
+        }
+    }
+    return h;
+}
+
+path ensure_dir(path dir)
+{
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+} // namespace
+
+WatchSession::WatchSession(ProjectLoader loader, std::vector<path> manifests,
+                           const IToolchain& toolchain, IExecutor& executor,
+                           path build_dir, WatchOptions options)
+    : m_loader(std::move(loader)), m_manifests(std::move(manifests)),
+      m_toolchain(toolchain), m_executor(executor),
+      m_build_dir(ensure_dir(std::move(build_dir))),
+      m_options(std::move(options)),
+      m_own_pool(m_options.job_pool
+                     ? nullptr
+                     : std::make_unique<importa::thread_pool::ThreadPool>()),
+      m_pool(m_options.job_pool ? *m_options.job_pool : *m_own_pool),
+      m_log(m_build_dir / "build.log"),
+      m_hash_cache(m_build_dir / "hashes.db", m_pool),
+      m_deps_log(m_build_dir / "deps.log"),
+      m_builder(m_executor, m_log, &m_hash_cache, &m_deps_log, &m_pool)
+{
+    if (m_own_pool && m_options.governor)
+    {
+        m_governor = std::make_unique<importa::load_governor::LoadGovernor>(
+            *m_own_pool, *m_options.governor);
+        m_governor->start();
+    }
+}
+
+BuildStats WatchSession::build_once()
+{
+    if (!m_loaded && m_options.graph_cache && prepare_std_modules() &&
+        load_cached_graph())
+    {
+        auto stats = m_builder.build(m_actions);
+        if (stats)
+        {
+            update_watches();
+            return stats;
+        }
+        // 源文件的 import 可能已与缓存的计划不符：重新规划后再构建一次
+    }
+    if (!reload())
+    {
+        return BuildStats{ .failed = 1 };
+    }
+    auto stats = m_builder.build(m_actions);
+    update_watches(); // 构建后才知道新的头文件依赖
+    return stats;
+}
+
+BuildStats WatchSession::on_changes(const std::vector<path>& changed)
+{
+    if (std::ranges::any_of(changed, [this](const path& file)
+                            { return is_manifest(file); }) ||
+        !m_loaded)
+    {
+        return build_once();
+    }
+
+    auto sources = changed;
+    if (take_output_changes(sources))
+    {
+        // 产物在构建之外被删除或改写：重新规划并让 Builder 检查全部动作
+        return build_once();
+    }
+    if (sources.empty())
+    {
+        return BuildStats{ .skipped = m_actions.size() };
+    }
+
+    // 快速路径：沿用内存中的计划，只调度受影响的动作，不重新加载项目
+    auto affected = select_affected(m_actions, sources, &m_deps_log);
+    BuildStats stats = m_builder.build(affected);
+    if (!stats)
+    {
+        update_watches();
+        return stats;
+    }
+
+    // 源文件的 import 可能已改变：重新规划，计划不同时再补一次完整构建
+    // （Builder 会跳过刚刚已经构建过的动作）
+    const auto before = plan_fingerprint(m_actions);
+    if (reload() && plan_fingerprint(m_actions) != before)
+    {
+        const auto full = m_builder.build(m_actions);
+        stats.executed += full.executed;
+        stats.failed += full.failed;
+        stats.cut_off += full.cut_off;
+    }
+    update_watches();
+    return stats;
+}
+
+BuildStats WatchSession::build_pending(bool full)
+{
+    auto changed = m_watcher.take_changes();
+    const bool outputs_changed = take_output_changes(changed);
+    if (!full && m_loaded && changed.empty() && !outputs_changed && m_clean)
+    {
+        return BuildStats{ .skipped = m_actions.size() };
+    }
+
+    // 上次构建失败时没有文件变化也要重试，以便报告同样的错误
+    auto stats = full || !m_loaded || changed.empty() || outputs_changed
+                     ? build_once()
+                     : on_changes(changed);
+    m_clean = static_cast<bool>(stats);
+    return stats;
+}
+
+void WatchSession::run(std::stop_token stop)
+{
+    std::stop_callback on_stop(stop, [this] { m_watcher.stop(); });
+
+    auto report = [](const BuildStats& stats)
+    {
+        std::cout << "[watch] " << stats.executed << " executed, "
+                  << stats.skipped << " up to date"
+                  << (stats ? "" : ", build FAILED") << ".\n";
+    };
+
+    report(build_once());
+    std::cout << "[watch] Watching " << m_watcher.size()
+              << " files for changes...\n";
+    while (!stop.stop_requested())
+    {
+        auto changed = m_watcher.wait_for_changes(m_options.quiet_period,
+                                                  m_options.max_coalesce);
+        const bool outputs_changed = take_output_changes(changed);
+        if (changed.empty() && !outputs_changed)
+        {
+            continue; // 只有构建自身写出的产物
+        }
+        std::cout << "[watch] " << changed.size() << " file(s) changed"
+                  << (outputs_changed ? ", build outputs modified" : "")
+                  << ".\n";
+        report(outputs_changed ? build_once() : on_changes(changed));
+    }
+}
+
+const std::vector<BuildAction>& WatchSession::actions() const
+{
+    return m_actions;
+}
+
+importa::file_watcher::FileWatcher& WatchSession::watcher()
+{
+    return m_watcher;
+}
+
+// --- 私有辅助函数实现 ---
+
+bool WatchSession::reload()
+{
+    if (!prepare_std_modules())
+    {
+        return false;
+    }
+    auto project = m_loader();
+    if (!project)
+    {
+        std::cerr << "Error: Failed to load the project; keeping the "
+                     "previous build plan.\n";
+        return false;
+    }
+    ProjectProcessor processor(*project, m_toolchain, m_build_dir,
+                               m_options.external_ifcs, {},
+                               m_options.external_objects);
+    auto plan = processor.generate_build_plan();
+    if (!plan)
+    {
+        return false;
+    }
+    m_loaded = true;
+    m_actions = std::move(plan->actions);
+    publish_actions();
+    if (m_options.graph_cache)
+    {
+        store_graph();
+    }
+    return true;
+}
+
+bool WatchSession::prepare_std_modules()
+{
+    if (m_std_cache || m_options.std_modules.empty())
+    {
+        return true;
+    }
+    namespace smc = importa::std_module_cache;
+    auto cache = std::make_unique<smc::StdModuleCache>(
+        m_options.std_cache_root.empty() ? smc::default_cache_root()
+                                         : m_options.std_cache_root,
+        m_toolchain, m_executor, m_options.std_cache_options);
+    auto artifacts =
+        cache->ensure(m_options.std_modules, m_build_dir / "std_modules");
+    if (!artifacts)
+    {
+        return false;
+    }
+    m_options.external_ifcs.insert(artifacts->ifcs.begin(),
+                                   artifacts->ifcs.end());
+    m_options.external_objects.insert(m_options.external_objects.end(),
+                                      artifacts->objects.begin(),
+                                      artifacts->objects.end());
+    m_std_cache = std::move(cache);
+    return true;
+}
+
+// 清单内容、工具链、构建目录与外部模块共同决定计划
+std::uint64_t WatchSession::graph_fingerprint() const
+{
+    namespace hashing = importa::hashing;
+    std::uint64_t h = graph_cache::manifest_fingerprint(m_manifests);
+    h = hashing::hash_combine(h,
+                              graph_cache::toolchain_fingerprint(m_toolchain));
+    h = hashing::hash_string(m_build_dir.generic_string(), h);
+    for (const auto& [name, ifc] : m_options.external_ifcs)
+    {
+        h = hashing::hash_string(name, h);
+        h = hashing::hash_string(ifc.generic_string(), h);
+    }
+    for (const auto& object : m_options.external_objects)
+    {
+        h = hashing::hash_string(object.generic_string(), h);
+    }
+    return h;
+}
+
+bool WatchSession::load_cached_graph()
+{
+    const auto fingerprint = graph_fingerprint();
+    auto graph = graph_cache::MappedGraph::open(
+        m_build_dir / "graph.bin", fingerprint);
+    if (!graph)
+    {
+        return false;
+    }
+    m_actions = graph->to_actions();
+    m_loaded = true;
+    publish_actions();
+    m_stored_graph.emplace(fingerprint, plan_fingerprint(m_actions));
+    return true;
+}
+
+void WatchSession::store_graph()
+{
+    const std::pair stored{ graph_fingerprint(), plan_fingerprint(m_actions) };
+    if (m_stored_graph == stored)
+    {
+        return;
+    }
+    if (graph_cache::write_graph(m_build_dir / "graph.bin", stored.first,
+                                 m_actions))
+    {
+        m_stored_graph = stored;
+    }
+}
+
+void WatchSession::publish_actions()
+{
+    if (m_options.module_mapper)
+    {
+        m_options.module_mapper->set_actions(m_actions);
+    }
+}
+
+void WatchSession::update_watches()
+{
+    for (const auto& manifest : m_manifests)
+    {
+        m_watcher.watch(manifest);
+    }
+
+    // 产物（BMI、目标文件）也受监视，并记录构建后的状态，
+    // 以区分构建自身的写入与构建之外的删除或改写
+    m_output_stamps.clear();
+    for (const auto& action : m_actions)
+    {
+        for (const auto& output : action.outputs)
+        {
+            m_output_stamps[output.lexically_normal().generic_string()] =
+                importa::file_hash_cache::stat_file(output);
+            m_watcher.watch(output);
+        }
+    }
+    auto watch_input = [&](const path& file)
+    {
+        if (!m_output_stamps.contains(
+                file.lexically_normal().generic_string()))
+        {
+            m_watcher.watch(file);
+        }
+    };
+    for (const auto& action : m_actions)
+    {
+        std::ranges::for_each(action.inputs, watch_input);
+        if (action.depfile.empty())
+        {
+            continue;
+        }
+        if (auto header_deps = m_deps_log.get_deps(action.primary_output))
+        {
+            std::ranges::for_each(*header_deps, watch_input);
+        }
+    }
+}
+
+// 从 changed 中移除产物，返回其中是否有与上次构建后状态不同的
+bool WatchSession::take_output_changes(std::vector<path>& changed) const
+{
+    bool modified = false;
+    std::erase_if(changed,
+                  [&](const path& file)
+                  {
+                      const auto stamp = m_output_stamps.find(
+                          file.lexically_normal().generic_string());
+                      if (stamp == m_output_stamps.end())
+                      {
+                          return false;
+                      }
+                      if (importa::file_hash_cache::stat_file(file) !=
+                          stamp->second)
+                      {
+                          modified = true;
+                      }
+                      return true;
+                  });
+    return modified;
+}
+
+bool WatchSession::is_manifest(const path& file) const
+{
+    const auto normalized = file.lexically_normal();
+    return std::ranges::any_of(
+        m_manifests, [&normalized](const path& manifest)
+        { return std::filesystem::absolute(manifest).lexically_normal() ==
+                     normalized ||
+                 manifest.lexically_normal() == normalized; });
+}
@@ -0,0 +1,139 @@
+// watch_mode.ixx
+//
+// 定义了 WatchSession 类：常驻进程的 --watch 模式。
+// 项目图、构建计划、构建日志与内容哈希缓存都保留在内存中，
+// 文件变化到达后只调度受影响的动作，而不是重新走一遍完整流程。
+
+export module watch_mode;
+
+import std;
+import executor;
+import toolchains;
+import thread_pool;
+import load_governor;
+import build_log;
+import deps_log;
+import file_hash_cache;
+import file_watcher;
+import module_processor;
+import builder;
+import std_module_cache;
+import artifact_cache;
+import gcc_module_mapper;
+
+namespace importa
+{
+
+namespace watch_mode
+{
+
+using path = std::filesystem::path;
+using namespace std::chrono_literals;
+
+// 加载（或重新加载）项目描述，失败时返回 nullopt。
+// 通常由清单解析或 DependencyScanner 实现。
+export using ProjectLoader =
+    std::function<std::optional<module_processor::Project>()>;
+
+export struct WatchOptions
+{
+    // 突发修改的合并窗口，见 FileWatcher::wait_for_changes
+    std::chrono::milliseconds quiet_period = 15ms;
+    std::chrono::milliseconds max_coalesce = 500ms;
+
+    // 项目之外已构建好的模块（例如 std）
+    std::map<std::string, path> external_ifcs;
+    std::vector<path> external_objects; // 它们需要参与链接的目标文件
+
+    // 首次加载时从用户级缓存获取（必要时构建）的标准库模块，
+    // 并入 external_ifcs 与 external_objects
+    std::vector<std_module_cache::StdModuleSource> std_modules;
+    path std_cache_root; // 为空时使用 default_cache_root()
+    artifact_cache::ArtifactCacheOptions std_cache_options;
+
+    // 与其他会话共享的任务池（哈希与编译都在其上执行），为空时自建一个
+    thread_pool::ThreadPool* job_pool = nullptr;
+    // 非空时按系统压力调整自建任务池的并发数；共享任务池由其所有者调整
+    std::optional<load_governor::GovernorOptions> governor;
+
+    // 为 true 时把构建计划缓存到 build_dir/graph.bin：清单、工具链与外部
+    // 模块都未变化时，新会话的首次构建直接映射该文件，跳过项目加载与规划
+    bool graph_cache = false;
+
+    // 使用 GccToolchain 时回答编译器询问的映射器，每次规划后用新计划更新
+    gcc_module_mapper::ModuleMapper* module_mapper = nullptr;
+};
+
+export class WatchSession
+{
+  public:
+    // manifests 中的文件变化会触发项目的重新加载与重新规划；
+    // 构建日志、依赖日志与哈希缓存存放在 build_dir 下
+    WatchSession(ProjectLoader loader, std::vector<path> manifests,
+                 const toolchains::IToolchain& toolchain,
+                 executor::IExecutor& executor, path build_dir,
+                 WatchOptions options = {});
+
+    // 加载项目、生成计划并完整构建一次
+    builder::BuildStats build_once();
+
+    // 处理一批文件变化：源文件变化只执行受影响的动作，
+    // 清单变化则重新加载项目后完整构建
+    builder::BuildStats on_changes(const std::vector<path>& changed);
+
+    // 不阻塞地处理监视器中积累的变化：尚未构建过或 full 为 true 时完整构建，
+    // 没有任何变化时不访问文件系统、直接视全部动作为最新
+    builder::BuildStats build_pending(bool full = false);
+
+    // 先完整构建一次，然后循环等待变化并增量重建，直到 stop 被请求
+    void run(std::stop_token stop);
+
+    // 当前的构建计划（按依赖顺序）
+    const std::vector<module_processor::BuildAction>& actions() const;
+
+    file_watcher::FileWatcher& watcher();
+
+  private:
+    ProjectLoader m_loader;
+    std::vector<path> m_manifests;
+    const toolchains::IToolchain& m_toolchain;
+    executor::IExecutor& m_executor;
+    path m_build_dir;
+    WatchOptions m_options;
+
+    // 以下成员在整个会话期间常驻内存，声明顺序即构造顺序
+    std::unique_ptr<thread_pool::ThreadPool> m_own_pool;
+    thread_pool::ThreadPool& m_pool;
+    std::unique_ptr<load_governor::LoadGovernor> m_governor;
+    build_log::BuildLog m_log;
+    file_hash_cache::FileHashCache m_hash_cache;
+    deps_log::DepsLog m_deps_log;
+    builder::Builder m_builder;
+    file_watcher::FileWatcher m_watcher;
+
+    bool m_loaded = false; // m_actions 是否已有计划（加载或取自缓存）
+    std::vector<module_processor::BuildAction> m_actions;
+    // 最近写入 graph.bin 的 {图指纹, 计划指纹}，避免重复写入相同的计划
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> m_stored_graph;
+    bool m_clean = false; // build_pending 的上一次构建是否成功
+    // 上次构建后各产物的状态。产物也受监视：与之相同的变化来自构建本身，
+    // 不同的（例如产物被删除）说明需要由 Builder 的 stat 检查重新构建
+    std::unordered_map<std::string,
+                       std::optional<file_hash_cache::FileIdentity>>
+        m_output_stamps;
+    // 会话期间保留，使缓存的后台清理与构建并行
+    std::unique_ptr<std_module_cache::StdModuleCache> m_std_cache;
+
+    bool reload();
+    bool prepare_std_modules();
+    std::uint64_t graph_fingerprint() const;
+    bool load_cached_graph();
+    void store_graph();
+    void publish_actions();
+    void update_watches();
+    bool take_output_changes(std::vector<path>& changed) const;
+    bool is_manifest(const path& file) const;
+};
+
+} // namespace watch_mode
+} // namespace importa
@@ -0,0 +1,217 @@
+// tests_artifact_cache.cpp
+// Contains unit tests for the size-bounded artifact cache.
+
+import std;
+import artifact_cache;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa::artifact_cache;
+
+// --- Helper Functions ---
+
+path stage_entry(ArtifactCache& cache, const std::string& content)
+{
+    const path dir = cache.stage();
+    std::ofstream(dir / "a.ifc") << content;
+    std::ofstream(dir / "a.obj") << content;
+    return dir;
+}
+
+std::string read_all(const path& file)
+{
+    std::ifstream in(file);
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+void age(const path& p, std::chrono::seconds by)
+{
+    fs::last_write_time(p, fs::last_write_time(p) - by);
+}
+
+// --- Test Suite for ArtifactCache ---
+
+void test_artifact_cache()
+{
+    std::cout << "--- Running Test Suite: ArtifactCache ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_artifact_cache";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const path root = temp_dir / "cache";
+
+    // Test 11A: published entries can be fetched into any directory
+    {
+        ArtifactCache cache(root);
+        assert(!cache.contains(1));
+        assert(!cache.fetch(1, temp_dir / "miss"));
+        assert(!fs::exists(temp_dir / "miss"));
+
+        const path staged = stage_entry(cache, "one");
+        assert(cache.publish(1, staged));
+        assert(!fs::exists(staged));
+        assert(cache.contains(1));
+        assert(cache.raw_bytes() == 6);
+        assert(cache.size_bytes() > 0);
+
+        assert(cache.fetch(1, temp_dir / "build" / "one"));
+        assert(read_all(temp_dir / "build" / "one" / "a.ifc") == "one");
+        // Fetching into an existing directory leaves it alone.
+        assert(cache.fetch(1, temp_dir / "build" / "one"));
+        std::cout << "  Test 11A: publish and fetch... Passed\n";
+    }
+
+    // Test 11B: racing writers and readers agree on one entry
+    {
+        ArtifactCache cache(root);
+        std::vector<std::jthread> workers;
+        std::atomic<int> fetched = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            workers.emplace_back(
+                [&, i]
+                {
+                    assert(cache.publish(2, stage_entry(cache, "two")));
+                    const path dest = temp_dir / "race" / std::to_string(i % 2);
+                    if (cache.fetch(2, dest))
+                    {
+                        ++fetched;
+                    }
+                });
+        }
+        workers.clear();
+        assert(fetched == 8);
+        assert(read_all(temp_dir / "race" / "0" / "a.obj") == "two");
+        assert(fs::is_empty(root / "tmp"));
+        for (const auto& entry : fs::directory_iterator(temp_dir / "race"))
+        {
+            assert(entry.path().filename().string().find(".tmp-") ==
+                   std::string::npos);
+        }
+        std::cout << "  Test 11B: concurrent publish and fetch... Passed\n";
+    }
+
+    // Test 11C: trimming evicts the least recently used entries
+    {
+        fs::remove_all(root);
+        std::uintmax_t entry_bytes = 0;
+        {
+            ArtifactCache writer(root);
+            for (std::uint64_t key = 10; key < 13; ++key)
+            {
+                assert(writer.publish(key, stage_entry(writer, "xxxx")));
+            }
+            entry_bytes = writer.size_bytes() / 3;
+        }
+        ArtifactCache cache(root, { .max_bytes = entry_bytes * 5 / 2,
+                                    .low_water_ratio = 0.5 });
+
+        // Make 10 the oldest, then use it so 11 becomes the coldest entry.
+        for (const auto& shard : fs::directory_iterator(root / "objects"))
+        {
+            for (const auto& entry : fs::directory_iterator(shard.path()))
+            {
+                age(entry.path(), std::chrono::minutes(10));
+            }
+        }
+        assert(cache.fetch(10, temp_dir / "lru"));
+
+        assert(cache.trim() == entry_bytes * 2);
+        assert(cache.contains(10));
+        assert(!cache.contains(11));
+        assert(!cache.contains(12));
+        assert(cache.size_bytes() == entry_bytes);
+        assert(cache.trim() == 0);
+        // Installed copies survive eviction.
+        assert(read_all(temp_dir / "lru" / "a.ifc") == "xxxx");
+        std::cout << "  Test 11C: LRU eviction... Passed\n";
+    }
+
+    // Test 11D: leftovers of crashed processes are cleaned up
+    {
+        ArtifactCache cache(root,
+                            { .stale_staging_age = std::chrono::minutes(5) });
+        const path fresh = cache.stage();
+        const path stale = cache.stage();
+        age(stale, std::chrono::minutes(10));
+        fs::create_directories(root / "trash" / "old");
+        age(root / "trash" / "old", std::chrono::minutes(10));
+
+        cache.trim();
+        assert(fs::exists(fresh));
+        assert(!fs::exists(stale));
+        assert(!fs::exists(root / "trash" / "old"));
+        std::cout << "  Test 11D: stale staging cleanup... Passed\n";
+    }
+
+    // Test 11E: background trimming finishes before destruction
+    {
+        {
+            ArtifactCache cache(root, { .max_bytes = 1 });
+            assert(cache.publish(20, stage_entry(cache, "bg")));
+            cache.trim_in_background();
+            cache.trim_in_background();
+        }
+        assert(ArtifactCache(root).size_bytes() == 0);
+        std::cout << "  Test 11E: background trim... Passed\n";
+    }
+
+    // Test 11F: entries are stored compressed and cold ones get recompressed
+    {
+        std::string content;
+        for (int i = 0; content.size() < 1'000'000; ++i)
+        {
+            content += "?symbol_" + std::to_string(i % 977) +
+                       "@importa@@QEAAXXZ " + std::to_string(i % 13);
+        }
+        ArtifactCache cache(root);
+        const path staged = cache.stage();
+        std::ofstream(staged / "big.obj", std::ios::binary) << content;
+        assert(cache.publish(30, staged));
+        assert(cache.raw_bytes() == content.size());
+        const auto fast_bytes = cache.size_bytes();
+        assert(fast_bytes * 3 < content.size());
+
+        const path entry = root / "objects" / "00" / "000000000000001e";
+        assert(fs::is_directory(entry));
+        age(entry, std::chrono::hours(48));
+        const auto last_use = fs::last_write_time(entry);
+        cache.trim();
+        assert(cache.size_bytes() <= fast_bytes);
+        assert(fs::last_write_time(entry) == last_use);
+        // A second trim leaves the already recompressed entry alone.
+        const auto high_bytes = cache.size_bytes();
+        cache.trim();
+        assert(cache.size_bytes() == high_bytes);
+
+        assert(cache.fetch(30, temp_dir / "cold"));
+        assert(read_all(temp_dir / "cold" / "big.obj") == content);
+        std::cout << "  Test 11F: compressed storage (" << content.size()
+                  << " -> " << fast_bytes << " -> " << high_bytes
+                  << " bytes)... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- ArtifactCache tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_artifact_cache();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All ArtifactCache tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,500 @@
+// tests_bmi_fingerprint.cpp
+// Contains unit tests for BMI interface fingerprints, using synthetic Clang
+// bitstreams, and for the Builder cutting off importers with them.
+
+import std;
+import executor;
+import toolchains;
+import build_log;
+import module_processor;
+import builder;
+import bmi_fingerprint;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::build_log;
+using namespace importa::module_processor;
+using namespace importa::builder;
+using namespace importa::bmi_fingerprint;
+
+// --- Helper Functions ---
+
+namespace
+{
+// Writes an LLVM bitstream, least significant bit first.
+class BitWriter
+{
+  public:
+    void fixed(std::uint64_t value, unsigned width)
+    {
+        for (unsigned i = 0; i < width; ++i, ++m_bit)
+        {
+            if (m_bit % 8 == 0)
+            {
+                m_bytes.push_back('\0');
+            }
+            if ((value >> i) & 1)
+            {
+                m_bytes.back() = static_cast<char>(
+                    m_bytes.back() | static_cast<char>(1 << (m_bit % 8)));
+            }
+        }
+    }
+
+    void vbr(std::uint64_t value, unsigned width)
+    {
+        const std::uint64_t high = 1ull << (width - 1);
+        while (value >= high)
+        {
+            fixed((value & (high - 1)) | high, width);
+            value >>= width - 1;
+        }
+        fixed(value, width);
+    }
+
+    void align32()
+    {
+        while (m_bit % 32 != 0)
+        {
+            fixed(0, 1);
+        }
+    }
+
+    // Returns the position of the length word, patched by end_block.
+    std::size_t enter_block(std::uint64_t id, unsigned width, unsigned outer)
+    {
+        fixed(1, outer);
+        vbr(id, 8);
+        vbr(width, 4);
+        align32();
+        const std::size_t length_pos = m_bytes.size();
+        fixed(0, 32);
+        return length_pos;
+    }
+
+    void end_block(std::size_t length_pos, unsigned width)
+    {
+        fixed(0, width);
+        align32();
+        const auto words =
+            static_cast<std::uint32_t>((m_bytes.size() - length_pos - 4) / 4);
+        for (int i = 0; i < 4; ++i)
+        {
+            m_bytes[length_pos + i] = static_cast<char>(words >> (8 * i));
+        }
+    }
+
+    void record(std::uint64_t code, const std::vector<std::uint64_t>& ops,
+                unsigned width)
+    {
+        fixed(3, width);
+        vbr(code, 6);
+        vbr(ops.size(), 6);
+        for (const auto op : ops)
+        {
+            vbr(op, 6);
+        }
+    }
+
+    const std::string& bytes() const { return m_bytes; }
+
+  private:
+    std::string m_bytes;
+    std::size_t m_bit = 0;
+};
+
+struct PcmContent
+{
+    std::uint64_t source_size = 120;
+    std::uint64_t source_mtime = 1'700'000'000;
+    std::uint64_t signature = 0xabcdef;
+    std::uint64_t import_size = 4096;
+    std::string decls = "export int answer();";
+    std::string blob = "inline body";
+    bool abbreviated_decls = true;
+};
+
+// Builds a .pcm shaped like Clang's: BLOCKINFO, CONTROL (with an
+// INPUT_FILES sub-block), AST and UNHASHED_CONTROL blocks.
+std::string make_pcm(const PcmContent& c)
+{
+    BitWriter w;
+
+    // BLOCKINFO: the AST block's abbreviation 4 is [17, array(fixed 8)].
+    auto pos = w.enter_block(0, 2, 2);
+    w.record(1, { 8 }, 2); // SETBID 8
+    w.fixed(2, 2);         // DEFINE_ABBREV
+    w.vbr(3, 5);
+    w.fixed(1, 1); // literal code
+    w.vbr(17, 8);
+    w.fixed(0, 1); // array
+    w.fixed(3, 3);
+    w.fixed(0, 1); // of fixed(8)
+    w.fixed(1, 3);
+    w.vbr(8, 5);
+    w.end_block(pos, 2);
+
+    pos = w.enter_block(15, 3, 2);
+    w.record(1, { 19, 1 }, 3);          // METADATA
+    w.record(2, { c.import_size }, 3);  // IMPORTS
+    w.record(6, { c.source_size }, 3);  // INPUT_FILE_OFFSETS
+    auto inner = w.enter_block(16, 3, 3);
+    w.record(1, { c.source_size, c.source_mtime }, 3);
+    w.end_block(inner, 3);
+    w.end_block(pos, 3);
+
+    pos = w.enter_block(8, 4, 2);
+    std::vector<std::uint64_t> chars(c.decls.begin(), c.decls.end());
+    if (c.abbreviated_decls)
+    {
+        w.fixed(4, 4);
+        w.vbr(chars.size(), 6);
+        for (const auto ch : chars)
+        {
+            w.fixed(ch, 8);
+        }
+    }
+    else
+    {
+        w.record(17, chars, 4);
+    }
+    w.fixed(2, 4); // DEFINE_ABBREV 5: [30, vbr(6), blob]
+    w.vbr(3, 5);
+    w.fixed(1, 1);
+    w.vbr(30, 8);
+    w.fixed(0, 1);
+    w.fixed(2, 3);
+    w.vbr(6, 5);
+    w.fixed(0, 1);
+    w.fixed(5, 3);
+    w.fixed(5, 4);
+    w.vbr(42, 6);
+    w.vbr(c.blob.size(), 6);
+    w.align32();
+    for (const char ch : c.blob)
+    {
+        w.fixed(static_cast<unsigned char>(ch), 8);
+    }
+    w.align32();
+    w.end_block(pos, 4);
+
+    pos = w.enter_block(19, 3, 2);
+    w.record(1, { c.signature }, 3); // SIGNATURE
+    w.end_block(pos, 3);
+
+    return "CPCH" + w.bytes();
+}
+
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+// Copies the first argument into the second, so the "source" of a BMI
+// action holds the bytes the compiler would have written.
+struct CopyExecutor : public IExecutor
+{
+    std::vector<std::string> executed;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const path source = command.arguments[0];
+        const path output = command.arguments[1];
+        fs::copy_file(source, output, fs::copy_options::overwrite_existing);
+        executed.push_back(output.filename().string());
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+BuildAction copy_action(const path& source, const path& output,
+                        std::vector<path> extra_inputs = {})
+{
+    BuildAction action;
+    action.command.executable = "copy";
+    action.command.arguments = { source.string(), output.string() };
+    action.primary_output = output;
+    action.inputs = { source };
+    action.inputs.insert(action.inputs.end(), extra_inputs.begin(),
+                         extra_inputs.end());
+    action.outputs = { output };
+    action.restat = true;
+    return action;
+}
+
+// Runs commands for real and remembers the -o output of each compile.
+struct RecordingExecutor : public IExecutor
+{
+    LocalExecutor local;
+    std::vector<std::string> outputs;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const auto& args = command.arguments;
+        auto o = std::ranges::find(args, "-o");
+        if (o != args.end() && o + 1 != args.end())
+        {
+            outputs.push_back(path(*(o + 1)).filename().string());
+        }
+        return local.execute(command);
+    }
+};
+
+// clang++ from IMPORTA_TEST_CLANGXX or PATH; empty when there is none.
+path find_clangxx()
+{
+    if (const char* env = std::getenv("IMPORTA_TEST_CLANGXX"); env && *env)
+    {
+        return env;
+    }
+    const char* path_env = std::getenv("PATH");
+    std::string_view dirs = path_env ? path_env : "";
+    while (!dirs.empty())
+    {
+        const auto colon = dirs.find(':');
+        const path candidate = path(dirs.substr(0, colon)) / "clang++";
+        std::error_code ec;
+        if (fs::is_regular_file(candidate, ec))
+        {
+            return candidate;
+        }
+        dirs.remove_prefix(colon == std::string_view::npos ? dirs.size()
+                                                           : colon + 1);
+    }
+    return {};
+}
+
+// Rewrites a source and moves its mtime forward, so the change is seen
+// even on file systems with coarse timestamps.
+void edit_source(const path& file, std::string_view content)
+{
+    const auto previous = fs::last_write_time(file);
+    write_file(file, content);
+    fs::last_write_time(file, previous + 1s);
+}
+} // namespace
+
+// --- Test Suite for bmi_fingerprint ---
+
+void test_bmi_fingerprint()
+{
+    std::cout << "--- Running Test Suite: BmiFingerprint ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_bmi_fingerprint";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+
+    const PcmContent base;
+    const auto base_fingerprint = clang_pcm_fingerprint(make_pcm(base));
+    assert(base_fingerprint.has_value());
+
+    // Test 16A: source metadata and record layout do not matter
+    {
+        PcmContent edited = base;
+        edited.source_size = 4000;
+        edited.source_mtime += 60;
+        edited.signature = 0x123456789;
+        assert(make_pcm(edited) != make_pcm(base));
+        assert(clang_pcm_fingerprint(make_pcm(edited)) == base_fingerprint);
+
+        PcmContent unabbreviated = base;
+        unabbreviated.abbreviated_decls = false;
+        assert(clang_pcm_fingerprint(make_pcm(unabbreviated)) ==
+               base_fingerprint);
+        std::cout << "  Test 16A: metadata is ignored... Passed\n";
+    }
+
+    // Test 16B: declarations, blobs and imports change the fingerprint
+    {
+        PcmContent decls = base;
+        decls.decls = "export long answer();";
+        PcmContent blob = base;
+        blob.blob = "inline body 2";
+        PcmContent imports = base;
+        imports.import_size = 8192;
+        for (const auto& changed : { decls, blob, imports })
+        {
+            assert(clang_pcm_fingerprint(make_pcm(changed)) !=
+                   base_fingerprint);
+        }
+        std::cout << "  Test 16B: interface changes are seen... Passed\n";
+    }
+
+    // Test 16C: other formats and damaged files fall back to content hashes
+    {
+        const path ifc = temp_dir / "Core.ifc";
+        write_file(ifc, "MSVC IFC");
+        const auto first = interface_fingerprint(ifc);
+        assert(first.has_value());
+        write_file(ifc, "MSVC IFC 2");
+        assert(interface_fingerprint(ifc) != first);
+
+        auto truncated = make_pcm(base);
+        truncated.resize(truncated.size() - 6);
+        assert(!clang_pcm_fingerprint(truncated));
+        assert(!clang_pcm_fingerprint("CPCH"
+                                      "\x03"));
+        const path pcm = temp_dir / "Core.pcm";
+        write_file(pcm, truncated);
+        assert(interface_fingerprint(pcm).has_value());
+        write_file(pcm, make_pcm(base));
+        assert(interface_fingerprint(pcm) == base_fingerprint);
+        assert(!interface_fingerprint(temp_dir / "missing.pcm"));
+        std::cout << "  Test 16C: fallback to content... Passed\n";
+    }
+
+    // Test 16D: the Builder keeps importers clean across body-only edits
+    {
+        const path core_src = temp_dir / "core.src";
+        const path core_pcm = temp_dir / "Core.pcm";
+        const path app_src = temp_dir / "app.src";
+        const path app_obj = temp_dir / "app.o";
+        write_file(core_src, make_pcm(base));
+        write_file(app_src, "import Core;");
+
+        std::vector<BuildAction> actions = {
+            copy_action(core_src, core_pcm),
+            copy_action(app_src, app_obj, { core_pcm }),
+        };
+        actions[0].interface_fingerprint = true;
+
+        BuildLog log(temp_dir / ".importa_log");
+        CopyExecutor executor;
+        Builder builder(executor, log);
+        assert(builder.build(actions).executed == 2);
+
+        PcmContent body_edit = base;
+        body_edit.source_size += 17;
+        body_edit.source_mtime += 1;
+        edit_source(core_src, make_pcm(body_edit));
+        executor.executed.clear();
+        auto stats = builder.build(actions);
+        assert(stats.executed == 1 && stats.cut_off == 1);
+        assert(executor.executed == std::vector<std::string>{ "Core.pcm" });
+
+        PcmContent interface_edit = body_edit;
+        interface_edit.decls = "export int answer(int);";
+        edit_source(core_src, make_pcm(interface_edit));
+        executor.executed.clear();
+        stats = builder.build(actions);
+        assert(stats.executed == 2);
+        assert(executor.executed.back() == "app.o");
+        std::cout << "  Test 16D: importers cut off... Passed\n";
+    }
+
+    // Test 16E: real clang accepts what is left after a body-only edit.
+    // C imports A and B, and B imports A. Editing A's body keeps A's
+    // interface, but B.pcm must still be rebuilt before C is recompiled.
+    if (const path clangxx = find_clangxx(); clangxx.empty())
+    {
+        std::cout << "  Test 16E: clang++ not found... Skipped\n";
+    }
+    else
+    {
+        const path src = temp_dir / "e2e";
+        fs::create_directories(src);
+        write_file(src / "a.cppm", "export module A;\n"
+                                   "export int answer();\n"
+                                   "int answer() { return 40; }\n");
+        write_file(src / "b.cppm", "export module B;\n"
+                                   "import A;\n"
+                                   "export int twice();\n"
+                                   "int twice() { return 2 * answer(); }\n");
+        write_file(src / "c.cppm", "export module C;\n"
+                                   "import A;\n"
+                                   "import B;\n"
+                                   "export int sum();\n"
+                                   "int sum() {\n"
+                                   "    return answer() + twice();\n"
+                                   "}\n");
+        write_file(src / "main.cpp",
+                   "import C;\nint main() { return sum(); }\n");
+
+        Project project;
+        project.name = "E2E";
+        project.output_executable = "e2e";
+        project.modules = {
+            { .name = "A", .primary_interface = src / "a.cppm" },
+            { .name = "B",
+              .primary_interface = src / "b.cppm",
+              .dependencies = { "A" } },
+            { .name = "C",
+              .primary_interface = src / "c.cppm",
+              .dependencies = { "A", "B" } },
+            { .name = "Main",
+              .implementations = { src / "main.cpp" },
+              .dependencies = { "C" } },
+        };
+        auto config = BuildConfigurationFactory::create_debug_default();
+        config.reduced_bmi = true;
+        ClangxxToolchain toolchain(clangxx, config);
+        const path build_dir = temp_dir / "e2e_build";
+        auto plan = ProjectProcessor(project, toolchain, build_dir)
+                        .generate_build_plan();
+        assert(plan.has_value());
+
+        BuildLog log(build_dir / ".importa_log");
+        RecordingExecutor executor;
+        Builder builder(executor, log);
+        assert(builder.build(plan->actions));
+        LocalExecutor run;
+        assert(run.execute({ .executable = build_dir / "e2e" }).exit_code ==
+               120);
+
+        // Both edits keep every interface; C is recompiled with B.pcm.
+        edit_source(src / "a.cppm", "export module A;\n"
+                                    "export int answer();\n"
+                                    "int answer() { return 41; }\n");
+        edit_source(src / "c.cppm", "export module C;\n"
+                                    "import A;\n"
+                                    "import B;\n"
+                                    "export int sum();\n"
+                                    "int sum() {\n"
+                                    "    return twice() + answer();\n"
+                                    "}\n");
+        executor.outputs.clear();
+        assert(builder.build(plan->actions));
+        assert(run.execute({ .executable = build_dir / "e2e" }).exit_code ==
+               123);
+        assert(std::ranges::find(executor.outputs, "B.obj") !=
+               executor.outputs.end());
+
+        // A length-changing body edit moves the source locations recorded
+        // in A.pcm. Whether or not that changes the fingerprint, the result
+        // must be what a clean build produces.
+        edit_source(src / "a.cppm", "export module A;\n"
+                                    "export int answer();\n"
+                                    "int answer() { return 40 + 2; }\n");
+        assert(builder.build(plan->actions));
+        assert(run.execute({ .executable = build_dir / "e2e" }).exit_code ==
+               126);
+        std::cout << "  Test 16E: clang accepts the cut-off build... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- BmiFingerprint tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_bmi_fingerprint();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All BmiFingerprint tests passed successfully!\n";
+    return 0;
+}
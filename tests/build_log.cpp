@@ -0,0 +1,136 @@
+// tests_build_log.cpp
+// Contains unit tests for the hashing and build_log modules.
+
+import std;
+import hashing;
+import build_log;
+
+#include <cassert>
+
+using namespace importa;
+using namespace importa::build_log;
+namespace fs = std::filesystem;
+
+// --- Test Suite for hashing ---
+
+void test_hashing()
+{
+    std::cout << "--- Running Test Suite: hashing ---\n";
+
+    // Test 1A: XXH64 reference vectors
+    {
+        assert(hashing::hash_string("") == 0xEF46DB3751D8E999ULL);
+        assert(hashing::hash_string("abc") == 0x44BC2CF5AD770999ULL);
+        assert(hashing::hash_string(
+                   "The quick brown fox jumps over the lazy dog") ==
+               0x0B242D361FDA71BCULL);
+        std::cout << "  Test 1A: XXH64 reference vectors... Passed\n";
+    }
+
+    // Test 1B: hash_combine is order sensitive
+    {
+        assert(hashing::hash_combine(hashing::hash_combine(0, 1), 2) !=
+               hashing::hash_combine(hashing::hash_combine(0, 2), 1));
+        std::cout << "  Test 1B: hash_combine order sensitivity... Passed\n";
+    }
+    std::cout << "--- hashing tests all passed ---\n\n";
+}
+
+// --- Test Suite for BuildLog ---
+
+void test_build_log()
+{
+    std::cout << "--- Running Test Suite: BuildLog ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_build_log";
+    fs::remove_all(temp_dir);
+    auto log_path = temp_dir / ".importa_log";
+
+    // Test 2A: records survive reopening
+    {
+        {
+            BuildLog log(log_path);
+            assert(log.size() == 0);
+            log.record("build/Core/Core.ifc",
+                       { .command_hash = 1, .input_stamp = 2,
+                         .output_stamp = 3, .duration_ms = 4 });
+            log.record("build/Core/impl.obj",
+                       { .command_hash = 5, .input_stamp = 6,
+                         .output_stamp = 7, .duration_ms = 8 });
+        }
+        BuildLog log(log_path);
+        assert(log.size() == 2);
+        const auto* rec = log.find("build/Core/Core.ifc");
+        assert(rec != nullptr);
+        assert(rec->command_hash == 1);
+        assert(rec->input_stamp == 2);
+        assert(rec->output_stamp == 3);
+        assert(rec->duration_ms == 4);
+        assert(log.find("build/Other/Other.ifc") == nullptr);
+        std::cout << "  Test 2A: records survive reopening... Passed\n";
+    }
+
+    // Test 2B: later records override earlier ones
+    {
+        {
+            BuildLog log(log_path);
+            log.record("build/Core/Core.ifc",
+                       { .command_hash = 11, .input_stamp = 12,
+                         .output_stamp = 13, .duration_ms = 14 });
+        }
+        BuildLog log(log_path);
+        assert(log.size() == 2);
+        assert(log.find("build/Core/Core.ifc")->command_hash == 11);
+        std::cout << "  Test 2B: later records override... Passed\n";
+    }
+
+    // Test 2C: a torn tail left by a crash is discarded
+    {
+        auto intact_size = fs::file_size(log_path);
+        {
+            std::ofstream out(log_path, std::ios::binary | std::ios::app);
+            out.write("garbage", 7);
+        }
+        BuildLog log(log_path);
+        assert(log.size() == 2);
+        assert(fs::file_size(log_path) == intact_size);
+        log.record("build/Core/extra.obj", { .command_hash = 21 });
+        std::cout << "  Test 2C: torn tail is truncated... Passed\n";
+    }
+
+    // Test 2D: recompact keeps only the latest records
+    {
+        {
+            BuildLog log(log_path);
+            assert(log.size() == 3);
+            log.recompact();
+            assert(log.size() == 3);
+        }
+        BuildLog log(log_path);
+        assert(log.size() == 3);
+        assert(log.find("build/Core/Core.ifc")->command_hash == 11);
+        assert(log.find("build/Core/extra.obj")->command_hash == 21);
+        std::cout << "  Test 2D: recompact... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- BuildLog tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_hashing();
+        test_build_log();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All BuildLog tests passed successfully!\n";
+    return 0;
+}
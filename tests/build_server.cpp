@@ -0,0 +1,270 @@
+// tests_build_server.cpp
+// Contains tests for the BuildServer and its client functions, using a mock
+// toolchain and a mock executor.
+
+import std;
+import executor;
+import toolchains;
+import thread_pool;
+import module_processor;
+import watch_mode;
+import build_server;
+
+#include <cassert>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::watch_mode;
+using namespace importa::build_server;
+
+// --- Mock Object Definitions ---
+
+// Produces "mock <output> <source>" commands.
+struct MockToolchain : public IToolchain
+{
+    std::optional<Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override
+    {
+        return Command{ .executable = "mock",
+                        .arguments = { args.output_ifc_path.string(),
+                                       args.interface_unit_path.string(),
+                                       args.output_obj_path.string() } };
+    }
+
+    std::optional<Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override
+    {
+        return Command{ .executable = "mock",
+                        .arguments = { args.output_obj_path.string(),
+                                       args.source_file.string() } };
+    }
+
+    std::optional<Command> generate_link_command(
+        const LinkArgs& args) const override
+    {
+        return Command{};
+    }
+};
+
+// Copies the source into the outputs (the first argument and any after the
+// source) and tracks how many commands run at once.
+struct MockExecutor : public IExecutor
+{
+    std::atomic<int> executed = 0;
+    std::atomic<int> running = 0;
+    std::atomic<int> max_running = 0;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const int now = ++running;
+        int seen = max_running;
+        while (now > seen && !max_running.compare_exchange_weak(seen, now))
+        {
+        }
+        std::this_thread::sleep_for(20ms);
+
+        for (std::size_t i = 0; i < command.arguments.size(); ++i)
+        {
+            if (i == 1)
+            {
+                continue;
+            }
+            const path output = command.arguments[i];
+            fs::create_directories(output.parent_path());
+            fs::copy_file(command.arguments[1], output,
+                          fs::copy_options::overwrite_existing);
+        }
+        --running;
+        ++executed;
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+// Each project has four independent modules.
+Project make_project(const path& dir)
+{
+    Project project;
+    project.name = dir.filename().string();
+    for (std::string name : { "A", "B", "C", "D" })
+    {
+        project.modules.push_back(
+            { .name = name, .primary_interface = dir / (name + ".ixx") });
+    }
+    return project;
+}
+} // namespace
+
+// --- Test Suite for BuildServer ---
+
+void test_build_server(const path& temp_dir)
+{
+    std::cout << "--- Running Test Suite: BuildServer ---\n";
+
+    for (std::string project : { "one", "two" })
+    {
+        fs::create_directories(temp_dir / project);
+        for (std::string name : { "A", "B", "C", "D" })
+        {
+            write_file(temp_dir / project / (name + ".ixx"),
+                       "export module " + name + ";");
+        }
+    }
+
+    MockToolchain toolchain;
+    MockExecutor executor;
+    SessionFactory factory =
+        [&](const std::string& project,
+            thread_pool::ThreadPool& job_pool) -> std::unique_ptr<WatchSession>
+    {
+        const path dir = temp_dir / project;
+        if (!fs::exists(dir))
+        {
+            return nullptr;
+        }
+        return std::make_unique<WatchSession>(
+            [dir] { return std::optional(make_project(dir)); },
+            std::vector<path>{}, toolchain, executor, dir / "build",
+            WatchOptions{ .job_pool = &job_pool });
+    };
+
+    const path socket_path = temp_dir / "server.sock";
+    assert(!request_build(socket_path, "one").has_value());
+
+    BuildServer server(socket_path, factory, 3);
+    assert(server.start());
+    BuildServer second(socket_path, factory, 1);
+    assert(!second.start());
+
+    // Test 6A: concurrent clients share one job pool
+    {
+        std::optional<BuildReply> reply_one;
+        std::optional<BuildReply> reply_two;
+        {
+            std::jthread client_one(
+                [&] { reply_one = request_build(socket_path, "one"); });
+            std::jthread client_two(
+                [&] { reply_two = request_build(socket_path, "two"); });
+        }
+        assert(reply_one && *reply_one && reply_one->executed == 4);
+        assert(reply_two && *reply_two && reply_two->executed == 4);
+        assert(executor.max_running > 1);
+        assert(executor.max_running <= 3);
+        assert(server.sessions() == 2);
+        std::cout << "  Test 6A: concurrent clients... Passed\n";
+    }
+
+    // Test 6B: a no-op build is answered from memory
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto reply = request_build(socket_path, "one");
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        assert(reply && *reply);
+        assert(reply->executed == 0);
+        assert(reply->skipped == 4);
+        std::cout << "  Test 6B: no-op build ("
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         elapsed)
+                         .count()
+                  << " us)... Passed\n";
+    }
+
+    // Test 6C: edits seen by the resident watcher are rebuilt
+    {
+        write_file(temp_dir / "two" / "C.ixx", "export module C; // edit");
+        std::this_thread::sleep_for(50ms); // let the notification arrive
+        auto reply = request_build(socket_path, "two");
+        assert(reply && reply->executed == 1);
+
+        reply = request_build(socket_path, "two", true);
+        assert(reply && reply->executed == 0 && reply->skipped == 4);
+        std::cout << "  Test 6C: incremental rebuild... Passed\n";
+    }
+
+    // Test 6D: errors are reported to the client
+    {
+        auto reply = request_build(socket_path, "missing");
+        assert(reply && !reply->ok);
+        assert(reply->message.find("missing") != std::string::npos);
+        std::cout << "  Test 6D: unknown project... Passed\n";
+    }
+
+    // Test 6E: a client can shut the server down
+    {
+        assert(request_shutdown(socket_path));
+        server.wait();
+        server.stop();
+        assert(!fs::exists(socket_path));
+        assert(!request_build(socket_path, "one").has_value());
+        std::cout << "  Test 6E: shutdown... Passed\n";
+    }
+
+#if !defined(_WIN32)
+    // Test 6F: a client that never sends its request does not block stop()
+    {
+        const path silent_socket = temp_dir / "silent.sock";
+        BuildServer silent_server(silent_socket, factory, 1);
+        assert(silent_server.start());
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, silent_socket.c_str(),
+                     sizeof(address.sun_path) - 1);
+        assert(::connect(fd, reinterpret_cast<sockaddr*>(&address),
+                         sizeof(address)) == 0);
+        assert(::send(fd, "build", 5, 0) == 5); // no newline
+        std::this_thread::sleep_for(50ms); // let the handler start reading
+
+        const auto start = std::chrono::steady_clock::now();
+        silent_server.stop();
+        assert(std::chrono::steady_clock::now() - start < 5s);
+        ::close(fd);
+        std::cout << "  Test 6F: silent client... Passed\n";
+    }
+#endif
+
+    std::cout << "--- BuildServer tests all passed ---\n\n";
+}
+
+int main()
+{
+    auto temp_dir = fs::temp_directory_path() / "importa_test_build_server";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    temp_dir = fs::canonical(temp_dir);
+
+    try
+    {
+        test_build_server(temp_dir);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "All BuildServer tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,451 @@
+// tests_builder.cpp
+// Contains unit tests for the Builder, using a mock executor.
+
+import std;
+import executor;
+import build_log;
+import deps_log;
+import thread_pool;
+import file_hash_cache;
+import module_processor;
+import builder;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::build_log;
+using namespace importa::deps_log;
+using namespace importa::thread_pool;
+using namespace importa::file_hash_cache;
+using namespace importa::module_processor;
+using namespace importa::builder;
+
+// --- Mock Object Definition ---
+
+// Treats the first argument as the output file and writes the remaining
+// arguments into it, so every "compile" produces a real artifact.
+// "-MF <file>" makes it write depfile_content to <file>, like clang -MD.
+// Outputs named "*.fail" make the command fail.
+struct MockExecutor : public IExecutor
+{
+    std::mutex mutex;
+    std::vector<std::string> executed;
+    std::string depfile_content;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        {
+            std::lock_guard lock(mutex);
+            executed.push_back(command.arguments.front());
+        }
+        if (command.arguments.front().ends_with(".fail"))
+        {
+            return { .success = false, .exit_code = 1 };
+        }
+        std::ofstream out(command.arguments.front(), std::ios::trunc);
+        for (std::size_t i = 1; i < command.arguments.size(); ++i)
+        {
+            out << command.arguments[i];
+            if (command.arguments[i] == "-MF")
+            {
+                std::ofstream depfile(command.arguments[++i]);
+                depfile << depfile_content;
+            }
+        }
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+// Holds each command briefly and records, per output, the most commands
+// that were running at once while it ran.
+struct OverlapExecutor : public IExecutor
+{
+    std::mutex mutex;
+    std::set<std::string> running;
+    std::map<std::string, std::size_t> peak;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const std::string output = command.arguments.front();
+        {
+            std::lock_guard lock(mutex);
+            running.insert(output);
+            for (const auto& name : running)
+            {
+                peak[name] = std::max(peak[name], running.size());
+            }
+        }
+        std::this_thread::sleep_for(30ms);
+        std::ofstream(output, std::ios::trunc) << command.arguments.back();
+        std::lock_guard lock(mutex);
+        running.erase(output);
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+BuildAction make_action(const path& source, const path& output,
+                        std::vector<path> extra_inputs = {})
+{
+    BuildAction action;
+    action.command.executable = "compiler";
+    action.command.arguments = { output.string(), source.string() };
+    action.primary_output = output;
+    action.inputs = { source };
+    action.inputs.insert(action.inputs.end(), extra_inputs.begin(),
+                         extra_inputs.end());
+    action.outputs = { output };
+    return action;
+}
+} // namespace
+
+// --- Test Suite for Builder ---
+
+void test_builder()
+{
+    std::cout << "--- Running Test Suite: Builder ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_builder";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+
+    const path core_src = temp_dir / "core.ixx";
+    const path core_ifc = temp_dir / "core.ifc";
+    const path app_src = temp_dir / "app.cpp";
+    const path app_obj = temp_dir / "app.obj";
+    write_file(core_src, "export module core;");
+    write_file(app_src, "import core;");
+
+    std::vector<BuildAction> actions = {
+        make_action(core_src, core_ifc),
+        make_action(app_src, app_obj, { core_ifc }),
+    };
+
+    BuildLog log(temp_dir / ".importa_log");
+    MockExecutor executor;
+    Builder builder(executor, log);
+
+    // Test 3A: first build runs everything
+    {
+        auto stats = builder.build(actions);
+        assert(stats);
+        assert(stats.executed == 2);
+        assert(stats.skipped == 0);
+        std::cout << "  Test 3A: initial build... Passed\n";
+    }
+
+    // Test 3B: no-op build runs nothing
+    {
+        executor.executed.clear();
+        auto stats = builder.build(actions);
+        assert(stats.executed == 0);
+        assert(stats.skipped == 2);
+        assert(builder.is_up_to_date(actions[0]));
+        std::cout << "  Test 3B: no-op build... Passed\n";
+    }
+
+    // Test 3C: a changed command reruns only that action
+    {
+        executor.executed.clear();
+        actions[1].command.arguments.push_back("-O2");
+        auto stats = builder.build(actions);
+        assert(stats.executed == 1);
+        assert(executor.executed.front() == app_obj.string());
+        std::cout << "  Test 3C: changed command... Passed\n";
+    }
+
+    // Test 3D: a changed source propagates through the rebuilt BMI
+    {
+        executor.executed.clear();
+        write_file(core_src, "export module core; // edited");
+        auto stats = builder.build(actions);
+        assert(stats.executed == 2);
+        std::cout << "  Test 3D: changed input propagates... Passed\n";
+    }
+
+    // Test 3E: a deleted output is rebuilt, state persists across logs
+    {
+        fs::remove(app_obj);
+        BuildLog reopened(temp_dir / ".importa_log");
+        Builder fresh_builder(executor, reopened);
+        executor.executed.clear();
+        auto stats = fresh_builder.build(actions);
+        assert(stats.executed == 1);
+        assert(stats.skipped == 1);
+        assert(executor.executed.front() == app_obj.string());
+        std::cout << "  Test 3E: missing output rebuilt... Passed\n";
+    }
+
+    // Test 3F: with content hashes, touching a file does not rebuild
+    {
+        thread_pool::ThreadPool pool(2);
+        FileHashCache hash_cache(temp_dir / ".importa_hashes", pool);
+        BuildLog hashed_log(temp_dir / ".importa_hashed_log");
+        Builder hashed_builder(executor, hashed_log, &hash_cache);
+        assert(hashed_builder.build(actions).executed == 2);
+
+        fs::last_write_time(app_src, fs::file_time_type::clock::now() +
+                                         std::chrono::seconds(5));
+        executor.executed.clear();
+        auto stats = hashed_builder.build(actions);
+        assert(stats.executed == 0);
+        assert(stats.skipped == 2);
+
+        write_file(app_src, "import core; int main() {}");
+        stats = hashed_builder.build(actions);
+        assert(stats.executed == 1);
+        assert(fs::exists(temp_dir / ".importa_hashes"));
+        std::cout << "  Test 3F: content-hash dirty detection... Passed\n";
+    }
+
+    // Test 3G: restat cuts off importers when the rebuilt BMI is identical
+    {
+        BuildLog restat_log(temp_dir / ".importa_restat_log");
+        Builder restat_builder(executor, restat_log);
+        auto restat_actions = actions;
+        restat_actions[0].restat = true;
+        assert(restat_builder.build(restat_actions).executed == 2);
+
+        // The mock BMI only depends on the command line, so editing the
+        // interface source re-emits a byte-identical BMI.
+        write_file(core_src, "export module core; // body-only edit");
+        executor.executed.clear();
+        auto stats = restat_builder.build(restat_actions);
+        assert(stats.executed == 1);
+        assert(stats.cut_off == 1);
+        assert(stats.skipped == 1);
+        assert(executor.executed.front() == core_ifc.string());
+
+        // A BMI whose bytes change still rebuilds its importers.
+        restat_actions[0].command.arguments.push_back("export int f();");
+        stats = restat_builder.build(restat_actions);
+        assert(stats.executed == 2);
+        assert(stats.cut_off == 0);
+        std::cout << "  Test 3G: restat early cutoff... Passed\n";
+    }
+
+    // Test 3H: headers reported through depfiles trigger rebuilds
+    {
+        const path header = temp_dir / "config.h";
+        const path depfile = temp_dir / "app.obj.d";
+        write_file(header, "#define LEVEL 1");
+        executor.depfile_content =
+            app_obj.string() + ": " + app_src.string() + " " + header.string();
+
+        auto header_actions = actions;
+        header_actions[1].depfile = depfile;
+        header_actions[1].command.arguments.push_back("-MF");
+        header_actions[1].command.arguments.push_back(depfile.string());
+
+        BuildLog header_log(temp_dir / ".importa_header_log");
+        DepsLog deps(temp_dir / ".importa_deps");
+        Builder header_builder(executor, header_log, nullptr, &deps);
+        assert(header_builder.build(header_actions).executed == 2);
+        assert(!fs::exists(depfile));
+        assert(*deps.get_deps(app_obj) == std::vector<path>{ header });
+        assert(header_builder.build(header_actions).executed == 0);
+
+        write_file(header, "#define LEVEL 22");
+        executor.executed.clear();
+        auto stats = header_builder.build(header_actions);
+        assert(stats.executed == 1);
+        assert(executor.executed.front() == app_obj.string());
+
+        // Without recorded deps the action cannot be proven clean.
+        DepsLog empty_deps(temp_dir / ".importa_deps_empty");
+        Builder forgetful_builder(executor, header_log, nullptr, &empty_deps);
+        assert(!forgetful_builder.is_up_to_date(header_actions[1]));
+        std::cout << "  Test 3H: header dependency tracking... Passed\n";
+    }
+
+    // Test 3I: select_affected keeps only the downstream cone of a change
+    {
+        const path lib_src = temp_dir / "lib.cpp";
+        const path lib_obj = temp_dir / "lib.obj";
+        auto graph = actions;
+        graph.push_back(make_action(lib_src, lib_obj));
+
+        auto affected = select_affected(graph, { core_src });
+        assert(affected.size() == 2);
+        assert(affected[0].primary_output == core_ifc);
+        assert(affected[1].primary_output == app_obj);
+
+        affected = select_affected(graph, { lib_src });
+        assert(affected.size() == 1);
+        assert(affected[0].primary_output == lib_obj);
+
+        // Header dependencies come from the deps log.
+        const path header = temp_dir / "config.h";
+        DepsLog deps(temp_dir / ".importa_deps_select");
+        deps.record_deps(lib_obj, { header });
+        graph[2].depfile = temp_dir / "lib.obj.d";
+        affected = select_affected(graph, { header }, &deps);
+        assert(affected.size() == 1);
+        assert(affected[0].primary_output == lib_obj);
+        assert(select_affected(graph, { temp_dir / "unrelated.h" }, &deps)
+                   .empty());
+        std::cout << "  Test 3I: select affected actions... Passed\n";
+    }
+
+    // Test 3J: independent actions run on the job pool, dependents wait
+    {
+        const path util_src = temp_dir / "util.cpp";
+        const path util_obj = temp_dir / "util.obj";
+        write_file(util_src, "int util();");
+        auto graph = actions;
+        graph.push_back(make_action(util_src, util_obj));
+        graph.push_back(make_action(app_src, temp_dir / "app.exe",
+                                    { app_obj, util_obj }));
+
+        thread_pool::ThreadPool pool(4);
+        BuildLog parallel_log(temp_dir / ".importa_parallel_log");
+        Builder parallel_builder(executor, parallel_log, nullptr, nullptr,
+                                 &pool);
+        executor.executed.clear();
+        auto stats = parallel_builder.build(graph);
+        assert(stats);
+        assert(stats.executed == 4);
+        auto position = [&](const path& output)
+        {
+            return std::ranges::find(executor.executed, output.string()) -
+                   executor.executed.begin();
+        };
+        assert(position(core_ifc) < position(app_obj));
+        assert(position(app_obj) < position(temp_dir / "app.exe"));
+        assert(position(util_obj) < position(temp_dir / "app.exe"));
+        assert(parallel_builder.build(graph).skipped == 4);
+
+        // A failure stops scheduling; its dependents never start.
+        graph[2].command.arguments.front() = (temp_dir / "util.fail").string();
+        graph[2].primary_output = temp_dir / "util.fail";
+        graph[3].inputs.back() = temp_dir / "util.fail";
+        graph[2].outputs = { temp_dir / "util.fail" };
+        executor.executed.clear();
+        stats = parallel_builder.build(graph);
+        assert(!stats);
+        assert(stats.failed == 1);
+        assert(std::ranges::find(executor.executed,
+                                 (temp_dir / "app.exe").string()) ==
+               executor.executed.end());
+        std::cout << "  Test 3J: parallel execution on a job pool... Passed\n";
+    }
+
+    // Test 3K: clear_outputs deletes old outputs before the tool runs
+    {
+        const path archive = temp_dir / "core.lib";
+        const path stale = temp_dir / "core.lib.member";
+        auto archive_action = make_action(core_src, archive);
+        archive_action.outputs.push_back(stale);
+        archive_action.clear_outputs = true;
+        write_file(stale, "removed member");
+
+        BuildLog archive_log(temp_dir / ".importa_archive_log");
+        Builder archive_builder(executor, archive_log);
+        assert(archive_builder.build({ archive_action }).executed == 1);
+        assert(fs::exists(archive));
+        assert(!fs::exists(stale));
+        std::cout << "  Test 3K: clear outputs before running... Passed\n";
+    }
+
+    // Test 3L: recently edited sources run first, after what they import
+    {
+        const path base_src = temp_dir / "base.ixx";
+        const path other_src = temp_dir / "other.cpp";
+        const path edited_src = temp_dir / "edited.cpp";
+        write_file(base_src, "export module base;");
+        write_file(other_src, "int other();");
+        write_file(edited_src, "import base;");
+        const path base_ifc = temp_dir / "base.ifc";
+        const std::vector<BuildAction> graph = {
+            make_action(base_src, base_ifc),
+            make_action(other_src, temp_dir / "other.obj"),
+            make_action(edited_src, temp_dir / "edited.obj", { base_ifc }),
+        };
+
+        const auto now = fs::file_time_type::clock::now();
+        fs::last_write_time(base_src, now - 3h);
+        fs::last_write_time(other_src, now - 2h);
+        fs::last_write_time(edited_src, now - 1h);
+        BuildLog order_log(temp_dir / ".importa_order_log");
+        Builder order_builder(executor, order_log);
+        executor.executed.clear();
+        assert(order_builder.build(graph).executed == 3);
+        assert((executor.executed ==
+                std::vector<std::string>{ base_ifc.string(),
+                                          (temp_dir / "edited.obj").string(),
+                                          (temp_dir / "other.obj").string() }));
+
+        // Once other.cpp is the newest edit it jumps the queue.
+        write_file(other_src, "int other(); // edit");
+        write_file(base_src, "export module base; // edit");
+        fs::last_write_time(base_src, now - 3h);
+        executor.executed.clear();
+        assert(order_builder.build(graph).executed == 3);
+        assert(executor.executed.front() == (temp_dir / "other.obj").string());
+        std::cout << "  Test 3L: edit-order priority... Passed\n";
+    }
+
+    // Test 3M: an action with several slots runs only when they are free
+    {
+        std::vector<BuildAction> graph;
+        for (const auto* name : { "a", "b", "c" })
+        {
+            const path src = temp_dir / (std::string(name) + ".cpp");
+            write_file(src, name);
+            graph.push_back(
+                make_action(src, temp_dir / (std::string(name) + ".obj")));
+        }
+        auto link = make_action(temp_dir / "a.cpp", temp_dir / "lto.exe");
+        link.slots = 4;
+        graph.insert(graph.begin() + 1, link);
+
+        ThreadPool pool(4);
+        OverlapExecutor overlap;
+        BuildLog slots_log(temp_dir / ".importa_slots_log");
+        Builder slots_builder(overlap, slots_log, nullptr, nullptr, &pool);
+        assert(slots_builder.build(graph).executed == 4);
+        const std::string lto = (temp_dir / "lto.exe").string();
+        assert(overlap.peak.at(lto) == 1);
+        assert(overlap.peak.at((temp_dir / "c.obj").string()) > 1);
+
+        // More slots than the pool has are capped instead of waiting forever.
+        graph[1].slots = 16;
+        graph[1].command.arguments.push_back("-flto-jobs=16");
+        overlap.peak.clear();
+        assert(slots_builder.build(graph).executed == 1);
+        assert(overlap.peak.at(lto) == 1);
+        std::cout << "  Test 3M: multi-slot actions... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- Builder tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_builder();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All Builder tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,195 @@
+// tests_compression.cpp
+// Contains unit tests for the artifact compression codec.
+
+import std;
+import compression;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa::compression;
+
+// --- Helper Functions ---
+
+// Text with the kind of repetition object files have: a small vocabulary of
+// long identifiers in varying order.
+std::string symbol_soup(std::size_t size, unsigned seed)
+{
+    const std::array<std::string_view, 6> words = {
+        "?get_value@Widget@importa@@QEBAHXZ ",
+        "_ZNSt6vectorIiSaIiEE9push_backERKi ",
+        "std::basic_string<char> ",
+        "importa::module_processor::ModuleProcessor ",
+        "\x01\x02\x03\x04\x00\x00\x00\x00",
+        "operator<=> ",
+    };
+    std::mt19937 rng(seed);
+    std::string text;
+    while (text.size() < size)
+    {
+        text += words[rng() % words.size()];
+        text += static_cast<char>('a' + rng() % 26);
+    }
+    text.resize(size);
+    return text;
+}
+
+std::string random_bytes(std::size_t size, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::string bytes(size, '\0');
+    for (auto& byte : bytes)
+    {
+        byte = static_cast<char>(rng());
+    }
+    return bytes;
+}
+
+std::string read_all(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+void round_trip(const std::string& data, Level level)
+{
+    const std::string packed = compress_block(data, level);
+    auto unpacked = decompress_block(packed, data.size());
+    assert(unpacked.has_value());
+    assert(*unpacked == data);
+}
+
+// --- Test Suite for compression ---
+
+void test_compression()
+{
+    std::cout << "--- Running Test Suite: compression ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_compression";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+
+    // Test 12A: blocks round-trip at both levels
+    {
+        const std::vector<std::string> samples = {
+            "",
+            "a",
+            "hello, world",
+            std::string(100000, 'z'),     // overlapping matches
+            std::string(300, 'q') + "x",  // long literal/match lengths
+            symbol_soup(70000, 1),        // matches beyond 64 KiB windows
+            random_bytes(5000, 2),
+        };
+        for (const auto& sample : samples)
+        {
+            round_trip(sample, Level::fast);
+            round_trip(sample, Level::high);
+        }
+        std::cout << "  Test 12A: block round trips... Passed\n";
+    }
+
+    // Test 12B: repetitive data shrinks, and the high level shrinks it more
+    {
+        const std::string soup = symbol_soup(200000, 3);
+        const auto fast = compress_block(soup, Level::fast).size();
+        const auto high = compress_block(soup, Level::high).size();
+        assert(fast * 3 < soup.size());
+        assert(high <= fast);
+        std::cout << "  Test 12B: compression ratio (" << soup.size() << " -> "
+                  << fast << " fast, " << high << " high)... Passed\n";
+    }
+
+    // Test 12C: corrupt blocks are rejected instead of overrunning
+    {
+        const std::string soup = symbol_soup(4000, 4);
+        std::string packed = compress_block(soup, Level::fast);
+        assert(!decompress_block(packed, soup.size() - 1).has_value());
+        assert(!decompress_block(packed.substr(0, packed.size() / 2),
+                                 soup.size())
+                    .has_value());
+        for (std::size_t i = 0; i < packed.size(); i += 7)
+        {
+            std::string damaged = packed;
+            damaged[i] = static_cast<char>(damaged[i] ^ 0x5A);
+            auto result = decompress_block(damaged, soup.size());
+            assert(!result || result->size() == soup.size());
+        }
+        std::cout << "  Test 12C: corrupt block handling... Passed\n";
+    }
+
+    // Test 12D: files stream through multiple blocks and report both sizes
+    {
+        const path raw = temp_dir / "big.obj";
+        const path packed = temp_dir / "big.obj.z";
+        const path repacked = temp_dir / "big.obj.z2";
+        const path restored = temp_dir / "big.obj.out";
+        const std::string content =
+            symbol_soup(700000, 5) + random_bytes(300000, 6);
+        std::ofstream(raw, std::ios::binary) << content;
+
+        auto sizes = compress_file(raw, packed, Level::fast);
+        assert(sizes.has_value());
+        assert(sizes->raw_bytes == content.size());
+        assert(sizes->stored_bytes == fs::file_size(packed));
+        assert(sizes->stored_bytes < sizes->raw_bytes);
+        assert(decompress_file(packed, restored));
+        assert(read_all(restored) == content);
+
+        auto high = recompress_file(packed, repacked, Level::high);
+        assert(high.has_value());
+        assert(high->raw_bytes == content.size());
+        assert(high->stored_bytes <= sizes->stored_bytes);
+        assert(decompress_file(repacked, restored));
+        assert(read_all(restored) == content);
+
+        // Empty files still get a valid frame.
+        std::ofstream(temp_dir / "empty.obj");
+        assert(compress_file(temp_dir / "empty.obj", packed, Level::fast)
+                   ->raw_bytes == 0);
+        assert(decompress_file(packed, restored));
+        assert(fs::file_size(restored) == 0);
+        std::cout << "  Test 12D: streaming file round trip... Passed\n";
+    }
+
+    // Test 12E: damaged or foreign files fail to decompress
+    {
+        const path raw = temp_dir / "small.ifc";
+        const path packed = temp_dir / "small.ifc.z";
+        std::ofstream(raw, std::ios::binary) << symbol_soup(10000, 7);
+        assert(compress_file(raw, packed, Level::fast).has_value());
+
+        std::string bytes = read_all(packed);
+        bytes[bytes.size() / 2] ^= 0x01;
+        std::ofstream(packed, std::ios::binary) << bytes;
+        assert(!decompress_file(packed, temp_dir / "out"));
+
+        std::ofstream(packed, std::ios::binary) << bytes.substr(0, 20);
+        assert(!decompress_file(packed, temp_dir / "out"));
+        assert(!decompress_file(raw, temp_dir / "out"));
+        assert(!decompress_file(temp_dir / "missing", temp_dir / "out"));
+        std::cout << "  Test 12E: damaged files are rejected... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- compression tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_compression();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All compression tests passed successfully!\n";
+    return 0;
+}
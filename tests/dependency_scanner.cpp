@@ -0,0 +1,331 @@
+// tests_dependency_scanner.cpp
+// Contains unit tests for the DependencyScanner, using a mock toolchain and
+// a mock executor that answers with canned P1689 output.
+
+import std;
+import executor;
+import toolchains;
+import thread_pool;
+import file_hash_cache;
+import module_processor;
+import dependency_scanner;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::dependency_scanner;
+
+// --- Mock Object Definitions ---
+
+struct MockToolchain : public IToolchain
+{
+    std::optional<Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override
+    {
+        return Command{};
+    }
+
+    std::optional<Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override
+    {
+        return Command{};
+    }
+
+    std::optional<Command> generate_link_command(
+        const LinkArgs& args) const override
+    {
+        return Command{};
+    }
+
+    std::optional<Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override
+    {
+        Command cmd;
+        cmd.executable = "scan-deps";
+        cmd.arguments = { args.source_file.string(),
+                          args.dependency_file.string() };
+        return cmd;
+    }
+};
+
+// Prints the P1689 rule registered for the scanned source to stdout, and
+// writes a depfile listing the headers registered for it.
+struct MockExecutor : public IExecutor
+{
+    std::map<std::string, std::string> rules;
+    std::map<std::string, std::vector<path>> headers;
+    std::atomic<int> calls = 0;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        ++calls;
+        const auto& source = command.arguments.front();
+        if (auto it = headers.find(source); it != headers.end())
+        {
+            std::ofstream depfile(command.arguments[1]);
+            depfile << "scan.obj: " << source;
+            for (const auto& header : it->second)
+            {
+                depfile << " \\\n  " << header.string();
+            }
+            depfile << "\n";
+        }
+        return { .success = true,
+                 .exit_code = 0,
+                 .std_out = R"({"version": 1, "revision": 0, "rules": [)" +
+                            rules.at(command.arguments.front()) + "]}" };
+    }
+};
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+} // namespace
+
+// --- Test Suite for P1689 parsing and ModuleUnit assembly ---
+
+void test_build_module_units()
+{
+    std::cout << "--- Running Test Suite: build_module_units ---\n";
+
+    // Test 1A: parse_p1689
+    {
+        auto result = parse_p1689(R"({
+            "version": 1, "revision": 0,
+            "rules": [{
+                "primary-output": "gfx.obj",
+                "provides": [{ "logical-name": "gfx:shader",
+                               "is-interface": false }],
+                "requires": [{ "logical-name": "core" },
+                             { "logical-name": "gfx:types" }]
+            }]
+        })");
+        assert(result.has_value());
+        assert(result->provided_module == "gfx:shader");
+        assert(!result->is_interface);
+        assert((result->required_modules ==
+                std::vector<std::string>{ "core", "gfx:types" }));
+        assert(!parse_p1689("not json").has_value());
+        std::cout << "  Test 1A: parse_p1689... Passed\n";
+    }
+
+    // Test 1B: units are assembled and topologically ordered
+    {
+        std::vector<ScanResult> results = {
+            { .source_file = "main.cpp", .required_modules = { "gfx" } },
+            { .source_file = "gfx/gfx.ixx",
+              .provided_module = "gfx",
+              .is_interface = true,
+              .required_modules = { "core", "gfx:types", "std" } },
+            { .source_file = "gfx/types.ixx",
+              .provided_module = "gfx:types",
+              .is_interface = true },
+            { .source_file = "gfx/impl.cpp",
+              .implemented_module = "gfx",
+              .required_modules = { "gfx" } },
+            { .source_file = "core/core.ixx",
+              .provided_module = "core",
+              .is_interface = true },
+        };
+        auto units = build_module_units(results);
+        assert(units.has_value());
+        assert(units->size() == 3);
+        assert((*units)[0].name == "core");
+        assert((*units)[1].name == "gfx");
+        assert((*units)[2].name == kNonModuleUnitName);
+
+        const auto& gfx = (*units)[1];
+        assert(gfx.primary_interface == "gfx/gfx.ixx");
+        assert(gfx.partitions == std::vector<path>{ "gfx/types.ixx" });
+        assert(gfx.implementations == std::vector<path>{ "gfx/impl.cpp" });
+        assert((gfx.dependencies == std::vector<std::string>{ "core", "std" }));
+        assert((*units)[2].dependencies == std::vector<std::string>{ "gfx" });
+        assert(gfx.partition_info.at("gfx/types.ixx").name == "types");
+        std::cout << "  Test 1B: build_module_units... Passed\n";
+    }
+
+    // Test 1C: inconsistent inputs are rejected
+    {
+        std::vector<ScanResult> orphan = {
+            { .source_file = "impl.cpp", .implemented_module = "missing" },
+        };
+        assert(!build_module_units(orphan).has_value());
+
+        std::vector<ScanResult> cycle = {
+            { .source_file = "a.ixx",
+              .provided_module = "a",
+              .is_interface = true,
+              .required_modules = { "b" } },
+            { .source_file = "b.ixx",
+              .provided_module = "b",
+              .is_interface = true,
+              .required_modules = { "a" } },
+        };
+        assert(!build_module_units(cycle).has_value());
+
+        cycle = {
+            { .source_file = "m.ixx", .provided_module = "m" },
+            { .source_file = "a.ixx",
+              .provided_module = "m:a",
+              .required_modules = { "m:b" } },
+            { .source_file = "b.ixx",
+              .provided_module = "m:b",
+              .required_modules = { "m:a" } },
+        };
+        assert(!build_module_units(cycle).has_value());
+        std::cout << "  Test 1C: invalid module graphs... Passed\n";
+    }
+
+    // Test 1D: partitions are ordered by their imports, not their names
+    {
+        std::vector<ScanResult> results = {
+            { .source_file = "m/m.ixx",
+              .provided_module = "m",
+              .is_interface = true,
+              .required_modules = { "m:a", "m:b" } },
+            { .source_file = "m/a.ixx",
+              .provided_module = "m:a",
+              .is_interface = true,
+              .required_modules = { "m:b", "std" } },
+            { .source_file = "m/b.cpp", .provided_module = "m:b" },
+            { .source_file = "m/c.ixx",
+              .provided_module = "m:c",
+              .is_interface = true },
+        };
+        auto units = build_module_units(results);
+        assert(units.has_value());
+        const auto& m = units->front();
+        assert((m.partitions ==
+                std::vector<path>{ "m/b.cpp", "m/c.ixx", "m/a.ixx" }));
+        const auto& a = m.partition_info.at("m/a.ixx");
+        assert(a.name == "a" && a.is_interface);
+        assert(a.imports == std::vector<std::string>{ "b" });
+        assert(!m.partition_info.at("m/b.cpp").is_interface);
+        assert(m.dependencies == std::vector<std::string>{ "std" });
+        std::cout << "  Test 1D: partition import order... Passed\n";
+    }
+    std::cout << "--- build_module_units tests all passed ---\n\n";
+}
+
+// --- Test Suite for DependencyScanner ---
+
+void test_dependency_scanner()
+{
+    std::cout << "--- Running Test Suite: DependencyScanner ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_scanner";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+
+    const path iface = temp_dir / "core.ixx";
+    const path impl = temp_dir / "core_impl.cpp";
+    write_file(iface, "export module core;");
+    write_file(impl, "module;\n#include <cstdio>\nmodule core;\n");
+
+    MockToolchain toolchain;
+    MockExecutor executor;
+    executor.rules[iface.string()] =
+        R"({"provides": [{"logical-name": "core", "is-interface": true}]})";
+    executor.rules[impl.string()] =
+        R"({"requires": [{"logical-name": "core"}]})";
+
+    thread_pool::ThreadPool pool(2);
+    file_hash_cache::FileHashCache hash_cache(temp_dir / ".importa_hashes",
+                                              pool);
+
+    // Test 2A: scanning produces module units
+    {
+        DependencyScanner scanner(toolchain, executor, pool, hash_cache,
+                                  temp_dir / "scan");
+        auto results = scanner.scan({ iface, impl });
+        assert(results.has_value());
+        assert(scanner.files_scanned() == 2);
+        assert((*results)[1].implemented_module == "core");
+
+        auto units = build_module_units(*results);
+        assert(units.has_value());
+        assert(units->size() == 1);
+        assert(units->front().primary_interface == iface);
+        assert(units->front().implementations == std::vector<path>{ impl });
+        assert(units->front().dependencies.empty());
+        std::cout << "  Test 2A: scan and assemble... Passed\n";
+    }
+
+    // Test 2B: rescans only touch changed sources
+    {
+        DependencyScanner scanner(toolchain, executor, pool, hash_cache,
+                                  temp_dir / "scan");
+        assert(scanner.scan({ iface, impl }).has_value());
+        assert(scanner.files_scanned() == 0);
+
+        write_file(impl, "module core;\nimport std;\n");
+        executor.rules[impl.string()] =
+            R"({"requires": [{"logical-name": "core"},
+                             {"logical-name": "std"}]})";
+        auto results = scanner.scan({ iface, impl });
+        assert(results.has_value());
+        assert(scanner.files_scanned() == 1);
+        assert((*results)[1].required_modules.size() == 2);
+        assert((*results)[1].implemented_module == "core");
+        std::cout << "  Test 2B: cached rescans... Passed\n";
+    }
+
+    // Test 2C: editing an included header rescans its includers
+    {
+        const path config = temp_dir / "config.h";
+        write_file(config, "#define CORE_USES_STD 0\n");
+        write_file(impl, "module;\n#include \"config.h\"\nmodule core;\n");
+        executor.headers[impl.string()] = { config };
+        DependencyScanner scanner(toolchain, executor, pool, hash_cache,
+                                  temp_dir / "scan");
+        assert(scanner.scan({ iface, impl }).has_value());
+        assert(scanner.files_scanned() == 1);
+        for (const auto& entry : fs::directory_iterator(temp_dir / "scan"))
+        {
+            assert(entry.path().extension() != ".d");
+        }
+
+        assert(scanner.scan({ iface, impl }).has_value());
+        assert(scanner.files_scanned() == 1);
+
+        write_file(config, "#define CORE_USES_STD 1 // import std\n");
+        assert(scanner.scan({ iface, impl }).has_value());
+        assert(scanner.files_scanned() == 2);
+
+        fs::remove(config);
+        assert(scanner.scan({ iface, impl }).has_value());
+        assert(scanner.files_scanned() == 3);
+        std::cout << "  Test 2C: header edits invalidate scans... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- DependencyScanner tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_build_module_units();
+        test_dependency_scanner();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All DependencyScanner tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,147 @@
+// tests_deps_log.cpp
+// Contains unit tests for the deps_log module.
+
+import std;
+import deps_log;
+
+#include <cassert>
+
+using namespace importa;
+using namespace importa::deps_log;
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+// --- Test Suite for dependency file parsers ---
+
+void test_parsers()
+{
+    std::cout << "--- Running Test Suite: dependency parsers ---\n";
+
+    // Test 1A: Makefile depfiles with continuations and escapes
+    {
+        auto deps = parse_makefile_deps(
+            "build/app.obj: src/app.cpp include/my\\ header.h \\\n"
+            "  C:\\sdk\\windows.h \\\r\n"
+            "  include/cost$$.h src/app.cpp\n");
+        assert(deps.size() == 4);
+        assert(deps[0] == "src/app.cpp");
+        assert(deps[1] == "include/my header.h");
+        assert(deps[2] == "C:\\sdk\\windows.h");
+        assert(deps[3] == "include/cost$.h");
+        std::cout << "  Test 1A: parse_makefile_deps... Passed\n";
+    }
+
+    // Test 1B: MSVC /sourceDependencies JSON
+    {
+        auto deps = parse_msvc_source_dependencies(R"({
+            "Version": "1.2",
+            "Data": {
+                "Source": "c:\\src\\executor.cpp",
+                "ProvidedModule": "",
+                "Includes": [
+                    "c:\\sdk\\um\\windows.h",
+                    "c:\\src\\caf\u00e9.h"
+                ],
+                "ImportedModules": [],
+                "ImportedHeaderUnits": []
+            }
+        })");
+        assert(deps.size() == 2);
+        assert(deps[0] == path("c:\\sdk\\um\\windows.h"));
+        assert(deps[1] == path("c:\\src\\caf\xC3\xA9.h"));
+        assert(parse_msvc_source_dependencies("{}").empty());
+        std::cout << "  Test 1B: parse_msvc_source_dependencies... Passed\n";
+    }
+    std::cout << "--- dependency parser tests all passed ---\n\n";
+}
+
+// --- Test Suite for DepsLog ---
+
+void test_deps_log()
+{
+    std::cout << "--- Running Test Suite: DepsLog ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_deps_log";
+    fs::remove_all(temp_dir);
+    auto log_path = temp_dir / ".importa_deps";
+
+    const std::vector<path> app_deps = { "include/a.h", "include/windows.h" };
+    const std::vector<path> core_deps = { "include/windows.h" };
+
+    // Test 2A: deps survive reopening and share interned paths
+    {
+        {
+            DepsLog log(log_path);
+            assert(!log.get_deps("build/app.obj").has_value());
+            log.record_deps("build/app.obj", app_deps);
+            log.record_deps("build/core.obj", core_deps);
+            log.record_deps("build/empty.obj", {});
+        }
+        DepsLog log(log_path);
+        assert(log.size() == 3);
+        assert(*log.get_deps("build/app.obj") == app_deps);
+        assert(*log.get_deps("build/core.obj") == core_deps);
+        assert(log.get_deps("build/empty.obj")->empty());
+        std::cout << "  Test 2A: deps survive reopening... Passed\n";
+    }
+
+    // Test 2B: unchanged deps do not grow the log
+    {
+        auto size_before = fs::file_size(log_path);
+        {
+            DepsLog log(log_path);
+            log.record_deps("build/app.obj", app_deps);
+        }
+        assert(fs::file_size(log_path) == size_before);
+        std::cout << "  Test 2B: unchanged deps are not rewritten... Passed\n";
+    }
+
+    // Test 2C: a torn tail is discarded
+    {
+        auto intact_size = fs::file_size(log_path);
+        {
+            std::ofstream out(log_path, std::ios::binary | std::ios::app);
+            out.write("\x05\x00\x00\x80zz", 6);
+        }
+        DepsLog log(log_path);
+        assert(log.size() == 3);
+        assert(fs::file_size(log_path) == intact_size);
+        std::cout << "  Test 2C: torn tail is truncated... Passed\n";
+    }
+
+    // Test 2D: recompact keeps only the latest deps
+    {
+        {
+            DepsLog log(log_path);
+            log.record_deps("build/app.obj", { "include/b.h" });
+            log.recompact();
+        }
+        DepsLog log(log_path);
+        assert(log.size() == 3);
+        assert(*log.get_deps("build/app.obj") ==
+               std::vector<path>{ "include/b.h" });
+        assert(*log.get_deps("build/core.obj") == core_deps);
+        std::cout << "  Test 2D: recompact... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- DepsLog tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_parsers();
+        test_deps_log();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All DepsLog tests passed successfully!\n";
+    return 0;
+}
@@ -65,6 +65,7 @@ void test_dry_run_executor() {
 
 // --- Integration Tests ---
 
+#if defined(_WIN32)
 void test_local_executor() {
     std::cout << "--- Running integration test: LocalExecutor ---\n";
     LocalExecutor executor;
@@ -131,6 +132,71 @@ void test_local_executor() {
 
     std::cout << "--- All LocalExecutor tests passed ---\n\n";
 }
+#else
+void test_local_executor() {
+    std::cout << "--- Running integration test: LocalExecutor (POSIX) ---\n";
+    LocalExecutor executor;
+
+    // Test 3.1: Successful execution and capture stdout (resolved via PATH)
+    Command cmd_stdout;
+    cmd_stdout.executable = "sh";
+    cmd_stdout.arguments = {"-c", "echo hello executor"};
+    auto result_stdout = executor.execute(cmd_stdout);
+    assert(result_stdout.success);
+    assert(result_stdout.std_out == "hello executor\n");
+    assert(result_stdout.std_err.empty());
+    std::cout << "  Test 3.1: Capture stdout... Passed\n";
+
+    // Test 3.2: Process returns non-zero exit code
+    Command cmd_exit_code;
+    cmd_exit_code.executable = "/bin/sh";
+    cmd_exit_code.arguments = {"-c", "exit 99"};
+    auto result_exit_code = executor.execute(cmd_exit_code);
+    assert(!result_exit_code.success);
+    assert(result_exit_code.exit_code == 99);
+    std::cout << "  Test 3.2: Non-zero exit code... Passed\n";
+
+    // Test 3.3: Capture stderr and stdout together without deadlocking
+    Command cmd_both;
+    cmd_both.executable = "/bin/sh";
+    cmd_both.arguments = {"-c", "i=0; while [ $i -lt 20000 ]; do echo out; echo err >&2; i=$((i+1)); done"};
+    auto result_both = executor.execute(cmd_both);
+    assert(result_both.success);
+    assert(result_both.std_out.size() == 20000 * 4);
+    assert(result_both.std_err.size() == 20000 * 4);
+    std::cout << "  Test 3.3: Capture large stdout and stderr... Passed\n";
+
+    // Test 3.4: Start a non-existent command
+    Command cmd_non_existent;
+    cmd_non_existent.executable = "this_command_does_not_exist_12345";
+    bool exception_thrown = false;
+    try {
+        executor.execute(cmd_non_existent);
+    } catch (const std::runtime_error&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+    std::cout << "  Test 3.4: Non-existent command throws exception... Passed\n";
+
+    // Test 3.5: Working directory and environment variables
+    auto temp_dir = fs::canonical(fs::temp_directory_path()) / "importa_test_wd";
+    fs::create_directory(temp_dir);
+
+    Command cmd_wd;
+    cmd_wd.executable = "/bin/sh";
+    cmd_wd.arguments = {"-c", "pwd; echo $IMPORTA_TEST_VAR"};
+    cmd_wd.working_directory = temp_dir;
+    cmd_wd.environment_variables = {{"IMPORTA_TEST_VAR", "42"}};
+
+    auto result_wd = executor.execute(cmd_wd);
+    assert(result_wd.success);
+    assert(result_wd.std_out == temp_dir.string() + "\n42\n");
+    fs::remove(temp_dir); // Clean up temp directory
+    std::cout << "  Test 3.5: Working directory and environment... Passed\n";
+
+    std::cout << "--- All LocalExecutor tests passed ---\n\n";
+}
+#endif
 
 
 int main() {
@@ -0,0 +1,157 @@
+// tests_file_hash_cache.cpp
+// Contains unit tests for the thread_pool and file_hash_cache modules.
+
+import std;
+import thread_pool;
+import file_hash_cache;
+
+#include <cassert>
+
+using namespace importa;
+using namespace importa::thread_pool;
+using namespace importa::file_hash_cache;
+namespace fs = std::filesystem;
+
+namespace
+{
+void write_file(const fs::path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+// Moves the mtime out of the racy window so the entry is persisted.
+void age_file(const fs::path& file, std::chrono::hours age)
+{
+    fs::last_write_time(file, fs::file_time_type::clock::now() - age);
+}
+} // namespace
+
+// --- Test Suite for ThreadPool ---
+
+void test_thread_pool()
+{
+    std::cout << "--- Running Test Suite: ThreadPool ---\n";
+
+    ThreadPool pool(4);
+    assert(pool.size() == 4);
+
+    // Test 1A: submit returns results through futures
+    {
+        auto future = pool.submit([] { return 6 * 7; });
+        assert(future.get() == 42);
+        std::cout << "  Test 1A: submit... Passed\n";
+    }
+
+    // Test 1B: parallel_for_each visits every item and propagates errors
+    {
+        std::vector<int> items(100);
+        std::iota(items.begin(), items.end(), 1);
+        std::atomic<int> sum = 0;
+        parallel_for_each(pool, items, [&sum](int v) { sum += v; });
+        assert(sum == 5050);
+
+        bool exception_thrown = false;
+        try
+        {
+            parallel_for_each(pool, items,
+                              [](int v)
+                              {
+                                  if (v == 50)
+                                  {
+                                      throw std::runtime_error("boom");
+                                  }
+                              });
+        }
+        catch (const std::runtime_error&)
+        {
+            exception_thrown = true;
+        }
+        assert(exception_thrown);
+        std::cout << "  Test 1B: parallel_for_each... Passed\n";
+    }
+    std::cout << "--- ThreadPool tests all passed ---\n\n";
+}
+
+// --- Test Suite for FileHashCache ---
+
+void test_file_hash_cache()
+{
+    std::cout << "--- Running Test Suite: FileHashCache ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_hash_cache";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const auto db_path = temp_dir / ".importa_hashes";
+    const auto a = temp_dir / "a.ixx";
+    const auto b = temp_dir / "b.cpp";
+    write_file(a, "export module a;");
+    write_file(b, "module a;");
+    age_file(a, std::chrono::hours(2));
+    age_file(b, std::chrono::hours(2));
+
+    ThreadPool pool(2);
+    std::uint64_t hash_a = 0;
+
+    // Test 2A: hashes depend only on content
+    {
+        FileHashCache cache(db_path, pool);
+        cache.hash_all({ a, b });
+        assert(cache.files_read() == 2);
+        hash_a = *cache.hash(a);
+        assert(cache.files_read() == 2);
+        assert(hash_a != *cache.hash(b));
+        assert(!cache.hash(temp_dir / "missing.cpp").has_value());
+
+        // A checkout that rewrites identical content only moves the mtime.
+        write_file(b, "export module a;");
+        age_file(b, std::chrono::hours(1));
+        assert(*cache.hash(b) == hash_a);
+        assert(cache.files_read() == 3);
+        cache.save();
+        std::cout << "  Test 2A: content hashing... Passed\n";
+    }
+
+    // Test 2B: a reloaded cache never rereads unchanged files
+    {
+        FileHashCache cache(db_path, pool);
+        assert(cache.size() == 2);
+        assert(*cache.hash(a) == hash_a);
+        assert(*cache.hash(b) == hash_a);
+        assert(cache.files_read() == 0);
+        std::cout << "  Test 2B: persisted cache... Passed\n";
+    }
+
+    // Test 2C: changed content is detected
+    {
+        FileHashCache cache(db_path, pool);
+        write_file(a, "export module a; export int f();");
+        assert(*cache.hash(a) != hash_a);
+        assert(cache.files_read() == 1);
+        // The identity seen while hashing is served without another stat.
+        assert(cache.identity(a) == stat_file(a));
+        assert(!cache.identity(temp_dir / "missing.cpp").has_value());
+        std::cout << "  Test 2C: changed content... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- FileHashCache tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_thread_pool();
+        test_file_hash_cache();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All FileHashCache tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,281 @@
+// tests_gcc_module_mapper.cpp
+// Contains unit tests for the in-process GCC module mapper.
+
+import std;
+import toolchains;
+import module_processor;
+import gcc_module_mapper;
+
+#include <cassert>
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::gcc_module_mapper;
+
+// --- Helper Functions ---
+
+namespace
+{
+// Plans App -> Core (with partition Core:detail) -> Base with the GCC
+// toolchain.
+std::vector<BuildAction> plan_with_gcc(const path& build_dir)
+{
+    Project project;
+    project.name = "App";
+    project.modules = {
+        { .name = "Base", .primary_interface = "src/base.ixx" },
+        { .name = "Core",
+          .primary_interface = "src/core.ixx",
+          .partitions = { "src/detail.ixx" },
+          .implementations = { "src/core_impl.cpp" },
+          .dependencies = { "Base" } },
+        { .name = "App",
+          .primary_interface = "src/app.ixx",
+          .dependencies = { "Core" } },
+    };
+    GccToolchain gcc("g++", BuildConfigurationFactory::create_debug_default(),
+                     "=/tmp/mapper.sock");
+    ProjectProcessor processor(project, gcc, build_dir);
+    auto plan = processor.generate_build_plan();
+    assert(plan.has_value());
+    return plan->actions;
+}
+
+// The ident GccToolchain puts after '?' in -fmodule-mapper.
+std::string ident_of(const BuildAction& action)
+{
+    for (const auto& arg : action.command.arguments)
+    {
+        if (arg.starts_with("-fmodule-mapper="))
+        {
+            return arg.substr(arg.find('?') + 1);
+        }
+    }
+    return {};
+}
+
+const BuildAction& action_for(const std::vector<BuildAction>& actions,
+                              std::string_view source)
+{
+    return *std::ranges::find_if(
+        actions, [&](const BuildAction& action)
+        { return action.inputs.front() == path(source); });
+}
+
+#if !defined(_WIN32)
+// Sends one block and reads the reply up to its final newline.
+std::string round_trip(int fd, std::string_view block)
+{
+    assert(::write(fd, block.data(), block.size()) ==
+           static_cast<ssize_t>(block.size()));
+    std::string reply;
+    char c;
+    while (::read(fd, &c, 1) == 1)
+    {
+        reply.push_back(c);
+        if (c == '\n' && !reply.ends_with(" ;\n"))
+        {
+            break;
+        }
+    }
+    return reply;
+}
+#endif
+} // namespace
+
+// --- Test Suite for gcc_module_mapper ---
+
+void test_gcc_module_mapper()
+{
+    std::cout << "--- Running Test Suite: GccModuleMapper ---\n";
+
+    auto temp_dir =
+        fs::temp_directory_path() / "importa_test_gcc_module_mapper";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const path build_dir = temp_dir / "build";
+
+    // Test 15A: words are split and quoted the way libcody does
+    {
+        assert((split_words("MODULE-IMPORT Core") ==
+                std::vector<std::string>{ "MODULE-IMPORT", "Core" }));
+        assert((split_words("  HELLO 1 GCC 'a b' ;") ==
+                std::vector<std::string>{ "HELLO", "1", "GCC", "a b", ";" }));
+        assert((split_words("X 'it\\'s' '\\n\\\\' ''") ==
+                std::vector<std::string>{ "X", "it's", "\n\\", "" }));
+        assert(split_words("'\\41\\7f'") ==
+               std::vector<std::string>{ std::string("A\x7f") });
+
+        assert(quote_word("build/Core.gcm") == "build/Core.gcm");
+        assert(quote_word("") == "''");
+        for (const std::string& word : std::vector<std::string>{
+                 "my dir/x.gcm", "it's", "tab\there", "nul\x01" })
+        {
+            assert(split_words(quote_word(word)) ==
+                   std::vector<std::string>{ word });
+        }
+        std::cout << "  Test 15A: word encoding... Passed\n";
+    }
+
+    const auto actions = plan_with_gcc(build_dir);
+    ModuleMapper mapper;
+    mapper.set_actions(actions);
+
+    // Test 15B: CMI locations are served from the build graph
+    {
+        const auto& core = action_for(actions, "src/core.ixx");
+        const std::string core_gcm =
+            (build_dir / "Core" / "Core.gcm").string();
+        assert(std::ranges::find(core.outputs, path(core_gcm)) !=
+               core.outputs.end());
+
+        std::string ident;
+        assert(mapper.respond(ident, "HELLO 1 GCC " +
+                                         quote_word(ident_of(core))) ==
+               "HELLO 1 importa\n");
+        assert(ident == ident_of(core));
+        assert(mapper.respond(ident, "MODULE-REPO") == "PATHNAME ''\n");
+        assert(mapper.respond(ident, "MODULE-EXPORT Core") ==
+               "PATHNAME " + core_gcm + "\n");
+        assert(mapper.respond(ident, "MODULE-IMPORT Base") ==
+               "PATHNAME " + (build_dir / "Base" / "Base.gcm").string() +
+                   "\n");
+        assert(mapper.respond(ident, "MODULE-COMPILED Core") == "OK\n");
+        assert(mapper.respond(ident, "INCLUDE-TRANSLATE 'vector'") ==
+               "BOOL FALSE\n");
+
+        // The implementation unit imports its own interface implicitly.
+        const auto& impl = action_for(actions, "src/core_impl.cpp");
+        ident = ident_of(impl);
+        assert(mapper.respond(ident, "MODULE-IMPORT Core") ==
+               "PATHNAME " + core_gcm + "\n");
+
+        // Partition CMIs are declared in the graph under their module name.
+        const std::string detail_gcm =
+            (build_dir / "Core" / "Core-detail.gcm").string();
+        const auto& detail = action_for(actions, "src/detail.ixx");
+        ident = ident_of(detail);
+        assert(mapper.respond(ident, "MODULE-EXPORT Core:detail") ==
+               "PATHNAME " + detail_gcm + "\n");
+        for (const auto* importer : { &core, &impl })
+        {
+            ident = ident_of(*importer);
+            assert(mapper.respond(ident, "MODULE-IMPORT Core:detail") ==
+                   "PATHNAME " + detail_gcm + "\n");
+        }
+        std::cout << "  Test 15B: export and import lookups... Passed\n";
+    }
+
+    // Test 15C: batches, unknown modules and replanning
+    {
+        const auto& app = action_for(actions, "src/app.ixx");
+        std::string ident;
+        const auto reply =
+            mapper.respond(ident, "HELLO 1 GCC " + ident_of(app) +
+                                      " ;\nMODULE-REPO ;\n"
+                                      "MODULE-IMPORT Core ;\n"
+                                      "MODULE-IMPORT Missing");
+        std::vector<std::string> lines;
+        for (auto line : reply | std::views::split('\n'))
+        {
+            lines.emplace_back(line.begin(), line.end());
+        }
+        assert(lines.size() == 5 && lines[4].empty());
+        assert(lines[0] == "HELLO 1 importa ;");
+        assert(lines[2].ends_with("Core.gcm ;"));
+        assert(lines[3] == "ERROR 'unknown module \\'Missing\\''");
+
+        // Modules outside the declared inputs still resolve from the graph.
+        assert(mapper.respond(ident, "MODULE-IMPORT Base").ends_with(
+            "Base.gcm\n"));
+
+        // Exports the graph does not know about go beside the object.
+        ident = "build/App/part.obj";
+        assert(mapper.respond(ident, "MODULE-EXPORT App:Part") ==
+               "PATHNAME " + (path("build/App") / "App-Part.gcm").string() +
+                   "\n");
+        // ... and are imported from the same place.
+        ident = "build/App/app.obj";
+        assert(mapper.respond(ident, "MODULE-IMPORT App:Part") ==
+               "PATHNAME " + (path("build/App") / "App-Part.gcm").string() +
+                   "\n");
+
+        mapper.set_actions({});
+        assert(mapper.respond(ident, "MODULE-IMPORT Core").starts_with(
+            "ERROR"));
+        mapper.set_actions(actions);
+        assert(mapper.respond(ident, "BOGUS").starts_with("ERROR"));
+        std::cout << "  Test 15C: batches and errors... Passed\n";
+    }
+
+    // Test 15D: compilers talk to the server over a Unix domain socket
+#if !defined(_WIN32)
+    {
+        const path socket_path = temp_dir / "mapper.sock";
+        ModuleMapperServer server(socket_path, mapper);
+        assert(server.start());
+        assert(server.endpoint() == "=" + socket_path.string());
+
+        const auto& core = action_for(actions, "src/core.ixx");
+        std::vector<std::jthread> compilers;
+        std::atomic<int> answered = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            compilers.emplace_back(
+                [&]
+                {
+                    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                    sockaddr_un address{};
+                    address.sun_family = AF_UNIX;
+                    std::ranges::copy(socket_path.string(),
+                                      address.sun_path);
+                    assert(::connect(fd,
+                                     reinterpret_cast<sockaddr*>(&address),
+                                     sizeof(address)) == 0);
+                    assert(round_trip(fd, "HELLO 1 GCC " + ident_of(core) +
+                                            " ;\nMODULE-REPO\n") ==
+                           "HELLO 1 importa ;\nPATHNAME ''\n");
+                    assert(round_trip(fd, "MODULE-IMPORT Base\n")
+                               .ends_with("Base.gcm\n"));
+                    assert(round_trip(fd, "MODULE-EXPORT Core\n")
+                               .ends_with("Core.gcm\n"));
+                    ::close(fd);
+                    ++answered;
+                });
+        }
+        compilers.clear();
+        assert(answered == 4);
+        server.stop();
+        assert(!fs::exists(socket_path));
+        std::cout << "  Test 15D: socket server... Passed\n";
+    }
+#endif
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- GccModuleMapper tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_gcc_module_mapper();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All GccModuleMapper tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,321 @@
+// tests_graph_cache.cpp
+// Contains unit tests for the memory-mapped build graph cache.
+
+import std;
+import toolchains;
+import module_processor;
+import graph_cache;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::graph_cache;
+
+// --- Helper Functions ---
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    fs::create_directories(file.parent_path());
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+std::string read_file(const path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    return { std::istreambuf_iterator<char>(in),
+             std::istreambuf_iterator<char>() };
+}
+
+// A plan shaped like the one ProjectProcessor emits: one BMI action per
+// module, importing its predecessors, plus a final link.
+std::vector<BuildAction> synthetic_plan(std::size_t modules)
+{
+    std::vector<BuildAction> actions;
+    const path build = "build/ifc";
+    for (std::size_t i = 0; i < modules; ++i)
+    {
+        const std::string name = "mod" + std::to_string(i);
+        BuildAction action;
+        action.command.executable = "/usr/bin/clang++";
+        action.command.arguments = { "-std=c++23", "--precompile",
+                                     "src/" + name + ".cppm", "-o",
+                                     (build / (name + ".pcm")).string() };
+        action.command.working_directory = "/work";
+        action.primary_output = build / (name + ".pcm");
+        action.inputs = { "src/" + name + ".cppm" };
+        for (std::size_t dep = i >= 3 ? i - 3 : 0; dep < i; ++dep)
+        {
+            const auto ifc = build / ("mod" + std::to_string(dep) + ".pcm");
+            action.command.arguments.push_back("-fmodule-file=mod" +
+                                               std::to_string(dep) + "=" +
+                                               ifc.string());
+            action.inputs.push_back(ifc);
+        }
+        action.outputs = { action.primary_output,
+                           build / (name + ".o") };
+        action.depfile = build / (name + ".pcm.d");
+        action.restat = true;
+        action.interface_fingerprint = i % 2 == 0;
+        actions.push_back(std::move(action));
+    }
+
+    BuildAction link;
+    link.command.executable = "/usr/bin/clang++";
+    link.command.arguments = { "-o", "build/app" };
+    link.command.environment_variables = { { "LC_ALL", "C" },
+                                           { "TMPDIR", "/tmp" } };
+    link.primary_output = "build/app";
+    link.outputs = { "build/app" };
+    for (std::size_t i = 0; i < modules; ++i)
+    {
+        link.inputs.push_back(build / ("mod" + std::to_string(i) + ".o"));
+    }
+    link.pool = "link";
+    link.slots = 8;
+    link.clear_outputs = true;
+    link.depfile_format = DependencyFormat::MsvcSourceDependencies;
+    actions.push_back(std::move(link));
+    return actions;
+}
+
+bool same_action(const BuildAction& a, const BuildAction& b)
+{
+    return a.command.executable == b.command.executable &&
+           a.command.arguments == b.command.arguments &&
+           a.command.working_directory == b.command.working_directory &&
+           a.command.environment_variables ==
+               b.command.environment_variables &&
+           a.primary_output == b.primary_output && a.inputs == b.inputs &&
+           a.outputs == b.outputs && a.depfile == b.depfile &&
+           a.depfile_format == b.depfile_format && a.restat == b.restat &&
+           a.interface_fingerprint == b.interface_fingerprint &&
+           a.pool == b.pool && a.slots == b.slots &&
+           a.clear_outputs == b.clear_outputs;
+}
+} // namespace
+
+// --- Test Suite for graph_cache ---
+
+void test_graph_cache()
+{
+    std::cout << "--- Running Test Suite: GraphCache ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_graph_cache";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const path graph_file = temp_dir / "graph.bin";
+
+    // Test 14A: a written graph maps back to the same actions
+    {
+        const auto plan = synthetic_plan(8);
+        assert(write_graph(graph_file, 42, plan));
+        // no temporary file is left next to the graph
+        assert(std::distance(fs::directory_iterator(temp_dir),
+                             fs::directory_iterator()) == 1);
+
+        auto graph = MappedGraph::open(graph_file, 42);
+        assert(graph.has_value());
+        assert(graph->size() == plan.size());
+        const auto actions = graph->to_actions();
+        assert(actions.size() == plan.size());
+        for (std::size_t i = 0; i < plan.size(); ++i)
+        {
+            assert(same_action(actions[i], plan[i]));
+        }
+
+        assert(write_graph(graph_file, 7, {}));
+        auto empty = MappedGraph::open(graph_file, 7);
+        assert(empty && empty->size() == 0);
+
+        // Sessions sharing a build directory may save at the same time;
+        // each writes its own temporary file, so the graph stays whole.
+        {
+            std::vector<std::jthread> writers;
+            for (std::uint64_t id = 1; id <= 4; ++id)
+            {
+                writers.emplace_back(
+                    [&, id]
+                    {
+                        for (int i = 0; i < 20; ++i)
+                        {
+                            write_graph(graph_file, id, plan);
+                        }
+                    });
+            }
+        }
+        bool valid = false;
+        for (std::uint64_t id = 1; id <= 4; ++id)
+        {
+            if (auto graph = MappedGraph::open(graph_file, id))
+            {
+                valid = graph->size() == plan.size();
+            }
+        }
+        assert(valid);
+        std::cout << "  Test 14A: round trip... Passed\n";
+    }
+
+    // Test 14B: views decode in place and strings are stored once
+    {
+        const auto plan = synthetic_plan(50);
+        assert(write_graph(graph_file, 1, plan));
+        auto graph = MappedGraph::open(graph_file, 1);
+        assert(graph.has_value());
+
+        const ActionView link = graph->action(graph->size() - 1);
+        assert(link.pool == "link");
+        assert(link.slots == 8 && graph->action(0).slots == 1);
+        assert(link.clear_outputs && !link.restat);
+        assert(!link.interface_fingerprint);
+        assert(graph->action(0).interface_fingerprint);
+        assert(link.environment.size() == 4);
+        assert(link.environment[0] == "LC_ALL");
+        assert(link.environment[1] == "C");
+        assert(link.inputs.size() == 50);
+
+        const ActionView third = graph->action(3);
+        assert(third.executable == "/usr/bin/clang++");
+        assert(third.restat);
+        assert(third.inputs[0] == "src/mod3.cppm");
+        assert(third.inputs.size() == 4);
+
+        // Every BMI path is shared by its producer and up to three
+        // importers, and the link reuses every object path.
+        const auto size = fs::file_size(graph_file);
+        std::size_t raw = 0;
+        for (const auto& action : plan)
+        {
+            for (const auto& arg : action.command.arguments)
+            {
+                raw += arg.size();
+            }
+            for (const auto& input : action.inputs)
+            {
+                raw += input.string().size();
+            }
+            for (const auto& output : action.outputs)
+            {
+                raw += output.string().size();
+            }
+        }
+        assert(size < raw);
+
+        // Views outlive the MappedGraph they came from via copies.
+        auto copy = *graph;
+        graph.reset();
+        assert(copy.action(0).primary_output ==
+               path("build/ifc/mod0.pcm").generic_string());
+        std::cout << "  Test 14B: views and interning (" << size
+                  << " bytes vs " << raw << " raw)... Passed\n";
+    }
+
+    // Test 14C: stale, damaged, truncated or missing files are rejected
+    {
+        const auto plan = synthetic_plan(4);
+        assert(write_graph(graph_file, 99, plan));
+        assert(!MappedGraph::open(graph_file, 98).has_value());
+        assert(!MappedGraph::open(temp_dir / "missing.bin", 99).has_value());
+
+        const std::string bytes = read_file(graph_file);
+        std::string flipped = bytes;
+        flipped[bytes.size() / 2] ^= 0x20;
+        write_file(graph_file, flipped);
+        assert(!MappedGraph::open(graph_file, 99).has_value());
+
+        write_file(graph_file, bytes.substr(0, bytes.size() - 1));
+        assert(!MappedGraph::open(graph_file, 99).has_value());
+        write_file(graph_file, bytes.substr(0, 16));
+        assert(!MappedGraph::open(graph_file, 99).has_value());
+        write_file(graph_file, "");
+        assert(!MappedGraph::open(graph_file, 99).has_value());
+
+        write_file(graph_file, bytes);
+        assert(MappedGraph::open(graph_file, 99).has_value());
+        std::cout << "  Test 14C: invalidation and corruption... Passed\n";
+    }
+
+    // Test 14D: fingerprints follow the manifest and the toolchain
+    {
+        const path manifest = temp_dir / "project.impa";
+        write_file(manifest, "App Core");
+        const auto original = manifest_fingerprint({ manifest });
+        assert(manifest_fingerprint({ manifest }) == original);
+        write_file(manifest, "App Core Util");
+        assert(manifest_fingerprint({ manifest }) != original);
+        fs::remove(manifest);
+        assert(manifest_fingerprint({ manifest }) != original);
+        write_file(manifest, "");
+        assert(manifest_fingerprint({ manifest }) !=
+               manifest_fingerprint({ temp_dir / "missing.impa" }));
+
+        auto debug = BuildConfigurationFactory::create_debug_default();
+        auto release = BuildConfigurationFactory::create_release_default();
+        ClangToolchain clang_debug("clang++", debug);
+        ClangToolchain clang_again("clang++", debug);
+        ClangToolchain clang_release("clang++", release);
+        ClangToolchain clang_other("clang++-19", debug);
+        MsvcToolchain msvc("cl.exe", "link.exe", debug);
+        const auto fp = toolchain_fingerprint(clang_debug);
+        assert(toolchain_fingerprint(clang_again) == fp);
+        assert(toolchain_fingerprint(clang_release) != fp);
+        assert(toolchain_fingerprint(clang_other) != fp);
+        assert(toolchain_fingerprint(msvc) != fp);
+
+        debug.defines.push_back("FEATURE=1");
+        ClangToolchain clang_define("clang++", debug);
+        assert(toolchain_fingerprint(clang_define) != fp);
+        std::cout << "  Test 14D: fingerprints... Passed\n";
+    }
+
+    // Test 14E: a 4k-module graph opens in milliseconds
+    {
+        const auto plan = synthetic_plan(4000);
+        assert(write_graph(graph_file, 4000, plan));
+
+        const auto start = std::chrono::steady_clock::now();
+        auto graph = MappedGraph::open(graph_file, 4000);
+        const auto opened = std::chrono::steady_clock::now();
+        const auto actions = graph->to_actions();
+        const auto materialized = std::chrono::steady_clock::now();
+        assert(actions.size() == plan.size());
+        assert(same_action(actions[1234], plan[1234]));
+        assert(same_action(actions.back(), plan.back()));
+
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        std::cout << "  Test 14E: 4000 modules, "
+                  << fs::file_size(graph_file) / 1024 << " KiB, open "
+                  << duration_cast<microseconds>(opened - start).count()
+                  << " us, materialize "
+                  << duration_cast<microseconds>(materialized - opened)
+                         .count()
+                  << " us... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- GraphCache tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_graph_cache();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All GraphCache tests passed successfully!\n";
+    return 0;
+}
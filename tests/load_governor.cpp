@@ -0,0 +1,219 @@
+// tests_load_governor.cpp
+// Contains unit tests for pressure-driven concurrency control.
+
+import std;
+import thread_pool;
+import load_governor;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa::thread_pool;
+using namespace importa::load_governor;
+
+// --- Helper Functions ---
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    fs::create_directories(file.parent_path());
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+std::string pressure(double some, double full)
+{
+    return "some avg10=" + std::to_string(some) +
+           " avg60=0.00 avg300=0.00 total=1\n"
+           "full avg10=" +
+           std::to_string(full) + " avg60=0.00 avg300=0.00 total=0\n";
+}
+
+SystemLoad calm()
+{
+    return { .cpu = PressureStall{},
+             .memory = PressureStall{},
+             .io = PressureStall{},
+             .load_average = 0.5,
+             .cpu_count = 8 };
+}
+
+// Runs many short tasks and reports how many ran at the same time.
+int peak_concurrency(ThreadPool& pool)
+{
+    std::atomic<int> running = 0;
+    std::atomic<int> peak = 0;
+    std::vector<int> items(24);
+    parallel_for_each(pool, items,
+                      [&](int)
+                      {
+                          const int now = ++running;
+                          int seen = peak;
+                          while (now > seen &&
+                                 !peak.compare_exchange_weak(seen, now))
+                          {
+                          }
+                          std::this_thread::sleep_for(5ms);
+                          --running;
+                      });
+    return peak;
+}
+} // namespace
+
+// --- Test Suite for load_governor ---
+
+void test_load_governor()
+{
+    std::cout << "--- Running Test Suite: LoadGovernor ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_load_governor";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+
+    // Test 13A: PSI and loadavg parsing
+    {
+        auto io = parse_pressure(pressure(12.5, 3.25));
+        assert(io.has_value());
+        assert(io->some == 12.5);
+        assert(io->full == 3.25);
+
+        // Older kernels have no "full" line for cpu.
+        auto cpu = parse_pressure("some avg10=7.00 avg60=1.00 avg300=0.50 "
+                                  "total=99\n");
+        assert(cpu && cpu->some == 7.0 && cpu->full == 0.0);
+
+        assert(!parse_pressure("").has_value());
+        assert(!parse_pressure("some total=1\n").has_value());
+        assert(parse_load_average("3.52 2.10 1.05 2/1234 5678\n") == 3.52);
+        assert(!parse_load_average("busy").has_value());
+        std::cout << "  Test 13A: PSI parsing... Passed\n";
+    }
+
+    // Test 13B: reading a proc tree, with or without PSI
+    {
+        const path proc = temp_dir / "proc";
+        write_file(proc / "loadavg", "6.00 4.00 2.00 1/100 42\n");
+        assert(read_system_load(proc).has_value());
+        assert(!read_system_load(proc)->io.has_value());
+        assert(read_system_load(proc)->load_average == 6.0);
+
+        write_file(proc / "pressure" / "cpu", pressure(1, 0));
+        write_file(proc / "pressure" / "memory", pressure(2, 1));
+        write_file(proc / "pressure" / "io", pressure(30, 12));
+        auto load = read_system_load(proc);
+        assert(load && load->io && load->io->some == 30.0);
+        assert(load->memory->full == 1.0);
+
+        assert(!read_system_load(temp_dir / "missing").has_value());
+        std::cout << "  Test 13B: reading /proc... Passed\n";
+    }
+
+    // Test 13C: the limit backs off under pressure and recovers gradually
+    {
+        ThreadPool pool(8);
+        LoadGovernor governor(pool, { .min_jobs = 2 });
+        assert(governor.limit() == 8);
+        assert(pool.concurrency_limit() == 8);
+
+        auto thrashing = calm();
+        thrashing.io = PressureStall{ .some = 45, .full = 20 };
+        assert(governor.update(thrashing) == 6);
+        assert(governor.update(thrashing) == 5);
+        assert(governor.update(thrashing) == 4);
+        assert(governor.update(thrashing) == 3);
+        assert(governor.update(thrashing) == 2);
+        assert(governor.update(thrashing) == 2); // min_jobs
+        assert(pool.concurrency_limit() == 2);
+
+        // Between half and the full threshold the limit holds.
+        auto easing = calm();
+        easing.io = PressureStall{ .some = 15 };
+        assert(governor.update(easing) == 2);
+
+        assert(governor.update(calm()) == 3);
+        for (int i = 0; i < 10; ++i)
+        {
+            governor.update(calm());
+        }
+        assert(governor.limit() == 8); // max_jobs defaults to the pool size
+
+        // The load average alone also counts, scaled by the CPU count.
+        auto busy = calm();
+        busy.load_average = 20;
+        assert(governor.update(busy) == 6);
+
+        // Without PSI the load average still drives the limit.
+        busy.cpu.reset();
+        busy.memory.reset();
+        busy.io.reset();
+        assert(governor.update(busy) == 5);
+        std::cout << "  Test 13C: back-off and recovery... Passed\n";
+    }
+
+    // Test 13D: the pool honours a lowered limit and restores it afterwards
+    {
+        ThreadPool pool(6);
+        assert(peak_concurrency(pool) > 2);
+        {
+            LoadGovernor governor(pool, { .min_jobs = 2, .max_jobs = 4 });
+            assert(pool.concurrency_limit() == 4);
+            auto memory_bound = calm();
+            memory_bound.memory = PressureStall{ .some = 25 };
+            governor.update(memory_bound);
+            governor.update(memory_bound);
+            assert(pool.concurrency_limit() == 2);
+            assert(peak_concurrency(pool) <= 2);
+        }
+        assert(pool.concurrency_limit() == 6);
+
+        pool.set_concurrency_limit(0);
+        assert(pool.concurrency_limit() == 1);
+        pool.set_concurrency_limit(100);
+        assert(pool.concurrency_limit() == 6);
+        std::cout << "  Test 13D: pool concurrency limit... Passed\n";
+    }
+
+    // Test 13E: background sampling reacts to the proc files
+    {
+        const path proc = temp_dir / "sampled";
+        write_file(proc / "loadavg", "0.10 0.10 0.10 1/100 42\n");
+        write_file(proc / "pressure" / "io", pressure(80, 40));
+
+        ThreadPool pool(4);
+        LoadGovernor governor(pool, { .interval = 5ms });
+        governor.start(proc);
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (governor.limit() > 1 &&
+               std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(5ms);
+        }
+        assert(governor.limit() == 1);
+        assert(pool.concurrency_limit() == 1);
+        std::cout << "  Test 13E: background sampling... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- LoadGovernor tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_load_governor();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All LoadGovernor tests passed successfully!\n";
+    return 0;
+}
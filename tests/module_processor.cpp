@@ -5,6 +5,8 @@ import std;
 import executor;
 import toolchains;
 import module_processor;
+import unity_build;
+import precompiled_headers;
 
 #include <cassert>
 
@@ -33,6 +35,12 @@ struct MockToolchain : public IToolchain
         const EmitIFCArgs& args) const override
     {
         call_history.push_back({ "emit_ifc", args.interface_unit_path });
+        configurations[args.interface_unit_path] = args.configuration;
+        record_references(args.interface_unit_path, args.module_dependencies);
+        if (args.internal_partition)
+        {
+            internal_partitions.insert(args.interface_unit_path);
+        }
         return Command{};
     }
 
@@ -40,6 +48,12 @@ struct MockToolchain : public IToolchain
         const CompileObjectArgs& args) const override
     {
         call_history.push_back({ "compile_obj", args.source_file });
+        configurations[args.source_file] = args.configuration;
+        record_references(args.source_file, args.module_dependencies);
+        if (args.precompiled_header)
+        {
+            pch_uses[args.source_file] = args.precompiled_header->pch_path;
+        }
         return Command{};
     }
 
@@ -47,11 +61,66 @@ struct MockToolchain : public IToolchain
         const LinkArgs& args) const override
     {
         call_history.push_back({ "link" });
+        lto_cache_dir = args.lto_cache_dir;
+        link_optimization = args.optimization;
         return Command{};
     }
 
+    unsigned link_jobs() const override
+    {
+        return jobs;
+    }
+
+    std::optional<Command> generate_emit_pch_command(
+        const EmitPchArgs& args) const override
+    {
+        call_history.push_back({ "emit_pch", args.pch.header });
+        configurations[args.pch.header] = args.configuration;
+        return Command{};
+    }
+
+    std::optional<Command> generate_archive_command(
+        const ArchiveArgs& args) const override
+    {
+        call_history.push_back({ "archive", args.output_archive_path });
+        return Command{};
+    }
+
+    bool emit_ifc_writes_object() const override
+    {
+        return writes_interface_object;
+    }
+
+    bool writes_reduced_bmi() const override
+    {
+        return reduced_bmi;
+    }
+
+    // The source file of each compile and the PCH it was given, if any
+    mutable std::map<path, path> pch_uses;
+    // The configuration override each compiled file was given
+    mutable std::map<path, ConfigurationOverride> configurations;
+    // The module names each compiled file was given a BMI for
+    mutable std::map<path, std::set<std::string>> references;
+    mutable std::set<path> internal_partitions;
+    mutable path lto_cache_dir;
+    mutable std::optional<OptimizationLevel> link_optimization;
+    unsigned jobs = 1;
+    bool writes_interface_object = true;
+    bool reduced_bmi = false;
+
   private:
     BuildConfiguration m_config;
+
+    void record_references(const path& source,
+                           const std::vector<ModuleReference>& deps) const
+    {
+        auto& names = references[source];
+        for (const auto& dep : deps)
+        {
+            names.insert(dep.name);
+        }
+    }
 };
 
 // --- Test Suite for ModuleProcessor ---
@@ -86,11 +155,11 @@ void test_module_processor()
 
         assert(history.size() == 4);
 
-        // Verify call order and content
-        assert(history[0].function_name == "compile_obj");
+        // Verify call order and content: partitions produce BMIs too
+        assert(history[0].function_name == "emit_ifc");
         assert(history[0].source_file == "gfx/renderer.ixx");
 
-        assert(history[1].function_name == "compile_obj");
+        assert(history[1].function_name == "emit_ifc");
         assert(history[1].source_file == "gfx/shader.cpp");
 
         assert(history[2].function_name == "emit_ifc");
@@ -100,6 +169,469 @@ void test_module_processor()
         assert(history[3].source_file == "gfx/utils.cpp");
 
         std::cout << "  Test 2A: generate_build_plan call order... Passed\n";
+
+        // Test 2B: actions carry their inputs, outputs and restat flag
+        const auto& actions = plan_opt->actions;
+        assert(actions.size() == 4);
+        // Objects are restat too: an identical object does not relink.
+        const path renderer_bmi = "build/TestGfx/TestGfx-renderer.ifc";
+        const path shader_bmi = "build/TestGfx/TestGfx-shader.ifc";
+        assert(actions[0].restat);
+        assert(actions[0].inputs.front() == "gfx/renderer.ixx");
+        assert(actions[0].primary_output == renderer_bmi);
+        assert((actions[0].outputs ==
+                std::vector<path>{ renderer_bmi,
+                                   "build/TestGfx/renderer.obj" }));
+
+        // Without scanned partition imports, a partition may import any
+        // partition declared before it, and the interface any partition.
+        auto reads = [](const BuildAction& action, const path& file)
+        {
+            return std::ranges::find(action.inputs, file) !=
+                   action.inputs.end();
+        };
+        assert(reads(actions[1], renderer_bmi));
+        assert(!reads(actions[0], shader_bmi));
+        assert(reads(actions[2], renderer_bmi));
+        assert(reads(actions[2], shader_bmi));
+        assert((mock_toolchain.references.at("gfx/shader.cpp") ==
+                std::set<std::string>{ "Core", "TestGfx:renderer" }));
+
+        assert(actions[2].restat);
+        assert(actions[2].primary_output == plan_opt->final_ifc_path);
+
+        const auto& impl_inputs = actions[3].inputs;
+        assert(impl_inputs.front() == "gfx/utils.cpp");
+        assert(std::ranges::find(impl_inputs, path("build/Core/Core.ifc")) !=
+               impl_inputs.end());
+        assert(std::ranges::find(impl_inputs, plan_opt->final_ifc_path) !=
+               impl_inputs.end());
+        std::cout << "  Test 2B: action inputs and outputs... Passed\n";
+    }
+
+    // Test 2C: ProjectProcessor orders modules by their dependencies
+    {
+        Project project;
+        project.name = "App";
+        project.modules = {
+            { .name = "App",
+              .primary_interface = "app/app.ixx",
+              .dependencies = { "Gfx", "std" } },
+            { .name = "Gfx",
+              .primary_interface = "gfx/gfx.ixx",
+              .dependencies = { "Core" } },
+            { .name = "Core", .primary_interface = "core/core.ixx" },
+        };
+
+        auto debug_config = BuildConfigurationFactory::create_debug_default();
+        MockToolchain mock_toolchain(debug_config);
+        ProjectProcessor processor(project, mock_toolchain, "build",
+                                   { { "std", "prebuilt/std.ifc" } });
+
+        auto plan = processor.generate_build_plan();
+        assert(plan.has_value());
+        assert((plan->module_order ==
+                std::vector<std::string>{ "Core", "Gfx", "App" }));
+        assert(plan->actions.size() == 3);
+        assert(plan->module_ifcs.contains("Core"));
+        assert(!plan->module_ifcs.contains("std")); // external, not planned
+
+        // Every BMI an action reads is produced by an earlier action.
+        const auto& gfx_inputs = plan->actions[1].inputs;
+        assert(std::ranges::find(gfx_inputs, plan->module_ifcs.at("Core")) !=
+               gfx_inputs.end());
+
+        // Cycles are reported instead of producing a plan.
+        project.modules[2].dependencies = { "App" };
+        ProjectProcessor cyclic(project, mock_toolchain, "build");
+        assert(!cyclic.generate_build_plan().has_value());
+        std::cout << "  Test 2C: ProjectProcessor module order... Passed\n";
+    }
+
+    // Test 2D: unity mode compiles one generated source per batch
+    {
+        namespace fs = std::filesystem;
+        auto temp_dir = fs::temp_directory_path() / "importa_test_unity_plan";
+        fs::remove_all(temp_dir);
+        fs::create_directories(temp_dir);
+
+        ModuleUnit test_module;
+        test_module.name = "Gfx";
+        test_module.primary_interface = temp_dir / "gfx.ixx";
+        for (const char* name : { "a", "b", "c" })
+        {
+            const path impl = temp_dir / (std::string(name) + ".cpp");
+            std::ofstream(impl) << "module Gfx;\nint " << name << "();\n";
+            test_module.implementations.push_back(impl);
+        }
+
+        auto debug_config = BuildConfigurationFactory::create_debug_default();
+        MockToolchain mock_toolchain(debug_config);
+        std::map<std::string, path> dependency_ifcs;
+        const path build_dir = temp_dir / "build";
+        unity_build::UnityPlanner unity(build_dir);
+        ModuleProcessor processor(test_module, mock_toolchain, build_dir,
+                                  dependency_ifcs, { .unity = &unity });
+
+        auto plan = processor.generate_build_plan();
+        assert(plan.has_value());
+        assert(plan->actions.size() == 2); // interface + one unity batch
+        const auto& batch = plan->actions[1];
+        assert(mock_toolchain.call_history.back().source_file ==
+               build_dir / "Gfx" / "Gfx.unity0.cpp");
+        for (const auto& impl : test_module.implementations)
+        {
+            assert(std::ranges::find(batch.inputs, impl) != batch.inputs.end());
+        }
+        assert(std::ranges::find(batch.inputs, plan->final_ifc_path) !=
+               batch.inputs.end());
+        fs::remove_all(temp_dir);
+        std::cout << "  Test 2D: unity batches... Passed\n";
+    }
+
+    // Test 2E: implementation units with the same global module fragment
+    // share a PCH; interface units never use one
+    {
+        namespace fs = std::filesystem;
+        auto temp_dir = fs::temp_directory_path() / "importa_test_pch_plan";
+        fs::remove_all(temp_dir);
+        fs::create_directories(temp_dir);
+        const std::string fragment = "module;\n#include <cstdio>\n";
+
+        ModuleUnit test_module;
+        test_module.name = "Io";
+        test_module.primary_interface = temp_dir / "io.ixx";
+        test_module.partitions = { temp_dir / "file.ixx" };
+        test_module.implementations = { temp_dir / "read.cpp",
+                                        temp_dir / "write.cpp",
+                                        temp_dir / "plain.cpp" };
+        std::ofstream(test_module.primary_interface)
+            << fragment << "export module Io;\n";
+        std::ofstream(test_module.partitions[0])
+            << fragment << "export module Io:file;\n";
+        std::ofstream(test_module.implementations[0])
+            << fragment << "module Io;\n";
+        std::ofstream(test_module.implementations[1])
+            << fragment << "module Io;\n";
+        std::ofstream(test_module.implementations[2]) << "module Io;\n";
+
+        auto debug_config = BuildConfigurationFactory::create_debug_default();
+        MockToolchain mock_toolchain(debug_config);
+        std::map<std::string, path> dependency_ifcs;
+        const path build_dir = temp_dir / "build";
+        precompiled_headers::PchPlanner pch(build_dir);
+        ModuleProcessor processor(test_module, mock_toolchain, build_dir,
+                                  dependency_ifcs, { .pch = &pch });
+
+        auto plan = processor.generate_build_plan();
+        assert(plan.has_value());
+        assert(plan->actions.size() == 6);
+        assert(mock_toolchain.call_history.front().function_name ==
+               "emit_pch");
+        const path pch_path = plan->actions.front().primary_output;
+        assert(pch_path.extension() == ".pch");
+
+        const auto& uses = mock_toolchain.pch_uses;
+        assert(uses.size() == 2);
+        assert(uses.at(test_module.implementations[0]) == pch_path);
+        assert(uses.at(test_module.implementations[1]) == pch_path);
+        for (std::size_t i = 1; i < 6; ++i)
+        {
+            const auto& inputs = plan->actions[i].inputs;
+            assert((std::ranges::find(inputs, pch_path) != inputs.end()) ==
+                   (i == 3 || i == 4));
+        }
+        fs::remove_all(temp_dir);
+        std::cout << "  Test 2E: shared precompiled headers... Passed\n";
+    }
+
+    // Test 2F: several configurations are planned into one action list
+    {
+        Project project;
+        project.name = "App";
+        project.modules = {
+            { .name = "App",
+              .primary_interface = "app/app.ixx",
+              .implementations = { "app/main.cpp" },
+              .dependencies = { "Core", "std" } },
+            { .name = "Core", .primary_interface = "core/core.ixx" },
+        };
+
+        MockToolchain debug(BuildConfigurationFactory::create_debug_default());
+        MockToolchain release(
+            BuildConfigurationFactory::create_release_default());
+        MultiConfigProcessor processor(project, "build");
+        auto plan = processor.generate_build_plan({
+            { .name = "Debug",
+              .toolchain = &debug,
+              .external_ifcs = { { "std", "std/Debug/std.ifc" } } },
+            { .name = "Release",
+              .toolchain = &release,
+              .external_ifcs = { { "std", "std/Release/std.ifc" } } },
+        });
+        assert(plan.has_value());
+        assert(plan->plans.size() == 2);
+        assert(plan->plans.at("Debug").module_ifcs.at("Core") ==
+               path("build") / "Debug" / "Core" / "Core.ifc");
+        assert(plan->plans.at("Release").module_ifcs.at("Core") ==
+               path("build") / "Release" / "Core" / "Core.ifc");
+        const auto& app_inputs =
+            plan->plans.at("Release").actions.back().inputs;
+        assert(std::ranges::find(app_inputs, path("std/Release/std.ifc")) !=
+               app_inputs.end());
+
+        // Both configurations advance module by module, each keeping its own
+        // dependency order.
+        assert(plan->actions.size() == 6);
+        std::vector<std::string> owners;
+        for (const auto& action : plan->actions)
+        {
+            owners.push_back(
+                (*std::next(action.primary_output.begin())).string());
+        }
+        assert((owners == std::vector<std::string>{ "Debug", "Release",
+                                                    "Debug", "Debug",
+                                                    "Release", "Release" }));
+
+        // Unnamed or duplicate configurations are rejected.
+        assert(!processor
+                    .generate_build_plan(
+                        { { .name = "Debug", .toolchain = &debug },
+                          { .name = "Debug", .toolchain = &release } })
+                    .has_value());
+        assert(!processor.generate_build_plan({ { .toolchain = &debug } })
+                    .has_value());
+        std::cout << "  Test 2F: multi-configuration plans... Passed\n";
+    }
+
+    // Test 2G: archives and the final link
+    {
+        Project project;
+        project.name = "App";
+        project.output_executable = "bin/app.exe";
+        project.link_libraries = { "kernel32.lib" };
+        project.modules = {
+            { .name = "App",
+              .primary_interface = "app/app.ixx",
+              .implementations = { "app/main.cpp" },
+              .dependencies = { "Core", "Util" } },
+            { .name = "Core",
+              .primary_interface = "core/core.ixx",
+              .implementations = { "core/a.cpp", "core/b.cpp" },
+              .static_library = true },
+            { .name = "Util",
+              .primary_interface = "util/util.ixx",
+              .static_library = true },
+        };
+
+        MockToolchain toolchain(BuildConfigurationFactory::create_debug_default());
+        ProjectProcessor processor(project, toolchain, "build", {}, {},
+                                   { "std/std.obj" });
+        auto plan = processor.generate_build_plan();
+        assert(plan.has_value());
+
+        const auto& core = plan->module_plans[0];
+        const path core_lib = path("build") / "Core" / "Core.lib";
+        assert(core.static_library == core_lib);
+        const auto& archive = core.actions.back();
+        assert(archive.primary_output == core_lib);
+        assert(archive.clear_outputs);
+        assert(archive.inputs == core.generated_obj_paths);
+        // The interface action declares the object cl writes next to the BMI.
+        const path core_obj = path("build") / "Core" / "Core.obj";
+        assert(std::ranges::find(core.actions.front().outputs, core_obj) !=
+               core.actions.front().outputs.end());
+        assert(std::ranges::find(archive.inputs, core_obj) !=
+               archive.inputs.end());
+        assert(!core.actions.front().interface_fingerprint);
+
+        const auto& link = plan->actions.back();
+        assert(link.primary_output == path("build") / "bin/app.exe");
+        assert(link.pool == "link");
+        assert(link.slots == 1);
+        assert(toolchain.lto_cache_dir == path("build") / "lto_cache");
+        // Objects come first, then archives with dependents before their
+        // dependencies, so single-pass linkers resolve every symbol.
+        assert((link.inputs ==
+                std::vector<path>{ path("build") / "App" / "App.obj",
+                                   path("build") / "App" / "main.obj",
+                                   "std/std.obj",
+                                   path("build") / "Util" / "Util.lib",
+                                   core_lib }));
+        assert(toolchain.call_history.back().function_name == "link");
+
+        // Toolchains whose interface compile only writes the BMI get a
+        // separate action that turns the BMI into the interface's object.
+        toolchain.writes_interface_object = false;
+        project.output_executable.clear();
+        auto split = ProjectProcessor(project, toolchain, "build")
+                         .generate_build_plan();
+        assert(split.has_value());
+        const auto& util = split->module_plans[1];
+        assert(util.actions.size() == 3); // BMI, object, archive
+        assert(util.actions[0].outputs.size() == 1);
+        assert(util.actions[1].inputs.front() == util.final_ifc_path);
+        assert(util.actions[1].primary_output ==
+               path("build") / "Util" / "Util.obj");
+        assert(std::ranges::none_of(split->actions, [](const auto& action)
+                                    { return action.pool == "link"; }));
+
+        // Reduced BMIs are compared by their interface fingerprint.
+        toolchain.reduced_bmi = true;
+        auto reduced = ProjectProcessor(project, toolchain, "build")
+                           .generate_build_plan();
+        assert(reduced.has_value());
+        const auto& reduced_util = reduced->module_plans[1];
+        assert(reduced_util.actions[0].interface_fingerprint);
+        assert(!reduced_util.actions[1].interface_fingerprint);
+        std::cout << "  Test 2G: archives and link... Passed\n";
+    }
+
+    // Test 2H: a module's configuration reaches all of its compiles
+    {
+        ConfigurationOverride hot;
+        hot.optimization = OptimizationLevel::O3;
+        hot.defines = { "HOT_PATH" };
+
+        Project project;
+        project.name = "Sim";
+        project.modules = {
+            { .name = "Numeric",
+              .primary_interface = "num/num.ixx",
+              .partitions = { "num/simd.ixx" },
+              .implementations = { "num/kernels.cpp" },
+              .configuration = hot },
+            { .name = "Sim",
+              .primary_interface = "sim/sim.ixx",
+              .implementations = { "sim/main.cpp" },
+              .dependencies = { "Numeric" } },
+        };
+        project.output_executable = "sim";
+
+        MockToolchain toolchain(
+            BuildConfigurationFactory::create_release_default());
+        toolchain.writes_interface_object = false;
+        auto plan = ProjectProcessor(project, toolchain, "build")
+                        .generate_build_plan();
+        assert(plan.has_value());
+        for (const path source :
+             { "num/num.ixx", "num/simd.ixx", "num/kernels.cpp",
+               "build/Numeric/Numeric.ifc" })
+        {
+            assert(toolchain.configurations.at(source) == hot);
+        }
+        for (const path source : { "sim/sim.ixx", "sim/main.cpp" })
+        {
+            assert(toolchain.configurations.at(source) ==
+                   ConfigurationOverride{});
+        }
+        // LTO codegen at link time uses the highest module level
+        assert(toolchain.link_optimization == OptimizationLevel::O3);
+        std::cout << "  Test 2H: per-module configuration... Passed\n";
+    }
+
+    // Test 2I: the link takes as many job slots as its LTO backends
+    {
+        Project project;
+        project.name = "App";
+        project.output_executable = "bin/app";
+        project.modules = { { .name = "App",
+                              .primary_interface = "app/app.ixx" } };
+
+        MockToolchain toolchain(
+            BuildConfigurationFactory::create_release_default());
+        toolchain.jobs = 6;
+        auto plan = ProjectProcessor(project, toolchain, "build/Release")
+                        .generate_build_plan();
+        assert(plan.has_value());
+        const auto& actions = plan->actions;
+        assert(actions.back().slots == 6);
+        assert(std::all_of(actions.begin(), actions.end() - 1,
+                           [](const auto& action)
+                           { return action.slots == 1; }));
+        assert(toolchain.lto_cache_dir ==
+               path("build/Release") / "lto_cache");
+        std::cout << "  Test 2I: link job slots... Passed\n";
+    }
+
+    // Test 2J: partitions are ordered by their scanned imports
+    {
+        ModuleUnit unit;
+        unit.name = "Net";
+        unit.primary_interface = "net/net.ixx";
+        unit.partitions = { "net/socket.ixx", "net/detail.cpp",
+                            "net/buffer.ixx" };
+        unit.partition_info = {
+            { "net/socket.ixx", { .name = "socket", .imports = { "buffer" } } },
+            { "net/detail.cpp", { .name = "detail", .is_interface = false } },
+            { "net/buffer.ixx", { .name = "buffer", .imports = { "detail" } } },
+        };
+
+        MockToolchain toolchain(
+            BuildConfigurationFactory::create_debug_default());
+        std::map<std::string, path> dependency_ifcs;
+        auto plan = ModuleProcessor(unit, toolchain, "build", dependency_ifcs)
+                        .generate_build_plan();
+        assert(plan.has_value());
+        std::vector<path> order;
+        for (const auto& call : toolchain.call_history)
+        {
+            order.push_back(call.source_file);
+        }
+        assert((order == std::vector<path>{ "net/detail.cpp", "net/buffer.ixx",
+                                            "net/socket.ixx", "net/net.ixx" }));
+        // Transitively imported partitions are passed as well.
+        assert((toolchain.references.at("net/socket.ixx") ==
+                std::set<std::string>{ "Net:buffer", "Net:detail" }));
+        assert((toolchain.internal_partitions ==
+                std::set<path>{ "net/detail.cpp" }));
+        const auto& socket = plan->actions[2];
+        assert(std::ranges::find(socket.inputs,
+                                 path("build/Net/Net-detail.ifc")) !=
+               socket.inputs.end());
+
+        // Unknown and cyclic partition imports are reported.
+        unit.partition_info.at("net/detail.cpp").imports = { "missing" };
+        assert(!ModuleProcessor(unit, toolchain, "build", dependency_ifcs)
+                    .generate_build_plan());
+        unit.partition_info.at("net/detail.cpp").imports = { "socket" };
+        assert(!ModuleProcessor(unit, toolchain, "build", dependency_ifcs)
+                    .generate_build_plan());
+        std::cout << "  Test 2J: partition import order... Passed\n";
+    }
+
+    // Test 2K: clang++ gets a .pcm for every partition, and units of a
+    // module get -fmodule-file= for its interface and partitions
+    {
+        ModuleUnit unit;
+        unit.name = "Geo";
+        unit.primary_interface = "geo/geo.ixx";
+        unit.partitions = { "geo/shapes.ixx" };
+        unit.implementations = { "geo/area.cpp" };
+
+        ClangxxToolchain clangxx(
+            "clang++", BuildConfigurationFactory::create_debug_default());
+        std::map<std::string, path> dependency_ifcs;
+        auto plan = ModuleProcessor(unit, clangxx, "build", dependency_ifcs)
+                        .generate_build_plan();
+        assert(plan.has_value());
+        assert(plan->actions.size() == 3);
+        auto has = [](const BuildAction& action, std::string_view flag)
+        {
+            return std::ranges::find(action.command.arguments, flag) !=
+                   action.command.arguments.end();
+        };
+        const auto& partition = plan->actions[0];
+        assert(has(partition, "-fmodule-output=build/Geo/Geo-shapes.pcm"));
+        assert(partition.outputs.front() == "build/Geo/Geo-shapes.pcm");
+        assert(has(plan->actions[1],
+                   "-fmodule-file=Geo:shapes=build/Geo/Geo-shapes.pcm"));
+        const auto& impl = plan->actions[2];
+        assert(has(impl, "-fmodule-file=Geo=build/Geo/Geo.pcm"));
+        assert(has(impl, "-fmodule-file=Geo:shapes=build/Geo/Geo-shapes.pcm"));
+        assert(std::ranges::find(impl.inputs, path("build/Geo/Geo.pcm")) !=
+               impl.inputs.end());
+        std::cout << "  Test 2K: clang++ partitions and units... Passed\n";
     }
     std::cout << "--- ModuleProcessor tests all passed ---\n\n";
 }
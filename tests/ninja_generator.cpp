@@ -0,0 +1,282 @@
+// tests_ninja_generator.cpp
+// Contains unit tests for the NinjaGenerator and the dyndep collator.
+
+import std;
+import executor;
+import toolchains;
+import module_processor;
+import dependency_scanner;
+import ninja_generator;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::dependency_scanner;
+using namespace importa::ninja_generator;
+
+// --- Mock Object Definition ---
+
+// Clang-like: BMIs are .pcm files, depfiles are Makefile fragments and the
+// scanner prints P1689 to stdout.
+struct MockToolchain : public IToolchain
+{
+    std::optional<Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override
+    {
+        return Command{ .executable = "cc",
+                        .arguments = { "--precompile",
+                                       args.interface_unit_path.string(), "-o",
+                                       get_bmi_path(args.output_ifc_path)
+                                           .string(),
+                                       "-MF", args.dependency_file.string() } };
+    }
+
+    std::optional<Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override
+    {
+        return Command{ .executable = "cc",
+                        .arguments = { "-c", args.source_file.string(), "-o",
+                                       args.output_obj_path.string(), "-MF",
+                                       args.dependency_file.string() } };
+    }
+
+    std::optional<Command> generate_link_command(
+        const LinkArgs& args) const override
+    {
+        return std::nullopt;
+    }
+
+    path get_bmi_path(const path& ifc_path) const override
+    {
+        path pcm = ifc_path;
+        return pcm.replace_extension(".pcm");
+    }
+
+    // Like clang, --precompile only writes the BMI.
+    bool emit_ifc_writes_object() const override
+    {
+        return false;
+    }
+
+    std::optional<Command> generate_scan_deps_command(
+        const ScanDepsArgs& args) const override
+    {
+        return Command{ .executable = "scan-deps",
+                        .arguments = { args.source_file.string(), "-o",
+                                       args.output_obj_path.string() } };
+    }
+};
+
+namespace
+{
+bool contains(const std::string& text, std::string_view needle)
+{
+    return text.find(needle) != std::string::npos;
+}
+
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+std::string read_file(const path& file)
+{
+    std::ifstream in(file);
+    return { std::istreambuf_iterator<char>(in),
+             std::istreambuf_iterator<char>() };
+}
+} // namespace
+
+// --- Test Suite for NinjaGenerator ---
+
+void test_ninja_generator()
+{
+    std::cout << "--- Running Test Suite: NinjaGenerator ---\n";
+
+    // Test 7A: escaping of paths and commands
+    {
+        assert(escape_ninja_path("C:/my dir/$x") == "C$:/my$ dir/$$x");
+
+        Command cmd{ .executable = "/usr/bin/cc",
+                     .arguments = { "-DNAME=it's", "a b", "-O2" },
+                     .working_directory = "/tmp/w d",
+                     .environment_variables = { { "LANG", "C" } } };
+        assert(to_shell_command(cmd, NinjaShell::Posix) ==
+               "cd '/tmp/w d' && env LANG=C /usr/bin/cc '-DNAME=it'\\''s' "
+               "'a b' -O2");
+
+        Command plain{ .executable = "cl.exe", .arguments = { "/c", "a b" } };
+        assert(to_shell_command(plain, NinjaShell::Windows) ==
+               plain.to_string());
+
+        // Embedded quotes and the backslashes before them are escaped.
+        Command link{ .executable = "link.exe",
+                      .arguments = { "/LIBPATH:\"C:/my libs\"",
+                                     "C:\\a b\\", "x\\\"y", "" } };
+        assert(to_shell_command(link, NinjaShell::Windows) ==
+               "\"link.exe\" \"/LIBPATH:\\\"C:/my libs\\\"\" "
+               "\"C:\\a b\\\\\" \"x\\\\\\\"y\" \"\"");
+        std::cout << "  Test 7A: escaping... Passed\n";
+    }
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_ninja";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const path build_dir = temp_dir / "build";
+
+    Project project;
+    project.name = "App";
+    project.modules = {
+        { .name = "Core", .primary_interface = "src/core.ixx" },
+        { .name = "App",
+          .primary_interface = "src/app.ixx",
+          .implementations = { "src/main.cpp" },
+          .dependencies = { "Core" } },
+    };
+    MockToolchain toolchain;
+    auto plan = ProjectProcessor(project, toolchain, build_dir)
+                    .generate_build_plan();
+    assert(plan.has_value());
+
+    BuildAction link;
+    link.command = { .executable = "ld", .arguments = { "-o", "app" } };
+    link.primary_output = build_dir / "app";
+    link.inputs = plan->module_plans[1].generated_obj_paths;
+    link.outputs = { link.primary_output };
+    link.pool = "link";
+    plan->actions.push_back(link);
+
+    const std::string core_pcm =
+        escape_ninja_path((build_dir / "Core" / "Core.pcm").string());
+
+    // Test 7B: static manifest, one edge per action
+    {
+        std::ostringstream out;
+        NinjaGenerator(toolchain, build_dir,
+                       { .shell = NinjaShell::Posix,
+                         .pool_depths = { { "link", 2 } } })
+            .write(*plan, out);
+        const std::string ninja = out.str();
+
+        assert(contains(ninja, "ninja_required_version = 1.10\n"));
+        assert(contains(ninja, "pool link\n  depth = 2\n"));
+        assert(contains(ninja, "build " + core_pcm +
+                                   ": importa_action src/core.ixx\n"));
+        assert(contains(ninja, "  restat = 1\n"));
+        assert(contains(ninja, "  deps = gcc\n"));
+        assert(contains(ninja, "  pool = link\n"));
+        assert(!contains(ninja, "dyndep"));
+        // main.cpp waits for both BMIs it imports.
+        assert(contains(ninja, "src/main.cpp " + core_pcm));
+
+        std::size_t edges = 0;
+        for (std::size_t pos = 0;
+             (pos = ninja.find(": importa_action", pos)) != std::string::npos;
+             ++pos)
+        {
+            ++edges;
+        }
+        assert(edges == plan->actions.size());
+        std::cout << "  Test 7B: static manifest... Passed\n";
+    }
+
+    // Test 7C: dyndep mode adds scan and collate edges
+    {
+        NinjaGenerator generator(toolchain, build_dir,
+                                 { .shell = NinjaShell::Posix,
+                                   .collator_command = { "importa",
+                                                         "--collate" } });
+        const path manifest = generator.write_files(*plan);
+        const std::string ninja = read_file(manifest);
+
+        assert(contains(ninja, "rule importa_scan\n"));
+        assert(contains(ninja, "command = importa --collate $map $out\n"));
+        assert(contains(ninja, ": importa_scan src/core.ixx\n"));
+        // The scanner prints to stdout, so its output is redirected.
+        assert(contains(ninja, " > "));
+        assert(contains(ninja, "  dyndep = " + (build_dir / "modules.dd").string()));
+        assert(contains(ninja,
+                        "|| " + escape_ninja_path(
+                                    (build_dir / "modules.dd").string())));
+
+        const std::string map = read_file(build_dir / "modules.map");
+        assert(contains(map, "module\tCore\t" +
+                                 (build_dir / "Core" / "Core.pcm").string()));
+        // Three compile edges are scanned; the link edge is not.
+        std::size_t scans = 0;
+        for (std::size_t pos = 0;
+             (pos = map.find("scan\t", pos)) != std::string::npos; ++pos)
+        {
+            ++scans;
+        }
+        assert(scans == 3);
+
+        // Rewriting an identical plan keeps the file untouched.
+        const auto stamp = fs::last_write_time(manifest);
+        generator.write_files(*plan);
+        assert(fs::last_write_time(manifest) == stamp);
+        std::cout << "  Test 7C: dyndep manifest... Passed\n";
+    }
+
+    // Test 7D: collating scan results into a dyndep file
+    {
+        ScanResult app;
+        app.provided_module = "App";
+        app.required_modules = { "Core", "std" };
+        ScanResult main_unit;
+        main_unit.required_modules = { "App" };
+        const std::string dd = format_dyndep(
+            { { "b/App.pcm", app }, { "b/main.obj", main_unit } },
+            { { "Core", "b/Core.pcm" }, { "App", "b/App.pcm" } });
+        assert(dd == "ninja_dyndep_version = 1\n"
+                     "build b/App.pcm: dyndep | b/Core.pcm\n"
+                     "  restat = 1\n"
+                     "build b/main.obj: dyndep | b/App.pcm\n");
+
+        const path scan_file = temp_dir / "app.ddi";
+        write_file(scan_file,
+                   R"({"version":1,"revision":0,"rules":[{"primary-output":"b/App.pcm",
+                       "provides":[{"logical-name":"App","is-interface":true}],
+                       "requires":[{"logical-name":"Core"}]}]})");
+        const path map_file = temp_dir / "modules.map";
+        write_file(map_file, "module\tCore\tb/Core.pcm\n"
+                             "scan\tb/App.pcm\t" +
+                                 scan_file.string() + "\n");
+        const path dd_file = temp_dir / "modules.dd";
+        assert(collate_dyndep(map_file, dd_file));
+        assert(read_file(dd_file) == "ninja_dyndep_version = 1\n"
+                                     "build b/App.pcm: dyndep | b/Core.pcm\n"
+                                     "  restat = 1\n");
+
+        write_file(scan_file, "not json");
+        assert(!collate_dyndep(map_file, dd_file));
+        std::cout << "  Test 7D: dyndep collation... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- NinjaGenerator tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_ninja_generator();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All NinjaGenerator tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+// tests_precompiled_headers.cpp
+// Contains unit tests for global module fragment precompiled headers.
+
+import std;
+import hashing;
+import precompiled_headers;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa;
+using namespace importa::precompiled_headers;
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+std::string read_file(const path& file)
+{
+    std::ifstream in(file);
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+} // namespace
+
+// --- Test Suite for PchPlanner ---
+
+void test_precompiled_headers()
+{
+    std::cout << "--- Running Test Suite: PrecompiledHeaders ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_pch";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir / "src");
+    const path build_dir = temp_dir / "build";
+
+    // Test 9A: only preprocessor-only fragments with includes qualify
+    {
+        auto fragment = extract_global_fragment(
+            "// comment\n"
+            "module;\n"
+            "\n"
+            "#define WIN32_LEAN_AND_MEAN\n"
+            "#include <windows.h>   \n"
+            "#define LONG_MACRO(x) \\\n"
+            "    ((x) + 1)\n"
+            "export module executor;\n"
+            "import std;\n");
+        assert(fragment.has_value());
+        assert(*fragment == "#define WIN32_LEAN_AND_MEAN\n"
+                            "#include <windows.h>\n"
+                            "#define LONG_MACRO(x) \\\n"
+                            "((x) + 1)\n");
+
+        assert(!extract_global_fragment("module;\nmodule core;\n"));
+        assert(!extract_global_fragment("module;\n#define X 1\nmodule core;\n"));
+        assert(!extract_global_fragment("module;\nint x;\nmodule core;\n"));
+        assert(!extract_global_fragment("export module core;\n"));
+        assert(!extract_global_fragment("#include <cstdio>\nint main() {}\n"));
+        std::cout << "  Test 9A: extract global module fragments... Passed\n";
+    }
+
+    // Test 9B: identical fragments share one generated header
+    const std::string heavy = "module;\n#include <sys/types.h>\n"
+                              "#include \"config.h\"\nmodule net;\n";
+    write_file(temp_dir / "src" / "config.h", "#define LEVEL 1\n");
+    const path a = temp_dir / "src" / "a.cpp";
+    const path b = temp_dir / "src" / "b.cpp";
+    const path c = temp_dir / "src" / "c.cpp";
+    const path d = temp_dir / "src" / "d.cpp";
+    write_file(a, heavy + "int a();\n");
+    write_file(b, heavy + "int b();\n");
+    write_file(c, "module;\n#include <vector>\nmodule net;\n");
+    write_file(d, "module net;\nint d();\n");
+    {
+        PchPlanner planner(build_dir);
+        auto groups = planner.plan("net", { a, b, c, d });
+        assert(groups.size() == 1); // c is alone, d has no fragment
+        const auto& group = groups.front();
+        assert((group.members == std::vector<path>{ a, b }));
+        assert(group.header.is_absolute());
+        assert(group.header.parent_path().filename() == "pch");
+
+        const auto header = read_file(group.header);
+        assert(header.find("#include <sys/types.h>") != std::string::npos);
+        assert(header.find((temp_dir / "src" / "config.h")
+                               .lexically_normal()
+                               .generic_string()) != std::string::npos);
+        assert(read_file(group.stub_source).find(group.header.string()) !=
+               std::string::npos);
+
+        PchOptions eager;
+        eager.min_units = 1;
+        PchPlanner eager_planner(temp_dir / "eager_build", eager);
+        assert(eager_planner.plan("net", { a, b, c, d }).size() == 2);
+        std::cout << "  Test 9B: group identical fragments... Passed\n";
+    }
+
+    // Test 9C: unchanged headers are not rewritten, unused ones are removed
+    {
+        PchPlanner planner(build_dir);
+        const path header = planner.plan("net", { a, b }).front().header;
+        const auto stamp = fs::last_write_time(header) - std::chrono::hours(1);
+        fs::last_write_time(header, stamp);
+        assert(planner.plan("net", { a, b }).front().header == header);
+        assert(fs::last_write_time(header) == stamp);
+
+        write_file(b, "module;\n#include <vector>\nmodule net;\n");
+        assert(planner.plan("net", { a, b }).empty());
+        assert(!fs::exists(header));
+        std::cout << "  Test 9C: stable and stale headers... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- PrecompiledHeaders tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_precompiled_headers();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All PrecompiledHeaders tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,290 @@
+// tests_std_module_cache.cpp
+// Contains unit tests for the shared std module BMI cache.
+
+import std;
+import executor;
+import toolchains;
+import std_module_cache;
+import artifact_cache;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::std_module_cache;
+
+// --- Mock Object Definitions ---
+
+// Emits "<ifc> <flag>..." commands; the matching executor writes the IFC
+// and an object file next to it, like cl /interface.
+struct MockToolchain : public IToolchain
+{
+    std::vector<std::string> flags = { "-std=c++23" };
+    std::string version = "mockcc 17.0";
+
+    std::optional<Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override
+    {
+        Command cmd;
+        cmd.executable = "mockcc";
+        cmd.arguments = { args.output_ifc_path.string(),
+                          args.interface_unit_path.string() };
+        for (const auto& dep : args.module_dependencies)
+        {
+            cmd.arguments.push_back("-r" + dep.ifc_path.string());
+        }
+        cmd.arguments.insert(cmd.arguments.end(), flags.begin(), flags.end());
+        return cmd;
+    }
+
+    std::optional<Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Command> generate_link_command(
+        const LinkArgs& args) const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Command> generate_version_command() const override
+    {
+        return Command{ .executable = "mockcc", .arguments = { "--version" } };
+    }
+};
+
+struct MockExecutor : public IExecutor
+{
+    const MockToolchain& toolchain;
+    std::vector<std::string> built;
+    bool fail = false;
+
+    explicit MockExecutor(const MockToolchain& tc) : toolchain(tc) {}
+
+    ExecutionResult execute(const Command& command) override
+    {
+        if (command.arguments.front() == "--version")
+        {
+            return { .success = true, .exit_code = 0,
+                     .std_out = toolchain.version };
+        }
+        if (fail)
+        {
+            return { .success = false, .exit_code = 2, .std_err = "boom" };
+        }
+        const path ifc = command.arguments.front();
+        built.push_back(ifc.stem().string());
+        std::ofstream(ifc) << "BMI";
+        std::ofstream(ifc.parent_path() / (ifc.stem().string() + ".obj"))
+            << "OBJ";
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+// Runs clang++ commands by creating the files named by -o and
+// -fmodule-output=.
+struct ClangxxExecutor : public IExecutor
+{
+    std::vector<Command> commands;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const auto& args = command.arguments;
+        if (args.front() == "--version")
+        {
+            return { .success = true, .exit_code = 0,
+                     .std_out = "clang version 19.1.0" };
+        }
+        commands.push_back(command);
+        for (std::size_t i = 0; i < args.size(); ++i)
+        {
+            if (args[i] == "-o" && i + 1 < args.size())
+            {
+                if (args[i + 1].empty())
+                {
+                    return { .success = false, .exit_code = 1 };
+                }
+                std::ofstream(args[i + 1]) << "OUT";
+            }
+            if (args[i].starts_with("-fmodule-output="))
+            {
+                std::ofstream(args[i].substr(16)) << "BMI";
+            }
+        }
+        return { .success = true, .exit_code = 0 };
+    }
+};
+
+// --- Test Suite for StdModuleCache ---
+
+void test_std_module_cache()
+{
+    std::cout << "--- Running Test Suite: StdModuleCache ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_std_cache";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    const path cache_root = temp_dir / "cache";
+    const path build1 = temp_dir / "build1" / "std_modules";
+    const path build2 = temp_dir / "build2" / "std_modules";
+
+    const path std_ixx = temp_dir / "std.ixx";
+    const path compat_ixx = temp_dir / "std.compat.ixx";
+    std::ofstream(std_ixx) << "export module std;";
+    std::ofstream(compat_ixx) << "export module std.compat;";
+    const std::vector<StdModuleSource> modules = {
+        { .name = "std", .interface_unit = std_ixx },
+        { .name = "std.compat",
+          .interface_unit = compat_ixx,
+          .dependencies = { "std" } },
+    };
+
+    MockToolchain toolchain;
+    MockExecutor executor(toolchain);
+
+    // Test 10A: a cold cache builds every module once
+    StdModuleArtifacts first;
+    {
+        StdModuleCache cache(cache_root, toolchain, executor);
+        auto artifacts = cache.ensure(modules, build1);
+        assert(artifacts.has_value());
+        assert(cache.modules_built() == 2);
+        assert((executor.built ==
+                std::vector<std::string>{ "std", "std.compat" }));
+        assert(fs::exists(artifacts->ifcs.at("std")));
+        assert(artifacts->ifcs.at("std").parent_path().parent_path() ==
+               build1);
+        assert(artifacts->objects.size() == 2);
+        first = *artifacts;
+        std::cout << "  Test 10A: cold cache builds std... Passed\n";
+    }
+
+    // Test 10B: another build tree reuses the cached copies
+    {
+        executor.built.clear();
+        StdModuleCache cache(cache_root, toolchain, executor);
+        auto artifacts = cache.ensure(modules, build2);
+        assert(artifacts.has_value());
+        assert(cache.modules_built() == 0);
+        assert(executor.built.empty());
+        assert(artifacts->ifcs.at("std") ==
+               build2 / first.ifcs.at("std").lexically_relative(build1));
+        assert(fs::exists(artifacts->ifcs.at("std.compat")));
+        std::cout << "  Test 10B: warm cache hit... Passed\n";
+    }
+
+    // Test 10C: BMI-affecting flags and compiler versions get new entries
+    {
+        toolchain.flags.push_back("-DNDEBUG");
+        StdModuleCache flagged(cache_root, toolchain, executor);
+        auto artifacts = flagged.ensure(modules, build1);
+        assert(flagged.modules_built() == 2);
+        assert(artifacts->ifcs.at("std") != first.ifcs.at("std"));
+        toolchain.flags.pop_back();
+
+        toolchain.version = "mockcc 18.0";
+        StdModuleCache upgraded(cache_root, toolchain, executor);
+        assert(upgraded.ensure(modules, build1)->ifcs.at("std") !=
+               first.ifcs.at("std"));
+        assert(upgraded.modules_built() == 2);
+        toolchain.version = "mockcc 17.0";
+
+        // Editing std.compat alone keeps the std entry.
+        std::ofstream(compat_ixx) << "export module std.compat; // v2";
+        StdModuleCache edited(cache_root, toolchain, executor);
+        artifacts = edited.ensure(modules, build1);
+        assert(edited.modules_built() == 1);
+        assert(artifacts->ifcs.at("std") == first.ifcs.at("std"));
+        std::cout << "  Test 10C: fingerprint invalidation... Passed\n";
+    }
+
+    // Test 10D: failed builds publish nothing
+    {
+        std::ofstream(std_ixx) << "export module std; // broken";
+        executor.fail = true;
+        StdModuleCache cache(cache_root, toolchain, executor);
+        assert(!cache.ensure(modules, build1).has_value());
+        assert(fs::is_empty(cache_root / "tmp"));
+        executor.fail = false;
+
+        // Dependencies must come first.
+        assert(!cache.ensure({ modules[1], modules[0] }, build1).has_value());
+        std::cout << "  Test 10D: failures leave the cache intact... Passed\n";
+    }
+
+    // Test 10E: evicting cache entries keeps installed copies usable
+    {
+        std::ofstream(std_ixx) << "export module std; // v3";
+        const path build3 = temp_dir / "build3" / "std_modules";
+        std::optional<StdModuleArtifacts> artifacts;
+        {
+            StdModuleCache tiny(cache_root, toolchain, executor,
+                                { .max_bytes = 1 });
+            artifacts = tiny.ensure(modules, build3);
+            assert(artifacts.has_value());
+            assert(tiny.modules_built() == 2);
+        } // waits for the background trim
+        assert(artifact_cache::ArtifactCache(cache_root).size_bytes() == 0);
+        for (const auto& [name, ifc] : artifacts->ifcs)
+        {
+            std::ifstream in(ifc);
+            std::string content;
+            in >> content;
+            assert(content == "BMI");
+        }
+        std::cout << "  Test 10E: eviction spares build trees... Passed\n";
+    }
+
+    // Test 10F: clang++ writes std's object in one step or from the BMI
+    {
+        const auto config = BuildConfigurationFactory::create_debug_default();
+        ClangxxToolchain one_phase("clang++", config);
+        ClangxxToolchain two_phase("clang++", config,
+                                   InterfaceCompilation::TwoPhase);
+        const std::array<const IToolchain*, 2> clang_toolchains = {
+            &one_phase, &two_phase
+        };
+        for (const auto* clangxx : clang_toolchains)
+        {
+            const path build = temp_dir / "clang" / "std_modules";
+            fs::remove_all(temp_dir / "clang");
+            ClangxxExecutor clang_executor;
+            StdModuleCache cache(temp_dir / "clang" / "cache", *clangxx,
+                                 clang_executor);
+            auto artifacts = cache.ensure({ modules[0] }, build);
+            assert(artifacts.has_value());
+            assert(artifacts->objects.size() == 1);
+            assert(artifacts->objects.front().filename() == "std.obj");
+            assert(fs::exists(artifacts->objects.front()));
+            assert(clang_executor.commands.size() ==
+                   (clangxx == &one_phase ? 1u : 2u));
+        }
+        std::cout << "  Test 10F: clang++ std objects... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- StdModuleCache tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_std_module_cache();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All StdModuleCache tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,292 @@
+// tests_toolchain_discovery.cpp
+// Contains unit tests for finding compilers on disk, probing their
+// capabilities, caching the probe results and creating toolchains from them.
+
+import std;
+import executor;
+import toolchains;
+import toolchain_discovery;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::toolchain_discovery;
+
+// --- Helper Functions ---
+
+namespace
+{
+// Answers like the compilers a test directory pretends to hold: the
+// --version banner depends on the file name, and flag probes succeed for
+// the flags listed per compiler.
+struct FakeCompilers : public IExecutor
+{
+    std::vector<std::string> runs; // "<file name> <first argument>"
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const auto name = command.executable.filename().string();
+        runs.push_back(name + " " + command.arguments.front());
+        if (command.arguments.front() == "--version")
+        {
+            return { .success = true, .exit_code = 0,
+                     .std_out = banner(name) };
+        }
+        const auto& flag = command.arguments[1];
+        const bool supported =
+            (name == "clang++-19" &&
+             (flag.starts_with("-fmodule-output=") ||
+              flag == "-fmodules-reduced-bmi")) ||
+            (name == "clang++-18" && flag.starts_with("-fmodule-output=")) ||
+            (name.starts_with("g++") && flag == "-fmodules-ts");
+        return { .success = supported, .exit_code = supported ? 0 : 1 };
+    }
+
+    static std::string banner(const std::string& name)
+    {
+        if (name.starts_with("clang++"))
+        {
+            const auto version = name == "clang++-19" ? "19.1.0" : "18.1.3";
+            return std::string("Ubuntu clang version ") + version +
+                   " (1ubuntu1)\nTarget: x86_64-pc-linux-gnu\n";
+        }
+        return "g++ (Ubuntu 14.2.0-4ubuntu2) 14.2.0\nCopyright (C) 2024 "
+               "Free Software Foundation, Inc.\n";
+    }
+};
+
+// Prints a fixed --version banner and accepts every flag.
+struct BannerExecutor : public IExecutor
+{
+    std::string banner;
+
+    ExecutionResult execute(const Command&) override
+    {
+        return { .success = true, .exit_code = 0, .std_out = banner };
+    }
+};
+
+void make_fake_executable(const path& file)
+{
+    std::ofstream(file) << "#!/bin/sh\n";
+    fs::permissions(file, fs::perms::owner_all);
+}
+
+bool has_flag(const std::vector<std::string>& args, std::string_view flag)
+{
+    return std::ranges::find(args, flag) != args.end();
+}
+
+const CompilerInfo* find_named(const std::vector<CompilerInfo>& found,
+                               std::string_view name)
+{
+    for (const auto& info : found)
+    {
+        if (info.executable.filename() == name)
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+// --- Test Suite for toolchain_discovery ---
+
+void test_toolchain_discovery()
+{
+    std::cout << "--- Running Test Suite: ToolchainDiscovery ---\n";
+
+    auto temp_dir =
+        fs::temp_directory_path() / "importa_test_toolchain_discovery";
+    fs::remove_all(temp_dir);
+    const path llvm_dir = temp_dir / "llvm";
+    const path gnu_dir = temp_dir / "gnu";
+    fs::create_directories(llvm_dir);
+    fs::create_directories(gnu_dir);
+
+    make_fake_executable(llvm_dir / "clang++-18");
+    make_fake_executable(llvm_dir / "clang++-19");
+    make_fake_executable(llvm_dir / "clang-scan-deps-19");
+    make_fake_executable(gnu_dir / "g++-14");
+    make_fake_executable(gnu_dir / "g++-wrapper");
+    make_fake_executable(gnu_dir / "clang++-tidy");
+    std::ofstream(gnu_dir / "g++-13") << "not executable\n";
+    fs::permissions(gnu_dir / "g++-13", fs::perms::owner_read);
+#if !defined(_WIN32)
+    // A second name for the same compiler is probed only once
+    fs::create_symlink("g++-14", gnu_dir / "g++");
+#endif
+
+    const std::vector<path> search_dirs = { llvm_dir, gnu_dir,
+                                            temp_dir / "missing" };
+    const path cache_file = temp_dir / "cache" / "toolchains.cache";
+
+    // Test 17A: compilers are found, identified and ordered newest first
+    std::vector<CompilerInfo> found;
+    {
+        ProbeCache cache(cache_file);
+        FakeCompilers executor;
+        found = discover_compilers(cache, executor, search_dirs);
+        assert(found.size() == 3);
+        assert(found[0].executable.filename() == "clang++-19");
+        assert(found[1].executable.filename() == "clang++-18");
+        const auto gcc_name = found[2].executable.filename();
+        assert(gcc_name == "g++" || gcc_name == "g++-14");
+
+        const auto& gcc = found[2];
+        assert(gcc.family == CompilerFamily::Gcc);
+        assert(gcc.version == "14.2.0" && gcc.major_version == 14);
+        assert(gcc.bmi_extension == ".gcm");
+        assert(gcc.modules && gcc.p1689_scan);
+
+        const auto& clang19 = *find_named(found, "clang++-19");
+        assert(clang19.family == CompilerFamily::Clang);
+        assert(clang19.version == "19.1.0");
+        assert(clang19.bmi_extension == ".pcm");
+        assert(clang19.modules && clang19.module_output);
+        assert(clang19.reduced_bmi && clang19.p1689_scan);
+
+        const auto& clang18 = *find_named(found, "clang++-18");
+        assert(clang18.modules && clang18.module_output);
+        assert(!clang18.reduced_bmi && !clang18.p1689_scan);
+
+        const auto version_runs = std::ranges::count_if(
+            executor.runs, [](const std::string& run)
+            { return run.ends_with("--version"); });
+        assert(version_runs == 3);
+        assert(cache.save());
+        assert(fs::exists(cache_file));
+        std::cout << "  Test 17A: discover and probe... Passed\n";
+    }
+
+    // Test 17B: a saved cache answers later runs without the compilers
+    {
+        ProbeCache cache(cache_file);
+        FakeCompilers executor;
+        assert(discover_compilers(cache, executor, search_dirs) == found);
+        assert(executor.runs.empty());
+        assert(cache.find(llvm_dir / "clang++-19") == found[0]);
+        assert(!cache.find(gnu_dir / "g++-13"));
+        std::cout << "  Test 17B: probe results are cached... Passed\n";
+    }
+
+    // Test 17C: replacing one compiler re-probes only that one
+    {
+        const path clang18 = llvm_dir / "clang++-18";
+        std::ofstream(clang18, std::ios::app) << "# upgraded\n";
+        fs::last_write_time(clang18, fs::last_write_time(clang18) + 1s);
+
+        ProbeCache cache(cache_file);
+        assert(!cache.find(clang18));
+        FakeCompilers executor;
+        assert(discover_compilers(cache, executor, search_dirs) == found);
+        assert(!executor.runs.empty());
+        for (const auto& run : executor.runs)
+        {
+            assert(run.starts_with("clang++-18 "));
+        }
+        assert(cache.save());
+        assert(ProbeCache(cache_file).find(clang18) == found[1]);
+        std::cout << "  Test 17C: replaced compiler re-probed... Passed\n";
+    }
+
+    // Test 17D: damaged cache files are ignored
+    {
+        std::ofstream(cache_file, std::ios::trunc) << "importa-toolchains 0\n";
+        ProbeCache cache(cache_file);
+        assert(!cache.find(llvm_dir / "clang++-19"));
+        std::ofstream(cache_file, std::ios::trunc) << "garbage\tline\n";
+        assert(!ProbeCache(cache_file).find(llvm_dir / "clang++-19"));
+        std::cout << "  Test 17D: damaged cache ignored... Passed\n";
+    }
+
+    // Test 17E: toolchains follow the probed capabilities
+    {
+        auto config = BuildConfigurationFactory::create_debug_default();
+        config.reduced_bmi = true;
+
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/core.ixx";
+        emit.output_ifc_path = "build/Core/Core.ifc";
+        emit.output_obj_path = "build/Core/Core.obj";
+
+        auto clang19 = make_toolchain(*find_named(found, "clang++-19"), config);
+        assert(clang19 && clang19->writes_reduced_bmi());
+        auto cmd = *clang19->generate_emit_ifc_command(emit);
+        assert(has_flag(cmd.arguments, "-fmodules-reduced-bmi"));
+
+        auto clang18 = make_toolchain(*find_named(found, "clang++-18"), config);
+        assert(clang18 && clang18->emit_ifc_writes_object());
+        assert(!clang18->writes_reduced_bmi());
+        cmd = *clang18->generate_emit_ifc_command(emit);
+        assert(!has_flag(cmd.arguments, "-fmodules-reduced-bmi"));
+
+        CompilerInfo old_clang = *find_named(found, "clang++-18");
+        old_clang.module_output = false;
+        auto two_phase = make_toolchain(old_clang, config);
+        assert(two_phase && !two_phase->emit_ifc_writes_object());
+
+        old_clang.modules = false;
+        assert(!make_toolchain(old_clang, config));
+
+        assert(!make_toolchain(found[2], config));
+        auto gcc = make_toolchain(found[2], config, "127.0.0.1:4000");
+        assert(gcc);
+        cmd = *gcc->generate_emit_ifc_command(emit);
+        assert(cmd.executable == found[2].executable);
+        assert(has_flag(cmd.arguments, "-fmodules-ts"));
+        std::cout << "  Test 17E: toolchains from probes... Passed\n";
+    }
+
+    // Test 17F: GCC versions follow the package tag, not the last word
+    {
+        const std::pair<std::string_view, std::string_view> banners[] = {
+            // Arch and openSUSE append the snapshot date.
+            { "g++ (GCC) 14.2.1 20240910", "14.2.1" },
+            // Fedora appends its package tag after the date.
+            { "g++ (GCC) 14.2.1 20250110 (Red Hat 14.2.1-7)", "14.2.1" },
+            { "g++ (Debian 12.2.0-14+deb12u1) 12.2.0", "12.2.0" },
+            { "g++-14 (Ubuntu 14.2.0-4ubuntu2~24.04) 14.2.0", "14.2.0" },
+        };
+        for (const auto& [first_line, version] : banners)
+        {
+            BannerExecutor executor;
+            executor.banner = std::string(first_line) +
+                              "\nCopyright (C) 2024 Free Software "
+                              "Foundation, Inc.\n";
+            auto info = probe_compiler(gnu_dir / "g++-14", executor);
+            assert(info && info->family == CompilerFamily::Gcc);
+            assert(info->version == version);
+            assert(version.starts_with(
+                std::to_string(info->major_version) + "."));
+        }
+        std::cout << "  Test 17F: distribution GCC banners... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- ToolchainDiscovery tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_toolchain_discovery();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All ToolchainDiscovery tests passed successfully!\n";
+    return 0;
+}
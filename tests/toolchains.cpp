@@ -102,6 +102,12 @@ void test_msvc_toolchain()
         
         // 3. 用这个自适应的字符串进行断言
         assert(has_flag_with_prefix(cmd.arguments, expected_fo_flag));
+
+        // Implementation partitions ("module M:P;") are not interfaces.
+        args.internal_partition = true;
+        const auto partition = *msvc.generate_emit_ifc_command(args);
+        assert(has_flag(partition.arguments, "/internalPartition"));
+        assert(!has_flag(partition.arguments, "/interface"));
         std::cout << "  Test 1B: generate_emit_ifc_command... Passed\n";
     }
 
@@ -118,13 +124,549 @@ void test_msvc_toolchain()
 
         assert(cmd.executable == "link.exe");
         assert(has_flag_with_prefix(cmd.arguments, "/OUT:build/app.exe"));
-        assert(has_flag(cmd.arguments, "/DEBUG:FULL"));
+        // Debug builds favour link speed: FASTLINK PDBs, incremental links.
+        assert(has_flag(cmd.arguments, "/DEBUG:FASTLINK"));
+        assert(has_flag(cmd.arguments, "/INCREMENTAL"));
         assert(has_flag_with_prefix(cmd.arguments, "/LIBPATH:\"C:/libs\""));
         assert(has_flag(cmd.arguments, "build/main.obj"));
         assert(has_flag(cmd.arguments, "build/Core.obj"));
         assert(has_flag(cmd.arguments, "kernel32.lib"));
         std::cout << "  Test 1C: generate_link_command... Passed\n";
     }
+
+    // Test 1D: dependency output is requested only when asked for
+    {
+        CompileObjectArgs args;
+        args.source_file = "src/main.cpp";
+        args.output_obj_path = "build/main.obj";
+        assert(!has_flag(msvc.generate_compile_obj_command(args)->arguments,
+                         "/sourceDependencies"));
+
+        args.dependency_file = "build/main.obj.json";
+        auto cmd = *msvc.generate_compile_obj_command(args);
+        assert(has_flag(cmd.arguments, "/sourceDependencies"));
+        assert(has_flag(cmd.arguments, "build/main.obj.json"));
+        assert(msvc.dependency_format() ==
+               DependencyFormat::MsvcSourceDependencies);
+
+        ClangToolchain clang("clang-cl.exe", debug_config);
+        args.dependency_file = "build/main.obj.d";
+        auto clang_cmd = *clang.generate_compile_obj_command(args);
+        assert(has_flag(clang_cmd.arguments, "/clang:-MD"));
+        assert(has_flag(clang_cmd.arguments, "/clang:-MFbuild/main.obj.d"));
+        // clang-cl reads a bare -MD as /MD, replacing the debug runtime.
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/core.ixx";
+        emit.output_ifc_path = "build/Core.ifc";
+        emit.dependency_file = "build/Core.ifc.d";
+        for (const auto& cmd :
+             { clang_cmd, *clang.generate_emit_ifc_command(emit) })
+        {
+            assert(has_flag(cmd.arguments, "/MDd"));
+            assert(!has_flag(cmd.arguments, "/MD"));
+            assert(!has_flag(cmd.arguments, "-MD"));
+            assert(!has_flag(cmd.arguments, "-MF"));
+        }
+        assert(clang.dependency_format() == DependencyFormat::Makefile);
+        std::cout << "  Test 1D: dependency file options... Passed\n";
+    }
+
+    // Test 1E: generate_scan_deps_command
+    {
+        ScanDepsArgs args;
+        args.source_file = "src/Core.ixx";
+        args.output_obj_path = "build/Core.obj";
+        args.output_scan_path = "build/Core.json";
+
+        auto cmd = *msvc.generate_scan_deps_command(args);
+        assert(cmd.executable == "cl.exe");
+        assert(has_flag(cmd.arguments, "/scanDependencies"));
+        assert(has_flag(cmd.arguments, "build/Core.json"));
+        assert(has_flag(cmd.arguments, "src/Core.ixx"));
+
+        ClangToolchain clang("llvm/bin/clang-cl.exe", debug_config);
+        auto clang_cmd = *clang.generate_scan_deps_command(args);
+        assert(clang_cmd.executable == path("llvm/bin/clang-scan-deps.exe"));
+        assert(has_flag(clang_cmd.arguments, "-format=p1689"));
+        assert(has_flag(clang_cmd.arguments, "llvm/bin/clang-cl.exe"));
+        assert(has_flag(clang_cmd.arguments, "src/Core.ixx"));
+        assert(!has_flag(clang_cmd.arguments, "/clang:-MD"));
+
+        // Scans can report the headers they read.
+        args.dependency_file = "build/Core.scan.d";
+        clang_cmd = *clang.generate_scan_deps_command(args);
+        assert(has_flag(clang_cmd.arguments, "/clang:-MFbuild/Core.scan.d"));
+        std::cout << "  Test 1E: generate_scan_deps_command... Passed\n";
+    }
+
+    // Test 1F: precompiled headers are created once and injected into users
+    {
+        EmitPchArgs args;
+        args.pch = { "build/pch/gmf.h", "build/gmf.pch" };
+        args.stub_source = "build/pch/gmf.cpp";
+        args.output_obj_path = "build/gmf.obj";
+
+        const std::string header = args.pch.header.string();
+        const std::string pch = args.pch.pch_path.string();
+
+        auto cmd = *msvc.generate_emit_pch_command(args);
+        assert(has_flag(cmd.arguments, "build/pch/gmf.cpp"));
+        assert(has_flag(cmd.arguments, "/Yc" + header));
+        assert(has_flag(cmd.arguments, "/Fp" + pch));
+        assert(msvc.pch_emits_object());
+
+        CompileObjectArgs compile;
+        compile.source_file = "src/win.cpp";
+        compile.output_obj_path = "build/win.obj";
+        compile.precompiled_header = args.pch;
+        auto use = *msvc.generate_compile_obj_command(compile);
+        assert(has_flag(use.arguments, "/Yu" + header));
+        assert(has_flag(use.arguments, "/FI" + header));
+        assert(has_flag(use.arguments, "/Fp" + pch));
+
+        // clang-cl takes the MSVC spellings.
+        ClangToolchain clang_cl("clang-cl", debug_config);
+        auto clang_cmd = *clang_cl.generate_emit_pch_command(args);
+        assert(has_flag(clang_cmd.arguments, "build/pch/gmf.cpp"));
+        assert(has_flag(clang_cmd.arguments, "/Yc" + header));
+        assert(has_flag(clang_cmd.arguments, "/Fp" + pch));
+        assert(!has_flag(clang_cmd.arguments, "c++-header"));
+        assert(clang_cl.pch_emits_object());
+        auto clang_use = *clang_cl.generate_compile_obj_command(compile);
+        assert(has_flag(clang_use.arguments, "/Yu" + header));
+        assert(has_flag(clang_use.arguments, "/FI" + header));
+        assert(has_flag(clang_use.arguments, "/Fp" + pch));
+        assert(!has_flag(clang_use.arguments, "-include-pch"));
+
+        ClangxxToolchain clangxx("clang++", debug_config);
+        clang_cmd = *clangxx.generate_emit_pch_command(args);
+        assert(has_flag(clang_cmd.arguments, "c++-header"));
+        assert(has_flag(clang_cmd.arguments, "build/pch/gmf.h"));
+        assert(!clangxx.pch_emits_object());
+        clang_use = *clangxx.generate_compile_obj_command(compile);
+        assert(has_flag(clang_use.arguments, "-include-pch"));
+        assert(has_flag(clang_use.arguments, "build/gmf.pch"));
+
+        compile.precompiled_header.reset();
+        assert(!has_flag_with_prefix(
+            msvc.generate_compile_obj_command(compile)->arguments, "/Yu"));
+        std::cout << "  Test 1F: precompiled header options... Passed\n";
+    }
+
+    // Test 1G: static libraries are thin archives where the tool allows it
+    {
+        ArchiveArgs args;
+        args.object_files = { "build/a.obj", "build/b.obj" };
+        args.output_archive_path = "build/Core.lib";
+
+        auto lib = *msvc.generate_archive_command(args);
+        assert(lib.executable == path("lib.exe"));
+        assert(has_flag(lib.arguments, "/OUT:build/Core.lib"));
+        assert(has_flag(lib.arguments, "build/b.obj"));
+        assert(msvc.archive_file_name("Core") == "Core.lib");
+
+        ClangToolchain clang("/usr/bin/clang++", debug_config);
+        args.output_archive_path = "build/libCore.a";
+        auto ar = *clang.generate_archive_command(args);
+        assert(ar.executable == path("/usr/bin/llvm-ar"));
+        assert(ar.arguments.front() == "rcsT");
+        assert(has_flag(ar.arguments, "build/libCore.a"));
+        args.thin = false;
+        assert(clang.generate_archive_command(args)->arguments.front() ==
+               "rcs");
+        assert(clang.archive_file_name("Core") == "libCore.a");
+
+        // Only cl writes the interface's object alongside the BMI.
+        assert(msvc.emit_ifc_writes_object());
+        assert(!clang.emit_ifc_writes_object());
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/Core.ixx";
+        emit.output_ifc_path = "build/Core.ifc";
+        emit.output_obj_path = "build/Core.interface.obj";
+        assert(has_flag(msvc.generate_emit_ifc_command(emit)->arguments,
+                        "/Fo:build/Core.interface.obj"));
+        std::cout << "  Test 1G: archive commands... Passed\n";
+    }
+
+    // Test 1H: linker selection, threads and incremental linking
+    {
+        LinkArgs args;
+        args.object_files = { "build/main.obj" };
+        args.output_target_path = "build/app.exe";
+
+        auto config =
+            BuildConfigurationFactory::create_release_with_debug_info();
+        config.incremental_link = true;
+        auto release = *MsvcToolchain("cl.exe", "link.exe", config)
+                            .generate_link_command(args);
+        // /OPT:REF rules out incremental links.
+        assert(has_flag(release.arguments, "/INCREMENTAL:NO"));
+        assert(!has_flag(release.arguments, "/INCREMENTAL"));
+        assert(has_flag(release.arguments, "/DEBUG:FULL"));
+
+        config = debug_config;
+        config.linker = Linker::Lld;
+        config.link_threads = 8;
+        auto lld_link = *MsvcToolchain("vc/cl.exe", "vc/link.exe", config)
+                             .generate_link_command(args);
+        assert(lld_link.executable == path("vc/lld-link.exe"));
+        assert(has_flag(lld_link.arguments, "/threads:8"));
+        assert(has_flag(lld_link.arguments, "/DEBUG:FULL"));
+        assert(!has_flag(lld_link.arguments, "/INCREMENTAL"));
+
+        auto lld =
+            *ClangxxToolchain("clang++", config).generate_link_command(args);
+        assert(has_flag(lld.arguments, "-fuse-ld=lld"));
+        assert(has_flag(lld.arguments, "-Wl,--threads=8"));
+
+        // clang-cl passes linker options to lld-link after /link.
+        auto lld_cl =
+            *ClangToolchain("clang-cl", config).generate_link_command(args);
+        assert(has_flag(lld_cl.arguments, "-fuse-ld=lld"));
+        assert(lld_cl.arguments.end()[-3] == "/link");
+        assert(lld_cl.arguments.end()[-2] == "/threads:8");
+        assert(lld_cl.arguments.back() == "/LIBPATH:C:/libs");
+        assert(!has_flag_with_prefix(lld_cl.arguments, "-Wl,"));
+        assert(!has_flag_with_prefix(lld_cl.arguments, "-L"));
+
+        config.linker = Linker::Mold;
+        auto mold =
+            *ClangxxToolchain("clang++", config).generate_link_command(args);
+        assert(has_flag(mold.arguments, "-fuse-ld=mold"));
+        assert(has_flag(mold.arguments, "-Wl,--thread-count=8"));
+        // Mold cannot link COFF; clang-cl keeps its default linker.
+        auto mold_cl =
+            *ClangToolchain("clang-cl", config).generate_link_command(args);
+        assert(!has_flag_with_prefix(mold_cl.arguments, "-fuse-ld"));
+        assert(!has_flag_with_prefix(mold_cl.arguments, "/threads"));
+
+        config.linker = Linker::Default;
+        auto plain =
+            *ClangxxToolchain("clang++", config).generate_link_command(args);
+        assert(std::ranges::none_of(plain.arguments, [](const auto& arg)
+                                    { return arg.starts_with("-fuse-ld"); }));
+        std::cout << "  Test 1H: linker options... Passed\n";
+    }
+
+    // Test 1I: GCC asks the module mapper instead of taking BMI paths
+    {
+        GccToolchain gcc("/opt/gcc/bin/g++-14", debug_config,
+                         "=/tmp/importa.sock");
+
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/core.ixx";
+        emit.output_ifc_path = "build/Core/Core.ifc";
+        emit.output_obj_path = "build/Core/Core.obj";
+        emit.module_dependencies = { { "Base", "build/Base/Base.ifc" } };
+        emit.dependency_file = "build/Core/Core.ifc.d";
+        auto cmd = *gcc.generate_emit_ifc_command(emit);
+        assert(cmd.executable == path("/opt/gcc/bin/g++-14"));
+        assert(has_flag(cmd.arguments, "-fmodules-ts"));
+        assert(has_flag(cmd.arguments, "src/core.ixx"));
+        assert(has_flag(cmd.arguments, "build/Core/Core.obj"));
+        assert(has_flag(cmd.arguments, "-fmodule-mapper==/tmp/importa.sock"
+                                       "?build/Core/Core.ifc"));
+        assert(has_flag(cmd.arguments, "-Mno-modules"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-fmodule-file"));
+        assert(gcc.emit_ifc_writes_object());
+        assert(gcc.get_bmi_path("build/Core/Core.ifc") ==
+               path("build/Core/Core.gcm"));
+
+        CompileObjectArgs compile;
+        compile.source_file = "src/core_impl.cpp";
+        compile.output_obj_path = "build/Core/core_impl.obj";
+        cmd = *gcc.generate_compile_obj_command(compile);
+        assert(has_flag(cmd.arguments, "-fmodule-mapper==/tmp/importa.sock"
+                                       "?build/Core/core_impl.obj"));
+        assert(!has_flag(cmd.arguments, "-MD"));
+
+        ArchiveArgs archive;
+        archive.object_files = { "build/Core/Core.obj" };
+        archive.output_archive_path = "build/Core/libCore.a";
+        cmd = *gcc.generate_archive_command(archive);
+        assert(cmd.executable == path("/opt/gcc/bin/gcc-ar-14"));
+        assert(gcc.archive_file_name("Core") == path("libCore.a"));
+
+        LinkArgs link;
+        link.object_files = { "build/Core/libCore.a" };
+        link.output_target_path = "build/app";
+        link.link_libraries = { "pthread", "/usr/lib/libz.a" };
+        cmd = *gcc.generate_link_command(link);
+        assert(has_flag(cmd.arguments, "-lpthread"));
+        assert(has_flag(cmd.arguments, "/usr/lib/libz.a"));
+
+        ScanDepsArgs scan;
+        scan.source_file = "src/core.ixx";
+        scan.output_obj_path = "build/Core/Core.obj";
+        scan.output_scan_path = "build/scan/core.ddi";
+        cmd = *gcc.generate_scan_deps_command(scan);
+        assert(has_flag(cmd.arguments, "-fdeps-format=p1689r5"));
+        assert(has_flag(cmd.arguments, "-fdeps-file=build/scan/core.ddi"));
+        scan.dependency_file = "build/scan/core.d";
+        cmd = *gcc.generate_scan_deps_command(scan);
+        assert(has_flag(cmd.arguments, "build/scan/core.d"));
+        assert(has_flag(cmd.arguments, "-Mno-modules"));
+        std::cout << "  Test 1I: GCC commands... Passed\n";
+    }
+
+    // Test 1J: native clang++ writes the object and the BMI in one step
+    {
+        ClangxxToolchain one_phase("/usr/bin/clang++-18", debug_config);
+        ClangxxToolchain two_phase("/usr/bin/clang++-18", debug_config,
+                                   InterfaceCompilation::TwoPhase);
+
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/core.ixx";
+        emit.output_ifc_path = "build/Core/Core.ifc";
+        emit.output_obj_path = "build/Core/Core.obj";
+        emit.module_dependencies = { { "Base", "build/Base/Base.ifc" } };
+        emit.dependency_file = "build/Core/Core.ifc.d";
+        auto cmd = *one_phase.generate_emit_ifc_command(emit);
+        assert(cmd.executable == path("/usr/bin/clang++-18"));
+        assert(one_phase.emit_ifc_writes_object());
+        assert(has_flag(cmd.arguments, "-c"));
+        assert(has_flag(cmd.arguments, "c++-module"));
+        assert(has_flag(cmd.arguments, "build/Core/Core.obj"));
+        assert(has_flag(cmd.arguments,
+                        "-fmodule-output=build/Core/Core.pcm"));
+        assert(has_flag(cmd.arguments,
+                        "-fmodule-file=Base=build/Base/Base.pcm"));
+        assert(!has_flag(cmd.arguments, "--precompile"));
+        assert(!has_flag(cmd.arguments, "-fms-compatibility"));
+        assert(has_flag(cmd.arguments, "-MD"));
+
+        cmd = *two_phase.generate_emit_ifc_command(emit);
+        assert(!two_phase.emit_ifc_writes_object());
+        assert(has_flag(cmd.arguments, "--precompile"));
+        assert(has_flag(cmd.arguments, "build/Core/Core.pcm"));
+        assert(!has_flag(cmd.arguments, "build/Core/Core.obj"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-fmodule-output"));
+        assert(one_phase.get_bmi_path("build/Core/Core.ifc") ==
+               path("build/Core/Core.pcm"));
+
+        ArchiveArgs archive;
+        archive.object_files = { "build/Core/Core.obj" };
+        archive.output_archive_path = "build/Core/libCore.a";
+        cmd = *one_phase.generate_archive_command(archive);
+        assert(cmd.executable == path("/usr/bin/llvm-ar-18"));
+        assert(one_phase.archive_file_name("Core") == path("libCore.a"));
+
+        ScanDepsArgs scan;
+        scan.source_file = "src/core.ixx";
+        scan.output_obj_path = "build/Core/Core.obj";
+        scan.dependency_file = "build/scan/core.d";
+        cmd = *one_phase.generate_scan_deps_command(scan);
+        assert(cmd.executable == path("/usr/bin/clang-scan-deps-18"));
+        assert(has_flag(cmd.arguments, "-MF"));
+        assert(has_flag(cmd.arguments, "build/scan/core.d"));
+
+        LinkArgs link;
+        link.object_files = { "build/Core/libCore.a" };
+        link.output_target_path = "build/app";
+        link.link_libraries = { "pthread" };
+        cmd = *one_phase.generate_link_command(link);
+        assert(has_flag(cmd.arguments, "-lpthread"));
+        std::cout << "  Test 1J: clang++ commands... Passed\n";
+    }
+
+    // Test 1K: reduced BMIs need the one-phase interface compile
+    {
+        auto config = debug_config;
+        config.reduced_bmi = true;
+        ClangxxToolchain one_phase("clang++", config);
+        ClangxxToolchain two_phase("clang++", config,
+                                   InterfaceCompilation::TwoPhase);
+        ClangToolchain clang_cl("clang-cl", config);
+
+        EmitIFCArgs emit;
+        emit.interface_unit_path = "src/core.ixx";
+        emit.output_ifc_path = "build/Core/Core.ifc";
+        emit.output_obj_path = "build/Core/Core.obj";
+
+        auto cmd = *one_phase.generate_emit_ifc_command(emit);
+        assert(has_flag(cmd.arguments, "-fmodules-reduced-bmi"));
+        assert(one_phase.writes_reduced_bmi());
+
+        cmd = *two_phase.generate_emit_ifc_command(emit);
+        assert(!has_flag(cmd.arguments, "-fmodules-reduced-bmi"));
+        assert(!two_phase.writes_reduced_bmi());
+
+        cmd = *clang_cl.generate_emit_ifc_command(emit);
+        assert(has_flag(cmd.arguments, "-fmodules-reduced-bmi"));
+        assert(has_flag(cmd.arguments,
+                        "-fmodule-output=build/Core/Core.pcm"));
+        assert(!has_flag(cmd.arguments, "--precompile"));
+        assert(clang_cl.emit_ifc_writes_object());
+        assert(clang_cl.writes_reduced_bmi());
+
+        ClangToolchain full_bmi("clang-cl", debug_config);
+        assert(!full_bmi.emit_ifc_writes_object());
+        assert(!full_bmi.writes_reduced_bmi());
+        assert(!MsvcToolchain("cl", "link", config).writes_reduced_bmi());
+        std::cout << "  Test 1K: reduced BMIs... Passed\n";
+    }
+
+    // Test 1L: per-module overrides share one flag list per configuration
+    {
+        auto release = BuildConfigurationFactory::create_release_default();
+        ClangxxToolchain clangxx("clang++", release);
+        MsvcToolchain msvc("cl", "link", release);
+
+        ConfigurationOverride hot;
+        hot.optimization = OptimizationLevel::O3;
+        ConfigurationOverride scaffolding;
+        scaffolding.optimization = OptimizationLevel::O1;
+        scaffolding.debug_info = DebugInfo::Minimal;
+        scaffolding.defines = { "TESTING" };
+        ConfigurationOverride same_as_base;
+        same_as_base.optimization = release.optimization;
+
+        const auto base = clangxx.compile_flags({});
+        assert(base == clangxx.compile_flags({}));
+        assert(base == clangxx.compile_flags(same_as_base));
+        const auto hot_flags = clangxx.compile_flags(hot);
+        assert(hot_flags != base && hot_flags == clangxx.compile_flags(hot));
+        assert(has_flag(*hot_flags, "-O3") && !has_flag(*hot_flags, "-O2"));
+        assert(has_flag(*base, "-O2") && !has_flag(*base, "-g"));
+
+        CompileObjectArgs obj;
+        obj.source_file = "test/fixture.cpp";
+        obj.output_obj_path = "build/Test/fixture.obj";
+        obj.configuration = scaffolding;
+        auto cmd = *clangxx.generate_compile_obj_command(obj);
+        assert(has_flag(cmd.arguments, "-O1"));
+        assert(has_flag(cmd.arguments, "-g"));
+        assert(has_flag(cmd.arguments, "-DNDEBUG"));
+        assert(has_flag(cmd.arguments, "-DTESTING"));
+        const auto scaffolding_flags = clangxx.compile_flags(scaffolding);
+        assert(std::ranges::equal(
+            *scaffolding_flags,
+            cmd.arguments | std::views::take(scaffolding_flags->size())));
+
+        cmd = *msvc.generate_compile_obj_command(obj);
+        assert(has_flag(cmd.arguments, "/O1"));
+        assert(has_flag(cmd.arguments, "/Z7"));
+        obj.configuration = hot;
+        cmd = *msvc.generate_compile_obj_command(obj);
+        assert(has_flag(cmd.arguments, "/Ox"));
+        assert(!has_flag(cmd.arguments, "/Z7"));
+
+        // Debug builds stay unoptimized; copies share the cache.
+        ClangxxToolchain debug("clang++", debug_config);
+        assert(debug.compile_flags(hot) == debug.compile_flags({}));
+        const auto copy = clangxx;
+        assert(copy.compile_flags(hot) == hot_flags);
+        std::cout << "  Test 1L: per-module configurations... Passed\n";
+    }
+
+    // Test 1M: LTO compile and link flags, backend jobs and ThinLTO cache
+    {
+        auto thin = BuildConfigurationFactory::create_release_default();
+        thin.lto = LtoMode::Thin;
+        thin.lto_jobs = 6;
+        thin.linker = Linker::Lld;
+        auto full = thin;
+        full.lto = LtoMode::Full;
+
+        LinkArgs link;
+        link.object_files = { "build/App/App.obj" };
+        link.output_target_path = "build/app";
+        link.lto_cache_dir = "build/lto_cache";
+
+        ClangxxToolchain clangxx("clang++", thin);
+        assert(has_flag(*clangxx.compile_flags({}), "-flto=thin"));
+        auto cmd = *clangxx.generate_link_command(link);
+        assert(has_flag(cmd.arguments, "-flto=thin"));
+        assert(has_flag(cmd.arguments, "-flto-jobs=6"));
+        assert(has_flag(cmd.arguments,
+                        "-Wl,--thinlto-cache-dir=build/lto_cache"));
+        assert(has_flag_with_prefix(cmd.arguments,
+                                    "-Wl,--thinlto-cache-policy="));
+        assert(clangxx.link_jobs() == 6);
+        // codegen runs in the linker: the link carries the -O level, and a
+        // module's higher level wins over the configuration's
+        assert(has_flag(cmd.arguments, "-O2"));
+        auto hot_link = link;
+        hot_link.optimization = OptimizationLevel::O3;
+        cmd = *clangxx.generate_link_command(hot_link);
+        assert(has_flag(cmd.arguments, "-O3"));
+        assert(!has_flag(cmd.arguments, "-O2"));
+        auto debug_thin = thin;
+        debug_thin.mode = BuildMode::Debug;
+        cmd = *ClangxxToolchain("clang++", debug_thin)
+                   .generate_link_command(hot_link);
+        assert(has_flag(cmd.arguments, "-O0"));
+
+        auto gold = thin;
+        gold.linker = Linker::Default;
+        cmd = *ClangxxToolchain("clang++", gold).generate_link_command(link);
+        assert(has_flag(cmd.arguments,
+                        "-Wl,-plugin-opt,cache-dir=build/lto_cache"));
+
+        ClangxxToolchain clangxx_full("clang++", full);
+        assert(has_flag(*clangxx_full.compile_flags({}), "-flto"));
+        cmd = *clangxx_full.generate_link_command(link);
+        assert(has_flag(cmd.arguments, "-flto"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-flto-jobs"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-Wl,--thinlto"));
+        assert(clangxx_full.link_jobs() == 1);
+
+        // clang-cl: lld-link options after /link, even without Linker::Lld
+        auto cl_thin = thin;
+        cl_thin.linker = Linker::Default;
+        ClangToolchain clang_cl("clang-cl", cl_thin);
+        assert(has_flag(*clang_cl.compile_flags({}), "-flto=thin"));
+        cmd = *clang_cl.generate_link_command(link);
+        assert(has_flag(cmd.arguments, "-flto=thin"));
+        assert(has_flag(cmd.arguments, "-fuse-ld=lld"));
+        assert(has_flag(cmd.arguments, "/link"));
+        assert(has_flag(cmd.arguments, "/opt:lldltojobs=6"));
+        assert(has_flag(cmd.arguments, "/opt:lldlto=2"));
+        cmd = *clang_cl.generate_link_command(hot_link);
+        assert(has_flag(cmd.arguments, "/opt:lldlto=3"));
+        assert(has_flag(cmd.arguments, "/lldltocache:build/lto_cache"));
+        assert(has_flag_with_prefix(cmd.arguments, "/lldltocachepolicy:"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-flto-jobs"));
+        assert(!has_flag_with_prefix(cmd.arguments, "-Wl,"));
+
+        GccToolchain gcc("g++", thin, "=/tmp/mapper.sock");
+        assert(has_flag(*gcc.compile_flags({}), "-flto"));
+        assert(has_flag(gcc.generate_link_command(link)->arguments,
+                        "-flto=6"));
+        assert(gcc.link_jobs() == 6);
+
+        MsvcToolchain msvc("cl", "link", thin);
+        assert(has_flag(*msvc.compile_flags({}), "/GL"));
+        cmd = *msvc.generate_link_command(link);
+        assert(cmd.executable == path("link"));
+        assert(has_flag(cmd.arguments, "/LTCG:INCREMENTAL"));
+        assert(has_flag(cmd.arguments, "/CGTHREADS:6"));
+        assert(msvc.link_jobs() == 6);
+        ArchiveArgs archive;
+        archive.object_files = link.object_files;
+        archive.output_archive_path = "build/App/App.lib";
+        assert(has_flag(msvc.generate_archive_command(archive)->arguments,
+                        "/LTCG"));
+
+        auto incremental = BuildConfigurationFactory::create_debug_default();
+        incremental.lto = LtoMode::Full;
+        cmd = *MsvcToolchain("cl", "link", incremental)
+                   .generate_link_command(link);
+        assert(has_flag(cmd.arguments, "/LTCG"));
+        assert(!has_flag(cmd.arguments, "/INCREMENTAL"));
+        assert(!has_flag_with_prefix(cmd.arguments, "/CGTHREADS"));
+        assert(MsvcToolchain("cl", "link", incremental).link_jobs() == 4);
+
+        // Without LTO nothing changes and links take one slot.
+        auto off = BuildConfigurationFactory::create_release_default();
+        ClangxxToolchain plain("clang++", off);
+        assert(!has_flag_with_prefix(*plain.compile_flags({}), "-flto"));
+        assert(!has_flag_with_prefix(
+            plain.generate_link_command(link)->arguments, "-flto"));
+        assert(plain.link_jobs() == 1);
+        assert(GccToolchain("g++", off, "=m").link_jobs() == 1);
+        std::cout << "  Test 1M: link-time optimization... Passed\n";
+    }
     std::cout << "--- MsvcToolchain tests all passed ---\n\n";
 }
 
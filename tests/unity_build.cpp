@@ -0,0 +1,242 @@
+// tests_unity_build.cpp
+// Contains unit tests for unity (jumbo) build planning.
+
+import std;
+import hashing;
+import unity_build;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+
+using namespace importa;
+using namespace importa::unity_build;
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+std::string read_file(const path& file)
+{
+    std::ifstream in(file);
+    return std::string{ std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>() };
+}
+
+std::string impl_unit(std::string_view function)
+{
+    return "module;\n#include <cstdio>\nmodule gfx;\nimport std;\n\nint " +
+           std::string(function) + "() { return 1; }\n";
+}
+} // namespace
+
+// --- Test Suite for UnityPlanner ---
+
+void test_unity_build()
+{
+    std::cout << "--- Running Test Suite: UnityBuild ---\n";
+
+    auto temp_dir = fs::temp_directory_path() / "importa_test_unity_build";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir / "src");
+    const path build_dir = temp_dir / "build";
+
+    // Test 8A: implementation units split into fragment, imports and body
+    {
+        auto parts = split_unit("// header comment\n"
+                                "module;\n"
+                                "#include \"config.h\"\n"
+                                "module gfx;\n"
+                                "import std;\n"
+                                "import core;\n"
+                                "\n"
+                                "int draw() { return 0; }\n");
+        assert(parts.has_value());
+        assert(parts->module_name == "gfx");
+        assert(parts->global_fragment == "#include \"config.h\"\n");
+        assert(parts->global_fragment_line == 3);
+        assert((parts->imports ==
+                std::vector<std::string>{ "import std;", "import core;" }));
+        assert(parts->body_line == 7);
+        assert(parts->body == "\nint draw() { return 0; }\n");
+
+        auto plain = split_unit("#include <cstdio>\nint main() {}\n");
+        assert(plain.has_value());
+        assert(plain->module_name.empty());
+        assert(plain->body_line == 1);
+
+        // Interfaces, partitions and late imports cannot be merged.
+        assert(!split_unit("export module gfx;\n"));
+        assert(!split_unit("module gfx:detail;\n"));
+        assert(!split_unit("module gfx;\n#if X\nimport core;\n#endif\n"));
+        std::cout << "  Test 8A: split implementation units... Passed\n";
+    }
+
+    // Test 8B: the composed source has one declaration and hoisted imports
+    {
+        write_file(temp_dir / "src" / "config.h", "#define LEVEL 1\n");
+        auto a = split_unit("module;\n#include \"config.h\"\nmodule gfx;\n"
+                            "import std;\nint a() { return LEVEL; }\n");
+        auto b = split_unit("module gfx;\nimport std;\nimport core;\n"
+                            "int b() { return 2; }\n");
+        assert(a && b);
+        auto text = compose_unity_source({ { temp_dir / "src" / "a.cpp", *a },
+                                           { temp_dir / "src" / "b.cpp", *b } });
+
+        auto count = [&](std::string_view needle)
+        {
+            std::size_t n = 0;
+            for (auto pos = text.find(needle); pos != std::string::npos;
+                 pos = text.find(needle, pos + 1))
+            {
+                ++n;
+            }
+            return n;
+        };
+        assert(count("module gfx;") == 1);
+        assert(count("import std;") == 1);
+        assert(count("import core;") == 1);
+        assert(text.find("module;") < text.find("#include"));
+        assert(text.find("#include") < text.find("module gfx;"));
+        assert(text.find("module gfx;") < text.find("int a()"));
+        assert(text.find("int a()") < text.find("int b()"));
+        assert(text.find((temp_dir / "src" / "config.h")
+                             .lexically_normal()
+                             .generic_string()) != std::string::npos);
+        assert(text.find("#line 5 \"" +
+                         (temp_dir / "src" / "a.cpp").generic_string()) !=
+               std::string::npos);
+        std::cout << "  Test 8B: compose unity source... Passed\n";
+    }
+
+    // Test 8C: sources are grouped into batches within the budgets
+    std::vector<path> sources;
+    for (const char* name : { "a", "b", "c", "d", "e" })
+    {
+        sources.push_back(temp_dir / "src" / (std::string(name) + ".cpp"));
+        write_file(sources.back(), impl_unit(name));
+    }
+    const path standalone = temp_dir / "src" / "f.cpp";
+    write_file(standalone, "export module gfx;\n");
+    sources.push_back(standalone);
+
+    UnityOptions options;
+    options.max_batch_files = 2;
+    options.hot_threshold = 2;
+    options.history_window = 4;
+    {
+        UnityPlanner planner(build_dir, options);
+        auto batches = planner.plan("gfx", sources);
+        // a+b, c+d, e alone, f (an interface) alone
+        assert(batches.size() == 4);
+        std::size_t merged = 0;
+        for (const auto& batch : batches)
+        {
+            if (batch.members.size() > 1)
+            {
+                ++merged;
+                assert(batch.members.size() == 2);
+                assert(batch.source.parent_path() == build_dir / "gfx");
+                assert(fs::exists(batch.source));
+            }
+            else
+            {
+                assert(batch.source == batch.members.front());
+            }
+        }
+        assert(merged == 2);
+        planner.save();
+
+        // A byte budget smaller than two files disables merging.
+        UnityOptions tight = options;
+        tight.max_batch_bytes = impl_unit("a").size() + 1;
+        UnityPlanner tight_planner(temp_dir / "tight_build", tight);
+        for (const auto& batch : tight_planner.plan("gfx", sources))
+        {
+            assert(batch.members.size() == 1);
+        }
+        std::cout << "  Test 8C: batch size budgets... Passed\n";
+    }
+
+    // Test 8D: unchanged plans leave generated sources untouched
+    {
+        const path unity0 = build_dir / "gfx" / "gfx.unity0.cpp";
+        const auto before = fs::last_write_time(unity0);
+        fs::last_write_time(unity0, before - std::chrono::hours(1));
+        UnityPlanner planner(build_dir, options);
+        planner.plan("gfx", sources);
+        assert(fs::last_write_time(unity0) == before - std::chrono::hours(1));
+        std::cout << "  Test 8D: generated sources are stable... Passed\n";
+    }
+
+    // Test 8E: a frequently edited file is split out of its batch
+    {
+        UnityPlanner planner(build_dir, options);
+        for (int edit = 0; edit < 2; ++edit)
+        {
+            write_file(sources[0], impl_unit("a") + "// edit " +
+                                       std::to_string(edit) + "\n");
+            planner.plan("gfx", sources);
+        }
+        planner.save();
+        assert(fs::exists(build_dir / "unity_churn"));
+
+        // The history survives a restart.
+        UnityPlanner reopened(build_dir, options);
+        auto batches = reopened.plan("gfx", sources);
+        auto hot = std::ranges::find_if(batches, [&](const UnityBatch& batch)
+                                        { return batch.source == sources[0]; });
+        assert(hot != batches.end());
+        assert(hot->members == std::vector<path>{ sources[0] });
+        for (const auto& batch : batches)
+        {
+            assert(batch.members.size() <= 2);
+        }
+        assert(read_file(build_dir / "gfx" / "gfx.unity0.cpp")
+                   .find("int a()") == std::string::npos);
+
+        // Once the file settles down it rejoins a batch.
+        for (int plan = 0; plan < 4; ++plan)
+        {
+            batches = reopened.plan("gfx", sources);
+        }
+        assert(std::ranges::none_of(batches, [&](const UnityBatch& batch)
+                                    { return batch.source == sources[0]; }));
+        std::cout << "  Test 8E: hot files are re-split... Passed\n";
+    }
+
+    // Test 8F: generated sources no longer in use are removed
+    {
+        UnityPlanner planner(build_dir, options);
+        auto batches = planner.plan("gfx", { sources[1], sources[2] });
+        assert(batches.size() == 1);
+        assert(fs::exists(build_dir / "gfx" / "gfx.unity0.cpp"));
+        assert(!fs::exists(build_dir / "gfx" / "gfx.unity1.cpp"));
+        std::cout << "  Test 8F: stale unity sources removed... Passed\n";
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "--- UnityBuild tests all passed ---\n\n";
+}
+
+int main()
+{
+    try
+    {
+        test_unity_build();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "All UnityBuild tests passed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,443 @@
+// tests_watch_mode.cpp
+// Contains tests for the FileWatcher and the WatchSession, using a mock
+// toolchain and a mock executor.
+
+import std;
+import executor;
+import toolchains;
+import module_processor;
+import builder;
+import file_watcher;
+import watch_mode;
+
+#include <cassert>
+
+using path = std::filesystem::path;
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+using namespace importa;
+using namespace importa::executor;
+using namespace importa::toolchains;
+using namespace importa::module_processor;
+using namespace importa::file_watcher;
+using namespace importa::watch_mode;
+
+// --- Mock Object Definitions ---
+
+// Produces "mock <output> <source> [-MF <depfile>]" commands.
+struct MockToolchain : public IToolchain
+{
+    std::optional<Command> generate_emit_ifc_command(
+        const EmitIFCArgs& args) const override
+    {
+        auto command = make_command(args.output_ifc_path,
+                                    args.interface_unit_path,
+                                    args.dependency_file);
+        if (!args.output_obj_path.empty())
+        {
+            command.arguments.push_back(args.output_obj_path.string());
+        }
+        return command;
+    }
+
+    std::optional<Command> generate_compile_obj_command(
+        const CompileObjectArgs& args) const override
+    {
+        return make_command(args.output_obj_path, args.source_file,
+                            args.dependency_file);
+    }
+
+    std::optional<Command> generate_link_command(
+        const LinkArgs& args) const override
+    {
+        return Command{};
+    }
+
+  private:
+    static Command make_command(const path& output, const path& source,
+                                const path& depfile)
+    {
+        Command command;
+        command.executable = "mock";
+        command.arguments = { output.string(), source.string() };
+        if (!depfile.empty())
+        {
+            command.arguments.push_back("-MF");
+            command.arguments.push_back(depfile.string());
+        }
+        return command;
+    }
+};
+
+// Copies the source into the output (and any extra outputs listed after the
+// depfile), so BMIs change with their interfaces, and writes a depfile that
+// lists only the source.
+struct MockExecutor : public IExecutor
+{
+    std::mutex mutex;
+    std::vector<std::string> executed;
+
+    ExecutionResult execute(const Command& command) override
+    {
+        const path output = command.arguments[0];
+        const path source = command.arguments[1];
+        fs::create_directories(output.parent_path());
+        fs::copy_file(source, output, fs::copy_options::overwrite_existing);
+        for (std::size_t i = 2; i < command.arguments.size(); ++i)
+        {
+            if (command.arguments[i] == "-MF")
+            {
+                std::ofstream depfile(command.arguments[++i]);
+                depfile << output.string() << ": " << source.string() << "\n";
+            }
+            else
+            {
+                fs::copy_file(source, command.arguments[i],
+                              fs::copy_options::overwrite_existing);
+            }
+        }
+        std::lock_guard lock(mutex);
+        executed.push_back(source.filename().string());
+        return { .success = true, .exit_code = 0 };
+    }
+
+    std::size_t count()
+    {
+        std::lock_guard lock(mutex);
+        return executed.size();
+    }
+};
+
+namespace
+{
+void write_file(const path& file, std::string_view content)
+{
+    std::ofstream out(file, std::ios::trunc);
+    out << content;
+}
+
+// Build outputs are watched as well, to notice them being deleted.
+std::size_t count_outputs(const WatchSession& session)
+{
+    std::size_t count = 0;
+    for (const auto& action : session.actions())
+    {
+        count += action.outputs.size();
+    }
+    return count;
+}
+} // namespace
+
+// --- Test Suite for FileWatcher ---
+
+void test_file_watcher(const path& temp_dir)
+{
+    std::cout << "--- Running Test Suite: FileWatcher ---\n";
+
+    const path a = temp_dir / "a.cpp";
+    const path b = temp_dir / "b.cpp";
+    const path c = temp_dir / "c.cpp";
+    write_file(a, "a");
+    write_file(b, "b");
+
+    FileWatcher watcher;
+    watcher.watch(a);
+    watcher.watch(b);
+    watcher.watch(c); // does not exist yet
+    watcher.watch(a);
+    assert(watcher.size() == 3);
+
+    // Test 4A: a single save is reported
+    {
+        std::jthread writer(
+            [&]
+            {
+                std::this_thread::sleep_for(50ms);
+                write_file(a, "a2");
+            });
+        auto changed = watcher.wait_for_changes();
+        assert(changed == std::vector<path>{ a });
+        std::cout << "  Test 4A: single change... Passed\n";
+    }
+
+    // Test 4B: a burst of changes is coalesced into one batch
+    {
+        std::jthread writer(
+            [&]
+            {
+                std::this_thread::sleep_for(50ms);
+                write_file(b, "b2");
+                write_file(c, "c");
+                write_file(a, "a3");
+                write_file(b, "b3");
+            });
+        auto changed = watcher.wait_for_changes(100ms, 2s);
+        assert((changed == std::vector<path>{ a, b, c }));
+        std::cout << "  Test 4B: burst coalescing... Passed\n";
+    }
+
+    // Test 4C: atomic saves (write temp + rename) and unwatched files
+    {
+        std::jthread writer(
+            [&]
+            {
+                std::this_thread::sleep_for(50ms);
+                write_file(temp_dir / "unrelated.txt", "x");
+                write_file(temp_dir / "b.cpp.tmp", "b4");
+                fs::rename(temp_dir / "b.cpp.tmp", b);
+            });
+        auto changed = watcher.wait_for_changes(100ms, 2s);
+        assert(changed == std::vector<path>{ b });
+        std::cout << "  Test 4C: atomic save... Passed\n";
+    }
+
+    // Test 4D: stop() wakes up a blocked waiter
+    {
+        std::jthread stopper(
+            [&]
+            {
+                std::this_thread::sleep_for(50ms);
+                watcher.stop();
+            });
+        assert(watcher.wait_for_changes().empty());
+        assert(watcher.stopped());
+        std::cout << "  Test 4D: stop... Passed\n";
+    }
+
+    std::cout << "--- FileWatcher tests all passed ---\n\n";
+}
+
+// --- Test Suite for WatchSession ---
+
+void test_watch_session(const path& temp_dir)
+{
+    std::cout << "--- Running Test Suite: WatchSession ---\n";
+
+    const path core_src = temp_dir / "core.ixx";
+    const path app_src = temp_dir / "app.ixx";
+    const path util_src = temp_dir / "util.ixx";
+    const path manifest = temp_dir / "project.impa";
+    write_file(core_src, "export module Core;");
+    write_file(app_src, "export module App; import Core;");
+    write_file(util_src, "export module Util;");
+    write_file(manifest, "Core App");
+
+    std::atomic<bool> with_util = false;
+    ProjectLoader loader = [&]() -> std::optional<Project>
+    {
+        Project project;
+        project.name = "App";
+        project.modules = {
+            { .name = "App",
+              .primary_interface = app_src,
+              .dependencies = { "Core" } },
+            { .name = "Core", .primary_interface = core_src },
+        };
+        if (with_util)
+        {
+            project.modules.push_back(
+                { .name = "Util", .primary_interface = util_src });
+        }
+        return project;
+    };
+
+    MockToolchain toolchain;
+    MockExecutor executor;
+    WatchSession session(loader, { manifest }, toolchain, executor,
+                         temp_dir / "build",
+                         { .quiet_period = 20ms, .max_coalesce = 1s });
+
+    // Test 5A: the first build runs everything and subscribes to inputs
+    {
+        auto stats = session.build_once();
+        assert(stats);
+        assert(stats.executed == 2);
+        assert(session.actions().size() == 2);
+        // two sources + manifest + outputs
+        assert(session.watcher().size() == 3 + count_outputs(session));
+        std::cout << "  Test 5A: initial build... Passed\n";
+    }
+
+    // Test 5B: a source change only schedules its downstream actions
+    {
+        write_file(app_src, "export module App; import Core; // edit");
+        executor.executed.clear();
+        auto stats = session.on_changes({ app_src });
+        assert(stats.executed == 1);
+        assert(executor.executed == std::vector<std::string>{ "app.ixx" });
+
+        write_file(core_src, "export module Core; // edit");
+        executor.executed.clear();
+        stats = session.on_changes({ core_src });
+        assert(stats.executed == 2);
+        assert(executor.executed.front() == "core.ixx");
+        std::cout << "  Test 5B: affected actions only... Passed\n";
+    }
+
+    // Test 5C: a manifest change reloads and replans the project
+    {
+        with_util = true;
+        write_file(manifest, "Core App Util");
+        executor.executed.clear();
+        auto stats = session.on_changes({ manifest });
+        assert(stats.executed == 1);
+        assert(stats.skipped == 2);
+        assert(session.actions().size() == 3);
+        assert(session.watcher().size() == 4 + count_outputs(session));
+        std::cout << "  Test 5C: manifest reload... Passed\n";
+    }
+
+    // Test 5D: run() rebuilds on save until stop is requested
+    {
+        executor.executed.clear();
+        std::jthread loop([&](std::stop_token stop) { session.run(stop); });
+        std::this_thread::sleep_for(100ms); // initial no-op build
+
+        const auto saved = std::chrono::steady_clock::now();
+        write_file(util_src, "export module Util; // saved");
+        while (executor.count() == 0 &&
+               std::chrono::steady_clock::now() - saved < 5s)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+        assert(executor.count() == 1);
+        loop.request_stop();
+        loop.join();
+        std::cout << "  Test 5D: watch loop (save to compile "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - saved)
+                         .count()
+                  << " ms)... Passed\n";
+    }
+
+    // Test 5E: std comes from the user-wide cache, shared by build trees
+    {
+        const path std_src = temp_dir / "std.ixx";
+        write_file(std_src, "export module std;");
+        ProjectLoader std_loader = [&]() -> std::optional<Project>
+        {
+            Project project;
+            project.name = "Hello";
+            project.modules = { { .name = "Hello",
+                                  .primary_interface = core_src,
+                                  .dependencies = { "std" } } };
+            return project;
+        };
+        WatchOptions options;
+        options.std_modules = { { .name = "std", .interface_unit = std_src } };
+        options.std_cache_root = temp_dir / "std_cache";
+
+        executor.executed.clear();
+        WatchSession first(std_loader, {}, toolchain, executor,
+                           temp_dir / "build_std1", options);
+        assert(first.build_once());
+        assert((executor.executed ==
+                std::vector<std::string>{ "std.ixx", "core.ixx" }));
+        const auto& inputs = first.actions().front().inputs;
+        assert(std::ranges::any_of(
+            inputs, [&](const path& input)
+            {
+                return input.parent_path().parent_path() ==
+                       temp_dir / "build_std1" / "std_modules";
+            }));
+
+        executor.executed.clear();
+        WatchSession second(std_loader, {}, toolchain, executor,
+                            temp_dir / "build_std2", options);
+        assert(second.build_once());
+        assert(executor.executed == std::vector<std::string>{ "core.ixx" });
+        std::cout << "  Test 5E: shared std module cache... Passed\n";
+    }
+
+    // Test 5F: a new session starts from the cached graph
+    {
+        with_util = false;
+        write_file(manifest, "Core App");
+        std::atomic<int> loads = 0;
+        ProjectLoader counting_loader = [&]() -> std::optional<Project>
+        {
+            ++loads;
+            return loader();
+        };
+        WatchOptions options{ .graph_cache = true };
+        const path build_dir = temp_dir / "build_graph";
+        {
+            WatchSession first(counting_loader, { manifest }, toolchain,
+                               executor, build_dir, options);
+            assert(first.build_once());
+            assert(loads == 1);
+        }
+        assert(fs::exists(build_dir / "graph.bin"));
+
+        executor.executed.clear();
+        WatchSession second(counting_loader, { manifest }, toolchain,
+                            executor, build_dir, options);
+        auto stats = second.build_once();
+        assert(stats && stats.executed == 0);
+        assert(loads == 1); // no project load, no planning
+        assert(second.actions().size() == 2);
+        assert(second.watcher().size() == 3 + count_outputs(second));
+
+        // Source edits still replan, so new imports are picked up.
+        write_file(core_src, "export module Core; // cached");
+        assert(second.on_changes({ core_src }).executed == 2);
+        assert(loads == 2);
+
+        // A manifest edit invalidates the cache for the next session.
+        with_util = true;
+        write_file(manifest, "Core App Util");
+        WatchSession third(counting_loader, { manifest }, toolchain,
+                           executor, build_dir, options);
+        assert(third.build_once());
+        assert(loads == 3);
+        assert(third.actions().size() == 3);
+        std::cout << "  Test 5F: cached build graph... Passed\n";
+    }
+
+    // Test 5G: pending changes: the build's own writes are not changes,
+    // but a deleted output is rebuilt
+    {
+        assert(session.build_pending(true));
+        std::this_thread::sleep_for(50ms); // let the notifications arrive
+        executor.executed.clear();
+        auto stats = session.build_pending();
+        assert(stats && stats.executed == 0);
+        assert(executor.count() == 0);
+
+        const auto& core = session.actions().front();
+        assert(fs::remove(core.primary_output));
+        std::this_thread::sleep_for(50ms);
+        stats = session.build_pending();
+        assert(stats && stats.executed == 1);
+        assert(executor.executed.front() == "core.ixx");
+        assert(fs::exists(core.primary_output));
+        std::cout << "  Test 5G: deleted outputs are rebuilt... Passed\n";
+    }
+
+    std::cout << "--- WatchSession tests all passed ---\n\n";
+}
+
+int main()
+{
+    auto temp_dir = fs::temp_directory_path() / "importa_test_watch_mode";
+    fs::remove_all(temp_dir);
+    fs::create_directories(temp_dir);
+    temp_dir = fs::canonical(temp_dir);
+
+    try
+    {
+        test_file_watcher(temp_dir);
+        test_watch_session(temp_dir);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "!!! A test failed with exception: " << e.what()
+                  << std::endl;
+        return 1;
+    }
+
+    fs::remove_all(temp_dir);
+    std::cout << "All watch mode tests passed successfully!\n";
+    return 0;
+}